@@ -14,6 +14,7 @@
 
 // Qt
 #include <QtCore/QMutex>
+#include <QtCore/QWaitCondition>
 
 namespace Marble
 {
@@ -33,12 +34,16 @@ class AbstractWorkerThreadPrivate
 
     ~AbstractWorkerThreadPrivate()
     {
+        m_runningMutex.lock();
         m_end = true;
+        m_workAdded.wakeAll();
+        m_runningMutex.unlock();
         m_parent->wait( 1000 );
     }
 
     bool m_running;
     QMutex m_runningMutex;
+    QWaitCondition m_workAdded;
     bool m_end;
 
     AbstractWorkerThread *m_parent;
@@ -65,30 +70,30 @@ void AbstractWorkerThread::ensureRunning()
             start( QThread::IdlePriority );
         }
     }
+    else {
+        d->m_workAdded.wakeAll();
+    }
 }
 
 void AbstractWorkerThread::run()
 {
-    int waitAttempts = WAIT_ATTEMPTS;
     while( !d->m_end ) {
         d->m_runningMutex.lock();
         if ( !workAvailable() ) {
-            waitAttempts--;
-            if ( !waitAttempts || d->m_end ) {
+            // Sleep until ensureRunning() is called again, switch off if
+            // nothing comes in for a while
+            const bool woken = !d->m_end
+                && d->m_workAdded.wait( &d->m_runningMutex, WAIT_ATTEMPTS * WAIT_TIME );
+            if ( !woken && !workAvailable() ) {
                 d->m_running = false;
                 d->m_runningMutex.unlock();
                 break;
             }
-            else {
-                d->m_runningMutex.unlock();
-                msleep( WAIT_TIME );
-            }
+            d->m_runningMutex.unlock();
         }
         else {
             d->m_runningMutex.unlock();
             work();
-
-            waitAttempts = WAIT_ATTEMPTS;
         }
     }
 }
@@ -58,6 +58,9 @@ class ClipPainterPrivate
     inline void clipPolyObject ( const QPolygonF & sourcePolygon, 
                                  QVector<QPolygonF> & clippedPolyObjects,
                                  bool isClosed );
+    inline void clipPolyObjectBatched ( const QPolygonF & sourcePolygon,
+                                        QVector<QPolygonF> & clippedPolyObjects,
+                                        bool isClosed );
 
     inline void clipMultiple( QPolygonF & clippedPolyObject,
                               QVector<QPolygonF> & clippedPolyObjects,
@@ -91,6 +94,13 @@ class ClipPainterPrivate
 #endif
 
     qreal m_labelAreaMargin;
+
+    // true if the batched clipping engine is used.
+    bool    m_batchClipping;
+
+    // Buffers that get reused across paint calls to avoid reallocations.
+    QVector<int>       m_sectors;
+    QVector<QPolygonF> m_clippedPolyObjects;
 };
 
 }
@@ -133,15 +143,48 @@ bool ClipPainter::isClipping() const
 }
 
 
+void ClipPainter::setBatchClipping( bool enable )
+{
+    d->m_batchClipping = enable;
+}
+
+
+bool ClipPainter::isBatchClipping() const
+{
+    return d->m_batchClipping;
+}
+
+
+void ClipPainter::clipPolygon( const QPolygonF & polygon,
+                               QVector<QPolygonF> & clippedPolyObjects,
+                               bool isClosed )
+{
+    d->initClipRect();
+
+    if ( d->m_batchClipping ) {
+        d->clipPolyObjectBatched( polygon, clippedPolyObjects, isClosed );
+    }
+    else {
+        d->clipPolyObject( polygon, clippedPolyObjects, isClosed );
+    }
+}
+
+
 void ClipPainter::drawPolygon ( const QPolygonF & polygon,
                                 Qt::FillRule fillRule )
 {
     d->initClipRect();
 
     if ( d->m_doClip ) {	
-        QVector<QPolygonF> clippedPolyObjects;
+        QVector<QPolygonF> & clippedPolyObjects = d->m_clippedPolyObjects;
+        clippedPolyObjects.resize( 0 );
 
-        d->clipPolyObject( polygon, clippedPolyObjects, true );
+        if ( d->m_batchClipping ) {
+            d->clipPolyObjectBatched( polygon, clippedPolyObjects, true );
+        }
+        else {
+            d->clipPolyObject( polygon, clippedPolyObjects, true );
+        }
 
         foreach( const QPolygonF & clippedPolyObject, clippedPolyObjects ) { 
             if ( clippedPolyObject.size() > 2 ) {
@@ -168,9 +211,15 @@ void ClipPainter::drawPolyline( const QPolygonF & polygon )
     d->initClipRect();
 
     if ( d->m_doClip ) {
-        QVector<QPolygonF> clippedPolyObjects;
+        QVector<QPolygonF> & clippedPolyObjects = d->m_clippedPolyObjects;
+        clippedPolyObjects.resize( 0 );
 
-        d->clipPolyObject( polygon, clippedPolyObjects, false );
+        if ( d->m_batchClipping ) {
+            d->clipPolyObjectBatched( polygon, clippedPolyObjects, false );
+        }
+        else {
+            d->clipPolyObject( polygon, clippedPolyObjects, false );
+        }
 
         foreach( const QPolygonF & clippedPolyObject, clippedPolyObjects ) { 
             if ( clippedPolyObject.size() > 1 ) {
@@ -200,9 +249,15 @@ void ClipPainter::drawPolyline( const QPolygonF & polygon, QVector<QPointF>& lab
 
     if ( d->m_doClip ) {
  
-        QVector<QPolygonF> clippedPolyObjects;
+        QVector<QPolygonF> & clippedPolyObjects = d->m_clippedPolyObjects;
+        clippedPolyObjects.resize( 0 );
 
-        d->clipPolyObject( polygon, clippedPolyObjects, false );
+        if ( d->m_batchClipping ) {
+            d->clipPolyObjectBatched( polygon, clippedPolyObjects, false );
+        }
+        else {
+            d->clipPolyObject( polygon, clippedPolyObjects, false );
+        }
 
         foreach( const QPolygonF & clippedPolyObject, clippedPolyObjects ) { 
             if ( clippedPolyObject.size() > 1 ) {
@@ -351,9 +406,11 @@ ClipPainterPrivate::ClipPainterPrivate( ClipPainter * parent )
       m_previousSector(4),
       m_currentPoint(QPointF()),
       m_previousPoint(QPointF()), 
-      m_labelAreaMargin(10.0)
+      m_labelAreaMargin(10.0),
+      m_batchClipping( true )
 {
     q = parent;
+    m_clippedPolyObjects.reserve( 16 );
 }
 
 void ClipPainterPrivate::initClipRect ()
@@ -524,6 +581,97 @@ void ClipPainterPrivate::clipPolyObject ( const QPolygonF & polygon,
 }
 
 
+void ClipPainterPrivate::clipPolyObjectBatched( const QPolygonF & polygon,
+                                                 QVector<QPolygonF> & clippedPolyObjects,
+                                                 bool isClosed )
+{
+    // This produces exactly the same nodes as clipPolyObject(), but works on
+    // the raw point array and determines the sectors of all nodes in a
+    // single pass first. As the sectors are the outcodes of the viewport
+    // the polygon can get accepted or rejected trivially in most cases.
+
+    const int size = polygon.size();
+    if ( size == 0 ) {
+        return;
+    }
+
+    if ( m_sectors.size() < size ) {
+        m_sectors.resize( size );
+    }
+
+    const QPointF * const points = polygon.constData();
+    int * const sectors = m_sectors.data();
+
+    const int firstSector = sector( points[0] );
+    sectors[0] = firstSector;
+    bool singleSector = true;
+
+    for ( int i = 1; i < size; ++i ) {
+        sectors[i] = sector( points[i] );
+        singleSector = singleSector && sectors[i] == firstSector;
+    }
+
+    if ( singleSector ) {
+        if ( firstSector == 4 ) {
+            // Trivial accept: The whole polygon is located on screen.
+            if ( isClosed ) {
+                QPolygonF clippedPolyObject( size + 1 );
+                qCopy( points, points + size, clippedPolyObject.data() );
+                clippedPolyObject[size] = points[0];
+                clippedPolyObjects << clippedPolyObject;
+            }
+            else {
+                clippedPolyObjects << polygon;
+            }
+        }
+        // Otherwise the polygon never leaves a single off screen sector
+        // and gets rejected trivially.
+        return;
+    }
+
+    QPolygonF clippedPolyObject;
+    clippedPolyObject.reserve( size );
+
+    // Linear rings revisit the first node to tessellate the closing segment.
+    const int nodeCount = isClosed ? size + 1 : size;
+
+    if ( isClosed ) {
+        m_previousPoint = points[size - 1];
+        m_previousSector = sectors[size - 1];
+    }
+    else {
+        m_previousSector = firstSector;
+    }
+
+    for ( int i = 0; i < nodeCount; ++i ) {
+        const int index = ( i < size ) ? i : 0;
+        m_currentPoint = points[index];
+        m_currentSector = sectors[index];
+
+        if ( m_currentSector != m_previousSector ) {
+            if ( m_currentSector == 4 || m_previousSector == 4 ) {
+                clipOnce( clippedPolyObject, clippedPolyObjects, isClosed );
+            }
+            else {
+                clipMultiple( clippedPolyObject, clippedPolyObjects, isClosed );
+            }
+
+            m_previousSector = m_currentSector;
+        }
+
+        if ( m_currentSector == 4 ) {
+            clippedPolyObject << m_currentPoint;
+        }
+
+        m_previousPoint = m_currentPoint;
+    }
+
+    if ( !clippedPolyObject.isEmpty() ) {
+        clippedPolyObjects << clippedPolyObject;
+    }
+}
+
+
 void ClipPainterPrivate::clipMultiple( QPolygonF & clippedPolyObject,
                                        QVector<QPolygonF> & clippedPolyObjects,
                                        bool isClosed )
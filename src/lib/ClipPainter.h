@@ -59,6 +59,25 @@ class MARBLE_EXPORT ClipPainter : public QPainter
     void setClipping( bool enable );
     bool isClipping() const;
 
+    /**
+     * @brief Toggles the batched clipping engine.
+     * The batched engine classifies all nodes of a polygon in one pass and
+     * accepts or rejects polygons that don't cross the viewport border
+     * trivially. It produces the same nodes as the point by point engine,
+     * which is only kept for regression tests. Enabled by default.
+     */
+    void setBatchClipping( bool enable );
+    bool isBatchClipping() const;
+
+    /**
+     * @brief Clips a polygon without painting it.
+     * The visible parts of @p polygon get appended to @p clippedPolyObjects.
+     * @param isClosed true for polygons, false for polylines
+     */
+    void clipPolygon( const QPolygonF & polygon,
+                      QVector<QPolygonF> & clippedPolyObjects,
+                      bool isClosed );
+
     void drawPolygon( const QPolygonF &, 
                       Qt::FillRule fillRule = Qt::OddEvenFill );
 
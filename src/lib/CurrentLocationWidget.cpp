@@ -351,7 +351,7 @@ void CurrentLocationWidgetPrivate::saveTrack()
     QString suggested = m_lastSavePath;
     QString fileName = QFileDialog::getSaveFileName(m_widget, QObject::tr("Save Track"), // krazy:exclude=qclasses
                                                     suggested.append('/' + QDateTime::currentDateTime().toString("yyyy-MM-dd_hhmmss") + ".kml"),
-                            QObject::tr("KML File (*.kml)"));
+                            QObject::tr("KML File (*.kml);;GPX File (*.gpx)"));
     if ( !fileName.isEmpty() ) {
         QFileInfo file( fileName );
         m_lastSavePath = file.absolutePath();
@@ -20,8 +20,13 @@
 #include "MarbleDebug.h"
 #include "MapThemeManager.h"
 #include "TileId.h"
+#include "GeoDataLineString.h"
 
 #include <QtGui/QLabel>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
 #include <QtCore/qmath.h>
 
 namespace Marble
@@ -33,9 +38,14 @@ public:
     ElevationModelPrivate( ElevationModel *_q, MarbleModel *const model )
         : q( _q ),
           m_tileLoader( model->downloadManager() ),
-          m_textureLayer( 0 )
+          m_textureLayer( 0 ),
+          m_tileZoomLevel( 0 ),
+          m_tileWidth( 0 ),
+          m_tileHeight( 0 ),
+          m_numTilesX( 0 ),
+          m_numTilesY( 0 )
     {
-        m_cache.setMaxCost( 10 ); //keep 10 tiles in memory (~17MB)
+        m_cache.setMaxCost( 20 ); //keep 20 tiles in memory (~17MB)
 
         const GeoSceneDocument *srtmTheme = model->mapThemeManager()->loadMapTheme( "earth/srtm2/srtm2.dgml" );
         if ( !srtmTheme ) {
@@ -59,22 +69,199 @@ public:
         textureLayers << m_textureLayer;
 
         m_tileLoader.setTextureLayers( textureLayers );
+
+        // Determined once here, so that sampling does not need to touch
+        // the texture layer and the tile loader from other threads.
+        m_tileZoomLevel = m_tileLoader.maximumTileLevel( *m_textureLayer );
+        Q_ASSERT( m_tileZoomLevel == 9 );
+
+        m_tileWidth = m_textureLayer->tileSize().width();
+        m_tileHeight = m_textureLayer->tileSize().height();
+
+        m_numTilesX = TileLoaderHelper::levelToColumn( m_textureLayer->levelZeroColumns(), m_tileZoomLevel );
+        m_numTilesY = TileLoaderHelper::levelToRow( m_textureLayer->levelZeroRows(), m_tileZoomLevel );
+        Q_ASSERT( m_numTilesX > 0 );
+        Q_ASSERT( m_numTilesY > 0 );
+    }
+
+    /**
+     * Converts an elevation tile to its raw heights, row by row.
+     */
+    static QVector<quint16> heightsFromImage( const QImage &image )
+    {
+        const QImage argbImage = image.convertToFormat( QImage::Format_ARGB32 );
+
+        QVector<quint16> heights( argbImage.width() * argbImage.height() );
+        quint16 *out = heights.data();
+        for ( int y = 0; y < argbImage.height(); ++y ) {
+            const QRgb *line = reinterpret_cast<const QRgb *>( argbImage.scanLine( y ) );
+            for ( int x = 0; x < argbImage.width(); ++x ) {
+                const unsigned int pixel = line[x] - 0xFF000000; //fully opaque
+                // Transparent pixels come from placeholder tiles without data
+                const bool isValid = qAlpha( line[x] ) == 0xFF && pixel < invalidElevationData;
+                *out++ = static_cast<quint16>( isValid ? pixel : invalidElevationData );
+            }
+        }
+
+        return heights;
     }
 
     void tileCompleted( const TileId & tileId, const QImage &image )
     {
-        m_cache.insert( tileId, new QImage( image ) );
+        {
+            QMutexLocker locker( &m_mutex );
+            m_cache.insert( tileId, new QVector<quint16>( heightsFromImage( image ) ) );
+        }
         emit q->updateAvailable();
     }
 
+    /**
+     * Returns the heights of the given tile, or an empty vector if the tile
+     * is not loaded yet and this is not the thread of the elevation model.
+     */
+    QVector<quint16> tile( const TileId &id )
+    {
+        {
+            QMutexLocker locker( &m_mutex );
+            const QVector<quint16> *heights = m_cache.object( id );
+            if ( heights ) {
+                return *heights;
+            }
+
+            if ( QThread::currentThread() != q->thread() ) {
+                if ( m_pendingTiles.isEmpty() ) {
+                    QMetaObject::invokeMethod( q, "loadPendingTiles", Qt::QueuedConnection );
+                }
+                m_pendingTiles.insert( id );
+                return QVector<quint16>();
+            }
+        }
+
+        // Not locked, the tile loader might report completed tiles right away.
+        const QImage image = m_tileLoader.loadTile( id, DownloadBrowse );
+        Q_ASSERT( !image.isNull() );
+        Q_ASSERT( m_tileWidth == image.width() );
+        Q_ASSERT( m_tileHeight == image.height() );
+        const QVector<quint16> heights = heightsFromImage( image );
+
+        QMutexLocker locker( &m_mutex );
+        m_cache.insert( id, new QVector<quint16>( heights ) );
+        return heights;
+    }
+
+    void loadPendingTiles()
+    {
+        QSet<TileId> pendingTiles;
+        {
+            QMutexLocker locker( &m_mutex );
+            pendingTiles = m_pendingTiles;
+            m_pendingTiles.clear();
+        }
+
+        foreach ( const TileId &id, pendingTiles ) {
+            tile( id );
+        }
+
+        if ( !pendingTiles.isEmpty() ) {
+            emit q->updateAvailable();
+        }
+    }
+
+    void heights( const qreal *lons, const qreal *lats, int count, qreal *result );
+
 public:
     ElevationModel *q;
 
     TileLoader m_tileLoader;
     const GeoSceneTexture *m_textureLayer;
-    QCache<TileId, const QImage> m_cache;
+
+    int m_tileZoomLevel;
+    int m_tileWidth;
+    int m_tileHeight;
+    int m_numTilesX;
+    int m_numTilesY;
+
+    QMutex m_mutex;
+    QCache<TileId, const QVector<quint16> > m_cache;
+    QSet<TileId> m_pendingTiles;
 };
 
+void ElevationModelPrivate::heights( const qreal *lons, const qreal *lats, int count, qreal *result )
+{
+    if ( !m_textureLayer ) {
+        for ( int i = 0; i < count; ++i ) {
+            result[i] = invalidElevationData;
+        }
+        return;
+    }
+
+    const int width = m_tileWidth;
+    const int height = m_tileHeight;
+    const int totalWidth = m_numTilesX * width;
+    const int totalHeight = m_numTilesY * height;
+    const qreal pixelsPerDegreeX = qreal( totalWidth ) / 360;
+    const qreal pixelsPerDegreeY = qreal( totalHeight ) / 180;
+
+    // The tiles needed so far, each looked up only once. Neighbouring
+    // samples mostly fall onto the same tile as the sample before.
+    QHash<int, QVector<quint16> > tiles;
+    int lastTileKey = -1;
+    const quint16 *lastTile = 0;
+
+    for ( int n = 0; n < count; ++n ) {
+        const qreal textureX = ( 180 + lons[n] ) * pixelsPerDegreeX;
+        const qreal textureY = ( 90 - lats[n] ) * pixelsPerDegreeY;
+
+        qreal ret = 0;
+        bool hasHeight = false;
+        qreal noData = 0;
+
+        for ( int i = 0; i < 4; ++i ) {
+            const int x = static_cast<int>( textureX + ( i % 2 ) );
+            const int y = static_cast<int>( textureY + ( i / 2 ) );
+
+            const int tileX = ( x % totalWidth ) / width;
+            const int tileY = ( y % totalHeight ) / height;
+            const int tileKey = tileY * m_numTilesX + tileX;
+
+            if ( tileKey != lastTileKey ) {
+                QHash<int, QVector<quint16> >::iterator it = tiles.find( tileKey );
+                if ( it == tiles.end() ) {
+                    const TileId id( "earth/srtm2", m_tileZoomLevel, tileX, tileY );
+                    it = tiles.insert( tileKey, tile( id ) );
+                }
+                lastTileKey = tileKey;
+                lastTile = it.value().isEmpty() ? 0 : it.value().constData();
+            }
+
+            const qreal dx = ( textureX > ( qreal )x ) ? textureX - ( qreal )x : ( qreal )x - textureX;
+            const qreal dy = ( textureY > ( qreal )y ) ? textureY - ( qreal )y : ( qreal )y - textureY;
+
+            Q_ASSERT( 0 <= dx && dx <= 1 );
+            Q_ASSERT( 0 <= dy && dy <= 1 );
+
+            const unsigned int pixel = lastTile ? lastTile[( y % height ) * width + x % width]
+                                                : invalidElevationData;
+            if ( pixel != invalidElevationData ) { //no data?
+                ret += ( qreal )pixel * ( 1 - dx ) * ( 1 - dy );
+                hasHeight = true;
+            } else {
+                noData += ( 1 - dx ) * ( 1 - dy );
+            }
+        }
+
+        if ( !hasHeight ) {
+            ret = invalidElevationData; //no data
+        } else {
+            if ( noData ) {
+                ret += ( ret / ( 1 - noData ) ) * noData;
+            }
+        }
+
+        result[n] = ret;
+    }
+}
+
 ElevationModel::ElevationModel( MarbleModel *const model )
     : QObject( 0 ),
       d( new ElevationModelPrivate( this, model ) )
@@ -86,81 +273,39 @@ ElevationModel::ElevationModel( MarbleModel *const model )
 
 qreal ElevationModel::height( qreal lon, qreal lat ) const
 {
-    if ( !d->m_textureLayer ) {
-        return invalidElevationData;
-    }
-
-    const int tileZoomLevel = d->m_tileLoader.maximumTileLevel( *( d->m_textureLayer ) );
-    Q_ASSERT( tileZoomLevel == 9 );
-
-    const int width = d->m_textureLayer->tileSize().width();
-    const int height = d->m_textureLayer->tileSize().height();
+    qreal result;
+    d->heights( &lon, &lat, 1, &result );
 
-    const int numTilesX = TileLoaderHelper::levelToColumn( d->m_textureLayer->levelZeroColumns(), tileZoomLevel );
-    const int numTilesY = TileLoaderHelper::levelToRow( d->m_textureLayer->levelZeroRows(), tileZoomLevel );
-    Q_ASSERT( numTilesX > 0 );
-    Q_ASSERT( numTilesY > 0 );
-
-    qreal textureX = 180 + lon;
-    textureX *= numTilesX * width / 360;
-
-    qreal textureY = 90 - lat;
-    textureY *= numTilesY * height / 180;
-
-    qreal ret = 0;
-    bool hasHeight = false;
-    qreal noData = 0;
-
-    for ( int i = 0; i < 4; ++i ) {
-        const int x = static_cast<int>( textureX + ( i % 2 ) );
-        const int y = static_cast<int>( textureY + ( i / 2 ) );
-
-        //mDebug() << "x" << x << ( x / width );
-        //mDebug() << "y" << y << ( y / height );
-
-        const TileId id( "earth/srtm2", tileZoomLevel, ( x % ( numTilesX * width ) ) / width, ( y % ( numTilesY * height ) ) / height );
-        //mDebug() << "LAT" << lat << "LON" << lon << "tile" << ( x % ( numTilesX * width ) ) / width << ( y % ( numTilesY * height ) ) / height;
+    //mDebug() << ">>>" << lat << lon << "returning an elevation of" << result;
+    return result;
+}
 
-        const QImage *image = d->m_cache[id];
-        if ( image == 0 ) {
-            image = new QImage( d->m_tileLoader.loadTile( id, DownloadBrowse ) );
-            d->m_cache.insert( id, image );
-        }
-        Q_ASSERT( image );
-        Q_ASSERT( !image->isNull() );
-        Q_ASSERT( width == image->width() );
-        Q_ASSERT( height == image->height() );
-
-        const qreal dx = ( textureX > ( qreal )x ) ? textureX - ( qreal )x : ( qreal )x - textureX;
-        const qreal dy = ( textureY > ( qreal )y ) ? textureY - ( qreal )y : ( qreal )y - textureY;
-
-        Q_ASSERT( 0 <= dx && dx <= 1 );
-        Q_ASSERT( 0 <= dy && dy <= 1 );
-        unsigned int pixel;
-        pixel = image->pixel( x % width, y % height );
-        pixel -= 0xFF000000; //fully opaque
-        //mDebug() << "(1-dx)" << (1-dx) << "(1-dy)" << (1-dy);
-        if ( pixel != invalidElevationData ) { //no data?
-            //mDebug() << "got at x" << x % width << "y" << y % height << "a height of" << pixel << "** RGB" << qRed(pixel) << qGreen(pixel) << qBlue(pixel);
-            ret += ( qreal )pixel * ( 1 - dx ) * ( 1 - dy );
-            hasHeight = true;
-        } else {
-            //mDebug() << "no data at" <<  x % width << "y" << y % height;
-            noData += ( 1 - dx ) * ( 1 - dy );
-        }
+QVector<qreal> ElevationModel::heights( const QVector<GeoDataCoordinates> &coordinates ) const
+{
+    QVector<qreal> lons( coordinates.size() );
+    QVector<qreal> lats( coordinates.size() );
+    for ( int i = 0; i < coordinates.size(); ++i ) {
+        lons[i] = coordinates.at( i ).longitude( GeoDataCoordinates::Degree );
+        lats[i] = coordinates.at( i ).latitude( GeoDataCoordinates::Degree );
     }
 
-    if ( !hasHeight ) {
-        ret = invalidElevationData; //no data
-    } else {
-        if ( noData ) {
-            //mDebug() << "NO DATA" << noData;
-            ret += ( ret / ( 1 - noData ) ) * noData;
-        }
+    QVector<qreal> result( coordinates.size() );
+    d->heights( lons.constData(), lats.constData(), result.size(), result.data() );
+    return result;
+}
+
+QVector<qreal> ElevationModel::heights( const GeoDataLineString &lineString ) const
+{
+    QVector<qreal> lons( lineString.size() );
+    QVector<qreal> lats( lineString.size() );
+    for ( int i = 0; i < lineString.size(); ++i ) {
+        lons[i] = lineString.at( i ).longitude( GeoDataCoordinates::Degree );
+        lats[i] = lineString.at( i ).latitude( GeoDataCoordinates::Degree );
     }
 
-    //mDebug() << ">>>" << lat << lon << "returning an elevation of" << ret;
-    return ret;
+    QVector<qreal> result( lineString.size() );
+    d->heights( lons.constData(), lats.constData(), result.size(), result.data() );
+    return result;
 }
 
 QList<GeoDataCoordinates> ElevationModel::heightProfile( qreal fromLon, qreal fromLat, qreal toLon, qreal toLat ) const
@@ -169,11 +314,7 @@ QList<GeoDataCoordinates> ElevationModel::heightProfile( qreal fromLon, qreal fr
         return QList<GeoDataCoordinates>();
     }
 
-    const int tileZoomLevel = d->m_tileLoader.maximumTileLevel( *( d->m_textureLayer ) );
-    const int width = d->m_textureLayer->tileSize().width();
-    const int numTilesX = TileLoaderHelper::levelToColumn( d->m_textureLayer->levelZeroColumns(), tileZoomLevel );
-
-    qreal distPerPixel = ( qreal )360 / ( width * numTilesX );
+    qreal distPerPixel = ( qreal )360 / ( d->m_tileWidth * d->m_numTilesX );
     //mDebug() << "heightProfile" << fromLat << fromLon << toLat << toLon << "distPerPixel" << distPerPixel;
 
     qreal lat = fromLat;
@@ -184,13 +325,12 @@ QList<GeoDataCoordinates> ElevationModel::heightProfile( qreal fromLon, qreal fr
     //mDebug() << "fromLon" << fromLon << "fromLat" << fromLat;
     //mDebug() << "diff lon" << ( fromLon - toLon ) << "diff lat" << ( fromLat - toLat );
     //mDebug() << "dirLon" << QString::number(dirLon) << "dirLat" << QString::number(dirLat) << "k" << k;
-    QList<GeoDataCoordinates> ret;
+    QVector<qreal> lons;
+    QVector<qreal> lats;
     while ( lat*dirLat <= toLat*dirLat && lon*dirLon <= toLon * dirLon ) {
         //mDebug() << lat << lon;
-        qreal h = height( lon, lat );
-        if ( h < 32000 ) {
-            ret << GeoDataCoordinates( lon, lat, h, GeoDataCoordinates::Degree );
-        }
+        lons << lon;
+        lats << lat;
         if ( k < 0.5 ) {
             //mDebug() << "lon(x) += distPerPixel";
             lat += distPerPixel * k * dirLat;
@@ -201,6 +341,16 @@ QList<GeoDataCoordinates> ElevationModel::heightProfile( qreal fromLon, qreal fr
             lon += distPerPixel / k * dirLon;
         }
     }
+
+    QVector<qreal> heights( lons.size() );
+    d->heights( lons.constData(), lats.constData(), heights.size(), heights.data() );
+
+    QList<GeoDataCoordinates> ret;
+    for ( int i = 0; i < heights.size(); ++i ) {
+        if ( heights.at( i ) < 32000 ) {
+            ret << GeoDataCoordinates( lons.at( i ), lats.at( i ), heights.at( i ), GeoDataCoordinates::Degree );
+        }
+    }
     //mDebug() << ret;
     return ret;
 }
@@ -26,6 +26,7 @@ namespace {
     unsigned int const invalidElevationData = 32768;
 }
 
+class GeoDataLineString;
 class TileId;
 class MarbleModel;
 class ElevationModelPrivate;
@@ -37,6 +38,20 @@ public:
     ElevationModel( MarbleModel * const model );
 
     qreal height( qreal lon, qreal lat ) const;
+
+    /**
+     * @brief Returns the heights at all of the given coordinates.
+     *
+     * This is much faster than calling height() for each of them, as the
+     * elevation tiles are looked up once per tile rather than once per sample.
+     * Like height(), it may be called from any thread. Missing tiles are loaded
+     * right away when called from the thread of the elevation model. Otherwise
+     * they are loaded in the background, invalidElevationData is returned for
+     * the samples on them and updateAvailable() is emitted once they are there.
+     */
+    QVector<qreal> heights( const QVector<GeoDataCoordinates> &coordinates ) const;
+    QVector<qreal> heights( const GeoDataLineString &lineString ) const;
+
     QList<GeoDataCoordinates> heightProfile( qreal fromLon, qreal fromLat, qreal toLon, qreal toLat ) const;
 
 Q_SIGNALS:
@@ -48,6 +63,7 @@ Q_SIGNALS:
 
 private:
     Q_PRIVATE_SLOT( d, void tileCompleted( TileId, QImage ) )
+    Q_PRIVATE_SLOT( d, void loadPendingTiles() )
 
 private:
     friend class ElevationModelPrivate;
@@ -15,6 +15,7 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QFile>
 #include <QtCore/QThread>
+#include <QtCore/QTime>
 
 #include "GeoDataParser.h"
 #include "GeoDataDocument.h"
@@ -43,9 +44,13 @@ public:
           m_filepath ( file ),
           m_documentRole ( role ),
           m_document( 0 ),
+          m_size( 0 ),
+          m_elapsed( -1 ),
+          m_finished( false ),
           m_clock( model->clock() )
     {
         m_runner->setModel( model );
+        resolvePaths();
     };
 
     FileLoaderPrivate( FileLoader* parent, MarbleModel *model,
@@ -56,6 +61,9 @@ public:
           m_contents ( contents ),
           m_documentRole ( role ),
           m_document( 0 ),
+          m_size( contents.size() ),
+          m_elapsed( -1 ),
+          m_finished( false ),
           m_clock( model->clock() )
     {
         m_runner->setModel( model );
@@ -66,6 +74,7 @@ public:
         delete m_runner;
     }
 
+    void resolvePaths();
     void saveFile(const QString& filename );
     void savePlacemarks(QDataStream &out, const GeoDataContainer *container);
 
@@ -74,16 +83,24 @@ public:
     int spacePopIdx( qint64 population ) const;
     int areaPopIdx( qreal area ) const;
 
+    void parseFile( const QString &fileName );
     void documentParsed( GeoDataDocument *doc, const QString& error);
+    void finish();
 
     FileLoader *q;
     MarbleRunnerManager *m_runner;
     QString m_filepath;
     QString m_contents;
+    QString m_sourceFile;
+    QString m_cacheFile;
     QString m_nonExistentLocalCacheFile;
     DocumentRole m_documentRole;
     GeoDataDocument *m_document;
     QString m_error;
+    qint64 m_size;
+    QTime m_time;
+    int m_elapsed;
+    bool m_finished;
 
     const MarbleClock *m_clock;
 };
@@ -122,71 +139,52 @@ QString FileLoader::error() const
     return d->m_error;
 }
 
+qint64 FileLoader::size() const
+{
+    return d->m_size;
+}
+
+int FileLoader::elapsed() const
+{
+    return d->m_elapsed;
+}
+
 void FileLoader::run()
 {
-    if ( d->m_contents.isEmpty() ) {
-        QString defaultSourceName;
+    d->m_time.start();
 
+    if ( d->m_contents.isEmpty() ) {
         mDebug() << "starting parser for" << d->m_filepath;
 
-        QFileInfo fileinfo( d->m_filepath );
-        QString path = fileinfo.path();
-        if ( path == "." ) path.clear();
-        QString name = fileinfo.completeBaseName();
-        QString suffix = fileinfo.suffix();
-        QString cacheFile;
-
-        // determine source, cache names
-        if ( fileinfo.isAbsolute() ) {
-            // We got an _absolute_ path now: e.g. "/patrick.kml"
-            defaultSourceName   = path + '/' + name + '.' + suffix;
-        }
-        else if ( d->m_filepath.contains( '/' ) ) {
-            // _relative_ path: "maps/mars/viking/patrick.kml"
-            defaultSourceName   = MarbleDirs::path( path + '/' + name + '.' + suffix );
-        }
-        else {
-            // _standard_ shared placemarks: "placemarks/patrick.kml"
-            defaultSourceName   = MarbleDirs::path( "placemarks/" + path + name + '.' + suffix );
-
-            cacheFile = MarbleDirs::path( "placemarks/" + path + name + ".cache" );
-            if ( cacheFile.isEmpty()) {
-                cacheFile = MarbleDirs::localPath() + "/placemarks/" + path + name + ".cache";
-                if ( !QFileInfo( cacheFile ).exists() ) {
-                    d->m_nonExistentLocalCacheFile = cacheFile;
-                }
-            }
-        }
-
         // if cache file more recent that source file, load cache file
-        if ( QFile::exists( cacheFile ) ) {
-            mDebug() << "Loading Cache File:" + cacheFile;
+        bool useCache = false;
+        if ( QFile::exists( d->m_cacheFile ) ) {
+            mDebug() << "Loading Cache File:" + d->m_cacheFile;
 
             QDateTime sourceLastModified;
 
-            if ( QFile::exists( defaultSourceName ) ) {
-                sourceLastModified = QFileInfo( defaultSourceName ).lastModified();
+            if ( QFile::exists( d->m_sourceFile ) ) {
+                sourceLastModified = QFileInfo( d->m_sourceFile ).lastModified();
             }
 
-            const QDateTime cacheLastModified  = QFileInfo( cacheFile ).lastModified();
+            const QDateTime cacheLastModified  = QFileInfo( d->m_cacheFile ).lastModified();
+            useCache = sourceLastModified < cacheLastModified;
+        }
 
-            if ( sourceLastModified < cacheLastModified ) {
-                connect( d->m_runner, SIGNAL( parsingFinished( GeoDataDocument*, QString ) ),
-                         this, SLOT( documentParsed( GeoDataDocument*, QString ) ) );
-                d->m_runner->parseFile( cacheFile, d->m_documentRole );
-            }
+        if ( useCache ) {
+            d->parseFile( d->m_cacheFile );
         }
         // we load source file, multiple cases
-        else if ( QFile::exists( defaultSourceName ) ) {
+        else if ( QFile::exists( d->m_sourceFile ) ) {
             mDebug() << "No recent Default Placemark Cache File available!";
 
             // use runners: pnt, gpx, osm
-            connect( d->m_runner, SIGNAL( parsingFinished(GeoDataDocument*,QString) ),
-                    this, SLOT( documentParsed( GeoDataDocument*, QString ) ) );
-            d->m_runner->parseFile( defaultSourceName, d->m_documentRole );
+            d->parseFile( d->m_sourceFile );
         }
         else {
-            mDebug() << "No Default Placemark Source File for " << name;
+            mDebug() << "No Default Placemark Source File for " << d->m_filepath;
+            // Nothing to wait for, the file manager can start the next loader
+            d->finish();
         }
     // content is not empty, we load from data
     } else {
@@ -199,7 +197,7 @@ void FileLoader::run()
 
         if ( !parser.read( &buffer ) ) {
             qWarning( "Could not import kml buffer!" );
-            emit loaderFinished( this );
+            d->finish();
             return;
         }
 
@@ -212,14 +210,52 @@ void FileLoader::run()
         d->createFilterProperties( d->m_document );
         buffer.close();
 
+        d->m_elapsed = d->m_time.elapsed();
         mDebug() << "newGeoDataDocumentAdded" << d->m_filepath;
 
         emit newGeoDataDocumentAdded( d->m_document );
-        emit loaderFinished( this );
+        d->finish();
     }
 
 }
 
+void FileLoaderPrivate::resolvePaths()
+{
+    QFileInfo fileinfo( m_filepath );
+    QString path = fileinfo.path();
+    if ( path == "." ) path.clear();
+    QString name = fileinfo.completeBaseName();
+    QString suffix = fileinfo.suffix();
+
+    // determine source, cache names
+    if ( fileinfo.isAbsolute() ) {
+        // We got an _absolute_ path now: e.g. "/patrick.kml"
+        m_sourceFile = path + '/' + name + '.' + suffix;
+    }
+    else if ( m_filepath.contains( '/' ) ) {
+        // _relative_ path: "maps/mars/viking/patrick.kml"
+        m_sourceFile = MarbleDirs::path( path + '/' + name + '.' + suffix );
+    }
+    else {
+        // _standard_ shared placemarks: "placemarks/patrick.kml"
+        m_sourceFile = MarbleDirs::path( "placemarks/" + path + name + '.' + suffix );
+
+        m_cacheFile = MarbleDirs::path( "placemarks/" + path + name + ".cache" );
+        if ( m_cacheFile.isEmpty()) {
+            m_cacheFile = MarbleDirs::localPath() + "/placemarks/" + path + name + ".cache";
+            if ( !QFileInfo( m_cacheFile ).exists() ) {
+                m_nonExistentLocalCacheFile = m_cacheFile;
+            }
+        }
+    }
+
+    // Whichever file gets parsed, the source file tells its dimension
+    m_size = QFileInfo( m_sourceFile ).size();
+    if ( m_size == 0 ) {
+        m_size = QFileInfo( m_cacheFile ).size();
+    }
+}
+
 const quint32 MarbleMagicNumber = 0x31415926;
 
 void FileLoaderPrivate::saveFile( const QString& filename )
@@ -281,9 +317,26 @@ void FileLoaderPrivate::savePlacemarks(QDataStream &out, const GeoDataContainer
     }
 }
 
+void FileLoaderPrivate::parseFile( const QString &fileName )
+{
+    QObject::connect( m_runner, SIGNAL( parsingFinished( GeoDataDocument*, QString ) ),
+                      q, SLOT( documentParsed( GeoDataDocument*, QString ) ) );
+    // Fires as well if none of the runners could make sense of the file
+    QObject::connect( m_runner, SIGNAL( parsingFinished() ),
+                      q, SLOT( finish() ) );
+    m_runner->parseFile( fileName, m_documentRole );
+}
+
 void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& error )
 {
+    if ( m_finished ) {
+        // Another runner was faster
+        delete doc;
+        return;
+    }
+
     m_error = error;
+    m_elapsed = m_time.elapsed();
     if ( doc ) {
         m_document = doc;
         doc->setFileName( m_filepath );
@@ -293,7 +346,15 @@ void FileLoaderPrivate::documentParsed( GeoDataDocument* doc, const QString& err
             saveFile( m_nonExistentLocalCacheFile );
         }
     }
-    emit q->loaderFinished( q );
+    finish();
+}
+
+void FileLoaderPrivate::finish()
+{
+    if ( !m_finished ) {
+        m_finished = true;
+        emit q->loaderFinished( q );
+    }
 }
 
 void FileLoaderPrivate::createFilterProperties( GeoDataContainer *container )
@@ -36,12 +36,23 @@ class FileLoader : public QThread
         GeoDataDocument *document();
         QString error() const;
 
+        /**
+         * The size of the file or data to load in bytes.
+         */
+        qint64 size() const;
+
+        /**
+         * The milliseconds it took to load the document, -1 while it is loading.
+         */
+        int elapsed() const;
+
     Q_SIGNALS:
         void loaderFinished( FileLoader* );
         void newGeoDataDocumentAdded( GeoDataDocument* );
 
 private:
         Q_PRIVATE_SLOT ( d, void documentParsed( GeoDataDocument *, QString) )
+        Q_PRIVATE_SLOT ( d, void finish() )
 
         friend class FileLoaderPrivate;
 
@@ -13,7 +13,9 @@
 
 #include <QtCore/QDir>
 #include <QtCore/QFileInfo>
+#include <QtCore/QThread>
 #include <QtCore/QTime>
+#include <QtCore/QTimer>
 #include <QtGui/QMessageBox>
 
 #include "FileLoader.h"
@@ -23,20 +25,45 @@
 
 #include "GeoDataDocument.h"
 #include "GeoDataLatLonAltBox.h"
+#include "GeoDataTypes.h"
 
 
 using namespace Marble;
 
 namespace Marble
 {
+
+// Further loaders wait while the files being loaded add up to this size
+static const qint64 MaxBytesLoading = 64 * 1024 * 1024;
+
 class FileManagerPrivate
 {
 public:
+    // The number of features a large container starts with in the tree model.
+    // Each chunk added later is as large as what is in already, so that the
+    // views, which rebuild their contents on every insertion, do so only a
+    // logarithmic number of times.
+    enum { ChunkSize = 1000 };
+
+    // Features of a loaded document that are not part of the tree model yet.
+    // The document is announced by fileAdded() once all of them are in.
+    struct PendingFeatures
+    {
+        GeoDataDocument *document;
+        GeoDataContainer *container;
+        QVector<GeoDataFeature*> features;
+        int next;
+    };
+
     FileManagerPrivate( MarbleModel* model )
         : m_model( model ),
           m_recenter( false ),
+          m_maxLoaders( qMax( 2, QThread::idealThreadCount() ) ),
+          m_bytesLoading( 0 ),
         m_t ( 0 )
     {
+        m_featureTimer.setSingleShot( true );
+        m_featureTimer.setInterval( 0 );
     }
 
     ~FileManagerPrivate()
@@ -46,12 +73,32 @@ public:
                 loader->wait();
             }
         }
+
+        foreach ( const PendingFeatures &pending, m_pendingFeatures ) {
+            qDeleteAll( pending.features.mid( pending.next ) );
+        }
+    }
+
+    bool isPending( const GeoDataDocument *document ) const
+    {
+        foreach ( const PendingFeatures &pending, m_pendingFeatures ) {
+            if ( pending.document == document ) {
+                return true;
+            }
+        }
+        return false;
     }
 
     MarbleModel* const m_model;
     QList<FileLoader*> m_loaderList;
+    // Loaders that did not start yet, the smallest file comes first
+    QList<FileLoader*> m_pendingLoaders;
     QList < GeoDataDocument* > m_fileItemList;
+    QList<PendingFeatures> m_pendingFeatures;
+    QTimer m_featureTimer;
     bool m_recenter;
+    const int m_maxLoaders;
+    qint64 m_bytesLoading;
     QTime *m_t;
 };
 }
@@ -60,6 +107,10 @@ FileManager::FileManager( MarbleModel *model, QObject *parent )
     : QObject( parent )
     , d( new FileManagerPrivate( model ) )
 {
+    connect( &d->m_featureTimer, SIGNAL( timeout() ),
+             this, SLOT( addPendingFeatures() ) );
+    connect( d->m_model->treeModel(), SIGNAL( removed( GeoDataObject* ) ),
+             this, SLOT( dropPendingFeatures( GeoDataObject* ) ) );
 }
 
 
@@ -75,7 +126,12 @@ void FileManager::addFile( const QString& filepath, DocumentRole role, bool rece
             return;  // already loaded
     }
 
-    foreach ( const FileLoader *loader, d->m_loaderList ) {
+    foreach ( const FileManagerPrivate::PendingFeatures &pending, d->m_pendingFeatures ) {
+        if ( pending.document->fileName() == filepath )
+            return;  // being added to the tree model
+    }
+
+    foreach ( const FileLoader *loader, d->m_loaderList + d->m_pendingLoaders ) {
         if ( loader->path() == filepath )
             return;  // currently loading
     }
@@ -112,18 +168,48 @@ void FileManager::appendLoader( FileLoader *loader )
     connect( loader, SIGNAL( newGeoDataDocumentAdded( GeoDataDocument* ) ),
              this, SLOT( addGeoDataDocument( GeoDataDocument* ) ) );
 
-    d->m_loaderList.append( loader );
-    loader->start();
+    QList<FileLoader*>::iterator it = d->m_pendingLoaders.begin();
+    while ( it != d->m_pendingLoaders.end() && (*it)->size() <= loader->size() ) {
+        ++it;
+    }
+    d->m_pendingLoaders.insert( it, loader );
+    startLoaders();
+}
+
+void FileManager::startLoaders()
+{
+    while ( !d->m_pendingLoaders.isEmpty() && d->m_loaderList.size() < d->m_maxLoaders ) {
+        FileLoader *loader = d->m_pendingLoaders.first();
+        // A file larger than the limit is loaded on its own
+        if ( !d->m_loaderList.isEmpty() && d->m_bytesLoading + loader->size() > MaxBytesLoading ) {
+            break;
+        }
+
+        d->m_pendingLoaders.removeFirst();
+        d->m_loaderList.append( loader );
+        d->m_bytesLoading += loader->size();
+        loader->start();
+    }
 }
 
 void FileManager::removeFile( const QString& key )
 {
+    foreach ( FileLoader *loader, d->m_pendingLoaders ) {
+        if ( loader->path() == key ) {
+            d->m_pendingLoaders.removeAll( loader );
+            delete loader;
+            return;
+        }
+    }
+
     foreach ( FileLoader *loader, d->m_loaderList ) {
         if ( loader->path() == key ) {
             disconnect( loader, 0, this, 0 );
             loader->wait();
             d->m_loaderList.removeAll( loader );
+            d->m_bytesLoading -= loader->size();
             delete loader->document();
+            startLoaders();
             return;
         }
     }
@@ -135,6 +221,16 @@ void FileManager::removeFile( const QString& key )
         }
     }
 
+    for ( int i = 0; i < d->m_pendingFeatures.size(); ++i ) {
+        GeoDataDocument *document = d->m_pendingFeatures.at( i ).document;
+        if ( key == document->fileName() ) {
+            // Drops the pending features as well
+            d->m_model->treeModel()->removeDocument( document );
+            delete document;
+            return;
+        }
+    }
+
     mDebug() << "could not identify " << key;
 }
 
@@ -147,7 +243,8 @@ void FileManager::closeFile( int index )
 {
     mDebug() << "FileManager::closeFile " << d->m_fileItemList.at( index )->fileName();
     if ( index < d->m_fileItemList.size() ) {
-        d->m_model->treeModel()->removeDocument( d->m_fileItemList.at( index ) );
+        GeoDataDocument *document = d->m_fileItemList.at( index );
+        d->m_model->treeModel()->removeDocument( document );
         emit fileRemoved( index );
         delete d->m_fileItemList.at( index );
         d->m_fileItemList.removeAt( index );
@@ -175,31 +272,136 @@ void FileManager::addGeoDataDocument( GeoDataDocument* document )
         document->setName( file.baseName() );
     }
 
-    d->m_fileItemList.append( document );
+    if ( d->m_recenter ) {
+        emit centeredDocument( document->latLonAltBox() );
+        d->m_recenter = false;
+    }
+
+    // Adding hundred thousands of features at once blocks the views for
+    // quite a while, so large containers are filled up step by step
+    detachFeatures( document, document );
     d->m_model->treeModel()->addDocument( document );
-    emit fileAdded( d->m_fileItemList.indexOf( document ) );
+    if ( d->isPending( document ) ) {
+        if ( !d->m_featureTimer.isActive() ) {
+            d->m_featureTimer.start();
+        }
+    } else {
+        appendDocument( document );
+    }
 }
 
-void FileManager::cleanupLoader( FileLoader* loader )
+void FileManager::appendDocument( GeoDataDocument *document )
 {
-    GeoDataDocument *doc = loader->document();
-    d->m_loaderList.removeAll( loader );
-    if ( loader->isFinished() ) {
-        if ( doc && d->m_recenter ) {
-            emit centeredDocument( doc->latLonAltBox() );
-            d->m_recenter = false;
+    d->m_fileItemList.append( document );
+    emit fileAdded( d->m_fileItemList.size() - 1 );
+}
+
+void FileManager::detachFeatures( GeoDataDocument *document, GeoDataContainer *container )
+{
+    const QVector<GeoDataFeature*> features = container->featureList();
+    if ( features.size() > FileManagerPrivate::ChunkSize ) {
+        FileManagerPrivate::PendingFeatures pending;
+        pending.document = document;
+        pending.container = container;
+        pending.features = features.mid( FileManagerPrivate::ChunkSize );
+        pending.next = 0;
+        for ( int i = features.size() - 1; i >= FileManagerPrivate::ChunkSize; --i ) {
+            container->remove( i );
         }
-        if ( !loader->error().isEmpty() ) {
-            QMessageBox errorBox;
-            errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
-            errorBox.setText( loader->error() );
-            errorBox.setIcon( QMessageBox::Warning );
-            errorBox.exec();
-            qWarning() << "File Parsing error " << loader->error();
+        // The parent comes first so that it is part of the tree model
+        // by the time the features of its children are added
+        d->m_pendingFeatures.append( pending );
+    }
+
+    foreach ( GeoDataFeature *feature, features ) {
+        if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType
+             || feature->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+            detachFeatures( document, static_cast<GeoDataContainer*>( feature ) );
+        }
+    }
+}
+
+void FileManager::addPendingFeatures()
+{
+    if ( d->m_pendingFeatures.isEmpty() ) {
+        return;
+    }
+
+    FileManagerPrivate::PendingFeatures &pending = d->m_pendingFeatures.first();
+    const int size = FileManagerPrivate::ChunkSize + pending.next;
+    const QVector<GeoDataFeature*> chunk = pending.features.mid( pending.next, size );
+    pending.next += chunk.size();
+    d->m_model->treeModel()->addFeatures( pending.container, chunk );
+    if ( pending.next == pending.features.size() ) {
+        GeoDataDocument *document = pending.document;
+        d->m_pendingFeatures.removeFirst();
+        if ( !d->isPending( document ) ) {
+            appendDocument( document );
         }
-        delete loader;
     }
-    if ( d->m_loaderList.isEmpty()  )
+
+    // Let the event loop catch up before the next chunk
+    if ( !d->m_pendingFeatures.isEmpty() ) {
+        d->m_featureTimer.start();
+    }
+}
+
+void FileManager::dropPendingFeatures( GeoDataObject *object )
+{
+    // Features detached from the removed object or anything below it are
+    // not going to be added anymore. The removed object is still alive, so
+    // are the ancestors of all pending containers.
+    QList<GeoDataDocument*> documents;
+    for ( int i = d->m_pendingFeatures.size() - 1; i >= 0; --i ) {
+        const FileManagerPrivate::PendingFeatures &pending = d->m_pendingFeatures.at( i );
+        GeoDataObject *ancestor = pending.container;
+        while ( ancestor && ancestor != object ) {
+            ancestor = ancestor->parent();
+        }
+        if ( ancestor ) {
+            if ( !documents.contains( pending.document ) ) {
+                documents << pending.document;
+            }
+            qDeleteAll( pending.features.mid( pending.next ) );
+            d->m_pendingFeatures.removeAt( i );
+        }
+    }
+
+    // A document that lost a folder with pending features may be complete now
+    foreach ( GeoDataDocument *document, documents ) {
+        if ( document != object && !d->isPending( document ) ) {
+            appendDocument( document );
+        }
+    }
+}
+
+void FileManager::cleanupLoader( FileLoader* loader )
+{
+    if ( d->m_loaderList.removeAll( loader ) > 0 ) {
+        d->m_bytesLoading -= loader->size();
+    }
+    mDebug() << "Loaded" << loader->path() << "(" << loader->size() / 1024 << "kB ) in"
+             << loader->elapsed() << "ms," << d->m_bytesLoading / 1024 << "kB still loading,"
+             << d->m_pendingLoaders.size() << "files waiting";
+
+    // The next files can be parsed meanwhile
+    startLoaders();
+
+    if ( !loader->error().isEmpty() ) {
+        QMessageBox errorBox;
+        errorBox.setWindowTitle( QObject::tr("File Parsing Error"));
+        errorBox.setText( loader->error() );
+        errorBox.setIcon( QMessageBox::Warning );
+        errorBox.exec();
+        qWarning() << "File Parsing error " << loader->error();
+    }
+
+    // The signal may arrive while the thread is about to return from run(),
+    // and the loader may be in the middle of emitting it
+    loader->wait();
+    loader->deleteLater();
+
+    if ( d->m_loaderList.isEmpty() && d->m_pendingLoaders.isEmpty() && d->m_t )
     {
         qDebug() << "Finished loading all placemarks " << d->m_t->elapsed();
         delete d->m_t;
@@ -24,7 +24,9 @@ namespace Marble
 class MarbleModel;
 class FileManagerPrivate;
 class FileLoader;
+class GeoDataContainer;
 class GeoDataLatLonBox;
+class GeoDataObject;
 
 /**
  * This class is responsible for loading the
@@ -32,6 +34,11 @@ class GeoDataLatLonBox;
  *
  * The loaded data are accessible via
  * various models in MarbleModel.
+ *
+ * Only a few files are loaded at the same time, depending on the number
+ * of processor cores and the size of the files. Smaller files go first.
+ * The features of large documents are added to the tree model in chunks,
+ * fileAdded() is emitted once all of them are in.
  */
 class FileManager : public QObject
 {
@@ -90,10 +97,28 @@ class FileManager : public QObject
  private Q_SLOTS:
     void cleanupLoader( FileLoader *loader );
 
+    void addPendingFeatures();
+
+    /**
+     * Drops the pending features of @p object and its children, which was
+     * removed from the tree model.
+     */
+    void dropPendingFeatures( GeoDataObject *object );
+
  private:
 
     void appendLoader( FileLoader *loader );
 
+    void startLoaders();
+
+    /**
+     * Detaches all but the first chunk of features of @p container and its
+     * children, they are added later on by addPendingFeatures().
+     */
+    void detachFeatures( GeoDataDocument *document, GeoDataContainer *container );
+
+    void appendDocument( GeoDataDocument *document );
+
     Q_DISABLE_COPY( FileManager )
 
     FileManagerPrivate *const d;
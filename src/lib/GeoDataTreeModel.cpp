@@ -541,6 +541,32 @@ int GeoDataTreeModel::addFeature( GeoDataContainer *parent, GeoDataFeature *feat
     return row; //-1 if it failed, the relative index otherwise.
 }
 
+int GeoDataTreeModel::addFeatures( GeoDataContainer *parent, const QVector<GeoDataFeature*> &features )
+{
+    if ( !parent || features.isEmpty() ) {
+        return -1;
+    }
+
+    QModelIndex modelindex = index( parent );
+    if ( parent != d->m_rootDocument && !modelindex.isValid() ) {
+        mDebug() << "GeoDataTreeModel::addFeatures (parent " << parent << ") : parent not found on the TreeModel";
+        return -1;
+    }
+
+    const int row = parent->size();
+    beginInsertRows( modelindex, row, row + features.size() - 1 );
+    foreach ( GeoDataFeature *feature, features ) {
+        parent->append( feature );
+    }
+    endInsertRows();
+
+    foreach ( GeoDataFeature *feature, features ) {
+        emit added( feature );
+    }
+
+    return row;
+}
+
 int GeoDataTreeModel::addDocument( GeoDataDocument *document )
 {
     return addFeature( d->m_rootDocument, document );
@@ -84,6 +84,12 @@ public Q_SLOTS:
 
     int addFeature( GeoDataContainer *parent, GeoDataFeature *feature );
 
+    /**
+      * Appends @p features to @p parent with a single row insertion.
+      * @return The row of the first feature, -1 if @p parent is not part of the model.
+      */
+    int addFeatures( GeoDataContainer *parent, const QVector<GeoDataFeature*> &features );
+
     bool removeFeature( GeoDataContainer *parent, int index );
 
     bool removeFeature( GeoDataFeature *feature );
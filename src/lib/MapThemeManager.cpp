@@ -14,6 +14,8 @@
 #include "MapThemeManager.h"
 
 // Qt
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
@@ -21,6 +23,7 @@
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QTimer>
+#include <QtGui/QImage>
 #include <QtGui/QStandardItemModel>
 
 // Local dir
@@ -35,6 +38,9 @@ namespace
 {
     static const QString mapDirName = "maps";
     static const int columnRelativePath = 1;
+
+    // Increase whenever the layout of the theme catalog cache changes.
+    static const quint32 catalogVersion = 2;
 }
 
 namespace Marble
@@ -53,6 +59,33 @@ public:
 class MapThemeManager::Private
 {
 public:
+    /**
+     * @brief The properties of a map theme shown in the map theme model.
+     *
+     * Entries are valid as long as neither the .dgml file nor the preview
+     * icon of the theme changed since they were created.
+     */
+    struct ThemeInfo
+    {
+        ThemeInfo()
+            : lastModified( 0 ),
+              iconLastModified( 0 ),
+              visible( false )
+        {
+        }
+
+        QString path;
+        qint64 lastModified;
+        QString iconPath;
+        qint64 iconLastModified;
+        bool visible;
+        QString name;
+        QString description;
+        QString target;
+        QString theme;
+        QImage icon;
+    };
+
     Private( MapThemeManager *parent );
     ~Private();
 
@@ -96,10 +129,25 @@ public:
      */
     QList<QStandardItem *> createMapThemeRow( const QString& mapThemeID );
 
+    /**
+     * @brief Returns the catalog entry of a map theme.
+     *
+     * Only parses the .dgml file of the theme if the catalog has no valid
+     * entry for it.
+     */
+    ThemeInfo themeInfo( const QString& mapThemeID );
+
+    static QString catalogFileName();
+    void readCatalog();
+    void writeCatalog();
+
     MapThemeManager *const q;
     StandardItemModelWithRoleNames m_mapThemeModel;
     QFileSystemWatcher m_fileSystemWatcher;
     bool m_isInitialized;
+    bool m_catalogRead;
+    bool m_catalogChanged;
+    QHash<QString, ThemeInfo> m_catalog;
 };
 
 StandardItemModelWithRoleNames::StandardItemModelWithRoleNames( int rows, int columns, QObject *parent ) :
@@ -117,7 +165,9 @@ MapThemeManager::Private::Private( MapThemeManager *parent )
     : q( parent ),
       m_mapThemeModel( 0, 3 ),
       m_fileSystemWatcher(),
-      m_isInitialized( false )
+      m_isInitialized( false ),
+      m_catalogRead( false ),
+      m_catalogChanged( false )
 {
     QHash<int,QByteArray> roleNames = m_mapThemeModel.roleNames();
     roleNames[ Qt::DecorationRole ] = "icon";
@@ -296,44 +346,152 @@ QStandardItemModel* MapThemeManager::mapThemeModel()
     return &d->m_mapThemeModel;
 }
 
+QString MapThemeManager::Private::catalogFileName()
+{
+    return MarbleDirs::localPath() + "/mapthemes.cache";
+}
+
+void MapThemeManager::Private::readCatalog()
+{
+    m_catalogRead = true;
+
+    QFile file( catalogFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return;
+    }
+
+    QDataStream stream( &file );
+    quint32 version;
+    qint32 count;
+    stream >> version >> count;
+    if ( version != catalogVersion || stream.status() != QDataStream::Ok ) {
+        return;
+    }
+
+    for ( qint32 i = 0; i < count; ++i ) {
+        QString mapThemeID;
+        ThemeInfo info;
+        stream >> mapThemeID >> info.path >> info.lastModified
+               >> info.iconPath >> info.iconLastModified >> info.visible
+               >> info.name >> info.description >> info.target >> info.theme >> info.icon;
+        if ( stream.status() != QDataStream::Ok ) {
+            m_catalog.clear();
+            return;
+        }
+        m_catalog.insert( mapThemeID, info );
+    }
+}
+
+void MapThemeManager::Private::writeCatalog()
+{
+    QDir().mkpath( MarbleDirs::localPath() );
+
+    QFile file( catalogFileName() );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write the map theme catalog" << file.fileName();
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream << catalogVersion << qint32( m_catalog.size() );
+    QHash<QString, ThemeInfo>::const_iterator it = m_catalog.constBegin();
+    QHash<QString, ThemeInfo>::const_iterator const end = m_catalog.constEnd();
+    for (; it != end; ++it ) {
+        const ThemeInfo &info = it.value();
+        stream << it.key() << info.path << info.lastModified
+               << info.iconPath << info.iconLastModified << info.visible
+               << info.name << info.description << info.target << info.theme << info.icon;
+    }
+
+    m_catalogChanged = false;
+}
+
+MapThemeManager::Private::ThemeInfo MapThemeManager::Private::themeInfo( const QString& mapThemeID )
+{
+    if ( !m_catalogRead ) {
+        readCatalog();
+    }
+
+    const QString dgmlPath = MarbleDirs::path( mapDirName + '/' + mapThemeID );
+    const QFileInfo dgmlInfo( dgmlPath );
+
+    QHash<QString, ThemeInfo>::const_iterator cached = m_catalog.constFind( mapThemeID );
+    if ( cached != m_catalog.constEnd() ) {
+        const ThemeInfo &info = cached.value();
+        const QFileInfo iconInfo( info.iconPath );
+        if ( info.path == dgmlPath
+             && info.lastModified == dgmlInfo.lastModified().toMSecsSinceEpoch()
+             && info.iconLastModified == ( iconInfo.exists() ? iconInfo.lastModified().toMSecsSinceEpoch() : 0 ) ) {
+            return info;
+        }
+    }
+
+    ThemeInfo info;
+    info.path = dgmlPath;
+    info.lastModified = dgmlInfo.lastModified().toMSecsSinceEpoch();
+
+    GeoSceneDocument *mapTheme = loadMapThemeFile( mapThemeID );
+    if ( mapTheme ) {
+        info.visible = mapTheme->head()->visible();
+        info.name = mapTheme->head()->name();
+        info.description = mapTheme->head()->description();
+        info.target = mapTheme->head()->target();
+        info.theme = mapTheme->head()->theme();
+
+        const QString relativePath = mapDirName + '/'
+            + info.target + '/' + info.theme + '/'
+            + mapTheme->head()->icon()->pixmap();
+        info.iconPath = MarbleDirs::path( relativePath );
+
+        const QFileInfo iconInfo( info.iconPath );
+        if ( iconInfo.exists() ) {
+            info.iconLastModified = iconInfo.lastModified().toMSecsSinceEpoch();
+        }
+
+        info.icon.load( info.iconPath );
+        if ( !info.icon.isNull() ) {
+            // Make sure we don't keep excessively large previews in memory
+            // TODO: Scale the icon down to the default icon size in MarbleSelectView.
+            //       For now maxIconSize already equals what's expected by the listview.
+            QSize maxIconSize( 136, 136 );
+            if ( info.icon.size() != maxIconSize ) {
+                mDebug() << "Smooth scaling theme icon";
+                info.icon = info.icon.scaled( maxIconSize,
+                                              Qt::KeepAspectRatio,
+                                              Qt::SmoothTransformation );
+            }
+        }
+
+        delete mapTheme;
+    }
+
+    // Broken themes are remembered too, so they don't get parsed again.
+    m_catalog.insert( mapThemeID, info );
+    m_catalogChanged = true;
+
+    return info;
+}
+
 QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString const& mapThemeID )
 {
     QList<QStandardItem *> itemList;
 
-    GeoSceneDocument *mapTheme = loadMapThemeFile( mapThemeID );
-    if ( !mapTheme || !mapTheme->head()->visible() ) {
+    const ThemeInfo mapTheme = themeInfo( mapThemeID );
+    if ( !mapTheme.visible ) {
         return itemList;
     }
 
-    QPixmap themeIconPixmap;
-    QString relativePath;
-
-    relativePath = mapDirName + '/'
-        + mapTheme->head()->target() + '/' + mapTheme->head()->theme() + '/'
-        + mapTheme->head()->icon()->pixmap();
-    themeIconPixmap.load( MarbleDirs::path( relativePath ) );
+    QPixmap themeIconPixmap = QPixmap::fromImage( mapTheme.icon );
 
     if ( themeIconPixmap.isNull() ) {
-        relativePath = "svg/application-x-marble-gray.png"; 
+        QString relativePath = "svg/application-x-marble-gray.png";
         themeIconPixmap.load( MarbleDirs::path( relativePath ) );
     }
-    else {
-        // Make sure we don't keep excessively large previews in memory
-        // TODO: Scale the icon down to the default icon size in MarbleSelectView.
-        //       For now maxIconSize already equals what's expected by the listview.
-        QSize maxIconSize( 136, 136 );
-        if ( themeIconPixmap.size() != maxIconSize ) {
-            mDebug() << "Smooth scaling theme icon";
-            themeIconPixmap = themeIconPixmap.scaled( maxIconSize,
-                                                      Qt::KeepAspectRatio,
-                                                      Qt::SmoothTransformation );
-        }
-    }
 
     QIcon mapThemeIcon =  QIcon( themeIconPixmap );
 
-    QString name = mapTheme->head()->name();
-    QString description = mapTheme->head()->description();
+    QString name = mapTheme.name;
+    QString description = mapTheme.description;
 
     QStandardItem *item = new QStandardItem( name );
     item->setData( QObject::tr( name.toUtf8() ), Qt::DisplayRole );
@@ -343,13 +501,11 @@ QList<QStandardItem *> MapThemeManager::Private::createMapThemeRow( QString cons
     item->setData( mapThemeID, Qt::UserRole + 1 );
 
     itemList << item;
-    itemList << new QStandardItem( mapTheme->head()->target() + '/'
-                                   + mapTheme->head()->theme() + '/'
-                                   + mapTheme->head()->theme() + ".dgml" );
+    itemList << new QStandardItem( mapTheme.target + '/'
+                                   + mapTheme.theme + '/'
+                                   + mapTheme.theme + ".dgml" );
     itemList << new QStandardItem( QObject::tr( description.toUtf8() ) );
 
-    delete mapTheme;
-
     return itemList;
 }
 
@@ -373,6 +529,21 @@ void MapThemeManager::Private::updateMapThemeModel()
             m_mapThemeModel.appendRow( itemList );
         }
     }
+
+    // Forget about themes which were removed.
+    QHash<QString, ThemeInfo>::iterator cached = m_catalog.begin();
+    while ( cached != m_catalog.end() ) {
+        if ( stringlist.contains( cached.key() ) ) {
+            ++cached;
+        } else {
+            cached = m_catalog.erase( cached );
+            m_catalogChanged = true;
+        }
+    }
+
+    if ( m_catalogChanged ) {
+        writeCatalog();
+    }
 }
 
 void MapThemeManager::Private::directoryChanged( const QString& path )
@@ -422,7 +593,11 @@ void MapThemeManager::Private::fileChanged( const QString& path )
             m_mapThemeModel.insertRow( insertAtRow, newMapThemeRow );
         }
     }
-    
+
+    if ( m_catalogChanged ) {
+        writeCatalog();
+    }
+
     emit q->themesChanged();
 }
 
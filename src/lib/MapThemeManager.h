@@ -33,6 +33,9 @@ class GeoSceneDocument;
  * This class which is able to check for maps that are locally available.
  * After parsing the data it only stores the name, description and path
  * into a QStandardItemModel.
+ *
+ * These properties are kept in a catalog on disk together with the scaled
+ * preview icon, so only map themes whose files changed get parsed again.
  * 
  * The MapThemeManager is not owned by the MarbleWidget/Map itself. 
  * Instead it is owned by the widget or application that contains 
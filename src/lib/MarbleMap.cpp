@@ -65,6 +65,7 @@
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
 #include "VectorComposer.h"
+#include "VectorTileLoader.h"
 #include "ViewParams.h"
 #include "ViewportParams.h"
 
@@ -112,6 +113,8 @@ class MarbleMapPrivate
 
     void updateProperty( const QString &, bool );
 
+    void updateVectorTiles();
+
     MarbleMap *const q;
 
     // The model we are showing.
@@ -181,6 +184,11 @@ MarbleMapPrivate::MarbleMapPrivate( MarbleMap *parent, MarbleModel *model )
                       parent, SIGNAL( tileLevelChanged( int ) ) );
     QObject::connect( &m_textureLayer, SIGNAL( repaintNeeded() ),
                       parent, SIGNAL( repaintNeeded() ) );
+
+    QObject::connect( parent, SIGNAL( visibleLatLonAltBoxChanged( GeoDataLatLonAltBox ) ),
+                      parent, SLOT( updateVectorTiles() ) );
+    QObject::connect( parent, SIGNAL( radiusChanged( int ) ),
+                      parent, SLOT( updateVectorTiles() ) );
 }
 
 void MarbleMapPrivate::updateProperty( const QString &name, bool show )
@@ -719,6 +727,13 @@ void MarbleMap::setMapThemeId( const QString& mapThemeId )
     d->m_model->setMapThemeId( mapThemeId );
 }
 
+void MarbleMapPrivate::updateVectorTiles()
+{
+    // The loader belongs to the model, with several maps on one model the
+    // tiles follow the viewport that changed last
+    m_model->vectorTileLoader()->setViewport( m_viewport.viewLatLonAltBox(), m_viewport.radius() );
+}
+
 void MarbleMapPrivate::updateMapTheme()
 {
     m_layerManager.removeLayer( &m_textureLayer );
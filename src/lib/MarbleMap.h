@@ -678,6 +678,7 @@ class MARBLE_EXPORT MarbleMap : public QObject
  private:
     Q_PRIVATE_SLOT( d, void updateMapTheme() )
     Q_PRIVATE_SLOT( d, void updateProperty( const QString &, bool ) )
+    Q_PRIVATE_SLOT( d, void updateVectorTiles() )
 
  private:
     Q_DISABLE_COPY( MarbleMap )
@@ -23,15 +23,12 @@
 #include <QtCore/QAbstractItemModel>
 #include <QtCore/QSet>
 #include <QtGui/QItemSelectionModel>
-#include <QtGui/QSortFilterProxyModel>
 
 #if (QT_VERSION >= 0x040700 && QT_VERSION < 0x040800)
 // See comment below why this is needed
 #include <QtNetwork/QNetworkConfigurationManager>
 #endif
 
-#include "kdescendantsproxymodel.h"
-
 #include "MapThemeManager.h"
 #include "global.h"
 #include "MarbleDebug.h"
@@ -48,7 +45,6 @@
 
 #include "GeoDataDocument.h"
 #include "GeoDataStyle.h"
-#include "GeoDataTypes.h"
 
 #include "DgmlAuxillaryDictionary.h"
 #include "MarbleClock.h"
@@ -60,6 +56,7 @@
 #include "MarbleDirs.h"
 #include "FileManager.h"
 #include "GeoDataTreeModel.h"
+#include "PlacemarkIndexModel.h"
 #include "Planet.h"
 #include "PluginManager.h"
 #include "StoragePolicy.h"
@@ -67,6 +64,7 @@
 #include "TileCreator.h"
 #include "TileCreatorDialog.h"
 #include "TileLoader.h"
+#include "VectorTileLoader.h"
 #include "routing/RoutingManager.h"
 #include "BookmarkManager.h"
 #include "ElevationModel.h"
@@ -92,8 +90,8 @@ class MarbleModelPrivate
           m_fileManager( 0 ),
           m_fileviewmodel(),
           m_treemodel(),
-          m_descendantproxy(),
-          m_sortproxy(),
+          m_placemarkIndex(),
+          m_vectorTileLoader( &m_treemodel ),
           m_placemarkselectionmodel( 0 ),
           m_positionTracking( &m_treemodel ),
           m_trackedPlacemark( 0 ),
@@ -102,10 +100,7 @@ class MarbleModelPrivate
           m_legend( 0 ),
           m_workOffline( false )
     {
-        m_sortproxy.setFilterFixedString( GeoDataTypes::GeoDataPlacemarkType );
-        m_sortproxy.setFilterKeyColumn( 1 );
-        m_sortproxy.setSourceModel( &m_descendantproxy );
-        m_descendantproxy.setSourceModel( &m_treemodel );
+        m_placemarkIndex.setTreeModel( &m_treemodel );
     }
 
     ~MarbleModelPrivate()
@@ -138,8 +133,8 @@ class MarbleModelPrivate
 
     FileViewModel            m_fileviewmodel;
     GeoDataTreeModel         m_treemodel;
-    KDescendantsProxyModel   m_descendantproxy;
-    QSortFilterProxyModel    m_sortproxy;
+    PlacemarkIndexModel      m_placemarkIndex;
+    VectorTileLoader         m_vectorTileLoader;
 
     // Selection handling
     QItemSelectionModel      m_placemarkselectionmodel;
@@ -388,7 +383,7 @@ GeoDataTreeModel *MarbleModel::treeModel()
 
 QAbstractItemModel *MarbleModel::placemarkModel()
 {
-    return &d->m_sortproxy;
+    return &d->m_placemarkIndex;
 }
 
 QItemSelectionModel *MarbleModel::placemarkSelectionModel()
@@ -431,6 +426,11 @@ FileManager *MarbleModel::fileManager()
     return d->m_fileManager;
 }
 
+VectorTileLoader *MarbleModel::vectorTileLoader()
+{
+    return &d->m_vectorTileLoader;
+}
+
 qreal MarbleModel::planetRadius()   const
 {
     return d->m_planet->radius();
@@ -66,6 +66,7 @@ class Planet;
 class RoutingManager;
 class BookmarkManager;
 class FileManager;
+class VectorTileLoader;
 class ElevationModel;
 
 /**
@@ -208,6 +209,15 @@ class MARBLE_EXPORT MarbleModel : public QObject
     void removeGeoData( const QString& key );
     FileManager       *fileManager();
 
+    /**
+     * @brief Return the loader of tiled vector documents, which shows the
+     * tiles around the viewport of the map.
+     *
+     * All maps of the model share the loader, it follows the map whose
+     * viewport changed last.
+     */
+    VectorTileLoader  *vectorTileLoader();
+
     FileViewModel      *fileViewModel();
 
     PositionTracking   *positionTracking() const;
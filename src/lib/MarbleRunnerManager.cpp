@@ -23,6 +23,7 @@
 #include "routing/RouteRequest.h"
 #include "routing/RoutingProfilesModel.h"
 
+#include <QtCore/QFileInfo>
 #include <QtCore/QObject>
 #include <QtCore/QString>
 #include <QtCore/QVector>
@@ -55,6 +56,10 @@ public:
 
     QList<RunnerPlugin*> plugins( RunnerPlugin::Capability capability );
 
+    /** Returns those of the given runner plugins that can work on the capability now. */
+    QList<RunnerPlugin*> usablePlugins( const QList<RunnerPlugin*> &plugins,
+                                        RunnerPlugin::Capability capability );
+
     QList<RunnerTask*> m_searchTasks;
     QList<RunnerTask*> m_reverseTasks;
     QList<RunnerTask*> m_routingTasks;
@@ -94,14 +99,15 @@ MarbleRunnerManagerPrivate::~MarbleRunnerManagerPrivate()
 }
 
 QList<RunnerPlugin*> MarbleRunnerManagerPrivate::plugins( RunnerPlugin::Capability capability )
+{
+    return usablePlugins( m_pluginManager->runnerPlugins( capability ), capability );
+}
+
+QList<RunnerPlugin*> MarbleRunnerManagerPrivate::usablePlugins( const QList<RunnerPlugin*> &plugins,
+                                                                RunnerPlugin::Capability capability )
 {
     QList<RunnerPlugin*> result;
-    QList<RunnerPlugin*> plugins = m_pluginManager->runnerPlugins();
     foreach( RunnerPlugin* plugin, plugins ) {
-        if ( !plugin->supports( capability ) ) {
-            continue;
-        }
-
         if ( ( m_marbleModel && m_marbleModel->workOffline() && !plugin->canWorkOffline() ) ) {
             continue;
         }
@@ -357,7 +363,9 @@ QVector<GeoDataDocument*> MarbleRunnerManager::searchRoute( const RouteRequest *
 
 void MarbleRunnerManager::parseFile( const QString &fileName, DocumentRole role )
 {
-    QList<RunnerPlugin*> plugins = d->plugins( RunnerPlugin::Parsing );
+    const QString extension = QFileInfo( fileName ).suffix();
+    QList<RunnerPlugin*> plugins = d->usablePlugins( d->m_pluginManager->parsingRunnerPlugins( extension ),
+                                                     RunnerPlugin::Parsing );
     foreach( RunnerPlugin *plugin, plugins ) {
         ParsingTask *task = new ParsingTask( plugin, this, fileName, role );
         connect( task, SIGNAL( finished( RunnerTask* ) ), this, SLOT( cleanupParsingTask(RunnerTask*) ) );
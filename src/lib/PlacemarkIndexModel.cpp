@@ -0,0 +1,355 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PlacemarkIndexModel.h"
+
+#include <QtCore/QList>
+#include <QtGui/QImage>
+
+#include "GeoDataDocument.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "GeoDataTypes.h"
+#include "MarblePlacemarkModel.h"
+
+namespace Marble
+{
+
+class PlacemarkIndexModel::Private
+{
+ public:
+    Private();
+
+    /**
+     * Appends the placemarks below @p feature in depth-first order.
+     */
+    static void collect( const GeoDataFeature *feature, QVector<GeoDataPlacemark*> *placemarks );
+
+    /**
+     * The row of the top level document @p object belongs to, or -1.
+     */
+    int documentOf( GeoDataObject *object ) const;
+
+    /**
+     * The index of the top level document listing @p row.
+     */
+    int documentAt( int row ) const;
+
+    void updateOffsets();
+
+    GeoDataTreeModel *m_treeModel;
+
+    // The placemarks of each top level document of the tree model
+    QList<QVector<GeoDataPlacemark*> > m_placemarks;
+
+    // The first row of each document, followed by the number of rows
+    QVector<int> m_offsets;
+};
+
+PlacemarkIndexModel::Private::Private()
+    : m_treeModel( 0 ),
+      m_offsets( 1, 0 )
+{
+}
+
+void PlacemarkIndexModel::Private::collect( const GeoDataFeature *feature, QVector<GeoDataPlacemark*> *placemarks )
+{
+    if ( feature->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+        placemarks->append( const_cast<GeoDataPlacemark*>( static_cast<const GeoDataPlacemark*>( feature ) ) );
+    }
+    else if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType
+              || feature->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+        const GeoDataContainer *container = static_cast<const GeoDataContainer*>( feature );
+        QVector<GeoDataFeature*>::const_iterator it = container->constBegin();
+        QVector<GeoDataFeature*>::const_iterator const end = container->constEnd();
+        for ( ; it != end; ++it ) {
+            collect( *it, placemarks );
+        }
+    }
+}
+
+int PlacemarkIndexModel::Private::documentOf( GeoDataObject *object ) const
+{
+    GeoDataDocument *root = m_treeModel->rootDocument();
+    while ( object && object->parent() != root ) {
+        object = object->parent();
+    }
+
+    if ( !object ) {
+        return -1;
+    }
+
+    return root->childPosition( static_cast<GeoDataFeature*>( object ) );
+}
+
+int PlacemarkIndexModel::Private::documentAt( int row ) const
+{
+    // The last document starting at or before row; empty ones are skipped
+    return qUpperBound( m_offsets.constBegin(), m_offsets.constEnd() - 1, row ) - m_offsets.constBegin() - 1;
+}
+
+void PlacemarkIndexModel::Private::updateOffsets()
+{
+    m_offsets.resize( m_placemarks.size() + 1 );
+    int offset = 0;
+    for ( int i = 0; i < m_placemarks.size(); ++i ) {
+        m_offsets[i] = offset;
+        offset += m_placemarks.at( i ).size();
+    }
+    m_offsets[m_placemarks.size()] = offset;
+}
+
+PlacemarkIndexModel::PlacemarkIndexModel( QObject *parent )
+    : QAbstractListModel( parent ),
+      d( new Private )
+{
+}
+
+PlacemarkIndexModel::~PlacemarkIndexModel()
+{
+    delete d;
+}
+
+void PlacemarkIndexModel::setTreeModel( GeoDataTreeModel *treeModel )
+{
+    if ( d->m_treeModel ) {
+        disconnect( d->m_treeModel, 0, this, 0 );
+    }
+
+    d->m_treeModel = treeModel;
+
+    if ( d->m_treeModel ) {
+        connect( d->m_treeModel, SIGNAL( rowsInserted( const QModelIndex &, int, int ) ),
+                 this, SLOT( addPlacemarks( const QModelIndex &, int, int ) ) );
+        connect( d->m_treeModel, SIGNAL( rowsRemoved( const QModelIndex &, int, int ) ),
+                 this, SLOT( removePlacemarks( const QModelIndex &, int, int ) ) );
+        connect( d->m_treeModel, SIGNAL( dataChanged( const QModelIndex &, const QModelIndex & ) ),
+                 this, SLOT( updatePlacemarks( const QModelIndex &, const QModelIndex & ) ) );
+        connect( d->m_treeModel, SIGNAL( modelReset() ),
+                 this, SLOT( resetPlacemarks() ) );
+        connect( d->m_treeModel, SIGNAL( layoutChanged() ),
+                 this, SLOT( resetPlacemarks() ) );
+    }
+
+    resetPlacemarks();
+}
+
+int PlacemarkIndexModel::rowCount( const QModelIndex &parent ) const
+{
+    if ( parent.isValid() ) {
+        return 0;
+    }
+
+    return d->m_offsets.last();
+}
+
+QVariant PlacemarkIndexModel::data( const QModelIndex &index, int role ) const
+{
+    GeoDataPlacemark *placemark = this->placemark( index.row() );
+    if ( !index.isValid() || !placemark ) {
+        return QVariant();
+    }
+
+    switch ( role ) {
+    case Qt::DisplayRole:
+        return QVariant( placemark->name() );
+    case Qt::DecorationRole:
+        return QVariant( placemark->style()->iconStyle().icon() );
+    case Qt::ToolTipRole:
+        return QVariant( placemark->description() );
+    case MarblePlacemarkModel::ObjectPointerRole:
+        return qVariantFromValue( static_cast<GeoDataObject*>( placemark ) );
+    case MarblePlacemarkModel::PopularityIndexRole:
+        return QVariant( placemark->popularityIndex() );
+    case MarblePlacemarkModel::PopularityRole:
+        return QVariant( placemark->popularity() );
+    case MarblePlacemarkModel::CoordinateRole:
+        return qVariantFromValue( placemark->coordinate() );
+    default:
+        return QVariant();
+    }
+}
+
+GeoDataPlacemark *PlacemarkIndexModel::placemark( int row ) const
+{
+    if ( row < 0 || row >= d->m_offsets.last() ) {
+        return 0;
+    }
+
+    const int document = d->documentAt( row );
+    return d->m_placemarks.at( document ).at( row - d->m_offsets.at( document ) );
+}
+
+QVector<GeoDataPlacemark*> PlacemarkIndexModel::placemarks() const
+{
+    QVector<GeoDataPlacemark*> result;
+    result.reserve( d->m_offsets.last() );
+    foreach ( const QVector<GeoDataPlacemark*> &placemarks, d->m_placemarks ) {
+        result += placemarks;
+    }
+
+    return result;
+}
+
+void PlacemarkIndexModel::addPlacemarks( const QModelIndex &parent, int first, int last )
+{
+    const GeoDataDocument *root = d->m_treeModel->rootDocument();
+
+    if ( !parent.isValid() ) {
+        // New documents, their placemarks go in between the existing ones
+        QList<QVector<GeoDataPlacemark*> > added;
+        int count = 0;
+        for ( int i = first; i <= last; ++i ) {
+            QVector<GeoDataPlacemark*> placemarks;
+            Private::collect( root->child( i ), &placemarks );
+            count += placemarks.size();
+            added.append( placemarks );
+        }
+
+        const int row = d->m_offsets.at( first );
+        if ( count > 0 ) {
+            beginInsertRows( QModelIndex(), row, row + count - 1 );
+        }
+        for ( int i = 0; i < added.size(); ++i ) {
+            d->m_placemarks.insert( first + i, added.at( i ) );
+        }
+        d->updateOffsets();
+        if ( count > 0 ) {
+            endInsertRows();
+        }
+        return;
+    }
+
+    const int document = d->documentOf( static_cast<GeoDataObject*>( parent.internalPointer() ) );
+    if ( document < 0 ) {
+        return;
+    }
+
+    // Features were added somewhere below a document. Compare its placemarks
+    // before and after, the new ones follow the common beginning.
+    QVector<GeoDataPlacemark*> placemarks;
+    Private::collect( root->child( document ), &placemarks );
+    const QVector<GeoDataPlacemark*> &old = d->m_placemarks.at( document );
+
+    const int count = placemarks.size() - old.size();
+    if ( count <= 0 ) {
+        return;
+    }
+
+    int prefix = 0;
+    while ( prefix < old.size() && old.at( prefix ) == placemarks.at( prefix ) ) {
+        ++prefix;
+    }
+
+    const int row = d->m_offsets.at( document ) + prefix;
+    beginInsertRows( QModelIndex(), row, row + count - 1 );
+    d->m_placemarks[document] = placemarks;
+    d->updateOffsets();
+    endInsertRows();
+}
+
+void PlacemarkIndexModel::removePlacemarks( const QModelIndex &parent, int first, int last )
+{
+    if ( !parent.isValid() ) {
+        if ( first < 0 || last >= d->m_placemarks.size() ) {
+            return;
+        }
+
+        const int row = d->m_offsets.at( first );
+        const int count = d->m_offsets.at( last + 1 ) - row;
+        if ( count > 0 ) {
+            beginRemoveRows( QModelIndex(), row, row + count - 1 );
+        }
+        for ( int i = first; i <= last; ++i ) {
+            d->m_placemarks.removeAt( first );
+        }
+        d->updateOffsets();
+        if ( count > 0 ) {
+            endRemoveRows();
+        }
+        return;
+    }
+
+    const int document = d->documentOf( static_cast<GeoDataObject*>( parent.internalPointer() ) );
+    if ( document < 0 ) {
+        return;
+    }
+
+    // The removed features may be deleted already, so the old placemarks
+    // are only compared, never dereferenced
+    QVector<GeoDataPlacemark*> placemarks;
+    Private::collect( d->m_treeModel->rootDocument()->child( document ), &placemarks );
+    const QVector<GeoDataPlacemark*> &old = d->m_placemarks.at( document );
+
+    const int count = old.size() - placemarks.size();
+    if ( count <= 0 ) {
+        return;
+    }
+
+    int prefix = 0;
+    while ( prefix < placemarks.size() && old.at( prefix ) == placemarks.at( prefix ) ) {
+        ++prefix;
+    }
+
+    const int row = d->m_offsets.at( document ) + prefix;
+    beginRemoveRows( QModelIndex(), row, row + count - 1 );
+    d->m_placemarks[document] = placemarks;
+    d->updateOffsets();
+    endRemoveRows();
+}
+
+void PlacemarkIndexModel::updatePlacemarks( const QModelIndex &topLeft, const QModelIndex &bottomRight )
+{
+    if ( !topLeft.isValid() ) {
+        return;
+    }
+
+    for ( int i = topLeft.row(); i <= bottomRight.row(); ++i ) {
+        const QModelIndex index = topLeft.sibling( i, 0 );
+        GeoDataObject *object = static_cast<GeoDataObject*>( index.internalPointer() );
+        const int document = d->documentOf( object );
+        if ( document < 0 ) {
+            continue;
+        }
+
+        const int offset = d->m_offsets.at( document );
+        if ( object->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+            const int row = d->m_placemarks.at( document ).indexOf( static_cast<GeoDataPlacemark*>( object ) );
+            if ( row >= 0 ) {
+                emit dataChanged( this->index( offset + row ), this->index( offset + row ) );
+            }
+        }
+        else if ( !d->m_placemarks.at( document ).isEmpty() ) {
+            // Changes of containers like their visibility apply to all of their placemarks
+            emit dataChanged( this->index( offset ), this->index( d->m_offsets.at( document + 1 ) - 1 ) );
+        }
+    }
+}
+
+void PlacemarkIndexModel::resetPlacemarks()
+{
+    beginResetModel();
+
+    d->m_placemarks.clear();
+    if ( d->m_treeModel ) {
+        const GeoDataDocument *root = d->m_treeModel->rootDocument();
+        for ( int i = 0; i < root->size(); ++i ) {
+            QVector<GeoDataPlacemark*> placemarks;
+            Private::collect( root->child( i ), &placemarks );
+            d->m_placemarks.append( placemarks );
+        }
+    }
+    d->updateOffsets();
+
+    endResetModel();
+}
+
+}
+
+#include "PlacemarkIndexModel.moc"
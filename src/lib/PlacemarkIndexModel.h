@@ -0,0 +1,73 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_PLACEMARKINDEXMODEL_H
+#define MARBLE_PLACEMARKINDEXMODEL_H
+
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QVector>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataPlacemark;
+class GeoDataTreeModel;
+
+/**
+ * @short A flat list of all placemarks of a GeoDataTreeModel.
+ *
+ * The placemarks are listed in the order a depth-first walk of the tree
+ * model visits them. The list is kept per top level document, so changes
+ * of the tree model only touch the placemarks of the affected document.
+ * Besides the usual model interface the placemarks can be accessed
+ * directly by their row.
+ */
+class MARBLE_EXPORT PlacemarkIndexModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+ public:
+    explicit PlacemarkIndexModel( QObject *parent = 0 );
+    ~PlacemarkIndexModel();
+
+    /**
+     * Lists the placemarks of @p treeModel and follows its changes.
+     */
+    void setTreeModel( GeoDataTreeModel *treeModel );
+
+    int rowCount( const QModelIndex &parent = QModelIndex() ) const;
+
+    QVariant data( const QModelIndex &index, int role = Qt::DisplayRole ) const;
+
+    /**
+     * The placemark in @p row, or 0 if there is no such row.
+     */
+    GeoDataPlacemark *placemark( int row ) const;
+
+    /**
+     * All placemarks in the order of their rows.
+     */
+    QVector<GeoDataPlacemark*> placemarks() const;
+
+ private Q_SLOTS:
+    void addPlacemarks( const QModelIndex &parent, int first, int last );
+    void removePlacemarks( const QModelIndex &parent, int first, int last );
+    void updatePlacemarks( const QModelIndex &topLeft, const QModelIndex &bottomRight );
+    void resetPlacemarks();
+
+ private:
+    Q_DISABLE_COPY( PlacemarkIndexModel )
+    class Private;
+    Private * const d;
+};
+
+}
+
+#endif
@@ -14,8 +14,16 @@
 #include "PluginManager.h"
 
 // Qt
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QPair>
 #include <QtCore/QPluginLoader>
+#include <QtCore/QSet>
 #include <QtCore/QTime>
 
 // Local dir
@@ -30,19 +38,76 @@
 namespace Marble
 {
 
+// Increase whenever the layout of the plugin cache changes.
+static const quint32 pluginCacheVersion = 2;
+
 class PluginManagerPrivate
 {
  public:
+    enum PluginType {
+        UnknownPlugin,
+        InvalidPlugin,
+        RenderPluginType,
+        NetworkPluginType,
+        PositionProviderPluginType,
+        RunnerPluginType
+    };
+
+    struct PluginInfo
+    {
+        PluginInfo()
+            : size( 0 ),
+              lastModified( 0 ),
+              type( UnknownPlugin ),
+              capabilities( 0 ),
+              loaded( false )
+        {
+        }
+
+        QString path;
+        qint64 size;
+        qint64 lastModified;
+        int type;
+        QString nameId;
+        int capabilities;
+        QStringList fileExtensions;
+        bool loaded;
+    };
+
     PluginManagerPrivate()
-            : m_pluginsLoaded(false)
+            : m_pluginsScanned( false ),
+              m_cacheChanged( false )
     {
     }
 
     ~PluginManagerPrivate();
 
-    void loadPlugins();
+    void scanPlugins();
+    void loadPlugins( PluginType type );
+    void loadRunnerPlugins( int capabilities, const QString &fileExtension = QString() );
+    void loadPlugin( PluginInfo &info );
+
+    /**
+     * Returns true if a plugin of the same kind and with the same name id
+     * was loaded already, e.g. a copy in another plugin directory.
+     */
+    bool isDuplicate( const PluginInfo &info ) const;
+
+    template<class T, class U>
+    bool appendPlugin( QObject *obj, QPluginLoader *loader, QList<T*> &plugins,
+                       PluginInfo &info, PluginType type );
+
+    QString cacheFileName() const;
+    void readCache();
+    void writeCache();
+
+    bool m_pluginsScanned;
+    bool m_cacheChanged;
+    QList<PluginType> m_loadedTypes;
+    QList<PluginInfo> m_pluginInfos;
+    QHash<QString, PluginInfo> m_cache;
+    QSet<QPair<int, QString> > m_loadedNameIds;
 
-    bool m_pluginsLoaded;
     QList<RenderPlugin *> m_renderPluginTemplates;
     QList<NetworkPlugin *> m_networkPluginTemplates;
     QList<PositionProviderPlugin *> m_positionProviderPluginTemplates;
@@ -66,10 +131,9 @@ PluginManager::~PluginManager()
 }
 
 template<class T>
-QList<T*> createPlugins( PluginManagerPrivate* d, const QList<T*> &loaders )
+QList<T*> createPlugins( const QList<T*> &loaders )
 {
     QList<T*> result;
-    d->loadPlugins();
     typename QList<T*>::const_iterator i = loaders.constBegin();
     typename QList<T*>::const_iterator const end = loaders.constEnd();
     for (; i != end; ++i) {
@@ -82,28 +146,66 @@ QList<T*> createPlugins( PluginManagerPrivate* d, const QList<T*> &loaders )
 
 QList<RenderPlugin *> PluginManager::createRenderPlugins() const
 {
-    return createPlugins( d, d->m_renderPluginTemplates );
+    d->loadPlugins( PluginManagerPrivate::RenderPluginType );
+    return createPlugins( d->m_renderPluginTemplates );
 }
 
 QList<NetworkPlugin *> PluginManager::createNetworkPlugins() const
 {
-    return createPlugins( d, d->m_networkPluginTemplates );
+    d->loadPlugins( PluginManagerPrivate::NetworkPluginType );
+    return createPlugins( d->m_networkPluginTemplates );
 }
 
 QList<PositionProviderPlugin *> PluginManager::createPositionProviderPlugins() const
 {
-    return createPlugins( d, d->m_positionProviderPluginTemplates );
+    d->loadPlugins( PluginManagerPrivate::PositionProviderPluginType );
+    return createPlugins( d->m_positionProviderPluginTemplates );
 }
 
 QList<RunnerPlugin *> PluginManager::runnerPlugins() const
 {
-    d->loadPlugins();
+    d->loadPlugins( PluginManagerPrivate::RunnerPluginType );
     return d->m_runnerPlugins;
 }
 
+QList<RunnerPlugin *> PluginManager::runnerPlugins( int capabilities ) const
+{
+    d->loadRunnerPlugins( capabilities );
+
+    QList<RunnerPlugin *> result;
+    foreach( RunnerPlugin *plugin, d->m_runnerPlugins ) {
+        if ( plugin->capabilities() & capabilities ) {
+            result << plugin;
+        }
+    }
+    return result;
+}
+
+QList<RunnerPlugin *> PluginManager::parsingRunnerPlugins( const QString &fileExtension ) const
+{
+    const QString extension = fileExtension.toLower();
+    d->loadRunnerPlugins( RunnerPlugin::Parsing, extension );
+
+    QList<RunnerPlugin *> result;
+    foreach( RunnerPlugin *plugin, d->m_runnerPlugins ) {
+        if ( plugin->supports( RunnerPlugin::Parsing )
+             && ( plugin->fileExtensions().isEmpty() || plugin->fileExtensions().contains( extension ) ) ) {
+            result << plugin;
+        }
+    }
+
+    // Nobody claims the extension, so let every parser try its luck.
+    if ( result.isEmpty() ) {
+        return runnerPlugins( RunnerPlugin::Parsing );
+    }
+
+    return result;
+}
+
 /** Append obj to the given plugins list if it inherits both T and U */
 template<class T, class U>
-bool appendPlugin( QObject * obj, QPluginLoader* &loader, QList<T*> &plugins )
+bool PluginManagerPrivate::appendPlugin( QObject *obj, QPluginLoader *loader, QList<T*> &plugins,
+                                         PluginInfo &info, PluginType type )
 {
     if ( qobject_cast<T*>( obj ) && qobject_cast<U*>( obj ) ) {
         Q_ASSERT( obj->metaObject()->superClass() ); // all our plugins have a super class
@@ -111,65 +213,242 @@ bool appendPlugin( QObject * obj, QPluginLoader* &loader, QList<T*> &plugins )
                 << "plugin loaded from" << loader->fileName();
         T* plugin = qobject_cast<T*>( obj );
         Q_ASSERT( plugin ); // checked above
-        plugins << plugin;
+        info.type = type;
+        info.nameId = plugin->nameId();
+        if ( isDuplicate( info ) ) {
+            mDebug() << "Ignoring" << info.path << "because plugin" << info.nameId << "is loaded already";
+        } else {
+            m_loadedNameIds << qMakePair( info.type, info.nameId );
+            plugins << plugin;
+        }
         return true;
     }
 
     return false;
 }
 
-void PluginManagerPrivate::loadPlugins()
+bool PluginManagerPrivate::isDuplicate( const PluginInfo &info ) const
 {
-    if (m_pluginsLoaded)
-    {
+    return !info.nameId.isEmpty() && m_loadedNameIds.contains( qMakePair( info.type, info.nameId ) );
+}
+
+QString PluginManagerPrivate::cacheFileName() const
+{
+    return MarbleDirs::localPath() + "/plugins.cache";
+}
+
+void PluginManagerPrivate::readCache()
+{
+    QFile file( cacheFileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
         return;
     }
 
-    QTime t;
-    t.start();
-    mDebug() << "Starting to load Plugins.";
+    QDataStream stream( &file );
+    quint32 version;
+    qint32 count;
+    stream >> version >> count;
+    if ( version != pluginCacheVersion || stream.status() != QDataStream::Ok ) {
+        return;
+    }
+
+    for ( qint32 i = 0; i < count; ++i ) {
+        PluginInfo info;
+        qint32 type;
+        qint32 capabilities;
+        stream >> info.path >> info.size >> info.lastModified >> type >> info.nameId >> capabilities
+               >> info.fileExtensions;
+        if ( stream.status() != QDataStream::Ok ) {
+            m_cache.clear();
+            return;
+        }
+        info.type = type;
+        info.capabilities = capabilities;
+        info.loaded = false;
+        m_cache.insert( info.path, info );
+    }
+}
+
+void PluginManagerPrivate::writeCache()
+{
+    QDir().mkpath( MarbleDirs::localPath() );
+
+    QFile file( cacheFileName() );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write the plugin cache" << file.fileName();
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream << pluginCacheVersion << qint32( m_pluginInfos.size() );
+    foreach( const PluginInfo &info, m_pluginInfos ) {
+        stream << info.path << info.size << info.lastModified << qint32( info.type )
+               << info.nameId << qint32( info.capabilities ) << info.fileExtensions;
+    }
+
+    m_cacheChanged = false;
+}
+
+void PluginManagerPrivate::scanPlugins()
+{
+    if ( m_pluginsScanned ) {
+        return;
+    }
 
     QStringList pluginFileNameList = MarbleDirs::pluginEntryList( "", QDir::Files );
 
     MarbleDirs::debug();
 
-    Q_ASSERT( m_renderPluginTemplates.isEmpty() );
-    Q_ASSERT( m_networkPluginTemplates.isEmpty() );
-    Q_ASSERT( m_positionProviderPluginTemplates.isEmpty() );
-    Q_ASSERT( m_runnerPlugins.isEmpty() );
+    readCache();
 
     foreach( const QString &fileName, pluginFileNameList ) {
-        // mDebug() << fileName << " - " << MarbleDirs::pluginPath( fileName );
         QString const path = MarbleDirs::pluginPath( fileName );
-        QPluginLoader* loader = new QPluginLoader( path );
-
-        QObject * obj = loader->instance();
-
-        if ( obj ) {
-            bool isPlugin = appendPlugin<RenderPlugin, RenderPluginInterface>
-                       ( obj, loader, m_renderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<NetworkPlugin, NetworkPluginInterface>
-                       ( obj, loader, m_networkPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
-                       ( obj, loader, m_positionProviderPluginTemplates );
-            isPlugin = isPlugin || appendPlugin<RunnerPlugin, RunnerPlugin>
-                       ( obj, loader, m_runnerPlugins ); // intentionally T==U
-            if ( !isPlugin ) {
-                mDebug() << "Plugin failure:" << fileName << "is a plugin, but it does not implement the "
-                        << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
-                delete loader;
+        QFileInfo const fileInfo( path );
+
+        PluginInfo info = m_cache.value( path );
+        if ( info.path.isEmpty()
+             || info.size != fileInfo.size()
+             || info.lastModified != fileInfo.lastModified().toMSecsSinceEpoch() ) {
+            info.path = path;
+            info.size = fileInfo.size();
+            info.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
+            info.type = UnknownPlugin;
+            info.capabilities = 0;
+            info.nameId.clear();
+            info.fileExtensions.clear();
+            info.loaded = false;
+            m_cacheChanged = true;
+        }
+
+        m_pluginInfos << info;
+    }
+
+    // Plugins which were removed since the cache was written.
+    m_cacheChanged = m_cacheChanged || m_cache.size() != m_pluginInfos.size();
+    m_cache.clear();
+
+    m_pluginsScanned = true;
+}
+
+void PluginManagerPrivate::loadPlugin( PluginInfo &info )
+{
+    QPluginLoader* loader = new QPluginLoader( info.path );
+
+    QObject * obj = loader->instance();
+
+    const PluginInfo cached = info;
+    info.loaded = true;
+    info.type = InvalidPlugin;
+    info.capabilities = 0;
+    info.fileExtensions.clear();
+
+    if ( obj ) {
+        const bool appended =
+            appendPlugin<RenderPlugin, RenderPluginInterface>
+                ( obj, loader, m_renderPluginTemplates, info, RenderPluginType )
+            || appendPlugin<NetworkPlugin, NetworkPluginInterface>
+                ( obj, loader, m_networkPluginTemplates, info, NetworkPluginType )
+            || appendPlugin<PositionProviderPlugin, PositionProviderPluginInterface>
+                ( obj, loader, m_positionProviderPluginTemplates, info, PositionProviderPluginType )
+            || appendPlugin<RunnerPlugin, RunnerPlugin> // intentionally T==U
+                ( obj, loader, m_runnerPlugins, info, RunnerPluginType );
+
+        if ( !appended ) {
+            mDebug() << "Plugin failure:" << info.path << "is a plugin, but it does not implement the "
+                    << "right interfaces or it was compiled against an old version of Marble. Ignoring it.";
+            delete loader;
+        } else if ( info.type == RunnerPluginType ) {
+            RunnerPlugin *plugin = qobject_cast<RunnerPlugin*>( obj );
+            info.capabilities = plugin->capabilities();
+            foreach( const QString &extension, plugin->fileExtensions() ) {
+                info.fileExtensions << extension.toLower();
             }
-        } else {
-            mDebug() << "Plugin failure:" << fileName << "is not a valid Marble Plugin:"
-                     << loader->errorString();
+        }
+    } else {
+        mDebug() << "Plugin failure:" << info.path << "is not a valid Marble Plugin:"
+                 << loader->errorString();
+    }
+
+    m_cacheChanged = m_cacheChanged
+                     || info.type != cached.type
+                     || info.nameId != cached.nameId
+                     || info.capabilities != cached.capabilities
+                     || info.fileExtensions != cached.fileExtensions;
+}
+
+void PluginManagerPrivate::loadPlugins( PluginType type )
+{
+    if ( m_loadedTypes.contains( type ) )
+    {
+        return;
+    }
+
+    QTime t;
+    t.start();
+    mDebug() << "Starting to load Plugins.";
+
+    scanPlugins();
+
+    // Invalid plugins are retried once per session, they may just have
+    // missed a library that got installed in the meantime.
+    for ( int i = 0; i < m_pluginInfos.size(); ++i ) {
+        PluginInfo &info = m_pluginInfos[i];
+        if ( info.loaded ) {
+            continue;
+        }
+
+        if ( info.type == type && isDuplicate( info ) ) {
+            info.loaded = true;
+            continue;
+        }
+
+        if ( info.type == type || info.type == UnknownPlugin || info.type == InvalidPlugin ) {
+            loadPlugin( info );
         }
     }
 
-    m_pluginsLoaded = true;
+    m_loadedTypes << type;
+
+    if ( m_cacheChanged ) {
+        writeCache();
+    }
 
     mDebug() << Q_FUNC_INFO << "Time elapsed:" << t.elapsed() << "ms";
 }
 
+void PluginManagerPrivate::loadRunnerPlugins( int capabilities, const QString &fileExtension )
+{
+    if ( m_loadedTypes.contains( RunnerPluginType ) )
+    {
+        return;
+    }
+
+    scanPlugins();
+
+    for ( int i = 0; i < m_pluginInfos.size(); ++i ) {
+        PluginInfo &info = m_pluginInfos[i];
+        if ( info.loaded ) {
+            continue;
+        }
+
+        if ( info.type == RunnerPluginType && isDuplicate( info ) ) {
+            info.loaded = true;
+            continue;
+        }
+
+        const bool matches = info.type == RunnerPluginType && ( info.capabilities & capabilities )
+                             && ( fileExtension.isEmpty() || info.fileExtensions.isEmpty()
+                                  || info.fileExtensions.contains( fileExtension ) );
+        if ( matches || info.type == UnknownPlugin || info.type == InvalidPlugin ) {
+            loadPlugin( info );
+        }
+    }
+
+    if ( m_cacheChanged ) {
+        writeCache();
+    }
+}
+
 }
 
 #include "PluginManager.moc"
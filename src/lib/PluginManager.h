@@ -38,6 +38,12 @@ class RunnerPlugin;
  * the objects, the PluginManager internally has a list of the plugins
  * which are owned by the PluginManager and destroyed by it.
  *
+ * Plugins are only loaded once a plugin of their kind is requested. The
+ * kind of each plugin file is remembered in a cache, so that later sessions
+ * don't need to load plugins they won't use. Cache entries are invalidated
+ * when the size or the modification time of a plugin file changes. Files
+ * that failed to load are retried once per session, and of several plugins
+ * with the same name id only the first one is loaded.
  */
 
 class MARBLE_EXPORT PluginManager : public QObject
@@ -72,6 +78,21 @@ class MARBLE_EXPORT PluginManager : public QObject
      */
     QList<RunnerPlugin *> runnerPlugins() const;
 
+    /**
+     * Returns all runner plugins which support one of the given
+     * RunnerPlugin::Capability flags. Only these runner plugins are loaded.
+     * @note: Runner plugins are owned by the PluginManager, do not delete them
+     */
+    QList<RunnerPlugin *> runnerPlugins( int capabilities ) const;
+
+    /**
+     * Returns the parsing runner plugins for files with the given extension.
+     * If no plugin claims the extension, all parsing runner plugins are
+     * returned.
+     * @note: Runner plugins are owned by the PluginManager, do not delete them
+     */
+    QList<RunnerPlugin *> parsingRunnerPlugins( const QString &fileExtension ) const;
+
  private:
     Q_DISABLE_COPY( PluginManager )
 
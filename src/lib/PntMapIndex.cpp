@@ -0,0 +1,278 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "PntMapIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "GeoPolygon.h"
+#include "MarbleDebug.h"
+
+namespace Marble
+{
+
+// The maximum number of polygons in a leaf of the hierarchy.
+static const int LEAF_SIZE = 8;
+
+class BoundsCenterLessThan
+{
+ public:
+    BoundsCenterLessThan( const QVector<PntMapIndex::Bounds> &bounds, bool byLongitude )
+        : m_bounds( bounds ),
+          m_byLongitude( byLongitude )
+    {
+    }
+
+    bool operator()( int a, int b ) const
+    {
+        const PntMapIndex::Bounds &boundsA = m_bounds.at( a );
+        const PntMapIndex::Bounds &boundsB = m_bounds.at( b );
+
+        if ( m_byLongitude ) {
+            return boundsA.west + boundsA.east < boundsB.west + boundsB.east;
+        }
+
+        return boundsA.south + boundsA.north < boundsB.south + boundsB.north;
+    }
+
+ private:
+    const QVector<PntMapIndex::Bounds> &m_bounds;
+    bool m_byLongitude;
+};
+
+PntMapIndex::PntMapIndex( const PntMap *pntmap )
+{
+    m_bounds.reserve( pntmap->size() );
+    m_polygons.reserve( pntmap->size() );
+
+    for ( int i = 0; i < pntmap->size(); ++i ) {
+        const GeoPolygon *polygon = pntmap->at( i );
+        const GeoDataCoordinates::PtrVector boundary = polygon->getBoundary();
+
+        Bounds bounds;
+        bounds.west  = -M_PI;
+        bounds.south = -M_PI / 2.0;
+        bounds.east  = +M_PI;
+        bounds.north = +M_PI / 2.0;
+
+        if ( boundary.size() >= 3 ) {
+            qreal lonLeft, latTop, lonRight, latBottom;
+            boundary[1]->geoCoordinates( lonLeft, latTop );
+            boundary[2]->geoCoordinates( lonRight, latBottom );
+
+            bounds.south = qMin( latTop, latBottom );
+            bounds.north = qMax( latTop, latBottom );
+
+            // Polygons crossing the dateline cover the whole longitude range.
+            if ( polygon->getDateLine() == GeoPolygon::None ) {
+                bounds.west = qMin( lonLeft, lonRight );
+                bounds.east = qMax( lonLeft, lonRight );
+            }
+        }
+
+        if ( boundary.size() >= 5 ) {
+            for ( int j = 0; j < 5; ++j ) {
+                bounds.nodes << boundary[j]->quaternion();
+            }
+        }
+
+        m_bounds << bounds;
+        m_polygons << i;
+    }
+
+    if ( !m_polygons.isEmpty() ) {
+        build( 0, m_polygons.size() );
+    }
+}
+
+int PntMapIndex::polygonCount() const
+{
+    return m_bounds.size();
+}
+
+int PntMapIndex::build( int first, int count )
+{
+    Node node;
+    node.west  = +M_PI;
+    node.south = +M_PI / 2.0;
+    node.east  = -M_PI;
+    node.north = -M_PI / 2.0;
+    node.first = first;
+    node.count = count;
+    node.left  = -1;
+    node.right = -1;
+
+    qreal x = 0.0;
+    qreal y = 0.0;
+    qreal z = 0.0;
+    bool capKnown = true;
+
+    for ( int i = first; i < first + count; ++i ) {
+        const Bounds &bounds = m_bounds.at( m_polygons.at( i ) );
+        node.west  = qMin( node.west,  bounds.west );
+        node.south = qMin( node.south, bounds.south );
+        node.east  = qMax( node.east,  bounds.east );
+        node.north = qMax( node.north, bounds.north );
+
+        capKnown = capKnown && !bounds.nodes.isEmpty();
+        foreach ( const Quaternion &boundaryNode, bounds.nodes ) {
+            x += boundaryNode.v[Q_X];
+            y += boundaryNode.v[Q_Y];
+            z += boundaryNode.v[Q_Z];
+        }
+    }
+
+    // The cap is centered at the mean of all boundary nodes and reaches out
+    // to the one that is farthest away. Without boundary nodes it covers the
+    // whole sphere, and so it does if the nodes are spread all over it.
+    const qreal length = sqrt( x * x + y * y + z * z );
+    node.capAxis = Quaternion( 0.0, 0.0, 0.0, 1.0 );
+    node.capRadius = M_PI;
+
+    if ( capKnown && length > 0.001 ) {
+        node.capAxis = Quaternion( 0.0, x / length, y / length, z / length );
+        node.capRadius = 0.0;
+
+        for ( int i = first; i < first + count; ++i ) {
+            foreach ( const Quaternion &boundaryNode, m_bounds.at( m_polygons.at( i ) ).nodes ) {
+                const qreal cosine = node.capAxis.v[Q_X] * boundaryNode.v[Q_X]
+                                   + node.capAxis.v[Q_Y] * boundaryNode.v[Q_Y]
+                                   + node.capAxis.v[Q_Z] * boundaryNode.v[Q_Z];
+                const qreal angle = acos( qBound( qreal( -1.0 ), cosine, qreal( 1.0 ) ) );
+                node.capRadius = qMax( node.capRadius, angle );
+            }
+        }
+    }
+
+    const int index = m_nodes.size();
+    m_nodes << node;
+
+    if ( count > LEAF_SIZE ) {
+        // Split at the median of the polygon centers along the longer side.
+        const bool byLongitude = node.east - node.west > node.north - node.south;
+        int * const begin = m_polygons.data() + first;
+        std::nth_element( begin, begin + count / 2, begin + count,
+                          BoundsCenterLessThan( m_bounds, byLongitude ) );
+
+        const int left = build( first, count / 2 );
+        const int right = build( first + count / 2, count - count / 2 );
+        m_nodes[index].left = left;
+        m_nodes[index].right = right;
+    }
+
+    return index;
+}
+
+void PntMapIndex::collect( int node, QVector<int> &result ) const
+{
+    const Node &current = m_nodes.at( node );
+    for ( int i = current.first; i < current.first + current.count; ++i ) {
+        result << m_polygons.at( i );
+    }
+}
+
+void PntMapIndex::intersecting( qreal west, qreal south, qreal east, qreal north,
+                                QVector<int> &result ) const
+{
+    if ( m_nodes.isEmpty() ) {
+        return;
+    }
+
+    const int previousSize = result.size();
+
+    if ( east - west >= 2 * M_PI ) {
+        west = -M_PI;
+        east = +M_PI;
+    }
+
+    // Query each copy of the box that overlaps the longitude range.
+    for ( int k = -1; k <= 1; ++k ) {
+        const qreal copyWest = qMax<qreal>( west + k * 2 * M_PI, -M_PI );
+        const qreal copyEast = qMin<qreal>( east + k * 2 * M_PI, +M_PI );
+        if ( copyWest <= copyEast ) {
+            intersecting( 0, copyWest, south, copyEast, north, result );
+        }
+    }
+
+    finish( result, previousSize );
+}
+
+void PntMapIndex::intersecting( int node, qreal west, qreal south, qreal east, qreal north,
+                                QVector<int> &result ) const
+{
+    const Node &current = m_nodes.at( node );
+
+    if ( current.east < west || current.west > east
+         || current.north < south || current.south > north ) {
+        return;
+    }
+
+    if ( current.left == -1 ) {
+        for ( int i = current.first; i < current.first + current.count; ++i ) {
+            const Bounds &bounds = m_bounds.at( m_polygons.at( i ) );
+            if ( bounds.east >= west && bounds.west <= east
+                 && bounds.north >= south && bounds.south <= north ) {
+                result << m_polygons.at( i );
+            }
+        }
+        return;
+    }
+
+    intersecting( current.left, west, south, east, north, result );
+    intersecting( current.right, west, south, east, north, result );
+}
+
+void PntMapIndex::facing( const matrix &rotMatrix, qreal zLimit, QVector<int> &result ) const
+{
+    if ( m_nodes.isEmpty() ) {
+        return;
+    }
+
+    const int previousSize = result.size();
+    facing( 0, rotMatrix, zLimit, result );
+    finish( result, previousSize );
+}
+
+void PntMapIndex::facing( int node, const matrix &rotMatrix, qreal zLimit,
+                          QVector<int> &result ) const
+{
+    const Node &current = m_nodes.at( node );
+
+    if ( current.capRadius < M_PI ) {
+        Quaternion axis = current.capAxis;
+        axis.rotateAroundAxis( rotMatrix );
+
+        // The highest z value any point of the cap can reach.
+        const qreal axisAngle = acos( qBound( qreal( -1.0 ), axis.v[Q_Z], qreal( 1.0 ) ) );
+        const qreal zMaximum = cos( qMax( qreal( 0.0 ), axisAngle - current.capRadius ) );
+
+        if ( zMaximum + 1e-9 < zLimit ) {
+            return;
+        }
+    }
+
+    if ( current.left == -1 ) {
+        collect( node, result );
+        return;
+    }
+
+    facing( current.left, rotMatrix, zLimit, result );
+    facing( current.right, rotMatrix, zLimit, result );
+}
+
+void PntMapIndex::finish( QVector<int> &result, int previousSize )
+{
+    int * const begin = result.data() + previousSize;
+    int * const end = result.data() + result.size();
+
+    std::sort( begin, end );
+    result.resize( std::unique( begin, end ) - result.data() );
+}
+
+}
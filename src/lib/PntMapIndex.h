@@ -0,0 +1,99 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_PNTMAPINDEX_H
+#define MARBLE_PNTMAPINDEX_H
+
+#include <QtCore/QVector>
+
+#include "Quaternion.h"
+
+namespace Marble
+{
+
+class PntMap;
+
+/**
+ * @short A bounding volume hierarchy over the polygons of a PntMap.
+ *
+ * Each node of the hierarchy encloses the boundaries of the polygons
+ * below it, both as a longitude/latitude box for the flat projections and
+ * as a spherical cap for the globe. The queries are conservative: they
+ * return every polygon that might be visible, in ascending order so that
+ * the paint order doesn't change. The precise test is up to the caller.
+ */
+class PntMapIndex
+{
+ public:
+    explicit PntMapIndex( const PntMap *pntmap );
+
+    /**
+     * @brief The number of polygons the index was built for.
+     */
+    int polygonCount() const;
+
+    /**
+     * @brief Find the polygons whose bounding box intersects a box.
+     * The box is given in radian and may exceed the longitude range, in which
+     * case it gets wrapped around the dateline. The indices of the matching
+     * polygons are appended to @p result.
+     */
+    void intersecting( qreal west, qreal south, qreal east, qreal north,
+                       QVector<int> &result ) const;
+
+    /**
+     * @brief Find the polygons which might face the viewer.
+     * Appends the indices of all polygons which might have a boundary node
+     * with a z value above @p zLimit after the rotation by @p rotMatrix.
+     */
+    void facing( const matrix &rotMatrix, qreal zLimit, QVector<int> &result ) const;
+
+ private:
+    friend class BoundsCenterLessThan;
+
+    struct Bounds
+    {
+        qreal west;
+        qreal south;
+        qreal east;
+        qreal north;
+        // The boundary nodes as unit vectors, empty if unknown.
+        QVector<Quaternion> nodes;
+    };
+
+    struct Node
+    {
+        qreal west;
+        qreal south;
+        qreal east;
+        qreal north;
+        Quaternion capAxis;
+        qreal capRadius;
+        int first;
+        int count;
+        int left;
+        int right;
+    };
+
+    int build( int first, int count );
+    void collect( int node, QVector<int> &result ) const;
+    void intersecting( int node, qreal west, qreal south, qreal east, qreal north,
+                       QVector<int> &result ) const;
+    void facing( int node, const matrix &rotMatrix, qreal zLimit,
+                 QVector<int> &result ) const;
+
+    static void finish( QVector<int> &result, int previousSize );
+
+    QVector<Bounds> m_bounds;
+    QVector<int>    m_polygons;
+    QVector<Node>   m_nodes;
+};
+
+}
+
+#endif
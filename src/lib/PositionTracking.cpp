@@ -28,9 +28,84 @@
 #include "PositionTracking_p.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 
 using namespace Marble;
 
+// The number of positions the live track keeps at least. Older ones are
+// dropped in chunks once it grew a quarter beyond that.
+static const int maximumTrackSize = 20000;
+
+GeoDataPlacemark *PositionTrackingPrivate::trackPlacemark()
+{
+    return static_cast<GeoDataPlacemark*>(m_document->child(m_document->size()-1));
+}
+
+GeoDataMultiGeometry *PositionTrackingPrivate::trackGeometry()
+{
+    return static_cast<GeoDataMultiGeometry*>(trackPlacemark()->geometry());
+}
+
+void PositionTrackingPrivate::beginSegment()
+{
+    m_currentLineString = new GeoDataLineString;
+    trackGeometry()->append(m_currentLineString);
+    m_journal.beginSegment();
+}
+
+void PositionTrackingPrivate::trimTrack()
+{
+    if ( m_trackSize <= maximumTrackSize + maximumTrackSize / 4 ) {
+        return;
+    }
+
+    GeoDataMultiGeometry *multiGeometry = trackGeometry();
+    int excess = m_trackSize - maximumTrackSize;
+
+    // Drop whole line strings first, but never the current one.
+    int count = 0;
+    while ( count < multiGeometry->size() - 1 ) {
+        const int size = static_cast<GeoDataLineString*>(multiGeometry->child(count))->size();
+        if ( size > excess ) {
+            break;
+        }
+        excess -= size;
+        ++count;
+    }
+    multiGeometry->erase( multiGeometry->begin(), multiGeometry->begin() + count );
+
+    if ( excess > 0 ) {
+        GeoDataLineString *lineString = static_cast<GeoDataLineString*>(multiGeometry->child(0));
+        lineString->erase( lineString->begin(), lineString->begin() + excess );
+    }
+
+    m_trackSize = maximumTrackSize;
+    m_treeModel->updateFeature( trackPlacemark() );
+}
+
+void PositionTrackingPrivate::restoreTrack()
+{
+    const QVector<TrackJournal::Segment> segments = TrackJournal::tail( m_journal.segments(),
+                                                                        maximumTrackSize );
+
+    GeoDataMultiGeometry *multiGeometry = trackGeometry();
+    multiGeometry->clear();
+    m_trackSize = 0;
+
+    foreach ( const TrackJournal::Segment &segment, segments ) {
+        GeoDataLineString *lineString = new GeoDataLineString;
+        foreach ( const TrackJournal::Point &point, segment ) {
+            lineString->append( point.coordinates );
+        }
+        m_trackSize += lineString->size();
+        multiGeometry->append( lineString );
+    }
+
+    // New positions don't continue the restored track.
+    m_currentLineString = new GeoDataLineString;
+    multiGeometry->append( m_currentLineString );
+}
+
 void PositionTrackingPrivate::setPosition( GeoDataCoordinates position,
                                            GeoDataAccuracy accuracy )
 {
@@ -38,10 +113,13 @@ void PositionTrackingPrivate::setPosition( GeoDataCoordinates position,
     if ( m_positionProvider && m_positionProvider->status() ==
         PositionProviderStatusAvailable )
     {
-        GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(m_document->child(m_document->size()-1));
+        GeoDataPlacemark *placemark = 0;
 
         if ( accuracy.horizontal < 250 ) {
             m_currentLineString->append(position);
+            m_journal.append( position, QDateTime::currentDateTime().toUTC() );
+            ++m_trackSize;
+            trimTrack();
         }
 
         //if the position has moved then update the current position
@@ -61,17 +139,18 @@ void PositionTrackingPrivate::setStatus( PositionProviderStatus status )
 {
     if (status == PositionProviderStatusAvailable) {
         Q_ASSERT(m_document);
-        m_treeModel->removeDocument( m_document );
-        GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(m_document->child(m_document->size()-1));
-        GeoDataMultiGeometry *multiGeometry = static_cast<GeoDataMultiGeometry*>(placemark->geometry());
-        m_currentLineString = new GeoDataLineString;
-        multiGeometry->append(m_currentLineString);
-        m_treeModel->addDocument( m_document );
+        beginSegment();
+        m_treeModel->updateFeature( trackPlacemark() );
     }
 
     emit statusChanged( status );
 }
 
+void PositionTrackingPrivate::flushJournal()
+{
+    m_journal.flush();
+}
+
 PositionTracking::PositionTracking( GeoDataTreeModel *model )
      : QObject( model ), d (new PositionTrackingPrivate( model ))
 {
@@ -118,12 +197,19 @@ PositionTracking::PositionTracking( GeoDataTreeModel *model )
 
     placemark->setStyleUrl(QString("#").append(styleMap.styleId()));
 
+    // Positions in the journal were taken over from instances that crashed.
+    if ( d->m_journal.open() && d->m_journal.hasPoints() ) {
+        d->restoreTrack();
+    }
+    d->m_flushTimer.start();
+
     d->m_treeModel->addDocument(d->m_document);
 }
 
 
 PositionTracking::~PositionTracking()
 {
+    d->m_journal.remove();
     delete d;
 }
 
@@ -179,10 +265,9 @@ bool PositionTracking::trackVisible() const
 
 void PositionTracking::setTrackVisible( bool visible )
 {
-    d->m_treeModel->removeDocument(d->m_document);
-    GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(d->m_document->child(d->m_document->size()-1));
+    GeoDataPlacemark *placemark = d->trackPlacemark();
     placemark->setVisible( visible );
-    d->m_treeModel->addDocument(d->m_document);
+    d->m_treeModel->updateFeature( placemark );
 }
 
 bool PositionTracking::saveTrack(QString& fileName)
@@ -190,6 +275,18 @@ bool PositionTracking::saveTrack(QString& fileName)
 
     if ( !fileName.isEmpty() )
     {
+        QFileInfo fileInfo( fileName );
+        QString name = fileInfo.baseName();
+
+        if ( fileName.endsWith(".gpx", Qt::CaseInsensitive) )
+        {
+            QFile file( fileName );
+            if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+                return false;
+            }
+            return d->m_journal.writeGpx( &file, "Track " + name );
+        }
+
         if ( !fileName.endsWith(".kml", Qt::CaseInsensitive) )
         {
             fileName.append( ".kml" );
@@ -200,8 +297,6 @@ bool PositionTracking::saveTrack(QString& fileName)
         writer.setDocumentType( kml::kmlTag_nameSpace22 );
 
         GeoDataDocument *document = new GeoDataDocument;
-        QFileInfo fileInfo( fileName );
-        QString name = fileInfo.baseName();
         document->setName( name );
         foreach( GeoDataStyle style, d->m_document->styles() ) {
             document->addStyle( style );
@@ -209,12 +304,24 @@ bool PositionTracking::saveTrack(QString& fileName)
         foreach( GeoDataStyleMap map, d->m_document->styleMaps() ) {
             document->addStyleMap( map );
         }
-        GeoDataFeature *track = new GeoDataFeature(d->m_document->last());
+
+        // The live track may have been trimmed, the journal has all of it.
+        GeoDataMultiGeometry *multiGeometry = new GeoDataMultiGeometry;
+        foreach ( const TrackJournal::Segment &segment, d->m_journal.segments() ) {
+            GeoDataLineString *lineString = new GeoDataLineString;
+            foreach ( const TrackJournal::Point &point, segment ) {
+                lineString->append( point.coordinates );
+            }
+            multiGeometry->append( lineString );
+        }
+
+        GeoDataPlacemark *track = new GeoDataPlacemark( *d->trackPlacemark() );
+        track->setGeometry( multiGeometry );
         track->setName( "Track " + name );
         document->append( track );
 
         QFile file( fileName );
-        file.open( QIODevice::ReadWrite );
+        file.open( QIODevice::WriteOnly | QIODevice::Truncate );
         bool const result = writer.write( &file, document );
         delete document;
         return result;
@@ -224,13 +331,12 @@ bool PositionTracking::saveTrack(QString& fileName)
 
 void PositionTracking::clearTrack()
 {
-    GeoDataPlacemark *placemark = static_cast<GeoDataPlacemark*>(d->m_document->child(d->m_document->size()-1));
-    GeoDataMultiGeometry *multiGeometry = static_cast<GeoDataMultiGeometry*>(placemark->geometry());
-    d->m_currentLineString = new GeoDataLineString;
-    d->m_treeModel->removeDocument( d->m_document );
+    GeoDataMultiGeometry *multiGeometry = d->trackGeometry();
     multiGeometry->clear();
-    multiGeometry->append(d->m_currentLineString);
-    d->m_treeModel->addDocument( d->m_document );
+    d->m_trackSize = 0;
+    d->m_journal.clear();
+    d->beginSegment();
+    d->m_treeModel->updateFeature( d->trackPlacemark() );
 }
 
 bool PositionTracking::isTrackEmpty() const
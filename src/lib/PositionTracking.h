@@ -86,7 +86,8 @@ public Q_SLOTS:
     void setTrackVisible ( bool visible );
 
     /**
-      * Saves the track document to file
+      * Saves the whole recorded track to file. A file name ending in .gpx
+      * saves it as GPX, otherwise it gets saved as KML.
       */
     bool saveTrack( QString& fileName );
 
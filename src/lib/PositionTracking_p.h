@@ -23,7 +23,11 @@
 #include "MarbleModel.h"
 #include "MarbleMath.h"
 #include "MarbleDebug.h"
+#include "MarbleDirs.h"
 #include "PositionProviderPlugin.h"
+#include "TrackJournal.h"
+
+#include <QtCore/QTimer>
 
 namespace Marble
 {
@@ -35,16 +39,44 @@ class PositionTrackingPrivate : public QObject
         : QObject( model ),
         m_document( 0 ),
         m_treeModel( model ),
-        m_positionProvider( 0 )
+        m_trackSize( 0 ),
+        m_positionProvider( 0 ),
+        m_journal( MarbleDirs::localPath() + "/tracking" )
     {
+        m_flushTimer.setInterval( 5000 );
+        connect( &m_flushTimer, SIGNAL( timeout() ), this, SLOT( flushJournal() ) );
     }
 
+    GeoDataPlacemark *trackPlacemark();
+
+    GeoDataMultiGeometry *trackGeometry();
+
+    /**
+     * Starts a new line string in the live track and a new segment in
+     * the journal.
+     */
+    void beginSegment();
+
+    /**
+     * Drops the oldest positions from the live track once it grew too
+     * large. The journal still contains the whole track.
+     */
+    void trimTrack();
+
+    /**
+     * Restores the tail of a track that was left in the journal because
+     * the application didn't shut down properly.
+     */
+    void restoreTrack();
+
     public Q_SLOTS:
     void setPosition( GeoDataCoordinates position,
                       GeoDataAccuracy accuracy );
 
     void setStatus( PositionProviderStatus status );
 
+    void flushJournal();
+
     Q_SIGNALS:
     void  gpsLocation( GeoDataCoordinates, qreal );
 
@@ -57,10 +89,14 @@ class PositionTrackingPrivate : public QObject
     GeoDataCoordinates  m_gpsCurrentPosition;
     GeoDataCoordinates  m_gpsPreviousPosition;
     GeoDataLineString  *m_currentLineString;
+    int                 m_trackSize;
 
     PositionProviderPlugin* m_positionProvider;
 
     GeoDataAccuracy m_accuracy;
+
+    TrackJournal m_journal;
+    QTimer       m_flushTimer;
 };
 }
 
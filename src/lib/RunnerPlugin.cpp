@@ -8,6 +8,8 @@ class RunnerPluginPrivate
 public:
     RunnerPlugin::Capabilities m_capabilities;
 
+    QStringList m_fileExtensions;
+
     QStringList m_supportedCelestialBodies;
 
     bool m_canWorkOffline;
@@ -62,6 +64,16 @@ void RunnerPlugin::setCapabilities( Capabilities capabilities )
     d->m_capabilities = capabilities;
 }
 
+QStringList RunnerPlugin::fileExtensions() const
+{
+    return d->m_fileExtensions;
+}
+
+void RunnerPlugin::setFileExtensions( const QStringList &extensions )
+{
+    d->m_fileExtensions = extensions;
+}
+
 QString RunnerPlugin::name() const
 {
     return d->m_name;
@@ -60,6 +60,11 @@ public:
     /** Convenience method to determine whether the plugin support the given capability */
     bool supports(Capability capability) const;
 
+    /** Lower-case extensions of the files the plugin can parse, e.g. "kml".
+      * An empty list means the plugin tries to parse any file.
+      */
+    QStringList fileExtensions() const;
+
     /** True if the plugin supports its tasks on the given planet */
     bool supportsCelestialBody( const QString &celestialBodyId ) const;
 
@@ -115,6 +120,8 @@ protected:
     // Convenience methods for plugins to use
     void setCapabilities(Capabilities capabilities);
 
+    void setFileExtensions( const QStringList &extensions );
+
     void setSupportedCelestialBodies( const QStringList &celestialBodies );
 
     void setCanWorkOffline( bool canWorkOffline );
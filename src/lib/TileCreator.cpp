@@ -13,11 +13,16 @@
 #include "TileCreator.h"
 
 #include <cmath>
+#include <cstring>
 
 #include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QPoint>
 #include <QtCore/QRect>
 #include <QtCore/QSize>
+#include <QtCore/QTime>
 #include <QtCore/QVector>
+#include <QtCore/QtConcurrentMap>
 #include <QtGui/QApplication>
 #include <QtGui/QImage>
 #include <QtGui/QImageReader>
@@ -38,11 +43,15 @@ class TileCreatorPrivate
                         const QString& dem, const QString& targetDir=QString() )
        : m_dem( dem ),
          m_targetDir( targetDir ),
-         m_cancelled( false ),
          m_tileFormat( "jpg" ),
          m_resume( false ),
          m_verify( false ),
-         m_source( source )
+         m_source( source ),
+         m_maxTileLevel( 0 ),
+         m_totalTileCount( 0 ),
+         m_percentCompleted( 0 ),
+         m_cancelled( 0 ),
+         m_failed( 0 )
      {
         if ( m_dem == "true" ) {
             m_tileQuality = 70;
@@ -56,18 +65,291 @@ class TileCreatorPrivate
         delete m_source;
     }
 
+    QString tileName( int level, int n, int m ) const;
+
+    QVector<QPoint> tilesOfLevel( int level ) const;
+
+    /**
+     * Crops all tiles of the given row from the source and saves them at
+     * the highest tile level.
+     */
+    void sliceBand( int n );
+
+    /**
+     * Builds a tile from the four tiles of the next higher level it covers.
+     */
+    void mergeTile( int level, int n, int m );
+
+    /**
+     * Saves a tile again with the final jpeg quality.
+     */
+    void reencodeTile( int level, int n, int m );
+
+    void saveTile( const QImage &tile, const QString &tileName, int quality );
+
+    void reportThroughput( int level, int elapsed ) const;
+
  public:
     QString  m_dem;
     QString  m_targetDir;
-    bool     m_cancelled;
     QString  m_tileFormat;
     int      m_tileQuality;
     bool     m_resume;
     bool     m_verify;
 
     TileCreatorSource  *m_source;
+
+    // Custom sources need not be thread-safe
+    QMutex   m_sourceMutex;
+
+    QVector<QRgb> m_grayScalePalette;
+    int      m_maxTileLevel;
+    int      m_totalTileCount;
+    int      m_percentCompleted;
+
+    // Updated by the workers, and the flags also by cancelTileCreation()
+    QAtomicInt m_cancelled;
+    QAtomicInt m_failed;
+    QAtomicInt m_createdTiles;
+    QAtomicInt m_savedTiles;
 };
 
+/**
+ * The work on a single tile, or a band of them, for QtConcurrent::map.
+ * Tiles are given as QPoint( m, n ).
+ */
+class TileCreatorTask
+{
+ public:
+    enum Kind {
+        Slice,
+        Merge,
+        Reencode
+    };
+
+    typedef void result_type;
+
+    TileCreatorTask( TileCreatorPrivate *d, Kind kind, int level )
+        : d( d ),
+          m_kind( kind ),
+          m_level( level )
+    {
+    }
+
+    void operator()( const QPoint &tile ) const
+    {
+        if ( d->m_cancelled || d->m_failed )
+            return;
+
+        switch ( m_kind ) {
+        case Slice:
+            d->sliceBand( tile.y() );
+            break;
+        case Merge:
+            d->mergeTile( m_level, tile.y(), tile.x() );
+            break;
+        case Reencode:
+            d->reencodeTile( m_level, tile.y(), tile.x() );
+            break;
+        }
+    }
+
+ private:
+    TileCreatorPrivate *d;
+    Kind m_kind;
+    int m_level;
+};
+
+/**
+ * Fills @p tile from the four quadrants, taking every other pixel of each.
+ */
+template<typename Pixel>
+static void downsample( QImage &tile, const QImage *quadrants[4] )
+{
+    const uint half = c_defaultTileSize / 2;
+
+    for ( int q = 0; q < 4; ++q ) {
+        const uint xOffset = ( q % 2 ) ? half : 0;
+        const uint yOffset = ( q / 2 ) ? half : 0;
+        const uint xEnd = xOffset ? c_defaultTileSize : half;
+        const uint yEnd = yOffset ? c_defaultTileSize : half;
+
+        for ( uint y = yOffset; y < yEnd; ++y ) {
+            Pixel *destLine = (Pixel*) tile.scanLine( y );
+            const Pixel *srcLine = (const Pixel*) quadrants[q]->scanLine( 2 * ( y - yOffset ) );
+            for ( uint x = xOffset; x < xEnd; ++x )
+                destLine[x] = srcLine[ 2 * ( x - xOffset ) ];
+        }
+    }
+}
+
+QString TileCreatorPrivate::tileName( int level, int n, int m ) const
+{
+    return m_targetDir + ( QString("%1/%2/%2_%3.%4")
+                           .arg( level )
+                           .arg( n, tileDigits, 10, QChar('0') )
+                           .arg( m, tileDigits, 10, QChar('0') ) )
+                           .arg( m_tileFormat );
+}
+
+QVector<QPoint> TileCreatorPrivate::tilesOfLevel( int level ) const
+{
+    QVector<QPoint> result;
+    const int nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, level );
+    const int mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, level );
+    for ( int n = 0; n < nmax; ++n ) {
+        for ( int m = 0; m < mmax; ++m ) {
+            result << QPoint( m, n );
+        }
+    }
+    return result;
+}
+
+void TileCreatorPrivate::sliceBand( int n )
+{
+    const int mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, m_maxTileLevel );
+
+    // The whole band is read at once, as sources like the one for images
+    // prepare the current row of tiles once and crop all tiles from it.
+    QVector<QImage> tiles( mmax );
+    {
+        QMutexLocker locker( &m_sourceMutex );
+        for ( int m = 0; m < mmax; ++m ) {
+            if ( m_cancelled )
+                return;
+
+            if ( m_resume && QFile::exists( tileName( m_maxTileLevel, n, m ) ) )
+                continue;
+
+            tiles[m] = m_source->tile( n, m, m_maxTileLevel );
+            if ( tiles.at( m ).isNull() ) {
+                mDebug() << "Read-Error! Null QImage!";
+                m_failed.fetchAndStoreOrdered( 1 );
+                return;
+            }
+        }
+    }
+
+    for ( int m = 0; m < mmax; ++m ) {
+        if ( m_cancelled )
+            return;
+
+        QImage tile = tiles.at( m );
+        tiles[m] = QImage();
+        if ( !tile.isNull() ) {
+            if ( m_dem == "true" ) {
+                tile = tile.convertToFormat(QImage::Format_Indexed8,
+                                            m_grayScalePalette,
+                                            Qt::ThresholdDither);
+            }
+
+            saveTile( tile, tileName( m_maxTileLevel, n, m ), m_tileFormat == "jpg" ? 100 : m_tileQuality );
+        }
+
+        m_createdTiles.ref();
+    }
+}
+
+void TileCreatorPrivate::mergeTile( int level, int n, int m )
+{
+    const QString newTileName = tileName( level, n, m );
+
+    if ( m_resume && QFile::exists( newTileName ) ) {
+        m_createdTiles.ref();
+        return;
+    }
+
+    QImage  img_topleft( tileName( level + 1, 2*n, 2*m ) );
+    Q_ASSERT( img_topleft.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
+    QImage  img_topright( tileName( level + 1, 2*n, 2*m+1 ) );
+    Q_ASSERT( img_topright.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
+    QImage  img_bottomleft( tileName( level + 1, 2*n+1, 2*m ) );
+    Q_ASSERT( img_bottomleft.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
+    QImage  img_bottomright( tileName( level + 1, 2*n+1, 2*m+1 ) );
+    Q_ASSERT( img_bottomright.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
+
+    QImage  tile;
+
+    if ( m_dem == "true" ) {
+        tile = img_topleft;
+        tile.setColorTable( m_grayScalePalette );
+
+        const QImage *quadrants[4] = { &img_topleft, &img_topright, &img_bottomleft, &img_bottomright };
+        downsample<uchar>( tile, quadrants );
+    }
+    else {
+
+        // tile.depth() != 8
+
+        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
+        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
+        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
+        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
+        tile = img_topleft;
+
+        const QImage *quadrants[4] = { &img_topleft, &img_topright, &img_bottomleft, &img_bottomright };
+        downsample<QRgb>( tile, quadrants );
+    }
+
+    // Saving at 100% JPEG quality to have a high-quality
+    // version to create the remaining needed tiles from.
+    saveTile( tile, newTileName, m_tileFormat == "jpg" ? 100 : m_tileQuality );
+    m_createdTiles.ref();
+}
+
+void TileCreatorPrivate::reencodeTile( int level, int n, int m )
+{
+    const QString name = tileName( level, n, m );
+    QImage tile( name );
+
+    bool ok = tile.save( name, m_tileFormat.toAscii().data(), m_tileQuality );
+    if ( !ok )
+        mDebug() << "Error while writing Tile: " << name;
+
+    m_savedTiles.ref();
+}
+
+void TileCreatorPrivate::saveTile( const QImage &tile, const QString &name, int quality )
+{
+    bool  ok = tile.save( name, m_tileFormat.toAscii().data(), quality );
+    if ( !ok )
+        mDebug() << "Error while writing Tile: " << name;
+
+    if ( !m_verify )
+        return;
+
+    // Comparing whole scan lines, and single pixels only to report differences
+    const QImage expected = tile.convertToFormat( QImage::Format_ARGB32 );
+    const QImage writtenTile = QImage( name ).convertToFormat( QImage::Format_ARGB32 );
+    Q_ASSERT( writtenTile.size() == tile.size() );
+    for ( int j = 0; j < writtenTile.height(); ++j ) {
+        if ( memcmp( writtenTile.scanLine( j ), expected.scanLine( j ), writtenTile.width() * sizeof( QRgb ) ) == 0 )
+            continue;
+
+        for ( int i = 0; i < writtenTile.width(); ++i ) {
+            if ( writtenTile.pixel( i, j ) != expected.pixel( i, j ) ) {
+                unsigned int  pixel = expected.pixel( i, j );
+                unsigned int  writtenPixel = writtenTile.pixel( i, j );
+                qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
+                QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
+                qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
+                QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
+                qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
+                Q_ASSERT(false);
+            }
+        }
+    }
+}
+
+void TileCreatorPrivate::reportThroughput( int level, int elapsed ) const
+{
+    const int count = TileLoaderHelper::levelToRow( defaultLevelZeroRows, level )
+                      * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, level );
+    mDebug() << QString( "tileLevel: %1 successfully created, %2 tiles in %3 s, %4 tiles per second" )
+                .arg( level ).arg( count ).arg( elapsed / 1000.0, 0, 'f', 1 )
+                .arg( 1000.0 * count / qMax( 1, elapsed ), 0, 'f', 1 );
+}
+
 class TileCreatorSourceImage : public TileCreatorSource
 {
 public:
@@ -207,7 +489,7 @@ TileCreator::~TileCreator()
 
 void TileCreator::cancelTileCreation()
 {
-    d->m_cancelled = true;
+    d->m_cancelled.fetchAndStoreOrdered( 1 );
 }
 
 void TileCreator::run()
@@ -222,9 +504,9 @@ void TileCreator::run()
 
     mDebug() << "Installing tiles to: " << d->m_targetDir;
 
-    QVector<QRgb> grayScalePalette;
+    d->m_grayScalePalette.clear();
     for ( int cnt = 0; cnt <= 255; ++cnt ) {
-        grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
+        d->m_grayScalePalette.insert(cnt, qRgb(cnt, cnt, cnt));
     }
 
     QSize fullImageSize = d->m_source->fullImageSize();
@@ -253,324 +535,115 @@ void TileCreator::run()
         .arg( maxTileLevel );
     }
     mDebug() << "Maximum Tile Level: " << maxTileLevel;
-
-
-    if ( !QDir( d->m_targetDir ).exists() )
-        ( QDir::root() ).mkpath( d->m_targetDir );
+    d->m_maxTileLevel = maxTileLevel;
 
     // Counting total amount of tiles to be generated for the progressbar
-    // to prevent compiler warnings this var should
-    // match the type of maxTileLevel
-    int  tileLevel      = 0;
-    int  totalTileCount = 0;
-
-    while ( tileLevel <= maxTileLevel ) {
-        totalTileCount += ( TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel )
-                            * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel ) );
-        tileLevel++;
+    // and creating the directory structure up front, so that the workers
+    // below only need to write files.
+    d->m_totalTileCount = 0;
+    for ( int tileLevel = 0; tileLevel <= maxTileLevel; ++tileLevel ) {
+        const int nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+        d->m_totalTileCount += nmax * TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
+
+        for ( int n = 0; n < nmax; ++n ) {
+            QString dirName( d->m_targetDir
+                             + QString("%1/%2").arg(tileLevel).arg( n, tileDigits, 10, QChar('0') ) );
+            if ( !QDir( dirName ).exists() )
+                ( QDir::root() ).mkpath( dirName );
+        }
     }
 
-    mDebug() << totalTileCount << " tiles to be created in total.";
+    mDebug() << d->m_totalTileCount << " tiles to be created in total.";
 
-    int  mmax = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, maxTileLevel );
-    int  nmax = TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel );
+    d->m_createdTiles = 0;
+    d->m_savedTiles = 0;
+    d->m_failed = 0;
+    d->m_percentCompleted = -1;
 
-    // Loading each row at highest spatial resolution and cropping tiles
-    int      percentCompleted = 0;
-    int      createdTilesCount = 0;
-    QString  tileName;
+    QTime totalTime;
+    totalTime.start();
+    QTime levelTime;
+    levelTime.start();
 
-    // Creating directory structure for the highest level
-    QString  dirName( d->m_targetDir
-                      + QString("%1").arg(maxTileLevel) );
-    if ( !QDir( dirName ).exists() ) 
-        ( QDir::root() ).mkpath( dirName );
-
-    for ( int n = 0; n < nmax; ++n ) {
-        QString dirName( d->m_targetDir
-                         + QString("%1/%2").arg(maxTileLevel).arg( n, tileDigits, 10, QChar('0') ) );
-        if ( !QDir( dirName ).exists() ) 
-            ( QDir::root() ).mkpath( dirName );
+    // Slicing the source image into tiles at the highest resolution, one
+    // band of tiles per worker
+    QVector<QPoint> bands;
+    for ( int n = 0; n < TileLoaderHelper::levelToRow( defaultLevelZeroRows, maxTileLevel ); ++n ) {
+        bands << QPoint( 0, n );
     }
+    waitForFinished( QtConcurrent::map( bands, TileCreatorTask( d, TileCreatorTask::Slice, maxTileLevel ) ) );
+    if ( d->m_cancelled || d->m_failed )
+        return;
 
-    for ( int n = 0; n < nmax; ++n ) {
-
-        for ( int m = 0; m < mmax; ++m ) {
-
-            mDebug() << "** tile" << m << "x" << n;
-
-            if ( d->m_cancelled ) 
-                return;
-
-            tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                       .arg( maxTileLevel )
-                                       .arg( n, tileDigits, 10, QChar('0') )
-                                       .arg( m, tileDigits, 10, QChar('0') ) )
-                                       .arg( d->m_tileFormat );
-
-            if ( QFile::exists( tileName ) && d->m_resume ) {
-
-                //mDebug() << tileName << "exists already";
-
-            } else {
-
-                QImage tile = d->m_source->tile( n, m, maxTileLevel );
-
-                if ( tile.isNull() ) {
-                    mDebug() << "Read-Error! Null QImage!";
-                    return;
-                }
-
-                if ( d->m_dem == "true" ) {
-                    tile = tile.convertToFormat(QImage::Format_Indexed8,
-                                                grayScalePalette,
-                                                Qt::ThresholdDither);
-                }
-
-                bool  ok = tile.save( tileName, d->m_tileFormat.toAscii().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                if ( !ok )
-                    mDebug() << "Error while writing Tile: " << tileName;
-
-                mDebug() << tileName << "size" << QFile( tileName ).size();
-
-                if ( d->m_verify ) {
-                    QImage writtenTile(tileName);
-                    Q_ASSERT( writtenTile.size() == tile.size() );
-                    for ( int i=0; i < writtenTile.size().width(); ++i) {
-                        for ( int j=0; j < writtenTile.size().height(); ++j) {
-                            if ( writtenTile.pixel( i, j ) != tile.pixel( i, j ) ) {
-                                unsigned int  pixel = tile.pixel( i, j);
-                                unsigned int  writtenPixel = writtenTile.pixel( i, j);
-                                qWarning() << "***** pixel" << i << j << "is off by" << (pixel - writtenPixel) << "pixel" << pixel << "writtenPixel" << writtenPixel;
-                                QByteArray baPixel((char*)&pixel, sizeof(unsigned int));
-                                qWarning() << "pixel" << baPixel.size() << "0x" << baPixel.toHex();
-                                QByteArray baWrittenPixel((char*)&writtenPixel, sizeof(unsigned int));
-                                qWarning() << "writtenPixel" << baWrittenPixel.size() << "0x" << baWrittenPixel.toHex();
-                                Q_ASSERT(false);
-                            }
-                        }
-                    }
-                }
+    d->reportThroughput( maxTileLevel, levelTime.restart() );
 
-            }
+    // Now that we have the tiles at the highest resolution lets build
+    // them together four by four, each level in parallel once the level
+    // below is complete.
+    //
+    // Jpeg tiles are written at 100% quality to have a high-quality version
+    // to create the remaining needed tiles from. Each level gets saved with
+    // the final quality as soon as the next lower resolution is built from
+    // it, while the one after that is being built.
+    const bool reencode = d->m_tileFormat == "jpg" && d->m_tileQuality != 100;
+    QVector<QPoint> reencodedTiles;
+    QFuture<void> reencoding;
+
+    for ( int tileLevel = maxTileLevel - 1; tileLevel >= 0; --tileLevel ) {
+        QVector<QPoint> tiles = d->tilesOfLevel( tileLevel );
+        waitForFinished( QtConcurrent::map( tiles, TileCreatorTask( d, TileCreatorTask::Merge, tileLevel ) ) );
+        if ( d->m_cancelled ) {
+            reencoding.waitForFinished();
+            return;
+        }
 
-            percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount) 
-                                        / (qreal)(totalTileCount) );	
-            createdTilesCount++;
+        d->reportThroughput( tileLevel, levelTime.restart() );
 
-            mDebug() << "percentCompleted" << percentCompleted;
-            emit progress( percentCompleted );
+        if ( reencode ) {
+            waitForFinished( reencoding );
+            reencodedTiles = d->tilesOfLevel( tileLevel + 1 );
+            reencoding = QtConcurrent::map( reencodedTiles, TileCreatorTask( d, TileCreatorTask::Reencode, tileLevel + 1 ) );
         }
     }
+    mDebug() << "Tile creation completed.";
 
-    mDebug() << "tileLevel: " << maxTileLevel << " successfully created.";
-
-    tileLevel = maxTileLevel;
-
-    // Now that we have the tiles at the highest resolution lets build
-    // them together four by four.
-
-    while( tileLevel > 0 ) {
-        tileLevel--;
+    if ( reencode ) {
+        waitForFinished( reencoding );
+        reencodedTiles = d->tilesOfLevel( 0 );
+        waitForFinished( QtConcurrent::map( reencodedTiles, TileCreatorTask( d, TileCreatorTask::Reencode, 0 ) ) );
+        if ( d->m_cancelled )
+            return;
+    }
 
-        int  nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
+    const int elapsed = totalTime.elapsed();
+    mDebug() << QString( "Created %1 tiles in %2 s, %3 tiles per second" )
+                .arg( d->m_totalTileCount ).arg( elapsed / 1000.0, 0, 'f', 1 )
+                .arg( 1000.0 * d->m_totalTileCount / qMax( 1, elapsed ), 0, 'f', 1 );
 
-        for ( int n = 0; n < nmaxit; ++n ) {
-            QString  dirName( d->m_targetDir
-                              + ( QString("%1/%2")
-                                  .arg(tileLevel)
-                                  .arg( n, tileDigits, 10, QChar('0') ) ) );
+    d->m_percentCompleted = 100;
+    emit progress( d->m_percentCompleted );
 
-            // mDebug() << "dirName: " << dirName;
-            if ( !QDir( dirName ).exists() ) 
-                ( QDir::root() ).mkpath( dirName );
+    mDebug() << "percentCompleted: " << d->m_percentCompleted;
+}
 
-            int   mmaxit = TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
-            for ( int m = 0; m < mmaxit; ++m ) {
-
-                if ( d->m_cancelled )
-                    return;
-
-                QString newTileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                           .arg( tileLevel )
-                                           .arg( n, tileDigits, 10, QChar('0') )
-                                           .arg( m, tileDigits, 10, QChar('0') ) )
-                                           .arg( d->m_tileFormat );
-
-                if ( QFile::exists( newTileName ) && d->m_resume ) {
-                    //mDebug() << newTileName << "exists already";
-                } else {
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topleft( tileName );
-                    Q_ASSERT( img_topleft.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_topright( tileName );
-                    Q_ASSERT( img_topright.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomleft( tileName );
-                    Q_ASSERT( img_bottomleft.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel + 1 )
-                                            .arg( 2*n+1, tileDigits, 10, QChar('0') )
-                                            .arg( 2*m+1, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage  img_bottomright( tileName );
-                    Q_ASSERT( img_bottomright.size() == QSize( c_defaultTileSize, c_defaultTileSize ) );
-
-                    QImage  tile = img_topleft;
-
-                    if ( d->m_dem == "true" ) {
-
-                        tile.setColorTable( grayScalePalette );
-                        uchar* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2*x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomleft.scanLine( 2 * ( y - c_defaultTileSize / 2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[ x ] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = tile.scanLine( y );
-                            const uchar* srcLine = img_bottomright.scanLine( 2 * ( y - c_defaultTileSize/2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                    }
-                    else {
-
-                        // tile.depth() != 8
-
-                        img_topleft = img_topleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_topright = img_topright.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomleft = img_bottomleft.convertToFormat( QImage::Format_ARGB32 );
-                        img_bottomright = img_bottomright.convertToFormat( QImage::Format_ARGB32 );
-                        tile = img_topleft;
-
-                        QRgb* destLine;
-
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topleft.scanLine( 2 * y );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = 0; y < c_defaultTileSize / 2; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_topright.scanLine( 2 * y );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2 * ( x - c_defaultTileSize / 2 ) ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomleft.scanLine( 2 * ( y-c_defaultTileSize/2 ) );
-                            for ( uint x = 0; x < c_defaultTileSize / 2; ++x )
-                                destLine[x] = srcLine[ 2 * x ];
-                        }
-                        for ( uint y = c_defaultTileSize / 2; y < c_defaultTileSize; ++y ) {
-                            destLine = (QRgb*) tile.scanLine( y );
-                            const QRgb* srcLine = (QRgb*) img_bottomright.scanLine( 2 * ( y-c_defaultTileSize / 2 ) );
-                            for ( uint x = c_defaultTileSize / 2; x < c_defaultTileSize; ++x )
-                                destLine[x] = srcLine[ 2*( x-c_defaultTileSize / 2 ) ];
-                        }
-                    }
-
-                    mDebug() << newTileName;
-
-                    // Saving at 100% JPEG quality to have a high-quality
-                    // version to create the remaining needed tiles from.
-                    bool  ok = tile.save( newTileName, d->m_tileFormat.toAscii().data(), d->m_tileFormat == "jpg" ? 100 : d->m_tileQuality );
-                    if ( ! ok )
-                        mDebug() << "Error while writing Tile: " << newTileName;
-                }
-
-                percentCompleted =  (int) ( 90 * (qreal)(createdTilesCount)
-                                            / (qreal)(totalTileCount) );	
-                createdTilesCount++;
-						
-                emit progress( percentCompleted );
-                mDebug() << "percentCompleted" << percentCompleted;
-            }
-        }
-        mDebug() << "tileLevel: " << tileLevel << " successfully created.";
+void TileCreator::waitForFinished( const QFuture<void> &future )
+{
+    while ( !future.isFinished() ) {
+        msleep( 100 );
+        reportProgress();
     }
-    mDebug() << "Tile creation completed.";
+    reportProgress();
+}
 
-    if ( d->m_tileFormat == "jpg" && d->m_tileQuality != 100 ) {
-
-        // Applying correct lower JPEG compression now that we created all tiles
-        int savedTilesCount = 0;
-
-        tileLevel = 0;
-        while ( tileLevel <= maxTileLevel ) {
-            int nmaxit =  TileLoaderHelper::levelToRow( defaultLevelZeroRows, tileLevel );
-            for ( int n = 0; n < nmaxit; ++n) {
-                int mmaxit =  TileLoaderHelper::levelToColumn( defaultLevelZeroColumns, tileLevel );
-                for ( int m = 0; m < mmaxit; ++m) {
-
-                    if ( d->m_cancelled )
-                        return;
-
-                    savedTilesCount++;
-
-                    tileName = d->m_targetDir + ( QString("%1/%2/%2_%3.%4")
-                                            .arg( tileLevel )
-                                            .arg( n, tileDigits, 10, QChar('0') )
-                                            .arg( m, tileDigits, 10, QChar('0') ) )
-                                            .arg( d->m_tileFormat );
-                    QImage tile( tileName );
-
-                    bool ok;
-
-                    ok = tile.save( tileName, d->m_tileFormat.toAscii().data(), d->m_tileQuality );
-
-                    if ( !ok )
-                        mDebug() << "Error while writing Tile: " << tileName;
-                    // Don't exceed 99% as this would cancel the thread unexpectedly
-                    percentCompleted = 90 + (int)( 9 * (qreal)(savedTilesCount)
-                                                / (qreal)(totalTileCount) );
-                    emit progress( percentCompleted );
-                    mDebug() << "percentCompleted" << percentCompleted;
-                    //mDebug() << "Saving Tile #" << savedTilesCount
-                    //         << " of " << totalTileCount
-                    //         << " Percent: " << percentCompleted;
-                }
-            }
-            tileLevel++;
-        }
+void TileCreator::reportProgress()
+{
+    // Don't exceed 99% before the end as this would cancel the thread unexpectedly
+    const qreal total = qMax( 1, d->m_totalTileCount );
+    const int percentCompleted = qMin( 99, int( 90 * ( d->m_createdTiles / total ) + 9 * ( d->m_savedTiles / total ) ) );
+    if ( percentCompleted != d->m_percentCompleted ) {
+        d->m_percentCompleted = percentCompleted;
+        emit progress( percentCompleted );
     }
-
-    percentCompleted = 100;
-    emit progress( percentCompleted );
-
-    mDebug() << "percentCompleted: " << percentCompleted;
 }
 
 void TileCreator::setTileFormat(const QString& format)
@@ -20,6 +20,8 @@
 
 #include "marble_export.h"
 
+template <typename T> class QFuture;
+
 namespace Marble
 {
 
@@ -50,6 +52,14 @@ public:
     virtual QImage tile( int n, int m, int tileLevel ) = 0;
 };
 
+/**
+ * Creates the tiles of a map theme from a source image.
+ *
+ * The tiles at the highest level are cropped from the source in bands of
+ * rows, and the lower levels are built from them one level at a time. The
+ * tiles of each step are encoded in parallel on the global thread pool.
+ * The result does not depend on the number of threads.
+ **/
 class MARBLE_EXPORT TileCreator : public QThread
 {
     Q_OBJECT
@@ -89,6 +99,9 @@ class MARBLE_EXPORT TileCreator : public QThread
 
 
  private:
+    void waitForFinished( const QFuture<void> &future );
+    void reportProgress();
+
     Q_DISABLE_COPY( TileCreator )
     TileCreatorPrivate  * const d;
 };
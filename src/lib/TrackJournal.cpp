@@ -0,0 +1,327 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "TrackJournal.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStringList>
+#include <QtCore/QXmlStreamWriter>
+
+#include "MarbleDebug.h"
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#include <string.h>
+#else
+#include <sys/file.h>
+#endif
+
+namespace Marble
+{
+
+// Takes an exclusive lock on an open file. The system releases it when
+// the file gets closed, also if the process dies.
+static bool lockFile( QFile &file )
+{
+#ifdef Q_OS_WIN
+    HANDLE handle = reinterpret_cast<HANDLE>( _get_osfhandle( file.handle() ) );
+    OVERLAPPED overlapped;
+    memset( &overlapped, 0, sizeof( overlapped ) );
+    return LockFileEx( handle, LOCKFILE_EXCLUSIVE_LOCK | LOCKFILE_FAIL_IMMEDIATELY,
+                       0, 1, 0, &overlapped );
+#else
+    return flock( file.handle(), LOCK_EX | LOCK_NB ) == 0;
+#endif
+}
+
+TrackJournal::TrackJournal( const QString &directory )
+    : m_directory( directory ),
+      m_file( directory + QString( "/journal-%1.txt" ).arg( QCoreApplication::applicationPid() ) ),
+      m_lockFile( m_file.fileName() + ".lock" ),
+      m_hasPoints( false ),
+      m_segmentPending( true )
+{
+}
+
+TrackJournal::TrackJournal( const QString &directory, const QString &fileName )
+    : m_directory( directory ),
+      m_file( directory + '/' + fileName ),
+      m_lockFile( m_file.fileName() + ".lock" ),
+      m_hasPoints( false ),
+      m_segmentPending( true )
+{
+}
+
+TrackJournal::~TrackJournal()
+{
+    if ( m_file.isOpen() ) {
+        m_file.close();
+    }
+    if ( m_lockFile.isOpen() ) {
+        m_lockFile.close();
+    }
+}
+
+QString TrackJournal::fileName() const
+{
+    return m_file.fileName();
+}
+
+bool TrackJournal::open()
+{
+    if ( m_file.isOpen() ) {
+        return true;
+    }
+
+    QDir().mkpath( m_directory );
+    if ( !m_lockFile.open( QIODevice::WriteOnly ) || !lockFile( m_lockFile ) ) {
+        mDebug() << "Unable to lock track journal" << m_lockFile.fileName() << m_lockFile.errorString();
+        m_lockFile.close();
+        return false;
+    }
+
+    const QByteArray crashed = takeCrashedJournals();
+
+    if ( !m_file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to open track journal" << m_file.fileName() << m_file.errorString();
+        m_lockFile.close();
+        return false;
+    }
+    m_file.write( crashed );
+
+    // Segment markers only get written together with a position, so a
+    // journal that isn't empty contains a track.
+    m_hasPoints = !crashed.isEmpty();
+    m_segmentPending = true;
+    return true;
+}
+
+QByteArray TrackJournal::takeCrashedJournals()
+{
+    QByteArray result;
+
+    const QDir directory( m_directory );
+    const QString ownName = QFileInfo( m_file ).fileName();
+    const QStringList names = directory.entryList( QStringList() << "journal-*.txt", QDir::Files,
+                                                   QDir::Time | QDir::Reversed );
+    foreach ( const QString &name, names ) {
+        const QString fileName = directory.filePath( name );
+
+        // A journal with our name is left over from a crashed process
+        // that had the same id.
+        QFile lock( fileName + ".lock" );
+        if ( name != ownName && lock.exists() ) {
+            if ( !lock.open( QIODevice::ReadWrite ) || !lockFile( lock ) ) {
+                continue;
+            }
+        }
+
+        QFile journal( fileName );
+        if ( journal.open( QIODevice::ReadOnly ) ) {
+            QByteArray data = journal.readAll();
+            // Drop the line the crash interrupted.
+            data.truncate( data.lastIndexOf( '\n' ) + 1 );
+            result += data;
+            journal.close();
+        }
+
+        journal.remove();
+        if ( name != ownName ) {
+            lock.close();
+            lock.remove();
+        }
+    }
+
+    return result;
+}
+
+bool TrackJournal::hasPoints() const
+{
+    return m_hasPoints;
+}
+
+void TrackJournal::beginSegment()
+{
+    m_segmentPending = true;
+}
+
+void TrackJournal::append( const GeoDataCoordinates &position, const QDateTime &timestamp )
+{
+    if ( !m_file.isOpen() ) {
+        return;
+    }
+
+    QByteArray line;
+    if ( m_segmentPending ) {
+        line += "S\n";
+        m_segmentPending = false;
+    }
+
+    line += "P ";
+    line += QByteArray::number( timestamp.toMSecsSinceEpoch() );
+    line += ' ';
+    line += QByteArray::number( position.longitude( GeoDataCoordinates::Degree ), 'f', 8 );
+    line += ' ';
+    line += QByteArray::number( position.latitude( GeoDataCoordinates::Degree ), 'f', 8 );
+    line += ' ';
+    line += QByteArray::number( position.altitude(), 'f', 2 );
+    line += '\n';
+
+    m_file.write( line );
+    m_hasPoints = true;
+}
+
+void TrackJournal::flush()
+{
+    if ( m_file.isOpen() ) {
+        m_file.flush();
+    }
+}
+
+void TrackJournal::clear()
+{
+    if ( m_file.isOpen() ) {
+        m_file.resize( 0 );
+    }
+    m_hasPoints = false;
+    m_segmentPending = true;
+}
+
+void TrackJournal::remove()
+{
+    if ( m_file.isOpen() ) {
+        m_file.close();
+    }
+    m_file.remove();
+    if ( m_lockFile.isOpen() ) {
+        m_lockFile.close();
+    }
+    m_lockFile.remove();
+    m_hasPoints = false;
+    m_segmentPending = true;
+}
+
+QVector<TrackJournal::Segment> TrackJournal::segments()
+{
+    flush();
+
+    QVector<Segment> result;
+
+    QFile file( m_file.fileName() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return result;
+    }
+
+    while ( !file.atEnd() ) {
+        const QByteArray line = file.readLine();
+
+        // A missing line break means the application died while writing it.
+        if ( !line.endsWith( '\n' ) ) {
+            break;
+        }
+
+        if ( line.startsWith( 'S' ) ) {
+            result.append( Segment() );
+            continue;
+        }
+
+        const QList<QByteArray> fields = line.trimmed().split( ' ' );
+        if ( fields.size() != 5 || fields.at( 0 ) != "P" || result.isEmpty() ) {
+            continue;
+        }
+
+        bool ok[4];
+        const qint64 msecs = fields.at( 1 ).toLongLong( &ok[0] );
+        const qreal lon = fields.at( 2 ).toDouble( &ok[1] );
+        const qreal lat = fields.at( 3 ).toDouble( &ok[2] );
+        const qreal alt = fields.at( 4 ).toDouble( &ok[3] );
+        if ( !ok[0] || !ok[1] || !ok[2] || !ok[3] ) {
+            continue;
+        }
+
+        Point point;
+        point.coordinates = GeoDataCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
+        point.timestamp = QDateTime::fromMSecsSinceEpoch( msecs ).toUTC();
+        result.last().append( point );
+    }
+
+    return result;
+}
+
+QVector<TrackJournal::Segment> TrackJournal::tail( const QVector<Segment> &segments, int count )
+{
+    QVector<Segment> result;
+
+    for ( int i = segments.size() - 1; i >= 0 && count > 0; --i ) {
+        const Segment &segment = segments.at( i );
+        if ( segment.size() <= count ) {
+            result.prepend( segment );
+            count -= segment.size();
+            continue;
+        }
+
+        Segment part;
+        part.reserve( count );
+        for ( int j = segment.size() - count; j < segment.size(); ++j ) {
+            part.append( segment.at( j ) );
+        }
+        result.prepend( part );
+        count = 0;
+    }
+
+    return result;
+}
+
+bool TrackJournal::writeGpx( QIODevice *device, const QString &name )
+{
+    const QVector<Segment> track = segments();
+
+    // The stream writer doesn't report device errors, so the document is
+    // written to the device in one go.
+    QByteArray data;
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::WriteOnly );
+
+    QXmlStreamWriter writer( &buffer );
+    writer.setAutoFormatting( true );
+    writer.writeStartDocument();
+    writer.writeStartElement( "gpx" );
+    writer.writeDefaultNamespace( "http://www.topografix.com/GPX/1/1" );
+    writer.writeAttribute( "version", "1.1" );
+    writer.writeAttribute( "creator", "Marble" );
+
+    writer.writeStartElement( "trk" );
+    writer.writeTextElement( "name", name );
+
+    foreach ( const Segment &segment, track ) {
+        writer.writeStartElement( "trkseg" );
+        foreach ( const Point &point, segment ) {
+            const qreal lon = point.coordinates.longitude( GeoDataCoordinates::Degree );
+            const qreal lat = point.coordinates.latitude( GeoDataCoordinates::Degree );
+            writer.writeStartElement( "trkpt" );
+            writer.writeAttribute( "lat", QString::number( lat, 'f', 8 ) );
+            writer.writeAttribute( "lon", QString::number( lon, 'f', 8 ) );
+            writer.writeTextElement( "ele", QString::number( point.coordinates.altitude(), 'f', 2 ) );
+            writer.writeTextElement( "time", point.timestamp.toString( Qt::ISODate ) + 'Z' );
+            writer.writeEndElement();
+        }
+        writer.writeEndElement();
+    }
+
+    writer.writeEndElement();
+    writer.writeEndElement();
+    writer.writeEndDocument();
+
+    return device->write( data ) == data.size();
+}
+
+}
@@ -0,0 +1,137 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_TRACKJOURNAL_H
+#define MARBLE_TRACKJOURNAL_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "GeoDataCoordinates.h"
+#include "marble_export.h"
+
+class QIODevice;
+
+namespace Marble
+{
+
+/**
+ * @short An append-only file that records a position track.
+ *
+ * Every recorded position is appended to the journal as one line of text,
+ * so a track survives a crash of the application up to the last flush.
+ * Incomplete lines at the end of the journal are ignored when reading it.
+ * The journal can be exported to KML (by the caller) or GPX.
+ *
+ * Each process writes its own journal, named after its process id, and
+ * holds a lock on a lock file next to it while the journal is open. When
+ * a journal gets opened it takes over the positions of the journals in
+ * the same directory whose lock is free, i.e. whose process crashed.
+ */
+class MARBLE_EXPORT TrackJournal
+{
+ public:
+    struct Point
+    {
+        GeoDataCoordinates coordinates;
+        QDateTime timestamp;
+    };
+
+    typedef QVector<Point> Segment;
+
+    /**
+     * @brief Creates the journal of this process in @p directory.
+     */
+    explicit TrackJournal( const QString &directory );
+
+    /**
+     * @brief Creates a journal with the given file name, e.g. to simulate
+     * another process. The lock file is @p fileName with a ".lock" suffix.
+     */
+    TrackJournal( const QString &directory, const QString &fileName );
+
+    ~TrackJournal();
+
+    QString fileName() const;
+
+    /**
+     * @brief Locks and opens the journal for appending.
+     * The positions of crashed journals in the same directory are moved
+     * into this one.
+     */
+    bool open();
+
+    /**
+     * @brief Returns true if the journal contains at least one position,
+     * e.g. ones taken over from a crashed journal after open().
+     */
+    bool hasPoints() const;
+
+    /**
+     * @brief Starts a new track segment.
+     */
+    void beginSegment();
+
+    /**
+     * @brief Appends a position to the current track segment.
+     */
+    void append( const GeoDataCoordinates &position, const QDateTime &timestamp );
+
+    /**
+     * @brief Writes buffered positions to the file.
+     */
+    void flush();
+
+    /**
+     * @brief Discards all recorded positions.
+     */
+    void clear();
+
+    /**
+     * @brief Closes and deletes the journal and its lock file.
+     */
+    void remove();
+
+    /**
+     * @brief Reads all track segments recorded so far.
+     */
+    QVector<Segment> segments();
+
+    /**
+     * @brief Returns the last @p count positions of @p segments, e.g. to
+     * restore a long track without keeping all of it in memory.
+     */
+    static QVector<Segment> tail( const QVector<Segment> &segments, int count );
+
+    /**
+     * @brief Writes all recorded track segments as GPX to @p device.
+     * Returns false if the device failed to write all of it.
+     */
+    bool writeGpx( QIODevice *device, const QString &name );
+
+ private:
+    Q_DISABLE_COPY( TrackJournal )
+
+    /**
+     * Returns the complete lines of the journals in the directory that are
+     * not locked by a running process, and deletes them.
+     */
+    QByteArray takeCrashedJournals();
+
+    QString m_directory;
+    QFile m_file;
+    QFile m_lockFile;
+    bool  m_hasPoints;
+    bool  m_segmentPending;
+};
+
+}
+
+#endif
@@ -23,6 +23,7 @@
 #include "AbstractProjection.h"
 #include "GeoPainter.h"
 #include "GeoPolygon.h"
+#include "PntMapIndex.h"
 #include "ViewportParams.h"
 #include "MathHelper.h"
 
@@ -30,21 +31,147 @@
 
 using namespace Marble;
 
+VectorMap::ViewKey::ViewKey()
+    : projection( Spherical ),
+      radius( -1 ),
+      width( -1 ),
+      height( -1 ),
+      planetAxis( 1.0, 0.0, 0.0, 0.0 ),
+      detail( -1 ),
+      zBoundingBoxLimit( 0.0 ),
+      zPointLimit( 0.0 )
+{
+}
+
+bool VectorMap::ViewKey::operator==( const ViewKey &other ) const
+{
+    return projection == other.projection
+        && radius == other.radius
+        && width == other.width
+        && height == other.height
+        && planetAxis == other.planetAxis
+        && detail == other.detail
+        && zBoundingBoxLimit == other.zBoundingBoxLimit
+        && zPointLimit == other.zPointLimit;
+}
+
+VectorMap::FlatProjectedPolygon::FlatProjectedPolygon()
+    : isValid( false ),
+      isViewportDependent( false )
+{
+}
+
+VectorMap::PntMapCache::PntMapCache( const PntMap *pntmap )
+    : pntmap( const_cast<PntMap *>( pntmap ) ),
+      index( new PntMapIndex( pntmap ) ),
+      hasLastPolygons( false ),
+      flatProjection( Spherical ),
+      flatRadius( -1 ),
+      flatDetail( -1 ),
+      flatPolygons( pntmap->size() )
+{
+}
+
+VectorMap::PntMapCache::~PntMapCache()
+{
+    delete index;
+}
+
 VectorMap::VectorMap()
     : m_zBoundingBoxLimit( 0.0 ),
-      m_zPointLimit( 0.0 )
+      m_zPointLimit( 0.0 ),
       // m_debugNodeCount( 0 )
+      m_currentCache( 0 ),
+      m_cacheEnabled( true ),
+      m_isViewportDependent( false )
 {
 }
 
 VectorMap::~VectorMap()
 {
+    qDeleteAll( m_pntMapCaches );
+}
+
+
+VectorMap::PntMapCache *VectorMap::pntMapCache( const PntMap *pntmap )
+{
+    // PntMaps get loaded in a separate thread, so they may only be
+    // indexed once they are complete.
+    if ( !m_cacheEnabled || !pntmap->isInitialized() ) {
+        return 0;
+    }
+
+    PntMapCache *cache = m_pntMapCaches.value( pntmap, 0 );
+    if ( cache && !cache->pntmap.isNull()
+         && cache->index->polygonCount() == pntmap->size() ) {
+        return cache;
+    }
+
+    // Drop the caches of deleted PntMaps along with an outdated one.
+    QHash<const PntMap *, PntMapCache *>::iterator it = m_pntMapCaches.begin();
+    while ( it != m_pntMapCaches.end() ) {
+        if ( it.value() == cache || it.value()->pntmap.isNull() ) {
+            delete it.value();
+            it = m_pntMapCaches.erase( it );
+        }
+        else {
+            ++it;
+        }
+    }
+
+    cache = new PntMapCache( pntmap );
+    m_pntMapCaches.insert( pntmap, cache );
+
+    return cache;
+}
+
+const ScreenPolygon::Vector &VectorMap::polygons() const
+{
+    return m_polygons;
+}
+
+void VectorMap::setCacheEnabled( bool enabled )
+{
+    m_cacheEnabled = enabled;
+    if ( !enabled ) {
+        qDeleteAll( m_pntMapCaches );
+        m_pntMapCaches.clear();
+        m_currentCache = 0;
+    }
+}
+
+bool VectorMap::isCacheEnabled() const
+{
+    return m_cacheEnabled;
 }
 
 
 void VectorMap::createFromPntMap( const PntMap* pntmap, 
                                   const ViewportParams* viewport )
 {
+    m_currentCache = pntMapCache( pntmap );
+
+    ViewKey key;
+    key.projection = viewport->projection();
+    key.radius = viewport->radius();
+    key.width = viewport->width();
+    key.height = viewport->height();
+    key.planetAxis = viewport->planetAxis();
+    key.detail = getDetailLevel( viewport->radius() );
+    key.zBoundingBoxLimit = m_zBoundingBoxLimit;
+    key.zPointLimit = m_zPointLimit;
+
+    // Repaints of an unchanged view (e.g. caused by other layers) can reuse
+    // the polygons of the last call.
+    if ( m_currentCache && m_currentCache->hasLastPolygons
+         && m_currentCache->lastKey == key ) {
+        if ( viewport->projection() == Spherical ) {
+            sphericalUpdateLimits( viewport );
+        }
+        m_polygons = m_currentCache->lastPolygons;
+        return;
+    }
+
     switch( viewport->projection() ) {
         case Spherical:
             sphericalCreateFromPntMap( pntmap, viewport );
@@ -56,13 +183,16 @@ void VectorMap::createFromPntMap( const PntMap* pntmap,
             mercatorCreateFromPntMap( pntmap, viewport );
             break;
     }
+
+    if ( m_currentCache ) {
+        m_currentCache->hasLastPolygons = true;
+        m_currentCache->lastKey = key;
+        m_currentCache->lastPolygons = m_polygons;
+    }
 }
 
-void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap, 
-                                           const ViewportParams* viewport )
+void VectorMap::sphericalUpdateLimits( const ViewportParams* viewport )
 {
-    m_polygons.clear();
-
     // We must use qreal or int64 for the calculations because we
     // square radius sometimes below, and it may cause an overflow. We
     // choose qreal because of some sqrt() calculations.
@@ -84,18 +214,40 @@ void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap,
     m_zPointLimit = ( ( m_zPointLimit >= 0.0 && zlimit < m_zPointLimit )
                       || m_zPointLimit < 0.0 )
                      ? zlimit : m_zPointLimit;
+}
+
+void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap, 
+                                           const ViewportParams* viewport )
+{
+    m_polygons.clear();
+
+    sphericalUpdateLimits( viewport );
 
     viewport->planetAxis().inverse().toMatrix( m_rotMatrix );
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
+
+    // Skip all polygons whose bounding caps face away from the viewer.
+    m_candidates.resize( 0 );
+    if ( m_currentCache ) {
+        m_currentCache->index->facing( m_rotMatrix, m_zBoundingBoxLimit, m_candidates );
+    }
+    else {
+        for ( int i = 0; i < pntmap->size(); ++i ) {
+            m_candidates << i;
+        }
+    }
+
+    QVector<int>::ConstIterator  itCandidate = m_candidates.constBegin();
+    QVector<int>::ConstIterator  itEndCandidate = m_candidates.constEnd();
 
     //	const int detail = 0;
     const int  detail = getDetailLevel( viewport->radius() );
 
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
+    for (; itCandidate != itEndCandidate; ++itCandidate )
     {
+        const GeoPolygon *polyLine = pntmap->at( *itCandidate );
+
         // This sorts out polygons by bounding box which aren't visible at all.
-        GeoDataCoordinates::PtrVector boundary = (*itPolyLine)->getBoundary();
+        GeoDataCoordinates::PtrVector boundary = polyLine->getBoundary();
         // rather paint an invalid line then crashing here if the boundaries are not loaded yet
         if(boundary.size() < 5) continue;
 
@@ -106,12 +258,12 @@ void VectorMap::sphericalCreateFromPntMap( const PntMap* pntmap,
             if ( qbound.v[Q_Z] > m_zBoundingBoxLimit ) {
                 // if (qbound.v[Q_Z] > 0){
                 m_polygon.clear();
-                m_polygon.reserve( (*itPolyLine)->size() );
-                m_polygon.setClosed( (*itPolyLine)->getClosed() );
+                m_polygon.reserve( polyLine->size() );
+                m_polygon.setClosed( polyLine->getClosed() );
 
                 // mDebug() << i << " Visible: YES";
-                sphericalCreatePolyLine( (*itPolyLine)->constBegin(),
-                                         (*itPolyLine)->constEnd(), detail, viewport );
+                sphericalCreatePolyLine( polyLine->constBegin(),
+                                         polyLine->constEnd(), detail, viewport );
 
                 break; // abort foreach test of current boundary
             } 
@@ -134,15 +286,29 @@ void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap,
     const qreal rad2Pixel = (float)( 2 * radius ) / M_PI;
 
     viewport->planetAxis().inverse().toMatrix( m_rotMatrix );
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
 
     const QRectF visibleArea ( 0, 0, viewport->width(), viewport->height() );
     const int      detail = getDetailLevel( radius );
 
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
+    // Only look at polygons whose bounding boxes might intersect the viewport.
+    const qreal halfWidth  = ( (qreal)(viewport->width())  / 2.0 + 1.0 ) / rad2Pixel;
+    const qreal halfHeight = ( (qreal)(viewport->height()) / 2.0 + 1.0 ) / rad2Pixel;
+    flatCollectCandidates( pntmap, viewport, detail,
+                           centerLon - halfWidth, centerLat - halfHeight,
+                           centerLon + halfWidth, centerLat + halfHeight );
+
+    // The screen position of the point at longitude and latitude zero.
+    const qreal originX = (qreal)(viewport->width())  / 2.0 - rad2Pixel * centerLon;
+    const qreal originY = (qreal)(viewport->height()) / 2.0 + rad2Pixel * centerLat;
+
+    QVector<int>::ConstIterator  itCandidate = m_candidates.constBegin();
+    QVector<int>::ConstIterator  itEndCandidate = m_candidates.constEnd();
+
+    for (; itCandidate != itEndCandidate; ++itCandidate )
     {
-        const GeoDataCoordinates::PtrVector  boundary = (*itPolyLine)->getBoundary();
+        const GeoPolygon *polyLine = pntmap->at( *itCandidate );
+
+        const GeoDataCoordinates::PtrVector  boundary = polyLine->getBoundary();
 
         // Let's just use the top left and the bottom right bounding
         // box point for this projection.
@@ -174,9 +340,9 @@ void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap,
             boundingPolygon.translate( -4 * radius, 0 );
 	    // FIXME: Get rid of this really fugly code once we have a
 	    //        proper LatLonBox check implemented and in place.
-        } while( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+        } while( ( polyLine->getDateLine() != GeoPolygon::Even 
 		   && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		 || ( (*itPolyLine)->getDateLine() == GeoPolygon::Even
+		 || ( polyLine->getDateLine() == GeoPolygon::Even
 		      && ( visibleArea.intersects( QRectF( boundingPolygon.at(1),
                                                            QPointF( (qreal)(viewport->width()) / 2.0
                                                                     - rad2Pixel * ( centerLon - M_PI )
@@ -193,9 +359,9 @@ void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap,
 
 	// FIXME: Get rid of this really fugly code once we will have
 	//        a proper LatLonBox check implemented and in place.
-        while ( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+        while ( ( polyLine->getDateLine() != GeoPolygon::Even 
 		  && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		|| ( (*itPolyLine)->getDateLine() == GeoPolygon::Even 
+		|| ( polyLine->getDateLine() == GeoPolygon::Even 
 		     && ( visibleArea.intersects(
 			    QRectF( boundingPolygon.at(1),
 				    QPointF( (qreal)(viewport->width()) / 2.0
@@ -210,13 +376,8 @@ void VectorMap::rectangularCreateFromPntMap( const PntMap* pntmap,
 					 boundingPolygon.at(0) ) ) ) )
 		) 
 	{
-
-            m_polygon.clear();
-            m_polygon.reserve( (*itPolyLine)->size() );
-            m_polygon.setClosed( (*itPolyLine)->getClosed() );
-
-            rectangularCreatePolyLine( (*itPolyLine)->constBegin(),
-                                       (*itPolyLine)->constEnd(), detail, viewport, offset );
+            flatCreatePolyLines( polyLine, *itCandidate, detail, viewport,
+                                 originX + offset, originY );
 
             offset += 4 * radius;
             boundingPolygon.translate( 4 * radius, 0 );
@@ -237,15 +398,32 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
     const qreal rad2Pixel = (float)( 2 * radius ) / M_PI;
 
     viewport->planetAxis().inverse().toMatrix( m_rotMatrix );
-    GeoPolygon::PtrVector::ConstIterator  itPolyLine = pntmap->constBegin();
-    GeoPolygon::PtrVector::ConstIterator  itEndPolyLine = pntmap->constEnd();
 
     const QRectF visibleArea ( 0, 0, viewport->width(), viewport->height() );
     const int      detail = getDetailLevel( radius );
 
-    for (; itPolyLine != itEndPolyLine; ++itPolyLine )
+    // Only look at polygons whose bounding boxes might intersect the viewport.
+    const qreal halfWidth  = ( (qreal)(viewport->width())  / 2.0 + 1.0 ) / rad2Pixel;
+    const qreal halfHeight = ( (qreal)(viewport->height()) / 2.0 + 1.0 ) / rad2Pixel;
+    const qreal centerY = atanh( sin( centerLat ) );
+    flatCollectCandidates( pntmap, viewport, detail,
+                           centerLon - halfWidth, atan( sinh( centerY - halfHeight ) ),
+                           centerLon + halfWidth, atan( sinh( centerY + halfHeight ) ) );
+
+    // The screen position of the point at longitude and latitude zero. Note
+    // that the polygons get projected with a more precise scale.
+    const qreal polyLineRad2Pixel = (qreal)( 2 * radius ) / M_PI;
+    const qreal originX = (qreal)(viewport->width())  / 2.0 - polyLineRad2Pixel * centerLon;
+    const qreal originY = (qreal)(viewport->height()) / 2.0 + polyLineRad2Pixel * centerY;
+
+    QVector<int>::ConstIterator  itCandidate = m_candidates.constBegin();
+    QVector<int>::ConstIterator  itEndCandidate = m_candidates.constEnd();
+
+    for (; itCandidate != itEndCandidate; ++itCandidate )
     {
-        const GeoDataCoordinates::PtrVector boundary = (*itPolyLine)->getBoundary();
+        const GeoPolygon *polyLine = pntmap->at( *itCandidate );
+
+        const GeoDataCoordinates::PtrVector boundary = polyLine->getBoundary();
 
         // Let's just use the top left and the bottom right bounding box point for 
         // this projection
@@ -279,9 +457,9 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
             boundingPolygon.translate( -4 * radius, 0 );
 	    // FIXME: Get rid of this really fugly code once we have a
 	    //        proper LatLonBox check implemented and in place.
-        } while( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+        } while( ( polyLine->getDateLine() != GeoPolygon::Even 
 		   && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		 || ( (*itPolyLine)->getDateLine() == GeoPolygon::Even
+		 || ( polyLine->getDateLine() == GeoPolygon::Even
 		      && ( visibleArea.intersects( QRectF( boundingPolygon.at(1),
                                                            QPointF( (qreal)(viewport->width()) / 2.0
                                                                     - rad2Pixel * ( centerLon
@@ -299,9 +477,9 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
 
 	// FIXME: Get rid of this really fugly code once we will have
 	//        a proper LatLonBox check implemented and in place.
-        while ( ( (*itPolyLine)->getDateLine() != GeoPolygon::Even 
+        while ( ( polyLine->getDateLine() != GeoPolygon::Even 
 		  && visibleArea.intersects( (QRectF)( boundingPolygon.boundingRect() ) ) )
-		|| ( (*itPolyLine)->getDateLine() == GeoPolygon::Even 
+		|| ( polyLine->getDateLine() == GeoPolygon::Even 
 		     && ( visibleArea.intersects(
 			    QRectF( boundingPolygon.at(1),
 				    QPointF( (qreal)(viewport->width()) / 2.0
@@ -316,12 +494,8 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
 					 boundingPolygon.at(0) ) ) ) )
 		)
 	{
-            m_polygon.clear();
-            m_polygon.reserve( (*itPolyLine)->size() );
-            m_polygon.setClosed( (*itPolyLine)->getClosed() );
-
-            mercatorCreatePolyLine( (*itPolyLine)->constBegin(),
-                                    (*itPolyLine)->constEnd(), detail, viewport, offset );
+            flatCreatePolyLines( polyLine, *itCandidate, detail, viewport,
+                                 originX + offset, originY );
 
             offset += 4 * radius;
             boundingPolygon.translate( 4 * radius, 0 );
@@ -329,6 +503,86 @@ void VectorMap::mercatorCreateFromPntMap( const PntMap* pntmap,
     }
 }
 
+void VectorMap::flatCollectCandidates( const PntMap* pntmap,
+                                       const ViewportParams* viewport, const int detail,
+                                       qreal west, qreal south, qreal east, qreal north )
+{
+    m_candidates.resize( 0 );
+
+    if ( !m_currentCache ) {
+        for ( int i = 0; i < pntmap->size(); ++i ) {
+            m_candidates << i;
+        }
+        return;
+    }
+
+    // Projected polygons only stay valid as long as the scale does.
+    if ( m_currentCache->flatProjection != viewport->projection()
+         || m_currentCache->flatRadius != viewport->radius()
+         || m_currentCache->flatDetail != detail ) {
+        m_currentCache->flatProjection = viewport->projection();
+        m_currentCache->flatRadius = viewport->radius();
+        m_currentCache->flatDetail = detail;
+        m_currentCache->flatPolygons.fill( FlatProjectedPolygon() );
+    }
+
+    m_currentCache->index->intersecting( west, south, east, north, m_candidates );
+}
+
+void VectorMap::flatCreatePolyLines( const GeoPolygon *polygon, int index,
+                                     const int detail, const ViewportParams *viewport,
+                                     qreal originX, qreal originY )
+{
+    if ( m_currentCache ) {
+        FlatProjectedPolygon &projected = m_currentCache->flatPolygons[index];
+
+        if ( !projected.isValid ) {
+            const int first = m_polygons.size();
+            flatCreatePolyLine( polygon, detail, viewport, 0.0, 0.0 );
+
+            projected.isValid = true;
+            projected.isViewportDependent = m_isViewportDependent;
+            projected.polygons = m_polygons.mid( first );
+            m_polygons.resize( first );
+        }
+
+        // Panning a flat map just translates the polygons.
+        if ( !projected.isViewportDependent ) {
+            ScreenPolygon::Vector::const_iterator itEndPolygon = projected.polygons.constEnd();
+            for ( ScreenPolygon::Vector::const_iterator itPolygon = projected.polygons.constBegin();
+                  itPolygon != itEndPolygon;
+                  ++itPolygon )
+            {
+                m_polygons.append( *itPolygon );
+                m_polygons.last().translate( originX, originY );
+            }
+            return;
+        }
+    }
+
+    flatCreatePolyLine( polygon, detail, viewport, originX, originY );
+}
+
+void VectorMap::flatCreatePolyLine( const GeoPolygon *polygon,
+                                    const int detail, const ViewportParams *viewport,
+                                    qreal originX, qreal originY )
+{
+    m_isViewportDependent = false;
+
+    m_polygon.clear();
+    m_polygon.reserve( polygon->size() );
+    m_polygon.setClosed( polygon->getClosed() );
+
+    if ( viewport->projection() == Mercator ) {
+        mercatorCreatePolyLine( polygon->constBegin(), polygon->constEnd(),
+                                detail, viewport, originX, originY );
+    }
+    else {
+        rectangularCreatePolyLine( polygon->constBegin(), polygon->constEnd(),
+                                   detail, viewport, originX, originY );
+    }
+}
+
 void VectorMap::sphericalCreatePolyLine( GeoDataCoordinates::Vector::ConstIterator const & itStartPoint,
                                          GeoDataCoordinates::Vector::ConstIterator const & itEndPoint,
                                          const int detail, const ViewportParams *viewport )
@@ -437,12 +691,9 @@ void VectorMap::sphericalCreatePolyLine( GeoDataCoordinates::Vector::ConstIterat
 void VectorMap::rectangularCreatePolyLine(
     GeoDataCoordinates::Vector::ConstIterator const & itStartPoint,
     GeoDataCoordinates::Vector::ConstIterator const & itEndPoint,
-    const int detail, const ViewportParams *viewport, int offset )
+    const int detail, const ViewportParams *viewport,
+    qreal originX, qreal originY )
 {
-    // Calculate translation of center point
-    const qreal centerLon = viewport->centerLongitude();
-    const qreal centerLat = viewport->centerLatitude();
-
     // Other convenience variables
     const qreal  rad2Pixel = (float)( 2 * viewport->radius() ) / M_PI;
 
@@ -467,8 +718,8 @@ void VectorMap::rectangularCreatePolyLine(
 
         qreal lon, lat;
         itPoint->geoCoordinates( lon, lat);
-        const qreal x = (qreal)(viewport->width())  / 2.0 - rad2Pixel * (centerLon - lon) + offset;
-        const qreal y = (qreal)(viewport->height()) / 2.0 + rad2Pixel * (centerLat - lat);
+        const qreal x = originX + rad2Pixel * lon;
+        const qreal y = originY - rad2Pixel * lat;
         int currentSign = ( lon > 0.0 ) ? 1 : -1 ;
 	if ( firstPoint ) {
 	    firstPoint = false;
@@ -482,14 +733,10 @@ void VectorMap::rectangularCreatePolyLine(
 
 	    // X coordinate on the screen for the points on the
 	    // dateline on both sides of the flat map.
-	    qreal lastXAtDateLine = (qreal)(viewport->width()) / 2.0
-                + rad2Pixel * ( lastSign * M_PI - centerLon ) + offset;
-	    qreal xAtDateLine = (qreal)(viewport->width()) / 2.0
-                + rad2Pixel * ( -lastSign * M_PI - centerLon ) + offset;
-	    qreal lastYAtDateLine = (qreal)(viewport->height()) / 2.0
-                - ( lastLat - centerLat ) * rad2Pixel;
-	    qreal yAtSouthPole = (qreal)(viewport->height()) / 2.0
-                - ( -viewport->currentProjection()->maxLat() - centerLat ) * rad2Pixel;
+	    qreal lastXAtDateLine = originX + rad2Pixel * lastSign * M_PI;
+	    qreal xAtDateLine = originX - rad2Pixel * lastSign * M_PI;
+	    qreal lastYAtDateLine = originY - lastLat * rad2Pixel;
+	    qreal yAtSouthPole = originY + viewport->currentProjection()->maxLat() * rad2Pixel;
 
 	    //If the "jump" occurs in the Anctartica's latitudes
 
@@ -497,6 +744,7 @@ void VectorMap::rectangularCreatePolyLine(
 		// FIXME: This should actually need to get investigated
 		//        in GeoPainter.  For now though we just help
 		//        GeoPainter to get the clipping right.
+		m_isViewportDependent = true;
 		if ( lastXAtDateLine > (qreal)(viewport->width()) - 1.0 )
 		    lastXAtDateLine = (qreal)(viewport->width()) - 1.0;
 		if ( lastXAtDateLine < 0.0 )
@@ -550,12 +798,8 @@ void VectorMap::mercatorCreatePolyLine(
         GeoDataCoordinates::Vector::ConstIterator const & itEndPoint,
         const int detail,
         const ViewportParams *viewport,
-        int offset )
+        qreal originX, qreal originY )
 {
-    // Calculate translation of center point
-    const qreal centerLon = viewport->centerLongitude();
-    const qreal centerLat = viewport->centerLatitude();
-
     // Other convenience variables
     const qreal  rad2Pixel = (qreal)( 2 * viewport->radius() ) / M_PI;
 
@@ -588,9 +832,8 @@ void VectorMap::mercatorCreatePolyLine(
     if ( fabs( lat ) > viewport->currentProjection()->maxLat() )
         continue;
 
-        const qreal x = (qreal)(viewport->width())  / 2.0 + rad2Pixel * (lon - centerLon) + offset;
-        const qreal y = (qreal)(viewport->height()) / 2.0
-            - rad2Pixel * ( atanh( sin( lat ) ) - atanh( sin( centerLat ) ) );
+        const qreal x = originX + rad2Pixel * lon;
+        const qreal y = originY - rad2Pixel * atanh( sin( lat ) );
         int currentSign = ( lon > 0.0 ) ? 1 : -1 ;
 	if ( firstPoint ) {
 	    firstPoint = false;
@@ -606,17 +849,11 @@ void VectorMap::mercatorCreatePolyLine(
 	    // x coordinate on the screen for the points on the dateline on both
 	    // sides of the flat map.
 	    // FIXME: mercator projection here too.
-	    qreal lastXAtDateLine = (qreal)(viewport->width()) / 2.0
-                + rad2Pixel * ( lastSign * M_PI - centerLon ) + offset;
-	    qreal xAtDateLine = (qreal)(viewport->width()) / 2.0
-                + rad2Pixel * ( -lastSign * M_PI - centerLon ) + offset;
-        qreal lastYAtDateLine = (qreal)( viewport->height() / 2 - rad2Pixel
-                                         * ( atanh( sin( lastLat ) )
-                                             - atanh( sin( centerLat ) ) ) );
-        qreal yAtSouthPole = (qreal)( viewport->height() / 2
-                                      - rad2Pixel * ( atanh( sin( -viewport->currentProjection()->
-                                                                  maxLat() ) )
-                                                      - atanh( sin( centerLat ) ) ) );
+	    qreal lastXAtDateLine = originX + rad2Pixel * lastSign * M_PI;
+	    qreal xAtDateLine = originX - rad2Pixel * lastSign * M_PI;
+	    qreal lastYAtDateLine = originY - rad2Pixel * atanh( sin( lastLat ) );
+	    qreal yAtSouthPole = originY
+                - rad2Pixel * atanh( sin( -viewport->currentProjection()->maxLat() ) );
 
 	    //If the "jump" occurs in the Anctartica's latitudes
 
@@ -624,6 +861,7 @@ void VectorMap::mercatorCreatePolyLine(
 		// FIXME: This should actually need to get investigated
 		//        in GeoPainter.  For now though we just help
 		//        GeoPainter to get the clipping right.
+		m_isViewportDependent = true;
 		if ( lastXAtDateLine > (qreal)(viewport->width()) - 1.0 )
 		    lastXAtDateLine = (qreal)(viewport->width()) - 1.0;
 		if ( lastXAtDateLine < 0.0 )
@@ -12,11 +12,15 @@
 #ifndef MARBLE_VECTORMAP_H
 #define MARBLE_VECTORMAP_H
 
+#include <QtCore/QHash>
+#include <QtCore/QPointer>
 #include <QtCore/QPointF>
+#include <QtCore/QVector>
 #include <QtGui/QPen>
 #include <QtGui/QBrush>
 
 #include "global.h"
+#include "marble_export.h"
 #include "Quaternion.h"
 #include "GeoDataCoordinates.h"
 #include "ScreenPolygon.h"
@@ -27,16 +31,31 @@ namespace Marble
 {
 
 class GeoPainter;
+class GeoPolygon;
 class PntMap;
+class PntMapIndex;
 class ViewportParams;
 
-class VectorMap
+class MARBLE_EXPORT VectorMap
 {
  public:
     VectorMap();
     ~VectorMap();
     void createFromPntMap( const PntMap*, const ViewportParams *viewport );
 
+    /**
+     * @brief The polygons created by the last call of createFromPntMap().
+     */
+    const ScreenPolygon::Vector &polygons() const;
+
+    /**
+     * @brief Set whether the polygons get indexed and cached per PntMap.
+     * Without the cache every polygon gets tested and projected directly
+     * on each call. It is enabled by default.
+     */
+    void setCacheEnabled( bool enabled );
+    bool isCacheEnabled() const;
+
     /**
      * @brief Paint the background, i.e. the water.
      */
@@ -52,19 +71,91 @@ class VectorMap
     //	int nodeCount(){ return m_debugNodeCount; }
 
  private:
+    /**
+     * The parameters the projected polygons of a PntMap depend on.
+     */
+    struct ViewKey
+    {
+        ViewKey();
+        bool operator==( const ViewKey &other ) const;
+
+        Projection projection;
+        int        radius;
+        int        width;
+        int        height;
+        Quaternion planetAxis;
+        int        detail;
+        qreal      zBoundingBoxLimit;
+        qreal      zPointLimit;
+    };
+
+    /**
+     * The polygons of a GeoPolygon projected to a flat map whose center is
+     * located at the origin of the screen coordinate system. Panning
+     * translates them only, unless they depend on the viewport size.
+     */
+    struct FlatProjectedPolygon
+    {
+        FlatProjectedPolygon();
+
+        bool isValid;
+        bool isViewportDependent;
+        ScreenPolygon::Vector polygons;
+    };
+
+    struct PntMapCache
+    {
+        PntMapCache( const PntMap *pntmap );
+        ~PntMapCache();
+
+        // Guards against a new PntMap that got the address of a deleted one.
+        QPointer<PntMap> pntmap;
+        PntMapIndex *index;
+
+        // The screen polygons created for the view described by lastKey.
+        bool                  hasLastPolygons;
+        ViewKey               lastKey;
+        ScreenPolygon::Vector lastPolygons;
+
+        // Lazily projected polygons for the flat projections.
+        Projection                    flatProjection;
+        int                           flatRadius;
+        int                           flatDetail;
+        QVector<FlatProjectedPolygon> flatPolygons;
+
+     private:
+        Q_DISABLE_COPY( PntMapCache )
+    };
+
+    PntMapCache *pntMapCache( const PntMap *pntmap );
+
+    void sphericalUpdateLimits( const ViewportParams *viewport );
+
     void sphericalCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
     void rectangularCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
     void mercatorCreateFromPntMap( const PntMap*, const ViewportParams *viewport );
 
+    void flatCollectCandidates( const PntMap *pntmap,
+                                const ViewportParams *viewport, const int detail,
+                                qreal west, qreal south, qreal east, qreal north );
+    void flatCreatePolyLines( const GeoPolygon *polygon, int index,
+                              const int detail, const ViewportParams *viewport,
+                              qreal originX, qreal originY );
+    void flatCreatePolyLine( const GeoPolygon *polygon,
+                             const int detail, const ViewportParams *viewport,
+                             qreal originX, qreal originY );
+
     void sphericalCreatePolyLine( GeoDataCoordinates::Vector::ConstIterator const &,
 				  GeoDataCoordinates::Vector::ConstIterator const &,
                                   const int detail, const ViewportParams *viewport );
     void rectangularCreatePolyLine( GeoDataCoordinates::Vector::ConstIterator const &,
 				    GeoDataCoordinates::Vector::ConstIterator const &,
-                                    const int detail, const ViewportParams *viewport, int offset );
+                                    const int detail, const ViewportParams *viewport,
+                                    qreal originX, qreal originY );
     void mercatorCreatePolyLine( GeoDataCoordinates::Vector::ConstIterator const &,
 				 GeoDataCoordinates::Vector::ConstIterator const &,
-                                 const int detail, const ViewportParams *viewport, int offset );
+                                 const int detail, const ViewportParams *viewport,
+                                 qreal originX, qreal originY );
 
     QPointF  horizonPoint( const ViewportParams *viewport, const QPointF &currentPoint, int rLimit ) const;
     void           createArc( const ViewportParams *viewport, const QPointF &horizona, const QPointF &horizonb, int rLimit );
@@ -83,6 +174,14 @@ class VectorMap
     //	int m_debugNodeCount;
 
     ScreenPolygon     m_polygon;
+
+    QHash<const PntMap *, PntMapCache *> m_pntMapCaches;
+    PntMapCache      *m_currentCache;
+    bool              m_cacheEnabled;
+    QVector<int>      m_candidates;
+
+    // true if the last projected polygon got clamped to the viewport.
+    bool              m_isViewportDependent;
 };
 
 }
@@ -0,0 +1,695 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "VectorTileCreator.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QMap>
+#include <QtCore/QPair>
+#include <QtCore/QRectF>
+#include <QtCore/QStack>
+#include <QtCore/QVector>
+#include <QtCore/qmath.h>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataLineString.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTrack.h"
+#include "GeoDataTypes.h"
+#include "MarbleDebug.h"
+#include "TileId.h"
+
+namespace Marble
+{
+
+static inline QPointF toPoint( const GeoDataCoordinates &coordinates )
+{
+    return QPointF( coordinates.longitude( GeoDataCoordinates::Degree ),
+                    coordinates.latitude( GeoDataCoordinates::Degree ) );
+}
+
+static QVector<GeoDataCoordinates> coordinatesOf( const GeoDataLineString &lineString )
+{
+    QVector<GeoDataCoordinates> result;
+    result.reserve( lineString.size() );
+    for ( QVector<GeoDataCoordinates>::ConstIterator it = lineString.constBegin();
+          it != lineString.constEnd(); ++it ) {
+        result.append( *it );
+    }
+
+    return result;
+}
+
+/**
+ * The bounding box of @p coordinates in degrees, with the longitude as x
+ * and the latitude as y.
+ */
+static QRectF boundsOf( const QVector<GeoDataCoordinates> &coordinates )
+{
+    if ( coordinates.isEmpty() ) {
+        return QRectF();
+    }
+
+    const QPointF first = toPoint( coordinates.first() );
+    qreal west = first.x();
+    qreal east = first.x();
+    qreal south = first.y();
+    qreal north = first.y();
+    for ( int i = 1; i < coordinates.size(); ++i ) {
+        const QPointF point = toPoint( coordinates.at( i ) );
+        west = qMin( west, point.x() );
+        east = qMax( east, point.x() );
+        south = qMin( south, point.y() );
+        north = qMax( north, point.y() );
+    }
+
+    return QRectF( QPointF( west, south ), QPointF( east, north ) );
+}
+
+static qreal squaredDistance( const QPointF &point, const QPointF &a, const QPointF &b )
+{
+    const QPointF ab = b - a;
+    const QPointF ap = point - a;
+    const qreal length = ab.x() * ab.x() + ab.y() * ab.y();
+    qreal t = 0.0;
+    if ( length > 0.0 ) {
+        t = qBound( qreal( 0.0 ), ( ap.x() * ab.x() + ap.y() * ab.y() ) / length, qreal( 1.0 ) );
+    }
+    const QPointF delta = ap - t * ab;
+    return delta.x() * delta.x() + delta.y() * delta.y();
+}
+
+/**
+ * Douglas-Peucker simplification of @p coordinates to @p tolerance degrees.
+ * The first and the last point are always kept.
+ */
+static QVector<GeoDataCoordinates> simplify( const QVector<GeoDataCoordinates> &coordinates, qreal tolerance )
+{
+    const int size = coordinates.size();
+    if ( size < 3 || tolerance <= 0.0 ) {
+        return coordinates;
+    }
+
+    QVector<QPointF> points( size );
+    for ( int i = 0; i < size; ++i ) {
+        points[i] = toPoint( coordinates.at( i ) );
+    }
+
+    QVector<bool> keep( size, false );
+    keep[0] = true;
+    keep[size - 1] = true;
+
+    const qreal squaredTolerance = tolerance * tolerance;
+    QStack<QPair<int, int> > ranges;
+    ranges.push( qMakePair( 0, size - 1 ) );
+    while ( !ranges.isEmpty() ) {
+        const QPair<int, int> range = ranges.pop();
+        qreal maximum = squaredTolerance;
+        int farthest = -1;
+        for ( int i = range.first + 1; i < range.second; ++i ) {
+            const qreal distance = squaredDistance( points.at( i ), points.at( range.first ), points.at( range.second ) );
+            if ( distance > maximum ) {
+                maximum = distance;
+                farthest = i;
+            }
+        }
+
+        if ( farthest != -1 ) {
+            keep[farthest] = true;
+            ranges.push( qMakePair( range.first, farthest ) );
+            ranges.push( qMakePair( farthest, range.second ) );
+        }
+    }
+
+    QVector<GeoDataCoordinates> result;
+    for ( int i = 0; i < size; ++i ) {
+        if ( keep.at( i ) ) {
+            result.append( coordinates.at( i ) );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Cuts a line into pieces whose bounding boxes are no larger than a tile.
+ * Consecutive pieces share their end points. Segments longer than half a
+ * tile are divided first and lines crossing the date line are split there.
+ */
+class LinePieces
+{
+ public:
+    LinePieces( qreal width, qreal height )
+        : m_width( width ),
+          m_height( height ),
+          m_west( 0.0 ),
+          m_east( 0.0 ),
+          m_south( 0.0 ),
+          m_north( 0.0 )
+    {
+    }
+
+    void append( const GeoDataCoordinates &coordinates )
+    {
+        const QPointF point = toPoint( coordinates );
+        if ( !m_piece.isEmpty() ) {
+            const GeoDataCoordinates last = m_piece.last();
+            const qreal deltaLon = point.x() - m_last.x();
+            const qreal deltaLat = point.y() - m_last.y();
+            const qreal deltaAlt = coordinates.altitude() - last.altitude();
+            if ( qAbs( deltaLon ) > 180.0 ) {
+                const qreal unwrapped = deltaLon > 0.0 ? deltaLon - 360.0 : deltaLon + 360.0;
+                const qreal border = unwrapped > 0.0 ? 180.0 : -180.0;
+                const qreal t = ( border - m_last.x() ) / unwrapped;
+                const qreal lat = m_last.y() + t * deltaLat;
+                const qreal alt = last.altitude() + t * deltaAlt;
+                append( GeoDataCoordinates( border, lat, alt, GeoDataCoordinates::Degree ) );
+                finish();
+                append( GeoDataCoordinates( -border, lat, alt, GeoDataCoordinates::Degree ) );
+                append( coordinates );
+                return;
+            }
+
+            const int steps = qCeil( qMax( qAbs( deltaLon ) / ( m_width / 2 ),
+                                           qAbs( deltaLat ) / ( m_height / 2 ) ) );
+            const QPointF start = m_last;
+            for ( int i = 1; i < steps; ++i ) {
+                const qreal t = qreal( i ) / steps;
+                const GeoDataCoordinates between( start.x() + t * deltaLon, start.y() + t * deltaLat,
+                                                  last.altitude() + t * deltaAlt, GeoDataCoordinates::Degree );
+                add( between, toPoint( between ) );
+            }
+        }
+
+        add( coordinates, point );
+    }
+
+    void finish()
+    {
+        if ( m_piece.size() > 1 ) {
+            m_pieces.append( m_piece );
+        }
+        m_piece.clear();
+    }
+
+    const QVector<QVector<GeoDataCoordinates> > &pieces() const
+    {
+        return m_pieces;
+    }
+
+ private:
+    void add( const GeoDataCoordinates &coordinates, const QPointF &point )
+    {
+        if ( m_piece.isEmpty() ) {
+            m_west = m_east = point.x();
+            m_south = m_north = point.y();
+        }
+        else {
+            const qreal west = qMin( m_west, point.x() );
+            const qreal east = qMax( m_east, point.x() );
+            const qreal south = qMin( m_south, point.y() );
+            const qreal north = qMax( m_north, point.y() );
+            if ( east - west > m_width || north - south > m_height ) {
+                const GeoDataCoordinates last = m_piece.last();
+                m_pieces.append( m_piece );
+                m_piece.clear();
+                m_piece.append( last );
+                m_west = qMin( m_last.x(), point.x() );
+                m_east = qMax( m_last.x(), point.x() );
+                m_south = qMin( m_last.y(), point.y() );
+                m_north = qMax( m_last.y(), point.y() );
+            }
+            else {
+                m_west = west;
+                m_east = east;
+                m_south = south;
+                m_north = north;
+            }
+        }
+
+        m_piece.append( coordinates );
+        m_last = point;
+    }
+
+    const qreal m_width;
+    const qreal m_height;
+    QVector<GeoDataCoordinates> m_piece;
+    QPointF m_last;
+    qreal m_west;
+    qreal m_east;
+    qreal m_south;
+    qreal m_north;
+    QVector<QVector<GeoDataCoordinates> > m_pieces;
+};
+
+class VectorTileCreatorPrivate
+{
+ public:
+    struct Tile
+    {
+        Tile() : placemarks( 0 ), coordinates( 0 ) {}
+
+        QByteArray data;
+        qint32 placemarks;
+        qint32 coordinates;
+    };
+
+    explicit VectorTileCreatorPrivate( const GeoDataDocument *document );
+
+    void collectPlacemarks( const GeoDataContainer *container );
+
+    int styleIndex( const GeoDataStyle *style );
+
+    void setLevel( int level );
+
+    /**
+     * Whether a feature of @p bounds is large enough for the current level.
+     */
+    bool isVisible( const QRectF &bounds ) const;
+
+    bool fitsTile( const QRectF &bounds ) const;
+
+    void addGeometry( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry );
+
+    void addLine( const GeoDataPlacemark *placemark, QVector<GeoDataCoordinates> coordinates,
+                  TessellationFlags flags, bool closed );
+
+    void addRing( const GeoDataPlacemark *placemark, const GeoDataLinearRing *ring );
+
+    void addPolygon( const GeoDataPlacemark *placemark, const GeoDataPolygon *polygon );
+
+    /**
+     * Stores @p placemark with @p geometry in the tile of the center of
+     * @p bounds. Takes ownership of @p geometry.
+     */
+    void addPiece( const GeoDataPlacemark *placemark, GeoDataGeometry *geometry,
+                   const QRectF &bounds, int coordinates );
+
+    bool writeTiles( const QString &directory );
+
+    bool writeIndex( const QString &directory );
+
+    const GeoDataDocument *const m_document;
+    int m_maximumLevel;
+    QString m_errorString;
+
+    QVector<const GeoDataPlacemark*> m_placemarks;
+    QVector<const GeoDataStyle*> m_styles;
+    QHash<const GeoDataStyle*, int> m_styleIndex;
+
+    // The level being created and its tiles
+    int m_level;
+    qreal m_tileWidth;
+    qreal m_tileHeight;
+    qreal m_tolerance;
+    QMap<TileId, Tile> m_tiles;
+
+    // The tiles of the finished levels
+    QVector<QPair<TileId, Tile> > m_index;
+};
+
+VectorTileCreatorPrivate::VectorTileCreatorPrivate( const GeoDataDocument *document )
+    : m_document( document ),
+      m_maximumLevel( 10 ),
+      m_level( 0 ),
+      m_tileWidth( 360.0 ),
+      m_tileHeight( 180.0 ),
+      m_tolerance( 0.0 )
+{
+}
+
+void VectorTileCreatorPrivate::collectPlacemarks( const GeoDataContainer *container )
+{
+    foreach ( const GeoDataFeature *feature, container->featureList() ) {
+        if ( feature->nodeType() == GeoDataTypes::GeoDataPlacemarkType ) {
+            m_placemarks.append( static_cast<const GeoDataPlacemark*>( feature ) );
+        }
+        else if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType
+                  || feature->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+            collectPlacemarks( static_cast<const GeoDataContainer*>( feature ) );
+        }
+    }
+}
+
+int VectorTileCreatorPrivate::styleIndex( const GeoDataStyle *style )
+{
+    if ( !style ) {
+        return -1;
+    }
+
+    QHash<const GeoDataStyle*, int>::const_iterator it = m_styleIndex.constFind( style );
+    if ( it != m_styleIndex.constEnd() ) {
+        return it.value();
+    }
+
+    const int index = m_styles.size();
+    m_styles.append( style );
+    m_styleIndex.insert( style, index );
+    return index;
+}
+
+void VectorTileCreatorPrivate::setLevel( int level )
+{
+    m_level = level;
+    m_tileWidth = 360.0 / ( 1 << level );
+    m_tileHeight = 180.0 / ( 1 << level );
+    m_tolerance = level < m_maximumLevel ? VectorTileCreator::tolerance( level ) : 0.0;
+}
+
+bool VectorTileCreatorPrivate::isVisible( const QRectF &bounds ) const
+{
+    return m_level == m_maximumLevel
+        || bounds.width() >= m_tolerance || bounds.height() >= m_tolerance;
+}
+
+bool VectorTileCreatorPrivate::fitsTile( const QRectF &bounds ) const
+{
+    return bounds.width() <= m_tileWidth && bounds.height() <= m_tileHeight;
+}
+
+void VectorTileCreatorPrivate::addGeometry( const GeoDataPlacemark *placemark, const GeoDataGeometry *geometry )
+{
+    if ( geometry->nodeType() == GeoDataTypes::GeoDataPointType ) {
+        if ( m_level == m_maximumLevel ) {
+            const GeoDataPoint *point = static_cast<const GeoDataPoint*>( geometry );
+            addPiece( placemark, new GeoDataPoint( *point ),
+                      QRectF( toPoint( *point ), QSizeF( 0.0, 0.0 ) ), 1 );
+        }
+    }
+    else if ( geometry->nodeType() == GeoDataTypes::GeoDataLineStringType ) {
+        const GeoDataLineString *lineString = static_cast<const GeoDataLineString*>( geometry );
+        addLine( placemark, coordinatesOf( *lineString ), lineString->tessellationFlags(), false );
+    }
+    else if ( geometry->nodeType() == GeoDataTypes::GeoDataLinearRingType ) {
+        addRing( placemark, static_cast<const GeoDataLinearRing*>( geometry ) );
+    }
+    else if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+        addPolygon( placemark, static_cast<const GeoDataPolygon*>( geometry ) );
+    }
+    else if ( geometry->nodeType() == GeoDataTypes::GeoDataMultiGeometryType ) {
+        const GeoDataMultiGeometry *multiGeometry = static_cast<const GeoDataMultiGeometry*>( geometry );
+        for ( int i = 0; i < multiGeometry->size(); ++i ) {
+            addGeometry( placemark, multiGeometry->child( i ) );
+        }
+    }
+    else if ( geometry->nodeType() == GeoDataTypes::GeoDataTrackType ) {
+        const GeoDataLineString *lineString = static_cast<const GeoDataTrack*>( geometry )->lineString();
+        addLine( placemark, coordinatesOf( *lineString ), lineString->tessellationFlags(), false );
+    }
+}
+
+void VectorTileCreatorPrivate::addLine( const GeoDataPlacemark *placemark, QVector<GeoDataCoordinates> coordinates,
+                                        TessellationFlags flags, bool closed )
+{
+    if ( closed && !coordinates.isEmpty() ) {
+        coordinates.append( coordinates.first() );
+    }
+
+    if ( coordinates.size() < 2 || !isVisible( boundsOf( coordinates ) ) ) {
+        return;
+    }
+
+    LinePieces pieces( m_tileWidth, m_tileHeight );
+    foreach ( const GeoDataCoordinates &point, simplify( coordinates, m_tolerance ) ) {
+        pieces.append( point );
+    }
+    pieces.finish();
+
+    foreach ( const QVector<GeoDataCoordinates> &piece, pieces.pieces() ) {
+        GeoDataLineString *lineString = new GeoDataLineString( flags );
+        lineString->append( piece );
+        addPiece( placemark, lineString, boundsOf( piece ), piece.size() );
+    }
+}
+
+void VectorTileCreatorPrivate::addRing( const GeoDataPlacemark *placemark, const GeoDataLinearRing *ring )
+{
+    const QVector<GeoDataCoordinates> coordinates = coordinatesOf( *ring );
+    const QRectF bounds = boundsOf( coordinates );
+    if ( coordinates.size() < 3 || !isVisible( bounds ) ) {
+        return;
+    }
+
+    if ( !fitsTile( bounds ) ) {
+        addLine( placemark, coordinates, ring->tessellationFlags(), true );
+        return;
+    }
+
+    const QVector<GeoDataCoordinates> simplified = simplify( coordinates, m_tolerance );
+    if ( simplified.size() >= 3 ) {
+        GeoDataLinearRing *result = new GeoDataLinearRing( ring->tessellationFlags() );
+        result->append( simplified );
+        addPiece( placemark, result, bounds, simplified.size() );
+    }
+}
+
+void VectorTileCreatorPrivate::addPolygon( const GeoDataPlacemark *placemark, const GeoDataPolygon *polygon )
+{
+    const QVector<GeoDataCoordinates> outer = coordinatesOf( polygon->outerBoundary() );
+    const QRectF bounds = boundsOf( outer );
+    if ( outer.size() < 3 || !isVisible( bounds ) ) {
+        return;
+    }
+
+    if ( !fitsTile( bounds ) ) {
+        addLine( placemark, outer, polygon->tessellationFlags(), true );
+        foreach ( const GeoDataLinearRing &inner, polygon->innerBoundaries() ) {
+            addLine( placemark, coordinatesOf( inner ), polygon->tessellationFlags(), true );
+        }
+        return;
+    }
+
+    const QVector<GeoDataCoordinates> simplified = simplify( outer, m_tolerance );
+    if ( simplified.size() < 3 ) {
+        return;
+    }
+
+    GeoDataPolygon *result = new GeoDataPolygon( polygon->tessellationFlags() );
+    GeoDataLinearRing outerBoundary;
+    outerBoundary.append( simplified );
+    result->setOuterBoundary( outerBoundary );
+    int count = simplified.size();
+
+    foreach ( const GeoDataLinearRing &inner, polygon->innerBoundaries() ) {
+        const QVector<GeoDataCoordinates> coordinates = coordinatesOf( inner );
+        if ( coordinates.size() < 3 || !isVisible( boundsOf( coordinates ) ) ) {
+            continue;
+        }
+        const QVector<GeoDataCoordinates> simplifiedInner = simplify( coordinates, m_tolerance );
+        if ( simplifiedInner.size() >= 3 ) {
+            GeoDataLinearRing innerBoundary;
+            innerBoundary.append( simplifiedInner );
+            result->appendInnerBoundary( innerBoundary );
+            count += simplifiedInner.size();
+        }
+    }
+
+    addPiece( placemark, result, bounds, count );
+}
+
+void VectorTileCreatorPrivate::addPiece( const GeoDataPlacemark *placemark, GeoDataGeometry *geometry,
+                                         const QRectF &bounds, int coordinates )
+{
+    // Copying the placemark would make its geometry a child of the copy, so
+    // the packed fields go into a placemark of its own
+    GeoDataPlacemark piece;
+    piece.setId( placemark->id() );
+    piece.setTargetId( placemark->targetId() );
+    piece.setName( placemark->name() );
+    piece.setAddress( placemark->address() );
+    piece.setPhoneNumber( placemark->phoneNumber() );
+    piece.setDescription( placemark->description() );
+    piece.setVisible( placemark->isVisible() );
+    piece.setRole( placemark->role() );
+    piece.setPopularity( placemark->popularity() );
+    piece.setPopularityIndex( placemark->popularityIndex() );
+    piece.setCountryCode( placemark->countryCode() );
+    piece.setArea( placemark->area() );
+    piece.setPopulation( placemark->population() );
+    piece.setGeometry( geometry );
+
+    const QPointF center = bounds.center();
+    const TileId id( "", m_level, VectorTileCreator::tileX( center.x(), m_level ),
+                     VectorTileCreator::tileY( center.y(), m_level ) );
+    Tile &tile = m_tiles[id];
+
+    // The visual category and the style are not part of the packed feature
+    QDataStream stream( &tile.data, QIODevice::WriteOnly | QIODevice::Append );
+    stream << qint32( placemark->visualCategory() ) << qint32( styleIndex( placemark->style() ) );
+    piece.pack( stream );
+
+    ++tile.placemarks;
+    tile.coordinates += coordinates;
+}
+
+bool VectorTileCreatorPrivate::writeTiles( const QString &directory )
+{
+    QMap<TileId, Tile>::const_iterator it = m_tiles.constBegin();
+    for ( ; it != m_tiles.constEnd(); ++it ) {
+        const TileId &id = it.key();
+        const QString fileName = VectorTileCreator::tileFileName( directory, id.zoomLevel(), id.x(), id.y() );
+        QDir().mkpath( QFileInfo( fileName ).path() );
+
+        QFile file( fileName );
+        if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+            m_errorString = QString( "Unable to write %1: %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+
+        QDataStream stream( &file );
+        stream << quint32( VectorTileCreator::TileMagic ) << qint32( VectorTileCreator::Version )
+               << it.value().placemarks;
+        stream.writeRawData( it.value().data.constData(), it.value().data.size() );
+        if ( stream.status() != QDataStream::Ok ) {
+            m_errorString = QString( "Unable to write %1: %2" ).arg( fileName ).arg( file.errorString() );
+            return false;
+        }
+
+        Tile entry;
+        entry.placemarks = it.value().placemarks;
+        entry.coordinates = it.value().coordinates;
+        m_index.append( qMakePair( id, entry ) );
+    }
+
+    return true;
+}
+
+bool VectorTileCreatorPrivate::writeIndex( const QString &directory )
+{
+    const QString fileName = VectorTileCreator::indexFileName( directory );
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        m_errorString = QString( "Unable to write %1: %2" ).arg( fileName ).arg( file.errorString() );
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream << quint32( VectorTileCreator::IndexMagic ) << qint32( VectorTileCreator::Version )
+           << qint32( m_maximumLevel );
+
+    stream << qint32( m_styles.size() );
+    foreach ( const GeoDataStyle *style, m_styles ) {
+        style->pack( stream );
+    }
+
+    stream << qint32( m_index.size() );
+    for ( int i = 0; i < m_index.size(); ++i ) {
+        const TileId &id = m_index.at( i ).first;
+        const Tile &tile = m_index.at( i ).second;
+        stream << qint32( id.zoomLevel() ) << qint32( id.x() ) << qint32( id.y() )
+               << tile.placemarks << tile.coordinates;
+    }
+
+    if ( stream.status() != QDataStream::Ok ) {
+        m_errorString = QString( "Unable to write %1: %2" ).arg( fileName ).arg( file.errorString() );
+        return false;
+    }
+
+    return true;
+}
+
+VectorTileCreator::VectorTileCreator( const GeoDataDocument *document )
+    : d( new VectorTileCreatorPrivate( document ) )
+{
+}
+
+VectorTileCreator::~VectorTileCreator()
+{
+    delete d;
+}
+
+void VectorTileCreator::setMaximumLevel( int level )
+{
+    d->m_maximumLevel = qBound( 0, level, 20 );
+}
+
+int VectorTileCreator::maximumLevel() const
+{
+    return d->m_maximumLevel;
+}
+
+bool VectorTileCreator::create( const QString &directory )
+{
+    d->m_errorString.clear();
+    d->m_placemarks.clear();
+    d->m_styles.clear();
+    d->m_styleIndex.clear();
+    d->m_index.clear();
+
+    if ( !QDir().mkpath( directory ) ) {
+        d->m_errorString = QString( "Unable to create %1" ).arg( directory );
+        return false;
+    }
+
+    d->collectPlacemarks( d->m_document );
+
+    // One level at a time, so only the tiles of a single level are kept in memory
+    for ( int level = 0; level <= d->m_maximumLevel; ++level ) {
+        d->setLevel( level );
+        foreach ( const GeoDataPlacemark *placemark, d->m_placemarks ) {
+            if ( placemark->geometry() ) {
+                d->addGeometry( placemark, placemark->geometry() );
+            }
+        }
+
+        const bool written = d->writeTiles( directory );
+        mDebug() << "Created" << d->m_tiles.size() << "vector tiles of level" << level;
+        d->m_tiles.clear();
+        if ( !written ) {
+            return false;
+        }
+    }
+
+    return d->writeIndex( directory );
+}
+
+QString VectorTileCreator::errorString() const
+{
+    return d->m_errorString;
+}
+
+QString VectorTileCreator::indexFileName( const QString &directory )
+{
+    return directory + "/index.tiles";
+}
+
+QString VectorTileCreator::tileFileName( const QString &directory, int level, int x, int y )
+{
+    return directory + QString( "/%1/%2/%2_%3.tile" )
+                       .arg( level )
+                       .arg( y, 6, 10, QChar( '0' ) )
+                       .arg( x, 6, 10, QChar( '0' ) );
+}
+
+int VectorTileCreator::tileX( qreal lon, int level )
+{
+    const int count = 1 << level;
+    return qBound( 0, int( ( lon + 180.0 ) / 360.0 * count ), count - 1 );
+}
+
+int VectorTileCreator::tileY( qreal lat, int level )
+{
+    const int count = 1 << level;
+    return qBound( 0, int( ( 90.0 - lat ) / 180.0 * count ), count - 1 );
+}
+
+qreal VectorTileCreator::tolerance( int level )
+{
+    return 360.0 / ( 1 << level ) / TileSize;
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_VECTORTILECREATOR_H
+#define MARBLE_VECTORTILECREATOR_H
+
+#include <QtCore/QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataDocument;
+class VectorTileCreatorPrivate;
+
+/**
+ * @short Splits a large vector document into tiles for the VectorTileLoader.
+ *
+ * The tiles of level n divide the globe into 2^n columns of 360/2^n degrees
+ * and 2^n rows of 180/2^n degrees. Every level holds the whole document,
+ * simplified to a tolerance of about one pixel at the zoom the loader picks
+ * that level for. Features smaller than that are left out of all but the
+ * highest level.
+ *
+ * Line strings are cut into pieces that are no larger than a tile and each
+ * piece is stored in the tile of its center, so a piece never reaches
+ * beyond the neighbors of its tile. Polygons that do not fit into a tile
+ * are stored as outlines. Points are stored in the highest level only.
+ *
+ * The tiles are written in the binary format of the GeoData pack() methods
+ * to directory/level/row/row_column.tile, along with an index of all tiles
+ * and the styles of the document.
+ */
+class MARBLE_EXPORT VectorTileCreator
+{
+ public:
+    enum {
+        IndexMagic = 0x4d565449, // "MVTI"
+        TileMagic = 0x4d565454,  // "MVTT"
+        Version = 1
+    };
+
+    /**
+     * The width in pixels that the tiles of a level have at most on screen
+     * when the loader shows that level.
+     */
+    enum { TileSize = 512 };
+
+    /**
+     * Creates the tiles of @p document, which has to outlive the creator.
+     */
+    explicit VectorTileCreator( const GeoDataDocument *document );
+
+    ~VectorTileCreator();
+
+    /**
+     * The highest level to create, 10 by default.
+     */
+    void setMaximumLevel( int level );
+    int maximumLevel() const;
+
+    /**
+     * Writes the tiles and the index to @p directory, which is created if
+     * needed. Returns false on errors, see errorString().
+     */
+    bool create( const QString &directory );
+
+    QString errorString() const;
+
+    static QString indexFileName( const QString &directory );
+    static QString tileFileName( const QString &directory, int level, int x, int y );
+
+    /**
+     * The column and row of the tile at level @p level containing the given
+     * point in degrees.
+     */
+    static int tileX( qreal lon, int level );
+    static int tileY( qreal lat, int level );
+
+    /**
+     * The simplification tolerance of level @p level in degrees.
+     */
+    static qreal tolerance( int level );
+
+ private:
+    Q_DISABLE_COPY( VectorTileCreator )
+    VectorTileCreatorPrivate * const d;
+};
+
+}
+
+#endif
@@ -0,0 +1,470 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "VectorTileLoader.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QVector>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleDebug.h"
+#include "TileId.h"
+#include "VectorTileCreator.h"
+#include "global.h"
+
+namespace Marble
+{
+
+// Rough memory use of a loaded placemark and of each point of its geometry
+static const qint64 PlacemarkCost = 512;
+static const qint64 CoordinateCost = 112;
+
+class VectorTileLoaderPrivate
+{
+ public:
+    struct Tile
+    {
+        GeoDataFolder *folder;
+        qint64 cost;
+        quint64 lastUse;
+    };
+
+    explicit VectorTileLoaderPrivate( GeoDataTreeModel *treeModel );
+
+    bool readIndex();
+
+    GeoDataFolder *loadTile( const TileId &id ) const;
+
+    /**
+     * The non-empty tiles of @p level covering @p box plus a margin of one
+     * tile, the closest to the center of @p box first.
+     */
+    QList<TileId> tilesOf( const GeoDataLatLonBox &box, int level ) const;
+
+    /**
+     * Deletes the least recently used tile that is not in @p keep. Returns
+     * false if there is none.
+     */
+    bool evictTile( const QSet<TileId> &keep );
+
+    /**
+     * Removes the shown tiles that are not in @p keep from the document,
+     * the others keep their rows in the tree model.
+     */
+    void hideTiles( const QSet<TileId> &keep );
+
+    /**
+     * Appends those of @p tiles that are not shown yet to the document, in
+     * a single row insertion.
+     */
+    void showTiles( const QList<TileId> &tiles );
+
+    GeoDataTreeModel *const m_treeModel;
+    QString m_directory;
+    GeoDataDocument *m_document;
+    int m_maximumLevel;
+    QVector<GeoDataStyle*> m_styles;
+
+    // The estimated memory of all non-empty tiles
+    QHash<TileId, qint64> m_index;
+
+    QHash<TileId, Tile> m_tiles;
+    QList<TileId> m_wanted;
+    QSet<TileId> m_shown;
+    int m_level;
+    qint64 m_memoryLimit;
+    qint64 m_memoryUsage;
+    quint64 m_useCount;
+};
+
+VectorTileLoaderPrivate::VectorTileLoaderPrivate( GeoDataTreeModel *treeModel )
+    : m_treeModel( treeModel ),
+      m_document( 0 ),
+      m_maximumLevel( 0 ),
+      m_level( -1 ),
+      m_memoryLimit( 128 * 1024 * 1024 ),
+      m_memoryUsage( 0 ),
+      m_useCount( 0 )
+{
+}
+
+bool VectorTileLoaderPrivate::readIndex()
+{
+    QFile file( VectorTileCreator::indexFileName( m_directory ) );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        mDebug() << "Unable to open" << file.fileName();
+        return false;
+    }
+
+    QDataStream stream( &file );
+    quint32 magic;
+    qint32 version;
+    stream >> magic >> version;
+    if ( magic != VectorTileCreator::IndexMagic || version != VectorTileCreator::Version ) {
+        mDebug() << "Not an index of vector tiles:" << file.fileName();
+        return false;
+    }
+
+    qint32 maximumLevel;
+    qint32 styles;
+    stream >> maximumLevel >> styles;
+    for ( int i = 0; i < styles && stream.status() == QDataStream::Ok; ++i ) {
+        GeoDataStyle *style = new GeoDataStyle;
+        style->unpack( stream );
+        m_styles.append( style );
+    }
+
+    qint32 tiles;
+    stream >> tiles;
+    for ( int i = 0; i < tiles && stream.status() == QDataStream::Ok; ++i ) {
+        qint32 level, x, y, placemarks, coordinates;
+        stream >> level >> x >> y >> placemarks >> coordinates;
+        m_index.insert( TileId( "", level, x, y ), placemarks * PlacemarkCost + coordinates * CoordinateCost );
+    }
+
+    if ( stream.status() != QDataStream::Ok ) {
+        mDebug() << "Broken index of vector tiles:" << file.fileName();
+        return false;
+    }
+
+    m_maximumLevel = maximumLevel;
+    return true;
+}
+
+GeoDataFolder *VectorTileLoaderPrivate::loadTile( const TileId &id ) const
+{
+    QFile file( VectorTileCreator::tileFileName( m_directory, id.zoomLevel(), id.x(), id.y() ) );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        mDebug() << "Unable to open" << file.fileName();
+        return 0;
+    }
+
+    QDataStream stream( &file );
+    quint32 magic;
+    qint32 version;
+    qint32 count;
+    stream >> magic >> version >> count;
+    if ( magic != VectorTileCreator::TileMagic || version != VectorTileCreator::Version ) {
+        mDebug() << "Not a vector tile:" << file.fileName();
+        return 0;
+    }
+
+    GeoDataFolder *folder = new GeoDataFolder;
+    folder->setName( QString( "%1/%2/%3" ).arg( id.zoomLevel() ).arg( id.y() ).arg( id.x() ) );
+    for ( int i = 0; i < count && stream.status() == QDataStream::Ok; ++i ) {
+        qint32 category;
+        qint32 style;
+        stream >> category >> style;
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemark->unpack( stream );
+        placemark->setVisualCategory( GeoDataFeature::GeoDataVisualCategory( category ) );
+        if ( style >= 0 && style < m_styles.size() ) {
+            placemark->setStyle( m_styles.at( style ) );
+        }
+        folder->append( placemark );
+    }
+
+    if ( stream.status() != QDataStream::Ok ) {
+        mDebug() << "Broken vector tile:" << file.fileName();
+        delete folder;
+        return 0;
+    }
+
+    return folder;
+}
+
+QList<TileId> VectorTileLoaderPrivate::tilesOf( const GeoDataLatLonBox &box, int level ) const
+{
+    const int count = 1 << level;
+    qreal north, south, east, west;
+    box.boundaries( north, south, east, west, GeoDataCoordinates::Degree );
+
+    const int top = qMax( 0, VectorTileCreator::tileY( north, level ) - 1 );
+    const int bottom = qMin( count - 1, VectorTileCreator::tileY( south, level ) + 1 );
+    int left = VectorTileCreator::tileX( west, level ) - 1;
+    int right = VectorTileCreator::tileX( east, level ) + 1;
+    if ( box.crossesDateLine() ) {
+        right += count;
+    }
+    if ( right - left + 1 >= count ) {
+        left = 0;
+        right = count - 1;
+    }
+
+    const GeoDataCoordinates center = box.center();
+    const int centerX = VectorTileCreator::tileX( center.longitude( GeoDataCoordinates::Degree ), level );
+    const int centerY = VectorTileCreator::tileY( center.latitude( GeoDataCoordinates::Degree ), level );
+
+    QList<QPair<int, TileId> > tiles;
+    for ( int y = top; y <= bottom; ++y ) {
+        for ( int column = left; column <= right; ++column ) {
+            const int x = ( column + count ) % count;
+            const TileId id( "", level, x, y );
+            if ( m_index.contains( id ) ) {
+                const int deltaX = qAbs( x - centerX );
+                const int distance = qMax( qMin( deltaX, count - deltaX ), qAbs( y - centerY ) );
+                tiles.append( qMakePair( distance, id ) );
+            }
+        }
+    }
+    qSort( tiles );
+
+    QList<TileId> result;
+    for ( int i = 0; i < tiles.size(); ++i ) {
+        result.append( tiles.at( i ).second );
+    }
+
+    return result;
+}
+
+bool VectorTileLoaderPrivate::evictTile( const QSet<TileId> &keep )
+{
+    QHash<TileId, Tile>::iterator oldest = m_tiles.end();
+    for ( QHash<TileId, Tile>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it ) {
+        if ( !keep.contains( it.key() ) && ( oldest == m_tiles.end() || it->lastUse < oldest->lastUse ) ) {
+            oldest = it;
+        }
+    }
+
+    if ( oldest == m_tiles.end() ) {
+        return false;
+    }
+
+    delete oldest->folder;
+    m_memoryUsage -= oldest->cost;
+    m_tiles.erase( oldest );
+    return true;
+}
+
+void VectorTileLoaderPrivate::hideTiles( const QSet<TileId> &keep )
+{
+    QSet<TileId>::iterator it = m_shown.begin();
+    while ( it != m_shown.end() ) {
+        if ( keep.contains( *it ) ) {
+            ++it;
+            continue;
+        }
+
+        m_treeModel->removeFeature( m_tiles.value( *it ).folder );
+        it = m_shown.erase( it );
+    }
+}
+
+void VectorTileLoaderPrivate::showTiles( const QList<TileId> &tiles )
+{
+    QVector<GeoDataFeature*> folders;
+    foreach ( const TileId &id, tiles ) {
+        if ( !m_shown.contains( id ) ) {
+            folders.append( m_tiles.value( id ).folder );
+            m_shown.insert( id );
+        }
+    }
+    m_treeModel->addFeatures( m_document, folders );
+}
+
+VectorTileLoader::VectorTileLoader( GeoDataTreeModel *treeModel, QObject *parent )
+    : QObject( parent ),
+      d( new VectorTileLoaderPrivate( treeModel ) )
+{
+}
+
+VectorTileLoader::~VectorTileLoader()
+{
+    close();
+    delete d;
+}
+
+bool VectorTileLoader::open( const QString &directory )
+{
+    close();
+
+    d->m_directory = directory;
+    if ( !d->readIndex() ) {
+        close();
+        return false;
+    }
+
+    d->m_document = new GeoDataDocument;
+    d->m_document->setFileName( directory );
+    d->m_document->setName( QFileInfo( directory ).fileName() );
+    d->m_treeModel->addDocument( d->m_document );
+    return true;
+}
+
+void VectorTileLoader::close()
+{
+    if ( d->m_document ) {
+        // The folders belong to the tiles, they are deleted with them
+        d->m_treeModel->removeDocument( d->m_document );
+        while ( d->m_document->size() > 0 ) {
+            d->m_document->remove( d->m_document->size() - 1 );
+        }
+        delete d->m_document;
+        d->m_document = 0;
+    }
+
+    foreach ( const VectorTileLoaderPrivate::Tile &tile, d->m_tiles ) {
+        delete tile.folder;
+    }
+    d->m_tiles.clear();
+    qDeleteAll( d->m_styles );
+    d->m_styles.clear();
+    d->m_index.clear();
+    d->m_wanted.clear();
+    d->m_shown.clear();
+    d->m_directory.clear();
+    d->m_maximumLevel = 0;
+    d->m_level = -1;
+    d->m_memoryUsage = 0;
+}
+
+bool VectorTileLoader::isOpen() const
+{
+    return d->m_document != 0;
+}
+
+QString VectorTileLoader::directory() const
+{
+    return d->m_directory;
+}
+
+int VectorTileLoader::maximumLevel() const
+{
+    return d->m_maximumLevel;
+}
+
+GeoDataDocument *VectorTileLoader::document() const
+{
+    return d->m_document;
+}
+
+void VectorTileLoader::setMemoryLimit( qint64 bytes )
+{
+    d->m_memoryLimit = bytes;
+
+    // The shown tiles stay until the viewport changes
+    const QSet<TileId> shown = d->m_wanted.toSet();
+    while ( d->m_memoryUsage > d->m_memoryLimit && d->evictTile( shown ) ) {
+    }
+}
+
+qint64 VectorTileLoader::memoryLimit() const
+{
+    return d->m_memoryLimit;
+}
+
+qint64 VectorTileLoader::memoryUsage() const
+{
+    return d->m_memoryUsage;
+}
+
+int VectorTileLoader::tileCount() const
+{
+    return d->m_tiles.size();
+}
+
+int VectorTileLoader::level() const
+{
+    return d->m_level;
+}
+
+int VectorTileLoader::levelForRadius( int radius )
+{
+    const qreal tiles = 2 * M_PI * radius / VectorTileCreator::TileSize;
+    int level = 0;
+    while ( level < 30 && ( 1 << level ) < tiles ) {
+        ++level;
+    }
+
+    return level;
+}
+
+void VectorTileLoader::setViewport( const GeoDataLatLonBox &box, int radius )
+{
+    if ( !d->m_document ) {
+        return;
+    }
+
+    const int level = qMin( levelForRadius( radius ), d->m_maximumLevel );
+    const QList<TileId> wanted = d->tilesOf( box, level );
+
+    ++d->m_useCount;
+    foreach ( const TileId &id, wanted ) {
+        QHash<TileId, VectorTileLoaderPrivate::Tile>::iterator it = d->m_tiles.find( id );
+        if ( it != d->m_tiles.end() ) {
+            it->lastUse = d->m_useCount;
+        }
+    }
+
+    if ( level == d->m_level && wanted == d->m_wanted ) {
+        return;
+    }
+
+    d->m_level = level;
+    d->m_wanted = wanted;
+
+    // Tiles leave the document before they may get evicted
+    const QSet<TileId> keep = wanted.toSet();
+    d->hideTiles( keep );
+
+    QList<TileId> shown;
+    bool full = false;
+    foreach ( const TileId &id, wanted ) {
+        if ( d->m_tiles.contains( id ) ) {
+            shown.append( id );
+            continue;
+        }
+        if ( full ) {
+            continue;
+        }
+
+        const qint64 cost = d->m_index.value( id );
+        while ( d->m_memoryUsage + cost > d->m_memoryLimit && d->evictTile( keep ) ) {
+        }
+        if ( d->m_memoryUsage + cost > d->m_memoryLimit ) {
+            // The closer tiles are loaded already, the rest does not fit
+            full = true;
+            continue;
+        }
+
+        GeoDataFolder *folder = d->loadTile( id );
+        if ( !folder ) {
+            d->m_index.remove( id );
+            continue;
+        }
+
+        VectorTileLoaderPrivate::Tile tile;
+        tile.folder = folder;
+        tile.cost = cost;
+        tile.lastUse = d->m_useCount;
+        d->m_tiles.insert( id, tile );
+        d->m_memoryUsage += cost;
+        shown.append( id );
+    }
+
+    if ( full ) {
+        mDebug() << "Memory limit of vector tiles reached, showing" << shown.size() << "of" << wanted.size() << "tiles";
+    }
+
+    d->showTiles( shown );
+}
+
+}
+
+#include "VectorTileLoader.moc"
@@ -0,0 +1,112 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_VECTORTILELOADER_H
+#define MARBLE_VECTORTILELOADER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include "marble_export.h"
+
+namespace Marble
+{
+
+class GeoDataDocument;
+class GeoDataLatLonBox;
+class GeoDataTreeModel;
+class VectorTileLoaderPrivate;
+
+/**
+ * @short Shows the vector tiles of a VectorTileCreator around the viewport.
+ *
+ * The tiles of the level that matches the zoom are loaded as the viewport
+ * moves and shown in a document of the tree model, one folder per tile.
+ * The document stays in the tree model while the tiles are open, only the
+ * folders of tiles that enter or leave the viewport are inserted or removed.
+ * Tiles that leave the viewport are hidden but kept in memory until the
+ * memory limit is reached, then the least recently used ones are deleted.
+ * If the tiles of the viewport alone exceed the limit, those closest to
+ * its center are shown.
+ *
+ * The memory use is estimated from the number of placemarks and points of
+ * the tiles.
+ *
+ * There is one loader per MarbleModel, shared by all maps of the model. It
+ * shows the tiles of the viewport that was set last.
+ */
+class MARBLE_EXPORT VectorTileLoader : public QObject
+{
+    Q_OBJECT
+
+ public:
+    explicit VectorTileLoader( GeoDataTreeModel *treeModel, QObject *parent = 0 );
+
+    ~VectorTileLoader();
+
+    /**
+     * Opens the tiles in @p directory, closing the previous ones. Returns
+     * false if the directory does not contain an index of vector tiles.
+     */
+    bool open( const QString &directory );
+
+    void close();
+
+    bool isOpen() const;
+
+    QString directory() const;
+
+    int maximumLevel() const;
+
+    /**
+     * The document holding the shown tiles, 0 if no tiles are open.
+     */
+    GeoDataDocument *document() const;
+
+    /**
+     * The estimated memory in bytes the loaded tiles may take, 128 MB by default.
+     */
+    void setMemoryLimit( qint64 bytes );
+    qint64 memoryLimit() const;
+
+    /**
+     * The estimated memory in bytes of all loaded tiles, shown or not.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * The number of loaded tiles, shown or not.
+     */
+    int tileCount() const;
+
+    /**
+     * The level shown for the current viewport.
+     */
+    int level() const;
+
+    /**
+     * The tile level whose tiles are at most VectorTileCreator::TileSize
+     * pixels wide on a globe of @p radius pixels.
+     */
+    static int levelForRadius( int radius );
+
+ public Q_SLOTS:
+    /**
+     * Shows the tiles covering @p box plus a margin of one tile, at the level
+     * of @p radius.
+     */
+    void setViewport( const GeoDataLatLonBox &box, int radius );
+
+ private:
+    Q_DISABLE_COPY( VectorTileLoader )
+    VectorTileLoaderPrivate * const d;
+};
+
+}
+
+#endif
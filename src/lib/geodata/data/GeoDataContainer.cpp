@@ -135,14 +135,26 @@ const GeoDataFeature* GeoDataContainer::child( int i ) const
  */
 int GeoDataContainer::childPosition( GeoDataFeature* object )
 {
-    for ( int i=0; i< p()->m_vector.size(); i++ )
-    {
-        if ( p()->m_vector.at( i ) == object )
-        {
-            return i;
+    QHash<const GeoDataFeature*, int> &positions = p()->m_positions;
+    QHash<const GeoDataFeature*, int>::const_iterator position = positions.constFind( object );
+    if ( position == positions.constEnd()
+         || *position >= p()->m_vector.size()
+         || p()->m_vector.at( *position ) != object ) {
+        // Rebuild the outdated index. Going backwards lets the first
+        // occurrence win, as in a linear search.
+        positions.clear();
+        positions.reserve( p()->m_vector.size() );
+        for ( int i = p()->m_vector.size() - 1; i >= 0; --i ) {
+            positions.insert( p()->m_vector.at( i ), i );
+        }
+
+        position = positions.constFind( object );
+        if ( position == positions.constEnd() ) {
+            return -1;
         }
     }
-    return -1;
+
+    return *position;
 }
 
 
@@ -151,12 +163,16 @@ void GeoDataContainer::append( GeoDataFeature *other )
     detach();
     other->setParent(this);
     p()->m_vector.append( other );
+    if ( !p()->m_positions.isEmpty() ) {
+        p()->m_positions.insert( other, p()->m_vector.size() - 1 );
+    }
 }
 
 
 void GeoDataContainer::remove( int index )
 {
     detach();
+    p()->m_positions.remove( p()->m_vector.at( index ) );
     p()->m_vector.remove( index );
 }
 
@@ -203,6 +219,7 @@ void GeoDataContainer::clear()
     GeoDataContainer::detach();
     qDeleteAll(p()->m_vector);
     p()->m_vector.clear();
+    p()->m_positions.clear();
 }
 
 QVector<GeoDataFeature*>::Iterator GeoDataContainer::begin()
@@ -13,6 +13,8 @@
 
 #include "GeoDataFeature_p.h"
 
+#include <QtCore/QHash>
+
 #include "GeoDataTypes.h"
 
 namespace Marble
@@ -33,6 +35,7 @@ class GeoDataContainerPrivate : public GeoDataFeaturePrivate
     void operator=( const GeoDataContainerPrivate &other)
     {
         qDeleteAll( m_vector );
+        m_positions.clear();
         foreach( GeoDataFeature *feature, other.m_vector )
         {
             m_vector.append( new GeoDataFeature( *feature ) );
@@ -57,6 +60,13 @@ class GeoDataContainerPrivate : public GeoDataFeaturePrivate
     }
 
     QVector<GeoDataFeature*> m_vector;
+
+    /**
+     * Positions of the features in m_vector, built on demand by
+     * childPosition(). Entries get outdated when features are removed or
+     * m_vector is changed through iterators, so check them before use.
+     */
+    QHash<const GeoDataFeature*, int> m_positions;
 };
 
 } // namespace Marble
@@ -27,6 +27,7 @@
 #include "GeoDataPlacemark.h"
 #include "GeoDataStyle.h"
 #include "GeoDataStyleMap.h"
+#include "GeoDataTypes.h"
 
 #include "MarbleDebug.h"
 
@@ -77,22 +78,109 @@ void GeoDataDocument::setFileName( const QString &value )
 void GeoDataDocument::addStyle( const GeoDataStyle& style )
 {
     detach();
-    p()->m_styleHash.insert( style.styleId(), style );
+    // Features keep pointers to the stored style, so it is assigned in place
+    GeoDataStyle &stored = p()->m_styleHash[ style.styleId() ];
+    stored = style;
+    if ( !p()->m_styleHandles.contains( style.styleId() ) ) {
+        p()->m_styleHandles.insert( style.styleId(), p()->m_styleTable.size() );
+        p()->m_styleTable.append( &stored );
+    }
 }
 
 void GeoDataDocument::removeStyle( const QString& styleId )
 {
     detach();
+    QHash<QString, int>::iterator handle = p()->m_styleHandles.find( styleId );
+    if ( handle != p()->m_styleHandles.end() ) {
+        p()->m_styleTable[ handle.value() ] = 0;
+        p()->m_styleHandles.erase( handle );
+    }
     p()->m_styleHash.remove( styleId );
 }
 
-GeoDataStyle& GeoDataDocument::style( const QString& styleId ) const
+const GeoDataStyle& GeoDataDocument::style( const QString& styleId ) const
+{
+    const GeoDataStyle *style = styleForHandle( p()->m_styleHandles.value( styleId, -1 ) );
+    return style ? *style : p()->m_emptyStyle;
+}
+
+GeoDataStyle& GeoDataDocument::styleForEditing( const QString& styleId )
+{
+    detach();
+    if ( !p()->m_styleHandles.contains( styleId ) ) {
+        GeoDataStyle style;
+        style.setStyleId( styleId );
+        addStyle( style );
+    }
+
+    return *styleForHandle( p()->m_styleHandles.value( styleId ) );
+}
+
+static QString styleIdOf( const QString &styleUrl )
 {
-    /*
-     * FIXME: m_styleHash always should contain at least default
-     *        GeoDataStyle element
-     */
-    return p()->m_styleHash[ styleId ];
+    return styleUrl.startsWith( QLatin1Char( '#' ) ) ? styleUrl.mid( 1 ) : styleUrl;
+}
+
+int GeoDataDocument::styleHandle( const QString& styleUrl ) const
+{
+    QString styleId = styleIdOf( styleUrl );
+
+    QMap<QString, GeoDataStyleMap>::const_iterator styleMap = p()->m_styleMapHash.constFind( styleId );
+    if ( styleMap != p()->m_styleMapHash.constEnd() ) {
+        const QString normal = styleMap->value( QString( "normal" ) );
+        if ( !normal.isEmpty() ) {
+            styleId = styleIdOf( normal );
+        }
+    }
+
+    return p()->m_styleHandles.value( styleId, -1 );
+}
+
+GeoDataStyle* GeoDataDocument::styleForHandle( int handle ) const
+{
+    if ( handle < 0 || handle >= p()->m_styleTable.size() ) {
+        return 0;
+    }
+
+    return p()->m_styleTable.at( handle );
+}
+
+void GeoDataDocument::resolveStyleUrls()
+{
+    // Many features share few urls, so each url is looked up once
+    QHash<QString, GeoDataStyle*> styles;
+    resolveStyleUrls( this, styles );
+}
+
+void GeoDataDocument::resolveStyleUrls( GeoDataContainer *container, QHash<QString, GeoDataStyle*> &styles )
+{
+    // Without styles only the nested documents are left to resolve
+    const bool hasStyles = !p()->m_styleHandles.isEmpty();
+    QVector<GeoDataFeature*>::ConstIterator it = container->constBegin();
+    QVector<GeoDataFeature*>::ConstIterator const end = container->constEnd();
+    for ( ; it != end; ++it ) {
+        GeoDataFeature *feature = *it;
+        if ( feature->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
+            // Nested documents have styles of their own
+            static_cast<GeoDataDocument*>( feature )->resolveStyleUrls();
+            continue;
+        }
+
+        const QString &styleUrl = feature->d->m_styleUrl;
+        if ( hasStyles && !feature->d->m_style && !styleUrl.isEmpty() ) {
+            QHash<QString, GeoDataStyle*>::const_iterator style = styles.constFind( styleUrl );
+            if ( style == styles.constEnd() ) {
+                style = styles.insert( styleUrl, styleForHandle( styleHandle( styleUrl ) ) );
+            }
+            if ( style.value() ) {
+                feature->setStyle( style.value() );
+            }
+        }
+
+        if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+            resolveStyleUrls( static_cast<GeoDataContainer*>( feature ), styles );
+        }
+    }
 }
 
 QList<GeoDataStyle> GeoDataDocument::styles() const
@@ -112,9 +200,22 @@ void GeoDataDocument::removeStyleMap( const QString& mapId )
     p()->m_styleMapHash.remove( mapId );
 }
 
-GeoDataStyleMap& GeoDataDocument::styleMap( const QString& styleId ) const
+const GeoDataStyleMap& GeoDataDocument::styleMap( const QString& styleId ) const
+{
+    QMap<QString, GeoDataStyleMap>::const_iterator styleMap = p()->m_styleMapHash.constFind( styleId );
+    return styleMap != p()->m_styleMapHash.constEnd() ? styleMap.value() : p()->m_emptyStyleMap;
+}
+
+GeoDataStyleMap& GeoDataDocument::styleMapForEditing( const QString& styleId )
 {
-    return p()->m_styleMapHash[ styleId ];
+    detach();
+    QMap<QString, GeoDataStyleMap>::iterator styleMap = p()->m_styleMapHash.find( styleId );
+    if ( styleMap == p()->m_styleMapHash.end() ) {
+        styleMap = p()->m_styleMapHash.insert( styleId, GeoDataStyleMap() );
+        styleMap->setStyleId( styleId );
+    }
+
+    return styleMap.value();
 }
 
 QList<GeoDataStyleMap> GeoDataDocument::styleMaps() const
@@ -149,7 +250,7 @@ void GeoDataDocument::unpack( QDataStream& stream )
     for( int i = 0; i < size; i++ ) {
         GeoDataStyle style;
         style.unpack( stream );
-        p()->m_styleHash.insert( style.styleId(), style );
+        addStyle( style );
     }
 }
 
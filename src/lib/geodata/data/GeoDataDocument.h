@@ -91,21 +91,60 @@ public:
 
     /**
      * @brief Add a style to the style storage
+     * A style with the same id is replaced in place, so the features
+     * using it pick up the change.
      * @param style  the new style
      */
     void addStyle( const GeoDataStyle& style );
 
     /**
-     * @brief Add a style to the style storage
-     * @param style  the new style
+     * @brief Remove a style from the style storage
+     * @param styleId  the id of the style
      */
     void removeStyle( const QString& styleId );
 
     /**
      * @brief Return a style in the style storage
+     * An empty style that is not part of the document is returned for
+     * unknown ids.
      * @param styleId  the id of the style
      */
-    GeoDataStyle& style( const QString& styleId ) const;
+    const GeoDataStyle& style( const QString& styleId ) const;
+
+    /**
+     * @brief Return a style in the style storage for changing it
+     * An empty style with the id is added for unknown ids, unlike style().
+     * @param styleId  the id of the style
+     */
+    GeoDataStyle& styleForEditing( const QString& styleId );
+
+    /**
+     * @brief Return the handle of the style a style url refers to
+     * Style maps are followed to their "normal" style. The handle stays
+     * the same while the style is in the document, so it may be used to
+     * cache data derived from the style.
+     * @param styleUrl  the style url, e.g. "#id"
+     * @return the handle, -1 if there is no such style
+     */
+    int styleHandle( const QString& styleUrl ) const;
+
+    /**
+     * @brief Return the style of a handle
+     * Changes to the style apply to all features using it.
+     * @param handle  a handle returned by styleHandle()
+     * @return the style, 0 for invalid handles
+     */
+    GeoDataStyle* styleForHandle( int handle ) const;
+
+    /**
+     * @brief Let the features use the styles of their style urls
+     * Style urls that refer to styles added after the url was set, as it
+     * happens when parsing files that define styles at the end, are
+     * resolved here in one pass. Features with a style of their own keep it.
+     * Nested documents resolve the urls of their features with their own
+     * styles.
+     */
+    void resolveStyleUrls();
 
     /**
     * @brief dump a Vector of all styles
@@ -125,10 +164,19 @@ public:
     void removeStyleMap( const QString& mapId );
 
     /**
-     * @brief Return a style in the style storage
-     * @param styleId  the id of the style
+     * @brief Return a stylemap in the stylemap storage
+     * An empty stylemap that is not part of the document is returned for
+     * unknown ids.
+     * @param styleId  the id of the stylemap
      */
-    GeoDataStyleMap& styleMap( const QString& styleId ) const;
+    const GeoDataStyleMap& styleMap( const QString& styleId ) const;
+
+    /**
+     * @brief Return a stylemap in the stylemap storage for changing it
+     * An empty stylemap with the id is added for unknown ids, unlike styleMap().
+     * @param styleId  the id of the stylemap
+     */
+    GeoDataStyleMap& styleMapForEditing( const QString& styleId );
 
     /**
     * @brief dump a Vector of all styles
@@ -142,6 +190,8 @@ public:
 
 private:
     GeoDataDocumentPrivate *p() const;
+
+    void resolveStyleUrls( GeoDataContainer *container, QHash<QString, GeoDataStyle*> &styles );
 };
 
 }
@@ -11,6 +11,9 @@
 #ifndef MARBLE_GEODATADOCUMENTPRIVATE_H
 #define MARBLE_GEODATADOCUMENTPRIVATE_H
 
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
 #include "GeoDataStyle.h"
 #include "GeoDataStyleMap.h"
 #include "GeoDataContainer_p.h"
@@ -32,9 +35,19 @@ class GeoDataDocumentPrivate : public GeoDataContainerPrivate
     { 
         GeoDataDocumentPrivate* copy = new GeoDataDocumentPrivate;
         *copy = *this;
+        copy->updateStyleTable();
         return copy;
     }
 
+    // Points the style table to the styles of this copy of m_styleHash
+    void updateStyleTable()
+    {
+        QHash<QString, int>::const_iterator it = m_styleHandles.constBegin();
+        for ( ; it != m_styleHandles.constEnd(); ++it ) {
+            m_styleTable[ it.value() ] = &m_styleHash[ it.key() ];
+        }
+    }
+
     virtual const char* nodeType() const
     {
         return GeoDataTypes::GeoDataDocumentType;
@@ -47,6 +60,15 @@ class GeoDataDocumentPrivate : public GeoDataContainerPrivate
 
     QMap<QString, GeoDataStyle> m_styleHash;
     QMap<QString, GeoDataStyleMap> m_styleMapHash;
+
+    // The styles of m_styleHash by handle, 0 for removed ones
+    QVector<GeoDataStyle*> m_styleTable;
+    QHash<QString, int> m_styleHandles;
+
+    // Returned for unknown ids, so that looking them up does not add them
+    GeoDataStyle m_emptyStyle;
+    GeoDataStyleMap m_emptyStyleMap;
+
     QString m_filename;
     DocumentRole m_documentRole;
 };
@@ -539,22 +539,17 @@ void GeoDataFeature::setStyleUrl( const QString &value)
 {
     detach();
     d->m_styleUrl = value;
-    QString styleUrl = value;
-    styleUrl.remove('#');
-    GeoDataObject *object = parent();
-    bool found = false;
-    while ( object && !found ) {
+
+    // Styles added later on are picked up by GeoDataDocument::resolveStyleUrls()
+    for ( GeoDataObject *object = parent(); object; object = object->parent() ) {
         if( object->nodeType() == GeoDataTypes::GeoDataDocumentType ) {
-            GeoDataDocument *doc = static_cast<GeoDataDocument*> ( object );
-            GeoDataStyleMap &styleMap = doc->styleMap( styleUrl );
-            if( !styleMap.value( QString( "normal" ) ).isEmpty() ) {
-                styleUrl = styleMap.value( QString( "normal" ) );
-                styleUrl.remove('#');
+            const GeoDataDocument *doc = static_cast<const GeoDataDocument*>( object );
+            GeoDataStyle *style = doc->styleForHandle( doc->styleHandle( value ) );
+            if ( style ) {
+                setStyle( style );
             }
-            setStyle( &doc->style( styleUrl ) );
-            found = true;
+            return;
         }
-        object = object->parent();
     }
 }
 
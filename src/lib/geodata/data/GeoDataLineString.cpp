@@ -213,6 +213,17 @@ void GeoDataLineString::append ( const GeoDataCoordinates& value )
     d->m_vector.append( value );
 }
 
+void GeoDataLineString::append ( const QVector<GeoDataCoordinates>& values )
+{
+    GeoDataGeometry::detach();
+    GeoDataLineStringPrivate* d = p();
+    qDeleteAll( d->m_rangeCorrected );
+    d->m_rangeCorrected.clear();
+    d->m_dirtyRange = true;
+    d->m_dirtyBox = true;
+    d->m_vector += values;
+}
+
 GeoDataLineString& GeoDataLineString::operator << ( const GeoDataCoordinates& value )
 {
     GeoDataGeometry::detach();
@@ -604,7 +615,6 @@ void GeoDataLineString::pack( QDataStream& stream ) const
           = p()->m_vector.constBegin();
          iterator != p()->m_vector.constEnd();
          ++iterator ) {
-        mDebug() << "innerRing: size" << p()->m_vector.size();
         GeoDataCoordinates coord = ( *iterator );
         coord.pack( stream );
     }
@@ -623,6 +633,7 @@ void GeoDataLineString::unpack( QDataStream& stream )
 
     p()->m_tessellationFlags = (TessellationFlags)(tessellationFlags);
 
+    p()->m_vector.reserve( p()->m_vector.size() + size );
     for(qint32 i = 0; i < size; i++ ) {
         GeoDataCoordinates coord;
         coord.unpack( stream );
@@ -279,6 +279,13 @@ class GEODATA_EXPORT GeoDataLineString : public GeoDataGeometry
     void append ( const GeoDataCoordinates& position );
 
 
+/*!
+    \brief Appends the given geodesic positions as new nodes to the LineString.
+    This is faster than appending them one by one.
+*/
+    void append ( const QVector<GeoDataCoordinates>& positions );
+
+
 /*!
     \brief Appends a given geodesic position as a new node to the LineString.
 */
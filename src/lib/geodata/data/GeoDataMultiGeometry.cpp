@@ -196,6 +196,21 @@ GeoDataMultiGeometry& GeoDataMultiGeometry::operator << ( const GeoDataGeometry&
     return *this;
 }
 
+QVector<GeoDataGeometry*>::Iterator GeoDataMultiGeometry::erase ( QVector<GeoDataGeometry*>::Iterator pos )
+{
+    detach();
+    delete *pos;
+    return p()->m_vector.erase( pos );
+}
+
+QVector<GeoDataGeometry*>::Iterator GeoDataMultiGeometry::erase ( QVector<GeoDataGeometry*>::Iterator begin,
+                                                                  QVector<GeoDataGeometry*>::Iterator end )
+{
+    detach();
+    qDeleteAll( begin, end );
+    return p()->m_vector.erase( begin, end );
+}
+
 void GeoDataMultiGeometry::clear()
 {
     detach();
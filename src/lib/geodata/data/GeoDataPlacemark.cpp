@@ -270,6 +270,10 @@ void GeoDataPlacemark::unpack( QDataStream& stream )
             break;
         default: break;
     };
+
+    if ( p()->m_geometry ) {
+        p()->m_geometry->setParent( this );
+    }
 }
 
 }
@@ -21,9 +21,6 @@
 
 #include "KmlCoordinatesTagHandler.h"
 
-#include <QtCore/QStringList>
-#include <QtCore/QRegExp>
-
 #include "MarbleDebug.h"
 #include "KmlElementDictionary.h"
 #include "GeoDataTrack.h"
@@ -32,6 +29,7 @@
 #include "GeoDataLineString.h"
 #include "GeoDataLinearRing.h"
 #include "GeoDataMultiGeometry.h"
+#include "GeoCoordinatesTokenizer.h"
 #include "GeoParser.h"
 #include "global.h"
 
@@ -58,93 +56,41 @@ GeoNode* KmlcoordinatesTagHandler::parse( GeoParser& parser ) const
      || parentItem.represents( kmlTag_LineString )
      || parentItem.represents( kmlTag_MultiGeometry )
      || parentItem.represents( kmlTag_LinearRing ) ) {
-        QStringList  coordinatesLines;// = parser.readElementText().trimmed().split( QRegExp("\\s"), QString::SkipEmptyParts );
-        // Splitting using the "\\s" regexp is slow, split manually instead.
-        QString const text = parser.readElementText().trimmed();
-        int index = 0;
-        bool inside = true;
-        int const size = text.size();
-        for ( int i=0; i<size; ++i ) {
-            if ( text[i].isSpace() ) {
-                if ( inside ) {
-                    coordinatesLines.append( text.mid( index, i-index ) );
-                    inside = false;
-                }
-                index = i+1;
-            } else {
-                inside = true;
-            }
-        }
-        coordinatesLines.append( text.mid( index ) );
-        Q_FOREACH( const QString& line, coordinatesLines ) {
-            QStringList coordinates = line.trimmed().split( ',' );
-            if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
-                GeoDataPoint coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble() );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble(),
-                              coordinates.at( 2 ).toDouble() );
-                }
-                parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coord );
-            } else {
-                GeoDataCoordinates coord;
-                if ( coordinates.size() == 2 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble() );
-                } else if( coordinates.size() == 3 ) {
-                    coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                              DEG2RAD * coordinates.at( 1 ).toDouble(),
-                              coordinates.at( 2 ).toDouble() );
-                }
-
-                if ( parentItem.represents( kmlTag_LineString ) ) {
-                    parentItem.nodeAs<GeoDataLineString>()->append( coord );
-                } else if ( parentItem.represents( kmlTag_LinearRing ) ) {
-                    parentItem.nodeAs<GeoDataLinearRing>()->append( coord );
+        QString const text = parser.readElementText();
+        GeoCoordinatesTokenizer tokenizer( text );
+
+        if ( parentItem.represents( kmlTag_LineString ) ) {
+            tokenizer.appendTo( parentItem.nodeAs<GeoDataLineString>() );
+        } else if ( parentItem.represents( kmlTag_LinearRing ) ) {
+            tokenizer.appendTo( parentItem.nodeAs<GeoDataLinearRing>() );
+        } else {
+            while ( tokenizer.next() ) {
+                if ( parentItem.represents( kmlTag_Point ) && parentItem.is<GeoDataFeature>() ) {
+                    GeoDataPoint coord( tokenizer.coordinates() );
+                    parentItem.nodeAs<GeoDataPlacemark>()->setCoordinate( coord );
                 } else if ( parentItem.represents( kmlTag_MultiGeometry ) ) {
-                    GeoDataPoint *point = new GeoDataPoint;
-                    if ( coordinates.size() == 2 ) {
-                        point->set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                                   DEG2RAD * coordinates.at( 1 ).toDouble() );
-                    } else if ( coordinates.size() == 3 ) {
-                        point->set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                                   DEG2RAD * coordinates.at( 1 ).toDouble(),
-                                   coordinates.at( 2 ).toDouble() );
-                    }
+                    GeoDataPoint *point = new GeoDataPoint( tokenizer.coordinates() );
                     parentItem.nodeAs<GeoDataMultiGeometry>()->append( point );
                 } else if ( parentItem.represents( kmlTag_Point ) ) {
 /*                  mDebug() << "found a free Point!";
                     qreal lon, lat;
                     coord.geoCoordinates(lon, lat);
                     parentItem.nodeAs<GeoDataPoint>()->set(lon, lat, coord.altitude());*/
-                } else {
-                    // raise warning as coordinates out of valid parents found
                 }
             }
+        }
 #ifdef DEBUG_TAGS
         mDebug() << "Parsed <" << parser.name()
-                 << ">" << coordinatesLines
+                 << ">" << text
                  << " parent item name: " << parentItem.qualifiedName().first;
 #endif // DEBUG_TAGS
-
-        }
     }
 
     if( parentItem.represents( kmlTag_Track ) ) {
-        QStringList coordinates = parser.readElementText().trimmed().split( ' ' );
-        GeoDataCoordinates coord;
-        if ( coordinates.size() == 2 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble() );
-        } else if( coordinates.size() == 3 ) {
-            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
-                       DEG2RAD * coordinates.at( 1 ).toDouble(),
-                       coordinates.at( 2 ).toDouble() );
-        }
-        parentItem.nodeAs<GeoDataTrack>()->appendCoordinates( coord );
+        QString const text = parser.readElementText();
+        GeoCoordinatesTokenizer tokenizer( text, QLatin1Char( ' ' ) );
+        tokenizer.next();
+        parentItem.nodeAs<GeoDataTrack>()->appendCoordinates( tokenizer.coordinates() );
     }
 
     return 0;
@@ -52,7 +52,7 @@ GeoNode* KmlStyleMapTagHandler::parse( GeoParser& parser ) const
         mDebug() << "Parsed <" << kmlTag_StyleMap << ">"
                  << " parent item name: " << parentItem.qualifiedName().first;
 #endif
-        return &parentItem.nodeAs<GeoDataDocument>()->styleMap( styleId );
+        return &parentItem.nodeAs<GeoDataDocument>()->styleMapForEditing( styleId );
     } else if( parentItem.is<GeoDataFeature>() ) {
 /*        GeoDataStyleMap styleMap;
         styleMap.setStyleId( parser.attribute( "id" ).trimmed() );
@@ -51,7 +51,7 @@ GeoNode* KmlStyleTagHandler::parse( GeoParser& parser ) const
     mDebug() << "Parsed <" << kmlTag_Style << "> containing: " << &parentItem.nodeAs<GeoDataDocument>()->style( styleId ) << " parentItem: Document "
              << " parent item name: " << parentItem.qualifiedName().first;
 #endif // DEBUG_TAGS
-        return &parentItem.nodeAs<GeoDataDocument>()->style( styleId );
+        return &parentItem.nodeAs<GeoDataDocument>()->styleForEditing( styleId );
     }
     else if ( parentItem.represents( kmlTag_Placemark ) ) {
         GeoDataStyle* style = new GeoDataStyle;
@@ -0,0 +1,109 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoAtomTable.h"
+
+#include <cstring>
+
+namespace Marble
+{
+
+static inline uint hashChars( const QChar *data, int size )
+{
+    uint hash = 0;
+    for ( int i = 0; i < size; ++i ) {
+        hash = 31 * hash + data[i].unicode();
+    }
+
+    return hash;
+}
+
+GeoAtomTable::GeoAtomTable()
+    : m_buckets( 64, -1 )
+{
+}
+
+int GeoAtomTable::atom( const QStringRef &text )
+{
+    return atom( text.unicode(), text.size() );
+}
+
+int GeoAtomTable::atom( const QString &text )
+{
+    return atom( text.constData(), text.size() );
+}
+
+int GeoAtomTable::atom( const char *text )
+{
+    QHash<const char*, int>::const_iterator it = m_literals.constFind( text );
+    if ( it != m_literals.constEnd() ) {
+        return it.value();
+    }
+
+    const QString string = QString::fromLatin1( text );
+    const int result = atom( string.constData(), string.size() );
+    m_literals.insert( text, result );
+    return result;
+}
+
+QString GeoAtomTable::string( int atom ) const
+{
+    Q_ASSERT( atom >= 0 && atom < m_strings.size() );
+    return m_strings.at( atom );
+}
+
+int GeoAtomTable::size() const
+{
+    return m_strings.size();
+}
+
+int GeoAtomTable::atom( const QChar *data, int size )
+{
+    const uint hash = hashChars( data, size );
+    const int mask = m_buckets.size() - 1;
+    for ( int i = hash & mask; m_buckets.at( i ) >= 0; i = ( i + 1 ) & mask ) {
+        const int candidate = m_buckets.at( i );
+        if ( m_hashes.at( candidate ) != hash ) {
+            continue;
+        }
+        const QString &string = m_strings.at( candidate );
+        if ( string.size() == size
+             && memcmp( string.constData(), data, size * sizeof( QChar ) ) == 0 ) {
+            return candidate;
+        }
+    }
+
+    const int result = m_strings.size();
+    m_strings.append( QString( data, size ) );
+    m_hashes.append( hash );
+
+    // Keep the buckets at most half full so that probing stays short
+    if ( 2 * m_strings.size() > m_buckets.size() ) {
+        m_buckets.fill( -1, 2 * m_buckets.size() );
+        for ( int i = 0; i < m_strings.size(); ++i ) {
+            insertBucket( i );
+        }
+    }
+    else {
+        insertBucket( result );
+    }
+
+    return result;
+}
+
+void GeoAtomTable::insertBucket( int atom )
+{
+    const int mask = m_buckets.size() - 1;
+    int i = m_hashes.at( atom ) & mask;
+    while ( m_buckets.at( i ) >= 0 ) {
+        i = ( i + 1 ) & mask;
+    }
+    m_buckets[i] = atom;
+}
+
+}
@@ -0,0 +1,72 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_GEOATOMTABLE_H
+#define MARBLE_GEOATOMTABLE_H
+
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "geodata_export.h"
+
+namespace Marble
+{
+
+/**
+ * @short Maps strings like tag names and namespaces to small integers.
+ *
+ * Each distinct string gets an atom, so comparing two strings boils down to
+ * comparing their atoms. Looking up the atom of a QStringRef as returned by
+ * QXmlStreamReader::name() does not create a QString, only strings that are
+ * seen for the first time are copied into the table.
+ *
+ * The table is not thread-safe, every parser keeps its own one.
+ */
+class GEODATA_EXPORT GeoAtomTable
+{
+ public:
+    GeoAtomTable();
+
+    /**
+     * The atom of @p text, it is added to the table if needed.
+     */
+    int atom( const QStringRef &text );
+    int atom( const QString &text );
+
+    /**
+     * The atom of the Latin-1 string @p text. The atom is remembered by the
+     * address of @p text, so it has to be a string that is never modified,
+     * like the tag name constants of the element dictionaries.
+     */
+    int atom( const char *text );
+
+    /**
+     * The string represented by @p atom.
+     */
+    QString string( int atom ) const;
+
+    /**
+     * The number of distinct strings in the table.
+     */
+    int size() const;
+
+ private:
+    int atom( const QChar *data, int size );
+    void insertBucket( int atom );
+
+    QVector<QString> m_strings;
+    QVector<uint> m_hashes;
+    // Open addressing, -1 marks an empty bucket
+    QVector<int> m_buckets;
+    QHash<const char*, int> m_literals;
+};
+
+}
+
+#endif
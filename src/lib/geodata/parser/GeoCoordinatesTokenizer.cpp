@@ -0,0 +1,252 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoCoordinatesTokenizer.h"
+
+#include <QtCore/QVector>
+
+#include "GeoDataCoordinates.h"
+#include "GeoDataLineString.h"
+#include "global.h"
+
+namespace Marble
+{
+
+// Powers of ten that are exact in a double
+static const double s_powersOfTen[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline int digitValue( const QChar &c )
+{
+    return c.unicode() - '0';
+}
+
+static inline bool isDigit( const QChar &c )
+{
+    return c.unicode() >= '0' && c.unicode() <= '9';
+}
+
+/**
+ * Converts decimal numbers whose digits fit into 53 bits and whose exponent
+ * is at most 22. Both the digits and the power of ten are exact then, so a
+ * single multiplication or division rounds correctly like strtod() does.
+ * Returns false for everything else.
+ */
+static bool parseDecimal( const QChar *begin, const QChar *end, qreal *result )
+{
+    const QChar *p = begin;
+    bool negative = false;
+    if ( p != end && ( *p == QLatin1Char( '-' ) || *p == QLatin1Char( '+' ) ) ) {
+        negative = ( *p == QLatin1Char( '-' ) );
+        ++p;
+    }
+
+    quint64 mantissa = 0;
+    int digits = 0;
+    // Zeros following the last non-zero digit, they are only multiplied
+    // into the mantissa if another non-zero digit follows
+    int trailingZeros = 0;
+    int fractionDigits = 0;
+    bool seenDigit = false;
+    bool fraction = false;
+    for ( ; p != end; ++p ) {
+        if ( *p == QLatin1Char( '.' ) && !fraction ) {
+            fraction = true;
+            continue;
+        }
+        if ( !isDigit( *p ) ) {
+            break;
+        }
+
+        seenDigit = true;
+        if ( fraction ) {
+            ++fractionDigits;
+        }
+        const int digit = digitValue( *p );
+        if ( digit == 0 ) {
+            if ( mantissa != 0 ) {
+                ++trailingZeros;
+            }
+            continue;
+        }
+
+        digits += trailingZeros + 1;
+        if ( digits > 19 ) {
+            return false;
+        }
+        for ( ; trailingZeros > 0; --trailingZeros ) {
+            mantissa *= 10;
+        }
+        mantissa = mantissa * 10 + digit;
+    }
+
+    if ( !seenDigit ) {
+        return false;
+    }
+
+    int exponent = 0;
+    if ( p != end && ( *p == QLatin1Char( 'e' ) || *p == QLatin1Char( 'E' ) ) ) {
+        ++p;
+        bool negativeExponent = false;
+        if ( p != end && ( *p == QLatin1Char( '-' ) || *p == QLatin1Char( '+' ) ) ) {
+            negativeExponent = ( *p == QLatin1Char( '-' ) );
+            ++p;
+        }
+        if ( p == end ) {
+            return false;
+        }
+        for ( ; p != end && isDigit( *p ); ++p ) {
+            if ( exponent < 10000 ) {
+                exponent = exponent * 10 + digitValue( *p );
+            }
+        }
+        if ( negativeExponent ) {
+            exponent = -exponent;
+        }
+    }
+
+    if ( p != end ) {
+        return false;
+    }
+
+    if ( mantissa == 0 ) {
+        *result = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    exponent += trailingZeros - fractionDigits;
+    if ( mantissa > ( Q_UINT64_C( 1 ) << 53 ) || exponent < -22 || exponent > 22 ) {
+        return false;
+    }
+
+    double value = double( mantissa );
+    if ( exponent < 0 ) {
+        value /= s_powersOfTen[-exponent];
+    }
+    else {
+        value *= s_powersOfTen[exponent];
+    }
+
+    *result = negative ? -value : value;
+    return true;
+}
+
+GeoCoordinatesTokenizer::GeoCoordinatesTokenizer( const QString &text, QChar separator )
+    : m_position( text.constData() ),
+      m_end( text.constData() + text.size() ),
+      m_separator( separator ),
+      m_size( 0 )
+{
+    for ( int i = 0; i < MaxValues; ++i ) {
+        m_values[i] = 0.0;
+    }
+}
+
+bool GeoCoordinatesTokenizer::next()
+{
+    while ( m_position != m_end && m_position->isSpace() ) {
+        ++m_position;
+    }
+
+    if ( m_position == m_end ) {
+        m_size = 0;
+        return false;
+    }
+
+    const QChar *begin = m_position;
+    if ( m_separator.isSpace() ) {
+        const QChar *end = m_end;
+        while ( end[-1].isSpace() ) {
+            --end;
+        }
+        m_position = m_end;
+        readTuple( begin, end );
+    }
+    else {
+        while ( m_position != m_end && !m_position->isSpace() ) {
+            ++m_position;
+        }
+        readTuple( begin, m_position );
+    }
+
+    return true;
+}
+
+void GeoCoordinatesTokenizer::readTuple( const QChar *begin, const QChar *end )
+{
+    m_size = 0;
+    const QChar *value = begin;
+    for ( const QChar *p = begin; ; ++p ) {
+        if ( p == end || *p == m_separator ) {
+            if ( m_size < MaxValues ) {
+                m_values[m_size] = toDouble( value, p );
+            }
+            ++m_size;
+            if ( p == end ) {
+                break;
+            }
+            value = p + 1;
+        }
+    }
+}
+
+int GeoCoordinatesTokenizer::size() const
+{
+    return m_size;
+}
+
+qreal GeoCoordinatesTokenizer::value( int index ) const
+{
+    Q_ASSERT( index >= 0 && index < MaxValues && index < m_size );
+    return m_values[index];
+}
+
+GeoDataCoordinates GeoCoordinatesTokenizer::coordinates() const
+{
+    GeoDataCoordinates coordinates;
+    if ( m_size == 2 ) {
+        coordinates.set( DEG2RAD * m_values[0], DEG2RAD * m_values[1] );
+    }
+    else if ( m_size == 3 ) {
+        coordinates.set( DEG2RAD * m_values[0], DEG2RAD * m_values[1], m_values[2] );
+    }
+
+    return coordinates;
+}
+
+int GeoCoordinatesTokenizer::appendTo( GeoDataLineString *lineString )
+{
+    QVector<GeoDataCoordinates> coordinates;
+    while ( next() ) {
+        coordinates.append( this->coordinates() );
+    }
+
+    lineString->append( coordinates );
+    return coordinates.size();
+}
+
+qreal GeoCoordinatesTokenizer::toDouble( const QChar *begin, const QChar *end )
+{
+    qreal result;
+    if ( parseDecimal( begin, end, &result ) ) {
+        return result;
+    }
+
+    // Anything unusual like surrounding whitespace, "nan" or plenty of
+    // digits is left to Qt
+    return QString::fromRawData( begin, end - begin ).toDouble();
+}
+
+qreal GeoCoordinatesTokenizer::toDouble( const QStringRef &text )
+{
+    return toDouble( text.unicode(), text.unicode() + text.size() );
+}
+
+}
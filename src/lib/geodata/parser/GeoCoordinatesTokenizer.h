@@ -0,0 +1,90 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_GEOCOORDINATESTOKENIZER_H
+#define MARBLE_GEOCOORDINATESTOKENIZER_H
+
+#include <QtCore/QChar>
+#include <QtCore/QString>
+
+#include "geodata_export.h"
+
+namespace Marble
+{
+
+class GeoDataCoordinates;
+class GeoDataLineString;
+
+/**
+ * @short Reads coordinate tuples like those of KML and GPX files.
+ *
+ * The tuples are separated by whitespace, their values by a separator
+ * character, e.g. "lon,lat,alt lon,lat,alt". The values are converted
+ * right from the text without creating intermediate strings.
+ *
+ * The tokenizer does not copy the text, it has to outlive the tokenizer.
+ */
+class GEODATA_EXPORT GeoCoordinatesTokenizer
+{
+ public:
+    /**
+     * Reads the tuples of @p text. If @p separator is whitespace itself the
+     * whole text is a single tuple.
+     */
+    explicit GeoCoordinatesTokenizer( const QString &text, QChar separator = QLatin1Char( ',' ) );
+
+    /**
+     * Moves to the next tuple. Returns false if there are no more tuples.
+     */
+    bool next();
+
+    /**
+     * The number of values of the current tuple.
+     */
+    int size() const;
+
+    /**
+     * The @p index-th value of the current tuple. Only the first three
+     * values of a tuple are kept.
+     */
+    qreal value( int index ) const;
+
+    /**
+     * The current tuple as longitude and latitude in degrees, optionally
+     * followed by the altitude. Tuples of other sizes give the null coordinates.
+     */
+    GeoDataCoordinates coordinates() const;
+
+    /**
+     * Appends the coordinates of all remaining tuples to @p lineString at
+     * once and returns their number.
+     */
+    int appendTo( GeoDataLineString *lineString );
+
+    /**
+     * Converts the text between @p begin and @p end like QString::toDouble()
+     * does. Plain decimal numbers are converted without any allocation.
+     */
+    static qreal toDouble( const QChar *begin, const QChar *end );
+    static qreal toDouble( const QStringRef &text );
+
+ private:
+    enum { MaxValues = 3 };
+
+    void readTuple( const QChar *begin, const QChar *end );
+
+    const QChar *m_position;
+    const QChar *m_end;
+    QChar m_separator;
+    int m_size;
+    qreal m_values[MaxValues];
+};
+
+}
+
+#endif
@@ -27,6 +27,7 @@
 #include "MarbleDebug.h"
 
 // Geodata
+#include "GeoDataDocument.h"
 #include "GeoDocument.h"
 #include "GeoTagHandler.h"
 
@@ -102,6 +103,8 @@ bool GeoParser::read( QIODevice* device )
         }
     }
 
+    finishDocument();
+
     if ( error() ) {
         if ( lineNumber() == 1) {
             raiseError("");
@@ -119,6 +122,14 @@ bool GeoParser::isValidElement( const QString& tagName ) const
     return name() == tagName;
 }
 
+void GeoParser::finishDocument()
+{
+    // Features may refer to styles defined after them
+    if ( m_document->isGeoDataDocument() ) {
+        static_cast<GeoDataDocument*>( m_document )->resolveStyleUrls();
+    }
+}
+
 GeoStackItem GeoParser::parentElement( unsigned int depth ) const
 {
     QStack<GeoStackItem>::const_iterator it = m_nodeStack.constEnd() - 1;
@@ -139,14 +150,16 @@ void GeoParser::parseDocument()
     }
 
     bool processChildren = true;
-    QualifiedName qName( name().toString(), namespaceUri().toString() );
+    // Resolving the atoms does not create any strings for known tags
+    const int nameAtom = m_atoms.atom( name() );
+    const int namespaceAtom = m_atoms.atom( namespaceUri() );
 
     if( tokenType() == QXmlStreamReader::Invalid )
         raiseWarning( QString( "%1: %2" ).arg( error() ).arg( errorString() ) );
 
-    GeoStackItem stackItem( qName, 0 );
+    GeoStackItem stackItem( &m_atoms, nameAtom, namespaceAtom, 0 );
 
-    if ( const GeoTagHandler* handler = GeoTagHandler::recognizes( qName )) {
+    if ( const GeoTagHandler* handler = tagHandler( nameAtom, namespaceAtom )) {
         stackItem.assignNode( handler->parse( *this ));
         processChildren = !isEndElement();
     }
@@ -190,6 +203,20 @@ void GeoParser::parseDocument()
 #endif
 }
 
+const GeoTagHandler* GeoParser::tagHandler( int nameAtom, int namespaceAtom )
+{
+    const quint64 key = ( quint64( nameAtom ) << 32 ) | quint32( namespaceAtom );
+    QHash<quint64, const GeoTagHandler*>::const_iterator it = m_tagHandlers.constFind( key );
+    if ( it != m_tagHandlers.constEnd() )
+        return it.value();
+
+    // Only done once per distinct element, unknown elements are remembered as well
+    const QualifiedName qName( m_atoms.string( nameAtom ), m_atoms.string( namespaceAtom ) );
+    const GeoTagHandler* handler = GeoTagHandler::recognizes( qName );
+    m_tagHandlers.insert( key, handler );
+    return handler;
+}
+
 void GeoParser::raiseWarning( const QString& warning )
 {
     // TODO: Maybe introduce a strict parsing mode where we feed the warning to
@@ -22,11 +22,13 @@
 #ifndef MARBLE_GEOPARSER_H
 #define MARBLE_GEOPARSER_H
 
+#include <QtCore/QHash>
 #include <QtCore/QPair>
 #include <QtCore/QStack>
 #include <QtXml/QXmlStreamReader>
 
 #include "geodata_export.h"
+#include "GeoAtomTable.h"
 
 namespace Marble
 {
@@ -36,6 +38,7 @@ typedef int GeoDataGenericSourceType;
 class GeoDocument;
 class GeoNode;
 class GeoStackItem;
+class GeoTagHandler;
 
 class GEODATA_EXPORT GeoParser : public QXmlStreamReader
 {
@@ -85,34 +88,53 @@ protected:
 
     virtual GeoDocument* createDocument() const = 0;
 
+    /**
+     * Called once the whole document has been read, for work that needs
+     * all of it, like resolving references to elements defined later on.
+     * The style urls of a GeoDataDocument are resolved here, so parsers
+     * that override it call the base implementation.
+     */
+    virtual void finishDocument();
+
 protected:
     GeoDocument* m_document;
     GeoDataGenericSourceType m_source;
 
 private:
     void parseDocument();
+
+    // The handler of the element with the given name and namespace atoms
+    const GeoTagHandler* tagHandler( int nameAtom, int namespaceAtom );
+
     QStack<GeoStackItem> m_nodeStack;
+    GeoAtomTable m_atoms;
+    QHash<quint64, const GeoTagHandler*> m_tagHandlers;
 };
 
 class GeoStackItem
 {
  public:
     GeoStackItem()
-        : m_qualifiedName(),
+        : m_atoms( 0 ),
+          m_name( -1 ),
+          m_namespace( -1 ),
           m_node( 0 )
     {
     }
 
-    GeoStackItem( const GeoParser::QualifiedName& qualifiedName, GeoNode* node )
-        : m_qualifiedName( qualifiedName ),
+    GeoStackItem( GeoAtomTable* atoms, int nameAtom, int namespaceAtom, GeoNode* node )
+        : m_atoms( atoms ),
+          m_name( nameAtom ),
+          m_namespace( namespaceAtom ),
           m_node( node )
     {
     }
 
-    // Fast path for tag handlers
+    // Fast path for tag handlers. tagName has to be one of the tag name
+    // constants, its atom is looked up by address.
     bool represents( const char* tagName ) const
     {
-        return m_node && tagName == m_qualifiedName.first;
+        return m_node && m_name == m_atoms->atom( tagName );
     }
 
     // Helper for tag handlers. Does NOT guard against miscasting. Use with care.
@@ -128,13 +150,22 @@ class GeoStackItem
         return 0 != dynamic_cast<T*>(m_node);
     }
 
-    GeoParser::QualifiedName qualifiedName() const { return m_qualifiedName; }
+    GeoParser::QualifiedName qualifiedName() const
+    {
+        if ( !m_atoms )
+            return GeoParser::QualifiedName();
+
+        return GeoParser::QualifiedName( m_atoms->string( m_name ), m_atoms->string( m_namespace ) );
+    }
+
     GeoNode* associatedNode() const { return m_node; }
 
 private:
     friend class GeoParser;
     void assignNode( GeoNode* node ) { m_node = node; }
-    GeoParser::QualifiedName m_qualifiedName;
+    GeoAtomTable* m_atoms;
+    int m_name;
+    int m_namespace;
     GeoNode* m_node;
 };
 
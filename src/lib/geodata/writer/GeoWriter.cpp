@@ -16,6 +16,8 @@
 
 #include "MarbleDebug.h"
 
+#include <cmath>
+
 namespace Marble
 {
 
@@ -57,19 +59,26 @@ bool GeoWriter::write(QIODevice* device, const GeoNode *feature)
 
 bool GeoWriter::writeElement(const GeoNode *object)
 {
-    // Add checks to see that everything is ok here
+    // Node types are static strings, so their address identifies them
+    // without building a qualified name and hashing it for every node
+    const char *nodeType = object->nodeType();
+    QHash<const char*, const GeoTagWriter*>::const_iterator cached = m_tagWriters.constFind( nodeType );
+    if ( cached == m_tagWriters.constEnd() ) {
+        GeoTagWriter::QualifiedName name( nodeType, m_documentType );
+        cached = m_tagWriters.insert( nodeType, GeoTagWriter::recognizes( name ) );
+    }
 
-    GeoTagWriter::QualifiedName name( object->nodeType(), m_documentType );
-    const GeoTagWriter* writer = GeoTagWriter::recognizes( name );
+    const GeoTagWriter* writer = cached.value();
 
     if( writer ) {
         if( ! writer->write( object, *this ) ) {
             mDebug() << "An error has been reported by the GeoWriter for: "
-                    << name;
+                    << GeoTagWriter::QualifiedName( nodeType, m_documentType );
             return false;
         }
     } else {
-        mDebug() << "There is no GeoWriter registered for: " << name;
+        mDebug() << "There is no GeoWriter registered for: "
+                 << GeoTagWriter::QualifiedName( nodeType, m_documentType );
         return true;
     }
     return true;
@@ -79,6 +88,7 @@ bool GeoWriter::writeElement(const GeoNode *object)
 void GeoWriter::setDocumentType( const QString &documentType )
 {
     m_documentType = documentType;
+    m_tagWriters.clear();
 }
 
 void GeoWriter::writeElement( const QString &namespaceUri, const QString &key, const QString &value )
@@ -102,4 +112,48 @@ void GeoWriter::writeOptionalElement( const QString &key, const QString &value )
     }
 }
 
+void GeoWriter::appendNumber( QString &text, qreal value, int precision )
+{
+    static const double powersOfTen[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+    };
+
+    if ( precision >= 0 && precision <= 15 ) {
+        // Below 2^44 the scaled value is off by less than 1/1000. If it is
+        // not that close to a tie, rounding it gives the correctly rounded
+        // digits QString::number() prints.
+        const double scaled = qAbs( value * powersOfTen[precision] );
+        const double fraction = scaled - floor( scaled );
+        const bool negativeZero = ( value == 0 && 1.0 / value < 0 );
+        if ( scaled < 17592186044416.0 && qAbs( fraction - 0.5 ) > 0.01 && !negativeZero ) {
+            quint64 digits = quint64( scaled + 0.5 );
+            // The sign of numbers that round to zero is left to Qt
+            if ( digits > 0 || value == 0 ) {
+                char buffer[32];
+                char *p = buffer + sizeof( buffer );
+                *--p = '\0';
+                for ( int i = 0; i < precision; ++i ) {
+                    *--p = '0' + digits % 10;
+                    digits /= 10;
+                }
+                if ( precision > 0 ) {
+                    *--p = '.';
+                }
+                do {
+                    *--p = '0' + digits % 10;
+                    digits /= 10;
+                } while ( digits > 0 );
+                if ( value < 0 ) {
+                    *--p = '-';
+                }
+
+                text.append( QLatin1String( p ) );
+                return;
+            }
+        }
+    }
+
+    text.append( QString::number( value, 'f', precision ) );
+}
+
 }
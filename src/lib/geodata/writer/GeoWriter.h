@@ -14,11 +14,14 @@
 #include "GeoDataFeature.h"
 #include "marble_export.h"
 
+#include <QtCore/QHash>
 #include <QtXml/QXmlStreamWriter>
 
 namespace Marble
 {
 
+class GeoTagWriter;
+
 /**
  * @brief Standard Marble way of writing XML
  * This class is intended to be a standardised way of writing XML for marble.
@@ -66,12 +69,23 @@ public:
      **/
     void writeOptionalElement( const QString &key, const QString &value );
 
+    /**
+     * @brief Appends @p value with @p precision decimals to @p text.
+     * The result is the same as QString::number( value, 'f', precision ) but
+     * no temporary strings are created for the usual coordinate values.
+     * Reserve enough space in @p text to avoid reallocations.
+     */
+    static void appendNumber( QString &text, qreal value, int precision );
+
 private:
     friend class GeoTagWriter;
     bool writeElement( const GeoNode* object );
 
 private:
     QString m_documentType;
+
+    // The tag writers of the current document type by node type
+    QHash<const char*, const GeoTagWriter*> m_tagWriters;
 };
 
 }
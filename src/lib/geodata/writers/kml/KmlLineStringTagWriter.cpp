@@ -30,39 +30,17 @@ bool KmlLineStringTagWriter::write( const GeoNode *node, GeoWriter& writer ) con
     if ( lineString->size() > 1 )
     {
         writer.writeStartElement( kml::kmlTag_LineString );
-        writer.writeStartElement( "coordinates" );
 
         // Write altitude for *all* elements, if *any* element
         // has altitude information (!= 0.0)
         bool hasAltitude = false;
-        for ( int i = 0; i < lineString->size(); ++i ) {
-            if ( lineString->at( i ).altitude() ) {
-                hasAltitude = true;
-                break;
-            }
-        }
-
-        for ( int i = 0; i < lineString->size(); ++i ) {
-            GeoDataCoordinates coordinates = lineString->at( i );
-            if ( i > 0 )
-            {
-                writer.writeCharacters( " " );
-            }
-
-            qreal lon = coordinates.longitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lon, 'f', 10 ) );
-            writer.writeCharacters( "," );
-            qreal lat = coordinates.latitude( GeoDataCoordinates::Degree );
-            writer.writeCharacters( QString::number( lat, 'f', 10 ) );
-
-            if ( hasAltitude ) {
-                qreal alt = coordinates.altitude();
-                writer.writeCharacters( "," );
-                writer.writeCharacters( QString::number( alt, 'f', 2 ) );
-            }
+        QVector<GeoDataCoordinates>::const_iterator it = lineString->constBegin();
+        QVector<GeoDataCoordinates>::const_iterator const end = lineString->constEnd();
+        for ( ; it != end && !hasAltitude; ++it ) {
+            hasAltitude = ( it->altitude() != 0.0 );
         }
 
-        writer.writeEndElement();
+        writeCoordinates( lineString, hasAltitude, writer );
         writer.writeEndElement();
 
         return true;
@@ -71,4 +49,39 @@ bool KmlLineStringTagWriter::write( const GeoNode *node, GeoWriter& writer ) con
     return false;
 }
 
+void KmlLineStringTagWriter::writeCoordinates( const GeoDataLineString *lineString, bool altitude, GeoWriter &writer )
+{
+    // Characters collected before they are passed to the writer at once
+    static const int chunkSize = 16 * 1024;
+
+    writer.writeStartElement( "coordinates" );
+
+    QString text;
+    text.reserve( chunkSize + 64 );
+    QVector<GeoDataCoordinates>::const_iterator const begin = lineString->constBegin();
+    QVector<GeoDataCoordinates>::const_iterator const end = lineString->constEnd();
+    for ( QVector<GeoDataCoordinates>::const_iterator it = begin; it != end; ++it ) {
+        if ( it != begin ) {
+            text += QLatin1Char( ' ' );
+        }
+
+        GeoWriter::appendNumber( text, it->longitude( GeoDataCoordinates::Degree ), 10 );
+        text += QLatin1Char( ',' );
+        GeoWriter::appendNumber( text, it->latitude( GeoDataCoordinates::Degree ), 10 );
+
+        if ( altitude ) {
+            text += QLatin1Char( ',' );
+            GeoWriter::appendNumber( text, it->altitude(), 2 );
+        }
+
+        if ( text.size() >= chunkSize ) {
+            writer.writeCharacters( text );
+            text.resize( 0 );
+        }
+    }
+
+    writer.writeCharacters( text );
+    writer.writeEndElement();
+}
+
 }
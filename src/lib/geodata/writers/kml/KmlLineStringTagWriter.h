@@ -16,10 +16,19 @@
 namespace Marble
 {
 
+class GeoDataLineString;
+
 class KmlLineStringTagWriter : public GeoTagWriter
 {
 public:
     virtual bool write( const GeoNode *node, GeoWriter& writer ) const;
+
+    /**
+     * Writes the coordinates element of @p lineString, including the
+     * altitudes if @p altitude is set. The text is handed to the writer in
+     * chunks of bounded size.
+     */
+    static void writeCoordinates( const GeoDataLineString *lineString, bool altitude, GeoWriter &writer );
 };
 
 }
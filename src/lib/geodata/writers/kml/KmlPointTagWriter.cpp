@@ -33,17 +33,18 @@ bool KmlPointTagWriter::write( const GeoNode *node,
     writer.writeStartElement("coordinates");
 
     QString coordinateString;
+    coordinateString.reserve( 64 );
 
     //FIXME: this should be using the GeoDataCoordinates::toString but currently
     // it is not including the altitude and is adding an extra space after commas
 
-    coordinateString += QString::number( point->longitude( GeoDataCoordinates::Degree ), 'f', 10 );
+    GeoWriter::appendNumber( coordinateString, point->longitude( GeoDataCoordinates::Degree ), 10 );
     coordinateString += ',' ;
-    coordinateString += QString::number( point->latitude( GeoDataCoordinates::Degree ) , 'f', 10 );
+    GeoWriter::appendNumber( coordinateString, point->latitude( GeoDataCoordinates::Degree ), 10 );
 
     if( point->altitude() ) {
         coordinateString += ',';
-        coordinateString += QString::number( point->altitude() , 'f' , 10);
+        GeoWriter::appendNumber( coordinateString, point->altitude(), 10 );
     }
 
     writer.writeCharacters( coordinateString );
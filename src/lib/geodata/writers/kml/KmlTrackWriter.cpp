@@ -27,14 +27,23 @@ bool KmlTrackWriter::write( const GeoNode *node, GeoWriter &writer ) const
 
     writer.writeStartElement( kml::kmlTag_Track );
 
+    const QList<QDateTime> when = track->whenList();
+    const QList<GeoDataCoordinates> coordinates = track->coordinatesList();
+    QString coord;
+    coord.reserve( 64 );
+
     int points = track->size();
     for ( int i = 0; i < points; i++ ) {
-        writer.writeElement( "when", track->whenList().at( i ).toString( Qt::ISODate ) );
+        writer.writeElement( "when", when.at( i ).toString( Qt::ISODate ) );
 
         qreal lon, lat, alt;
-        track->coordinatesList().at( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
-        QString coord = QString::number( lon, 'f', 10 ) + ' '
-                        + QString::number( lat, 'f', 10 ) + ' ' + QString::number( alt, 'f', 10 );
+        coordinates.at( i ).geoCoordinates( lon, lat, alt, GeoDataCoordinates::Degree );
+        coord.resize( 0 );
+        GeoWriter::appendNumber( coord, lon, 10 );
+        coord += ' ';
+        GeoWriter::appendNumber( coord, lat, 10 );
+        coord += ' ';
+        GeoWriter::appendNumber( coord, alt, 10 );
 
         writer.writeElement( kml::kmlTag_nameSpaceGx22, "gx:coord", coord );
     }
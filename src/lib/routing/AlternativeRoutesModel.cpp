@@ -7,8 +7,9 @@
 #include "RoutingModel.h"
 #include "RouteAnnotator.h"
 
+#include <QtCore/QSet>
 #include <QtCore/QTimer>
-#include <QtGui/QPainter>
+#include <QtCore/QPointF>
 
 namespace Marble {
 
@@ -34,11 +35,13 @@ public:
     bool filter( const GeoDataDocument* document ) const;
 
     /**
-      * Returns a similarity measure in the range of [0..1]. Two routes with a similarity of 0 can
-      * be treated as totally different (e.g. different route requests), two routes with a similarity
-      * of 1 are considered equal. Otherwise the routes overlap to an extent indicated by the
-      * similarity value -- the higher, the more they do overlap.
-      * @note: The direction of routes is important; reversed routes are not considered equal
+      * Returns a similarity measure in the range of [0..1]: The share of the longer route in the
+      * length of both routes together, where parts of the routes running within about 50 meters
+      * of each other are counted once. Two routes with a similarity of 1 are considered
+      * equal, routes without any common part have a similarity of 0.5 or less. Otherwise the
+      * routes overlap to an extent indicated by the similarity value -- the higher, the more
+      * they do overlap.
+      * @note: The direction of routes is not regarded; reversed routes are considered equal
       */
     static qreal similarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB );
 
@@ -65,10 +68,28 @@ public:
     static GeoDataCoordinates coordinates( const GeoDataCoordinates &start, qreal distance, qreal bearing );
 
     /**
-      * Returns the similarity between routeA and routeB. This method is not symmetric, i.e. in
-      * general unidirectionalSimilarity(a,b) != unidirectionalSimilarity(b,a)
+      * Returns the path of the route in meters in a plane tangent to the earth at the given
+      * latitude and longitude, with points not farther apart than half of the similarity
+      * cell size. Longitudes are unwrapped, so routes crossing the date line stay connected.
       */
-    static qreal unidirectionalSimilarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB );
+    static QVector<QPointF> resample( const GeoDataLineString* lineString, qreal latitude, qreal longitude );
+
+    /**
+      * Returns the keys of all grid cells the given path passes through
+      */
+    static QSet<qint64> cells( const QVector<QPointF> &path );
+
+    /**
+      * Returns the length of the given path
+      */
+    static qreal length( const QVector<QPointF> &path );
+
+    /**
+      * Returns the length of the parts of the given path which pass through or next to the given grid cells
+      */
+    static qreal sharedLength( const QVector<QPointF> &path, const QSet<qint64> &cells );
+
+    static qint64 cellKey( qreal x, qreal y, int dx = 0, int dy = 0 );
 
     /**
       * (Primitive) scoring for routes
@@ -81,12 +102,11 @@ public:
     static qreal instructionScore( const GeoDataDocument* document );
 
     static GeoDataLineString* waypoints( const GeoDataDocument* document );
-
-    static int nonZero( const QImage &image );
-
-    static QPolygonF polygon( const GeoDataLineString* lineString, qreal x, qreal y, qreal sx, qreal sy );
 };
 
+/** Routes passing the same cell or neighboring ones share that part of their path */
+static const qreal similarityCellSize = 50.0;
+
 
 AlternativeRoutesModelPrivate::AlternativeRoutesModelPrivate() :
         m_currentIndex( -1 )
@@ -94,30 +114,6 @@ AlternativeRoutesModelPrivate::AlternativeRoutesModelPrivate() :
     // nothing to do
 }
 
-int AlternativeRoutesModelPrivate::nonZero( const QImage &image )
-{
-  QRgb* destLine = 0;
-  QRgb const black = qRgb( 0, 0, 0 );
-  int count = 0;
-  for ( int y = 0; y < image.height(); ++y ) {
-      destLine = (QRgb*) image.scanLine( y );
-      for ( int x = 0; x < image.width(); ++x ) {
-          count += destLine[x] == black ? 0 : 1;
-      }
-  }
-  return count;
-}
-
-QPolygonF AlternativeRoutesModelPrivate::polygon( const GeoDataLineString* lineString, qreal x, qreal y, qreal sx, qreal sy )
-{
-    QPolygonF poly;
-    for ( int i=0; i<lineString->size(); ++i ) {
-        poly << QPointF( qAbs( ( *lineString)[i].longitude() - x ) * sx,
-                         qAbs( ( *lineString)[i].latitude()  - y ) * sy );
-    }
-    return poly;
-}
-
 bool AlternativeRoutesModelPrivate::filter( const GeoDataDocument* document ) const
 {
     for ( int i=0; i<m_routes.size(); ++i ) {
@@ -132,8 +128,25 @@ bool AlternativeRoutesModelPrivate::filter( const GeoDataDocument* document ) co
 
 qreal AlternativeRoutesModelPrivate::similarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB )
 {
-    return qMax<qreal>( unidirectionalSimilarity( routeA, routeB ),
-                        unidirectionalSimilarity( routeB, routeA ) );
+    GeoDataLineString* waypointsA = waypoints( routeA );
+    GeoDataLineString* waypointsB = waypoints( routeB );
+    if ( !waypointsA || !waypointsB || waypointsA->isEmpty() || waypointsB->isEmpty() )
+    {
+        return 0.0;
+    }
+
+    qreal const latitude = ( waypointsA->first().latitude() + waypointsB->first().latitude() ) / 2.0;
+    qreal const longitude = waypointsA->first().longitude();
+    QVector<QPointF> const pathA = resample( waypointsA, latitude, longitude );
+    QVector<QPointF> const pathB = resample( waypointsB, latitude, longitude );
+
+    qreal const lengthA = length( pathA );
+    qreal const lengthB = length( pathB );
+    qreal const shared = ( sharedLength( pathA, cells( pathB ) ) + sharedLength( pathB, cells( pathA ) ) ) / 2.0;
+
+    // The share of the longer route in the length of both routes together
+    qreal const united = lengthA + lengthB - shared;
+    return united > 0.0 ? qMin<qreal>( 1.0, qMax( lengthA, lengthB ) / united ) : 0.0;
 }
 
 qreal AlternativeRoutesModelPrivate::distance( GeoDataLineString* wayPoints, const GeoDataCoordinates &position )
@@ -187,36 +200,79 @@ qreal AlternativeRoutesModelPrivate::distance( const GeoDataCoordinates &satelli
     }
 }
 
-qreal AlternativeRoutesModelPrivate::unidirectionalSimilarity( const GeoDataDocument* routeA, const GeoDataDocument* routeB )
+QVector<QPointF> AlternativeRoutesModelPrivate::resample( const GeoDataLineString* lineString, qreal latitude, qreal longitude )
 {
-    GeoDataLineString* waypointsA = waypoints( routeA );
-    GeoDataLineString* waypointsB = waypoints( routeB );
-    if ( !waypointsA || !waypointsB )
-    {
-        return 0.0;
-    }
+    qreal const scaleX = EARTH_RADIUS * cos( latitude );
+    qreal const step = similarityCellSize / 2.0;
 
-    QImage image( 64, 64, QImage::Format_ARGB32_Premultiplied );
-    image.fill( qRgb( 0, 0, 0 ) );
-    GeoDataLatLonBox box = GeoDataLatLonBox::fromLineString( *waypointsA );
-    box = box.united( GeoDataLatLonBox::fromLineString( *waypointsB ) );
-    if ( !box.width() || !box.height() ) {
-      return 0.0;
+    QVector<QPointF> result;
+    result.reserve( lineString->size() );
+    qreal lon = longitude;
+    for ( int i=0; i<lineString->size(); ++i ) {
+        // Each longitude is taken relative to the previous one, in [-pi, pi)
+        qreal const delta = lineString->at( i ).longitude() - lon;
+        lon += delta - 2 * M_PI * floor( ( delta + M_PI ) / ( 2 * M_PI ) );
+        QPointF const point( ( lon - longitude ) * scaleX, lineString->at( i ).latitude() * EARTH_RADIUS );
+        if ( i > 0 ) {
+            QPointF const last = result.last();
+            qreal const distance = sqrt( ( point.x() - last.x() ) * ( point.x() - last.x() ) +
+                                         ( point.y() - last.y() ) * ( point.y() - last.y() ) );
+            int const parts = qMax( 1, int( ceil( distance / step ) ) );
+            for ( int j=1; j<parts; ++j ) {
+                result << last + ( point - last ) * j / parts;
+            }
+        }
+        result << point;
     }
 
-    qreal const sw = image.width() / box.width();
-    qreal const sh = image.height() / box.height();
+    return result;
+}
+
+qint64 AlternativeRoutesModelPrivate::cellKey( qreal x, qreal y, int dx, int dy )
+{
+    qint64 const column = qint64( floor( x / similarityCellSize ) ) + dx;
+    qint64 const row = qint64( floor( y / similarityCellSize ) ) + dy;
+    return ( column << 32 ) | quint32( row );
+}
+
+QSet<qint64> AlternativeRoutesModelPrivate::cells( const QVector<QPointF> &path )
+{
+    QSet<qint64> result;
+    result.reserve( path.size() );
+    foreach( const QPointF &point, path ) {
+        result.insert( cellKey( point.x(), point.y() ) );
+    }
+    return result;
+}
 
-    QPainter painter( &image );
-    painter.setPen( QColor( Qt::white ) );
+qreal AlternativeRoutesModelPrivate::length( const QVector<QPointF> &path )
+{
+    qreal result = 0.0;
+    for ( int i=1; i<path.size(); ++i ) {
+        QPointF const delta = path[i] - path[i-1];
+        result += sqrt( delta.x() * delta.x() + delta.y() * delta.y() );
+    }
+    return result;
+}
 
-    painter.drawPoints( AlternativeRoutesModelPrivate::polygon( waypointsA, box.west(), box.north(), sw, sh ) );
-    int const countA = AlternativeRoutesModelPrivate::nonZero( image );
+qreal AlternativeRoutesModelPrivate::sharedLength( const QVector<QPointF> &path, const QSet<qint64> &cells )
+{
+    qreal result = 0.0;
+    for ( int i=1; i<path.size(); ++i ) {
+        QPointF const center = ( path[i-1] + path[i] ) / 2.0;
+        bool shared = false;
+        for ( int dx=-1; !shared && dx<=1; ++dx ) {
+            for ( int dy=-1; !shared && dy<=1; ++dy ) {
+                shared = cells.contains( cellKey( center.x(), center.y(), dx, dy ) );
+            }
+        }
 
-    painter.drawPoints( AlternativeRoutesModelPrivate::polygon( waypointsB, box.west(), box.north(), sw, sh ) );
-    int const countB = AlternativeRoutesModelPrivate::nonZero( image );
-    Q_ASSERT( countA <= countB );
-    return countB ? 1.0 - qreal( countB - countA ) / countB : 0;
+        if ( shared ) {
+            QPointF const delta = path[i] - path[i-1];
+            result += sqrt( delta.x() * delta.x() + delta.y() * delta.y() );
+        }
+    }
+    return result;
 }
 
 bool AlternativeRoutesModelPrivate::higherScore( const GeoDataDocument* one, const GeoDataDocument* two )
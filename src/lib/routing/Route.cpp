@@ -17,6 +17,7 @@ Route::Route() :
     m_distance( 0.0 ),
     m_travelTime( 0 ),
     m_positionDirty( true ),
+    m_indexDirty( true ),
     m_closestSegmentIndex( -1 )
 {
     // nothing to do
@@ -36,6 +37,7 @@ void Route::addRouteSegment( const RouteSegment &segment )
         }
         m_segments.push_back( segment );
         m_positionDirty = true;
+        m_indexDirty = true;
 
         for ( int i=1; i<m_segments.size(); ++i ) {
             m_segments[i-1].setNextRouteSegment(&m_segments[i]);
@@ -101,23 +103,58 @@ void Route::updatePosition() const
             m_closestSegmentIndex = 0;
         }
 
-        qreal distance = m_segments[m_closestSegmentIndex].distanceTo( m_position, m_currentWaypoint, m_positionOnRoute );
-        QList<int> candidates;
+        if ( m_indexDirty ) {
+            m_index.build( m_segments );
+            m_indexDirty = false;
+        }
 
-        for ( int i=0; i<m_segments.size(); ++i ) {
-            if ( i != m_closestSegmentIndex && m_segments[i].minimalDistanceTo( m_position ) <= distance ) {
-                candidates << i;
+        // The position is usually still close to the segment matched last time.
+        // Only the parts of the route not farther away than that segment can be
+        // closer, and the index knows which ones these are.
+        int const lastSegmentIndex = m_closestSegmentIndex;
+        qreal distance = m_segments[lastSegmentIndex].distanceTo( m_position, m_currentWaypoint, m_positionOnRoute );
+
+        QVector<RouteSegmentIndex::Edge> edges;
+        if ( m_index.edgesNear( m_position, distance, edges ) ) {
+            GeoDataCoordinates closest, interpolated;
+            QVector<int> indices;
+            for ( int i=0; i<edges.size(); ++i ) {
+                int const segment = edges[i].segment;
+                indices << edges[i].index;
+                if ( i+1 < edges.size() && edges[i+1].segment == segment ) {
+                    continue;
+                }
+
+                if ( segment != lastSegmentIndex ) {
+                    qreal const dist = m_segments[segment].distanceTo( m_position, indices, closest, interpolated );
+                    if ( distance < 0.0 || dist < distance ) {
+                        distance = dist;
+                        m_closestSegmentIndex = segment;
+                        m_positionOnRoute = interpolated;
+                        m_currentWaypoint = closest;
+                    }
+                }
+                indices.clear();
+            }
+        } else {
+            // Far off the route, where looking at all segments is cheaper
+            QList<int> candidates;
+
+            for ( int i=0; i<m_segments.size(); ++i ) {
+                if ( i != lastSegmentIndex && m_segments[i].minimalDistanceTo( m_position ) <= distance ) {
+                    candidates << i;
+                }
             }
-        }
 
-        GeoDataCoordinates closest, interpolated;
-        foreach( int i, candidates ) {
-            qreal const dist = m_segments[i].distanceTo( m_position, closest, interpolated );
-            if ( distance < 0.0 || dist < distance ) {
-                distance = dist;
-                m_closestSegmentIndex = i;
-                m_positionOnRoute = interpolated;
-                m_currentWaypoint = closest;
+            GeoDataCoordinates closest, interpolated;
+            foreach( int i, candidates ) {
+                qreal const dist = m_segments[i].distanceTo( m_position, closest, interpolated );
+                if ( distance < 0.0 || dist < distance ) {
+                    distance = dist;
+                    m_closestSegmentIndex = i;
+                    m_positionOnRoute = interpolated;
+                    m_currentWaypoint = closest;
+                }
             }
         }
     }
@@ -12,6 +12,7 @@
 #define MARBLE_ROUTE_H
 
 #include "RouteSegment.h"
+#include "RouteSegmentIndex.h"
 #include "GeoDataLatLonBox.h"
 
 namespace Marble
@@ -69,6 +70,10 @@ private:
 
     mutable bool m_positionDirty;
 
+    mutable bool m_indexDirty;
+
+    mutable RouteSegmentIndex m_index;
+
     mutable int m_closestSegmentIndex;
 
     mutable GeoDataCoordinates m_positionOnRoute;
@@ -146,7 +146,19 @@ GeoDataCoordinates RouteSegment::projected(const GeoDataCoordinates &p, const Ge
 
 }
 
-qreal RouteSegment::distanceTo( const GeoDataCoordinates &point, GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const
+void RouteSegment::updateClosestPart( const GeoDataCoordinates &point, int index,
+                                      qreal &minDistance, int &minIndex ) const
+{
+    Q_ASSERT( index > 0 && index < m_path.size() );
+    qreal const distance = distancePointToLine( point, m_path[index-1], m_path[index] );
+    if ( minDistance < 0.0 || distance < minDistance ) {
+        minDistance = distance;
+        minIndex = index;
+    }
+}
+
+qreal RouteSegment::closestPoint( const GeoDataCoordinates &point, int minIndex, qreal minDistance,
+                                  GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const
 {
     Q_ASSERT( !m_path.isEmpty() );
 
@@ -155,16 +167,6 @@ qreal RouteSegment::distanceTo( const GeoDataCoordinates &point, GeoDataCoordina
         return EARTH_RADIUS * distanceSphere( m_path.first(), point );
     }
 
-    qreal minDistance = -1.0;
-    int minIndex = 0;
-    for ( int i=1; i<m_path.size(); ++i ) {
-        qreal const distance = distancePointToLine( point, m_path[i-1], m_path[i] );
-        if ( minDistance < 0.0 || distance < minDistance ) {
-            minDistance = distance;
-            minIndex = i;
-        }
-    }
-
     closest = m_path[minIndex];
     if ( minIndex == 0 ) {
         interpolated = closest;
@@ -174,6 +176,33 @@ qreal RouteSegment::distanceTo( const GeoDataCoordinates &point, GeoDataCoordina
     return minDistance;
 }
 
+qreal RouteSegment::distanceTo( const GeoDataCoordinates &point, GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const
+{
+    qreal minDistance = -1.0;
+    int minIndex = 0;
+    for ( int i=1; i<m_path.size(); ++i ) {
+        updateClosestPart( point, i, minDistance, minIndex );
+    }
+
+    return closestPoint( point, minIndex, minDistance, closest, interpolated );
+}
+
+qreal RouteSegment::distanceTo( const GeoDataCoordinates &point, const QVector<int> &indices,
+                                GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const
+{
+    Q_ASSERT( !indices.isEmpty() );
+
+    qreal minDistance = -1.0;
+    int minIndex = 0;
+    if ( m_path.size() > 1 ) {
+        foreach ( int i, indices ) {
+            updateClosestPart( point, i, minDistance, minIndex );
+        }
+    }
+
+    return closestPoint( point, minIndex, minDistance, closest, interpolated );
+}
+
 qreal RouteSegment::minimalDistanceTo( const GeoDataCoordinates &point ) const
 {
     if ( bounds().contains( point) ) {
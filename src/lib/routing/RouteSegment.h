@@ -49,6 +49,14 @@ public:
 
     qreal distanceTo( const GeoDataCoordinates &point, GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const;
 
+    /**
+      * Like the method above, but only regards the parts of the path ending at the
+      * given point indices, which must be in ascending order. Index 0 stands for
+      * the only point of a path with just one point.
+      */
+    qreal distanceTo( const GeoDataCoordinates &point, const QVector<int> &indices,
+                      GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const;
+
     qreal minimalDistanceTo( const GeoDataCoordinates &point ) const;
 
     bool operator==( const RouteSegment &other ) const;
@@ -60,6 +68,21 @@ private:
 
     GeoDataCoordinates projected(const GeoDataCoordinates &p, const GeoDataCoordinates &a, const GeoDataCoordinates &b) const;
 
+    /**
+      * Makes the part of the path ending at @p index the closest one to
+      * @p point if it is closer than @p minDistance, which is negative
+      * before the first part was checked.
+      */
+    void updateClosestPart( const GeoDataCoordinates &point, int index,
+                            qreal &minDistance, int &minIndex ) const;
+
+    /**
+      * Sets @p closest and @p interpolated for the closest part found by
+      * updateClosestPart() and returns the distance to it.
+      */
+    qreal closestPoint( const GeoDataCoordinates &point, int minIndex, qreal minDistance,
+                        GeoDataCoordinates &closest, GeoDataCoordinates &interpolated ) const;
+
     bool m_valid;
 
     qreal m_distance;
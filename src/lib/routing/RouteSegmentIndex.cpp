@@ -0,0 +1,214 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "RouteSegmentIndex.h"
+
+#include "RouteSegment.h"
+#include "MarbleMath.h"
+
+#include <QtCore/QtAlgorithms>
+
+namespace Marble
+{
+
+// Limits the grid to 4096 x 4096 cells
+static const int maximumGridSize = 4096;
+
+RouteSegmentIndex::RouteSegmentIndex() :
+    m_gridWest( 0.0 ),
+    m_gridSouth( 0.0 ),
+    m_cellSize( 1.0 ),
+    m_columns( 0 ),
+    m_rows( 0 )
+{
+    // nothing to do
+}
+
+void RouteSegmentIndex::build( const QVector<RouteSegment> &segments )
+{
+    clear();
+
+    qreal gridEast = 0.0;
+    qreal gridNorth = 0.0;
+    qreal extentSum = 0.0;
+
+    for ( int i = 0; i < segments.size(); ++i ) {
+        const GeoDataLineString &path = segments.at( i ).path();
+        for ( int j = path.size() == 1 ? 0 : 1; j < path.size(); ++j ) {
+            const GeoDataCoordinates &a = path.at( j == 0 ? 0 : j - 1 );
+            const GeoDataCoordinates &b = path.at( j );
+
+            Edge edge;
+            edge.segment = i;
+            edge.index = j;
+            m_edges << edge;
+
+            m_west << qMin( a.longitude(), b.longitude() );
+            m_east << qMax( a.longitude(), b.longitude() );
+            m_south << qMin( a.latitude(), b.latitude() );
+            m_north << qMax( a.latitude(), b.latitude() );
+
+            extentSum += qMax( m_east.last() - m_west.last(), m_north.last() - m_south.last() );
+
+            if ( m_edges.size() == 1 ) {
+                m_gridWest = m_west.last();
+                m_gridSouth = m_south.last();
+                gridEast = m_east.last();
+                gridNorth = m_north.last();
+            } else {
+                m_gridWest = qMin( m_gridWest, m_west.last() );
+                m_gridSouth = qMin( m_gridSouth, m_south.last() );
+                gridEast = qMax( gridEast, m_east.last() );
+                gridNorth = qMax( gridNorth, m_north.last() );
+            }
+        }
+    }
+
+    if ( m_edges.isEmpty() ) {
+        return;
+    }
+
+    // A few edges per cell on average, but not more cells than the grid can hold
+    const qreal extent = qMax( gridEast - m_gridWest, gridNorth - m_gridSouth );
+    m_cellSize = qMax( 4.0 * extentSum / m_edges.size(), extent / ( maximumGridSize - 1 ) );
+    m_cellSize = qMax<qreal>( m_cellSize, 1e-9 );
+    m_columns = column( gridEast ) + 1;
+    m_rows = row( gridNorth ) + 1;
+
+    for ( int i = 0; i < m_edges.size(); ++i ) {
+        insert( i, m_west.at( i ), m_south.at( i ), m_east.at( i ), m_north.at( i ) );
+    }
+}
+
+void RouteSegmentIndex::clear()
+{
+    m_edges.clear();
+    m_west.clear();
+    m_south.clear();
+    m_east.clear();
+    m_north.clear();
+    m_cells.clear();
+    m_columns = 0;
+    m_rows = 0;
+}
+
+bool RouteSegmentIndex::isEmpty() const
+{
+    return m_edges.isEmpty();
+}
+
+int RouteSegmentIndex::column( qreal lon ) const
+{
+    return qBound( 0, int( ( lon - m_gridWest ) / m_cellSize ), maximumGridSize - 1 );
+}
+
+int RouteSegmentIndex::row( qreal lat ) const
+{
+    return qBound( 0, int( ( lat - m_gridSouth ) / m_cellSize ), maximumGridSize - 1 );
+}
+
+void RouteSegmentIndex::insert( int edge, qreal west, qreal south, qreal east, qreal north )
+{
+    const int lastColumn = column( east );
+    const int lastRow = row( north );
+    for ( int y = row( south ); y <= lastRow; ++y ) {
+        for ( int x = column( west ); x <= lastColumn; ++x ) {
+            m_cells[y * m_columns + x] << edge;
+        }
+    }
+}
+
+bool RouteSegmentIndex::collect( qreal west, qreal south, qreal east, qreal north, QVector<int> &edges ) const
+{
+    const int firstColumn = column( west );
+    const int lastColumn = column( east );
+    const int firstRow = row( south );
+    const int lastRow = row( north );
+
+    if ( qreal( lastColumn - firstColumn + 1 ) * ( lastRow - firstRow + 1 ) > m_edges.size() ) {
+        return false;
+    }
+
+    for ( int y = firstRow; y <= lastRow; ++y ) {
+        for ( int x = firstColumn; x <= lastColumn; ++x ) {
+            QHash<int, QVector<int> >::const_iterator cell = m_cells.constFind( y * m_columns + x );
+            if ( cell == m_cells.constEnd() ) {
+                continue;
+            }
+
+            foreach ( int edge, cell.value() ) {
+                if ( m_west.at( edge ) <= east && m_east.at( edge ) >= west
+                     && m_south.at( edge ) <= north && m_north.at( edge ) >= south ) {
+                    edges << edge;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool RouteSegmentIndex::edgesNear( const GeoDataCoordinates &position, qreal distance, QVector<Edge> &edges ) const
+{
+    if ( m_edges.isEmpty() ) {
+        return true;
+    }
+
+    // A little more than the distance to be safe from rounding errors
+    const qreal radius = qMax<qreal>( 0.0, distance ) / EARTH_RADIUS * 1.000001 + 1e-12;
+    const qreal lon = position.longitude();
+    const qreal lat = position.latitude();
+
+    // RouteSegment measures distances to the inner part of an edge in the plane of
+    // longitude and latitude, and to its end points on the sphere. Points on the
+    // sphere which are that close differ by more in longitude, up to the bound
+    // following from the haversine formula.
+    qreal lonRadius = M_PI;
+    if ( qAbs( lat ) + radius < M_PI / 2 ) {
+        const qreal sine = sin( radius / 2 ) / sqrt( cos( lat ) * cos( qAbs( lat ) + radius ) );
+        if ( sine < 1.0 ) {
+            lonRadius = qMax( radius, 2 * asin( sine ) );
+        }
+    }
+
+    const qreal south = lat - radius;
+    const qreal north = lat + radius;
+
+    QVector<int> found;
+    if ( lonRadius >= M_PI ) {
+        if ( !collect( -M_PI, south, M_PI, north, found ) ) {
+            return false;
+        }
+    } else {
+        const qreal west = lon - lonRadius;
+        const qreal east = lon + lonRadius;
+        if ( !collect( west, south, east, north, found ) ) {
+            return false;
+        }
+
+        // End points on the other side of the date line
+        if ( west < -M_PI && !collect( west + 2 * M_PI, south, M_PI, north, found ) ) {
+            return false;
+        }
+        if ( east > M_PI && !collect( -M_PI, south, east - 2 * M_PI, north, found ) ) {
+            return false;
+        }
+    }
+
+    // Edges spanning several cells are found more than once
+    qSort( found );
+    for ( int i = 0; i < found.size(); ++i ) {
+        if ( i == 0 || found.at( i ) != found.at( i - 1 ) ) {
+            edges << m_edges.at( found.at( i ) );
+        }
+    }
+
+    return true;
+}
+
+}
@@ -0,0 +1,93 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_ROUTESEGMENTINDEX_H
+#define MARBLE_ROUTESEGMENTINDEX_H
+
+#include "GeoDataCoordinates.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QVector>
+
+namespace Marble
+{
+
+class RouteSegment;
+
+/**
+ * @short A uniform grid over the path of a route for finding the parts of it near a position.
+ *
+ * The path of each route segment is split into edges between consecutive
+ * points. Each edge is registered in the grid cells its bounding box
+ * overlaps, so that only the edges in the few cells around a position
+ * need to be looked at when matching it to the route.
+ */
+class RouteSegmentIndex
+{
+public:
+    /**
+     * An edge of the path of a route segment, ending at the point @p index of it.
+     * Segments with just one point have a single edge with index 0.
+     */
+    struct Edge
+    {
+        int segment;
+        int index;
+    };
+
+    RouteSegmentIndex();
+
+    /**
+     * @brief Indexes the paths of the given route segments, replacing the previous ones.
+     */
+    void build( const QVector<RouteSegment> &segments );
+
+    void clear();
+
+    bool isEmpty() const;
+
+    /**
+     * @brief Looks up all edges which may be closer to @p position than @p distance meters.
+     *
+     * The edges are appended to @p edges sorted by segment and index. Returns
+     * false if the area to search is so large compared to the route that
+     * looking at every segment is cheaper. @p edges is left untouched then.
+     */
+    bool edgesNear( const GeoDataCoordinates &position, qreal distance, QVector<Edge> &edges ) const;
+
+private:
+    void insert( int edge, qreal west, qreal south, qreal east, qreal north );
+
+    bool collect( qreal west, qreal south, qreal east, qreal north, QVector<int> &edges ) const;
+
+    int column( qreal lon ) const;
+
+    int row( qreal lat ) const;
+
+    QVector<Edge> m_edges;
+
+    // The bounding boxes of the edges, in radian
+    QVector<qreal> m_west;
+    QVector<qreal> m_south;
+    QVector<qreal> m_east;
+    QVector<qreal> m_north;
+
+    // The grid covers the bounding box of the route, starting at its south west corner
+    qreal m_gridWest;
+    qreal m_gridSouth;
+    qreal m_cellSize;
+    int m_columns;
+    int m_rows;
+
+    // The edges overlapping each cell, keyed by row * m_columns + column
+    QHash<int, QVector<int> > m_cells;
+};
+
+}
+
+#endif
@@ -355,11 +355,7 @@ RoutingProfile RoutingManager::defaultProfile( RoutingProfile::TransportType tra
     }
 
     const PluginManager* pluginManager = d->m_marbleModel->pluginManager();
-    foreach( RunnerPlugin* plugin, pluginManager->runnerPlugins() ) {
-        if ( !plugin->supports( RunnerPlugin::Routing ) ) {
-            continue;
-        }
-
+    foreach( RunnerPlugin* plugin, pluginManager->runnerPlugins( RunnerPlugin::Routing ) ) {
         if ( plugin->supportsTemplate( tpl ) ) {
             profile.pluginSettings()[plugin->nameId()] = plugin->templateSettings( tpl );
         }
@@ -42,11 +42,8 @@ RoutingProfileSettingsDialog::RoutingProfileSettingsDialog( const PluginManager
       m_ui->buttonBox->hide();
     }
 
-    QList<RunnerPlugin*> allPlugins = pluginManager->runnerPlugins();
+    QList<RunnerPlugin*> allPlugins = pluginManager->runnerPlugins( RunnerPlugin::Routing );
     foreach( RunnerPlugin* plugin, allPlugins ) {
-        if ( !plugin->supports( RunnerPlugin::Routing ) ) {
-            continue;
-        }
         m_plugins << plugin;
         RunnerPlugin::ConfigWidget* configWidget = plugin->configWidget();
         if ( configWidget ) {
@@ -18,7 +18,7 @@
 using namespace Marble;
 
 AprsGatherer::AprsGatherer( AprsSource *from,
-                            QMap<QString, AprsObject *> *objects,
+                            AprsObjectStore *objects,
                             QMutex *mutex,
                             QString *filter )
     : m_source( from ),
@@ -36,7 +36,7 @@ AprsGatherer::AprsGatherer( AprsSource *from,
 }
 
 AprsGatherer::AprsGatherer( QIODevice *from,
-                            QMap<QString, AprsObject *> *objects,
+                            AprsObjectStore *objects,
                             QMutex *mutex,
                             QString *filter ) 
     : m_source( 0 ),
@@ -210,9 +210,6 @@ AprsGatherer::addObject( const QString &callSign,
                          const QChar &symbolTable,
                          const QChar &symbolCode )
 {
-    AprsObject *foundObject = 0;
-    QMutexLocker locker( m_mutex );
-        
     int this_seenFrom = m_seenFrom;
     if ( canDoDirect ) {
         if ( !routePath.contains( QChar( '*' ) ) ) {
@@ -220,24 +217,14 @@ AprsGatherer::addObject( const QString &callSign,
         }
     }
 
-    if ( m_objects->contains( callSign ) ) {
-        // we already have one for this callSign; just add the new
-        // history item.
-        ( *m_objects )[callSign]->setLocation( longitude, latitude,
-                                               this_seenFrom );
-        ( *m_objects )[callSign]->setSeenFrom( this_seenFrom );
-
-        // mDebug() << "  is old";
-    }
-    else {
-        foundObject = new AprsObject( longitude, latitude, callSign,
-                                      this_seenFrom );
-        QString s = m_pixmaps[QPair<QChar, QChar>( '/','*' )];
-        foundObject->setPixmapId( m_pixmaps[QPair<QChar, QChar>( symbolTable,symbolCode )] );
-        ( *m_objects )[callSign] = foundObject;
-        mDebug() << "aprs:  new: " << callSign.toLocal8Bit().data();
-        // foundObject->setTarget( "earth" );
-    }
+    // The plugin applies the packet the next time it draws the stations
+    AprsPacket packet;
+    packet.callSign = callSign;
+    packet.longitude = longitude;
+    packet.latitude = latitude;
+    packet.seenFrom = this_seenFrom;
+    packet.pixmapId = m_pixmaps.value( QPair<QChar, QChar>( symbolTable, symbolCode ) );
+    m_objects->enqueue( packet );
     //emit repaintNeeded( QRegion() );
 }
 
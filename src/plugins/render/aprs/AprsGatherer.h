@@ -13,13 +13,15 @@
 
 #include <QtCore/QThread>
 #include <QtCore/QMap>
+#include <QtCore/QPair>
 #include <QtCore/QString>
 #include <QtNetwork/QAbstractSocket>
 #include <QtCore/QMutex>
 #include <QtCore/QIODevice>
 
 #include "AprsSource.h"
-#include "AprsObject.h"
+#include "AprsObjectStore.h"
+#include "GeoAprsCoordinates.h"
 
 namespace Marble {
         
@@ -29,12 +31,12 @@ namespace Marble {
 
             public:
         AprsGatherer( AprsSource *from,
-                      QMap<QString, AprsObject *> *objects,
+                      AprsObjectStore *objects,
                       QMutex *mutex,
                       QString *filter
             );
         AprsGatherer( QIODevice                   *from,
-                      QMap<QString, AprsObject *> *objects,
+                      AprsObjectStore *objects,
                       QMutex *mutex,
                       QString *filter
             );
@@ -68,9 +70,9 @@ namespace Marble {
         GeoAprsCoordinates::SeenFrom m_seenFrom;
         QString                      m_sourceName;
 
-        // Shared with the parent thread
+        // Shared with the parent thread; the mutex guards the filter
         QMutex                      *m_mutex;
-        QMap<QString, AprsObject *> *m_objects;
+        AprsObjectStore             *m_objects;
 
         QMap<QPair<QChar, QChar>, QString> m_pixmaps;
 
@@ -12,6 +12,8 @@
 
 #include <QtGui/QPixmap>
 
+#include <cstring>
+
 #include "MarbleDebug.h"
 #include "MarbleDirs.h"
 #include "GeoPainter.h"
@@ -19,19 +21,36 @@
 
 using namespace Marble;
 
+// Positions are compared exactly, so their bits make a good hash key
+static QPair<quint64, quint64> positionKey( const GeoDataCoordinates &position )
+{
+    const qreal lon = position.longitude();
+    const qreal lat = position.latitude();
+    quint64 lonBits = 0;
+    quint64 latBits = 0;
+    memcpy( &lonBits, &lon, sizeof( lon ) );
+    memcpy( &latBits, &lat, sizeof( lat ) );
+    return qMakePair( lonBits, latBits );
+}
+
 AprsObject::AprsObject( const GeoAprsCoordinates &at, QString &name )
-    : m_myName( name ),
+    : m_historyStart( 0 ),
+      m_myName( name ),
       m_seenFrom( GeoAprsCoordinates::FromNowhere ),
       m_havePixmap ( false ),
       m_pixmapFilename( ),
       m_pixmap( 0 )
 {
     m_history.push_back( at );
+    m_historyIndex.insert( positionKey( at ), 0 );
+    updateBoundingBox();
+    m_lastSeen.start();
 }
 
 AprsObject::AprsObject( const qreal &lon, const qreal &lat,
                         const QString &name, int where )
-    : m_myName( name ),
+    : m_historyStart( 0 ),
+      m_myName( name ),
       m_seenFrom( where ),
       m_havePixmap ( false ),
       m_pixmapFilename( ),
@@ -39,6 +58,9 @@ AprsObject::AprsObject( const qreal &lon, const qreal &lat,
 {
     m_history.push_back( GeoAprsCoordinates( lon, lat, 0,
                                              GeoAprsCoordinates::Degree ) );
+    m_historyIndex.insert( positionKey( m_history.first() ), 0 );
+    updateBoundingBox();
+    m_lastSeen.start();
 }
 
 AprsObject::~AprsObject()
@@ -47,24 +69,91 @@ AprsObject::~AprsObject()
 }
 
 GeoAprsCoordinates
-AprsObject::location()
+AprsObject::location() const
+{
+    return historyAt( m_history.count() - 1 );
+}
+
+const QTime &
+AprsObject::lastSeen() const
+{
+    return m_lastSeen;
+}
+
+int
+AprsObject::historySize() const
 {
-    return m_history.last();
+    return m_history.count();
+}
+
+const GeoDataLatLonBox &
+AprsObject::boundingBox() const
+{
+    return m_boundingBox;
+}
+
+const GeoAprsCoordinates &
+AprsObject::historyAt( int index ) const
+{
+    return m_history.at( ( m_historyStart + index ) % m_history.count() );
 }
 
 void
 AprsObject::setLocation( GeoAprsCoordinates location )
 {
+    const QPair<quint64, quint64> key = positionKey( location );
+    QHash<QPair<quint64, quint64>, int>::const_iterator found =
+        m_historyIndex.constFind( key );
+    m_lastSeen.start();
+
     // Not ideal but it's unlikely they'll jump to the *exact* same spot again
-    if ( !m_history.contains( location ) ) {
-        m_history.push_back( location );
-        mDebug() << "  moved: " << m_myName.toLocal8Bit().data();
-    } else {
-        int index = m_history.indexOf( location );
+    if ( found != m_historyIndex.constEnd() && m_history.at( *found ) == location ) {
         QTime now;
-        m_history[index].setTimestamp( now );
-        m_history[index].addSeenFrom( location.seenFrom() );
+        m_history[*found].setTimestamp( now );
+        m_history[*found].addSeenFrom( location.seenFrom() );
+        return;
+    }
+
+    int slot;
+    if ( m_history.count() < maxHistorySize ) {
+        slot = m_history.count();
+        m_history.push_back( location );
     }
+    else {
+        // Replace the oldest position
+        slot = m_historyStart;
+        QHash<QPair<quint64, quint64>, int>::iterator oldest =
+            m_historyIndex.find( positionKey( m_history.at( slot ) ) );
+        if ( oldest != m_historyIndex.end() && *oldest == slot )
+            m_historyIndex.erase( oldest );
+        m_history[slot] = location;
+        m_historyStart = ( m_historyStart + 1 ) % maxHistorySize;
+    }
+
+    m_historyIndex.insert( key, slot );
+    updateBoundingBox();
+    mDebug() << "  moved: " << m_myName.toLocal8Bit().data();
+}
+
+void
+AprsObject::updateBoundingBox()
+{
+    qreal north = m_history.first().latitude();
+    qreal south = north;
+    qreal east = m_history.first().longitude();
+    qreal west = east;
+    for ( int i = 1; i < m_history.count(); ++i ) {
+        const qreal lat = m_history.at( i ).latitude();
+        const qreal lon = m_history.at( i ).longitude();
+        north = qMax( north, lat );
+        south = qMin( south, lat );
+        east = qMax( east, lon );
+        west = qMin( west, lon );
+    }
+
+    // Tracks crossing the date line get a box around the whole earth,
+    // which is fine for culling
+    m_boundingBox = GeoDataLatLonBox( north, south, east, west );
 }
 
 void
@@ -75,7 +164,7 @@ AprsObject::setLocation( qreal lon, qreal lat, int from )
 }
 
 void
-AprsObject::setPixmapId( QString &pixmap )
+AprsObject::setPixmapId( const QString &pixmap )
 {
     QString pixmapFilename = MarbleDirs::path( pixmap );
     if ( QFile( pixmapFilename ).exists() ) {
@@ -142,50 +231,43 @@ AprsObject::render( GeoPainter *painter, ViewportParams *viewport,
     Q_UNUSED( layer );
     Q_UNUSED( renderPos );
 
-    if ( hideTime > 0 && m_history.last().timestamp().elapsed() > hideTime )
+    if ( hideTime > 0 && m_lastSeen.elapsed() > hideTime )
         return;
 
+    const GeoAprsCoordinates &last = historyAt( m_history.count() - 1 );
+
     QColor baseColor = calculatePaintColor( painter, m_seenFrom,
-                                      m_history.last().timestamp(),
+                                      last.timestamp(),
                                       fadeTime );
 
-    if ( m_history.count() > 1 ) {
-    
-        QList<GeoAprsCoordinates>::iterator spot = m_history.begin();
-        QList<GeoAprsCoordinates>::iterator endSpot = m_history.end();
-        QList<GeoAprsCoordinates>::iterator lastspot;
-        
-        for( ++spot, lastspot = m_history.begin();
-             spot != endSpot;
-             ++spot, ++lastspot ) {
-
-            if ( hideTime > 0 && ( *spot ).timestamp().elapsed() > hideTime )
-                break;
-
-            // draw the line in the base color
-            painter->setPen( baseColor );
-            painter->drawLine( *lastspot, *spot );
-
-            // draw the new circle in whatever is appropriate for that point
-            calculatePaintColor( painter, ( *spot ).seenFrom(), ( *spot ).timestamp(),
-                           fadeTime );
-            painter->drawRect( *spot, 5, 5, false );
-        }
+    // Walk back from the latest position until the track gets too old
+    for ( int i = m_history.count() - 1; i > 0; --i ) {
+        const GeoAprsCoordinates &spot = historyAt( i );
+        if ( hideTime > 0 && spot.timestamp().elapsed() > hideTime )
+            break;
+
+        // draw the line in the base color
+        painter->setPen( baseColor );
+        painter->drawLine( historyAt( i - 1 ), spot );
+
+        // draw the new circle in whatever is appropriate for that point
+        calculatePaintColor( painter, spot.seenFrom(), spot.timestamp(),
+                       fadeTime );
+        painter->drawRect( spot, 5, 5, false );
     }
-    
 
     // Always draw the symbol then the text last so it's on top
     if ( m_havePixmap ) {
         if ( ! m_pixmap )
             m_pixmap = new QPixmap ( m_pixmapFilename );
         if ( m_pixmap && ! m_pixmap->isNull() )
-            painter->drawPixmap( m_history.last(), *m_pixmap ); 
+            painter->drawPixmap( last, *m_pixmap );
         else
-            painter->drawRect( m_history.last(), 6, 6 );
+            painter->drawRect( last, 6, 6 );
     }
     else
-        painter->drawRect( m_history.last(), 6, 6 );
+        painter->drawRect( last, 6, 6 );
 
     painter->setPen( baseColor );
-    painter->drawText( m_history.last(), m_myName );
+    painter->drawText( last, m_myName );
 }
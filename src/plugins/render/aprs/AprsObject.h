@@ -11,10 +11,13 @@
 #ifndef APRSOBJECT_H
 #define APRSOBJECT_H
 
+#include <QtCore/QHash>
 #include <QtCore/QObject>
+#include <QtCore/QPair>
 #include <QtCore/QString>
 
 #include "GeoAprsCoordinates.h"
+#include "GeoDataLatLonBox.h"
 #include "GeoPainter.h"
 #include "GeoSceneLayer.h"
 
@@ -33,9 +36,19 @@ namespace Marble
 
         void setLocation( GeoAprsCoordinates location );
         void setLocation( qreal lon, qreal lat, int from );
-        void setPixmapId( QString &pixmap );
+        void setPixmapId( const QString &pixmap );
         void setSeenFrom( int where );
-        GeoAprsCoordinates location();
+        GeoAprsCoordinates location() const;
+
+        // When a position was reported last, which may be a repeated older
+        // one rather than location()
+        const QTime &lastSeen() const;
+
+        // The number of positions kept, at most maxHistorySize
+        int historySize() const;
+
+        // The bounding box of the positions kept
+        const GeoDataLatLonBox &boundingBox() const;
 
         QColor calculatePaintColor( GeoPainter *painter ) const;
         QColor calculatePaintColor( GeoPainter *painter, int from,
@@ -45,8 +58,22 @@ namespace Marble
                      const QString& renderPos, GeoSceneLayer * layer,
                      int fadeTime = 10*60, int hideTime = 30*60 );
 
+        // Older positions are dropped
+        static const int maxHistorySize = 64;
+
       private:
+        // The @p index oldest position kept
+        const GeoAprsCoordinates &historyAt( int index ) const;
+        void updateBoundingBox();
+
+        // A ring buffer which starts with the oldest position at
+        // m_historyStart once it is full
         QList<GeoAprsCoordinates>     m_history;
+        int                           m_historyStart;
+        // Positions by their longitude and latitude bits
+        QHash<QPair<quint64, quint64>, int> m_historyIndex;
+        GeoDataLatLonBox              m_boundingBox;
+        QTime                         m_lastSeen;
         QString                       m_myName;
         int                           m_seenFrom;
         bool                          m_havePixmap;
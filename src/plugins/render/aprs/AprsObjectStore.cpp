@@ -0,0 +1,145 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "AprsObjectStore.h"
+
+#include "MarbleDebug.h"
+#include "GeoDataLatLonBox.h"
+#include "AprsObject.h"
+
+using namespace Marble;
+
+AprsObjectStore::AprsObjectStore()
+    : m_pending( 0 )
+{
+}
+
+AprsObjectStore::~AprsObjectStore()
+{
+    clear();
+}
+
+void
+AprsObjectStore::enqueue( const AprsPacket &packet )
+{
+    Node *node = new Node;
+    node->packet = packet;
+
+    // Push onto the stack. The only consumer takes the whole stack at
+    // once, so nodes are never popped one by one and cannot be reused
+    // while a producer still looks at them.
+    Node *head;
+    do {
+        head = m_pending;
+        node->next = head;
+    } while ( !m_pending.testAndSetRelease( head, node ) );
+}
+
+int
+AprsObjectStore::applyPending()
+{
+    // Take the queued packets and restore their arrival order
+    Node *node = m_pending.fetchAndStoreAcquire( 0 );
+    Node *first = 0;
+    while ( node ) {
+        Node *next = node->next;
+        node->next = first;
+        first = node;
+        node = next;
+    }
+
+    int applied = 0;
+    while ( first ) {
+        const AprsPacket &packet = first->packet;
+        QHash<QString, AprsObject *>::const_iterator found =
+            m_objects.constFind( packet.callSign );
+        if ( found != m_objects.constEnd() ) {
+            // we already have one for this callSign; just add the new
+            // history item.
+            ( *found )->setLocation( packet.longitude, packet.latitude,
+                                     packet.seenFrom );
+            ( *found )->setSeenFrom( packet.seenFrom );
+        }
+        else {
+            AprsObject *object = new AprsObject( packet.longitude,
+                                                 packet.latitude,
+                                                 packet.callSign,
+                                                 packet.seenFrom );
+            object->setPixmapId( packet.pixmapId );
+            m_objects.insert( packet.callSign, object );
+            mDebug() << "aprs:  new: " << packet.callSign.toLocal8Bit().data();
+        }
+
+        Node *next = first->next;
+        delete first;
+        first = next;
+        ++applied;
+    }
+
+    return applied;
+}
+
+int
+AprsObjectStore::expire( int maxAge )
+{
+    int removed = 0;
+    QHash<QString, AprsObject *>::iterator obj = m_objects.begin();
+    while ( obj != m_objects.end() ) {
+        if ( ( *obj )->lastSeen().elapsed() > maxAge ) {
+            delete *obj;
+            obj = m_objects.erase( obj );
+            ++removed;
+        }
+        else {
+            ++obj;
+        }
+    }
+
+    return removed;
+}
+
+QList<AprsObject *>
+AprsObjectStore::objects( const GeoDataLatLonBox &box ) const
+{
+    QList<AprsObject *> result;
+    QHash<QString, AprsObject *>::const_iterator obj;
+    QHash<QString, AprsObject *>::const_iterator end = m_objects.constEnd();
+    for ( obj = m_objects.constBegin(); obj != end; ++obj ) {
+        if ( box.intersects( ( *obj )->boundingBox() ) ) {
+            result.append( *obj );
+        }
+    }
+
+    return result;
+}
+
+AprsObject *
+AprsObjectStore::object( const QString &callSign ) const
+{
+    return m_objects.value( callSign );
+}
+
+int
+AprsObjectStore::count() const
+{
+    return m_objects.count();
+}
+
+void
+AprsObjectStore::clear()
+{
+    Node *node = m_pending.fetchAndStoreAcquire( 0 );
+    while ( node ) {
+        Node *next = node->next;
+        delete node;
+        node = next;
+    }
+
+    qDeleteAll( m_objects );
+    m_objects.clear();
+}
@@ -0,0 +1,78 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef APRSOBJECTSTORE_H
+#define APRSOBJECTSTORE_H
+
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+
+namespace Marble
+{
+
+    class AprsObject;
+    class GeoDataLatLonBox;
+
+    // A position report parsed by one of the gatherers
+    struct AprsPacket
+    {
+        QString callSign;
+        qreal   longitude;
+        qreal   latitude;
+        int     seenFrom;
+        QString pixmapId;
+    };
+
+    // @brief The stations known to the plugin.
+    //
+    // Gatherer threads hand their packets to enqueue() which never
+    // blocks. All other methods must be called from the thread that
+    // owns the store (the GUI thread); it applies the queued packets
+    // in batches with applyPending(), so drawing the stations does not
+    // need a lock.
+    class AprsObjectStore
+    {
+      public:
+        AprsObjectStore();
+        ~AprsObjectStore();
+
+        // Thread-safe and lock-free
+        void enqueue( const AprsPacket &packet );
+
+        // Moves all queued packets into the stations in the order they
+        // arrived and returns their number
+        int applyPending();
+
+        // Removes the stations that did not report for @p maxAge
+        // milliseconds and returns their number
+        int expire( int maxAge );
+
+        // The stations whose track intersects @p box
+        QList<AprsObject *> objects( const GeoDataLatLonBox &box ) const;
+
+        AprsObject *object( const QString &callSign ) const;
+        int count() const;
+        void clear();
+
+      private:
+        struct Node
+        {
+            AprsPacket packet;
+            Node      *next;
+        };
+
+        // Packets not applied yet, latest first
+        QAtomicPointer<Node>          m_pending;
+        QHash<QString, AprsObject *>  m_objects;
+    };
+
+}
+
+#endif /* APRSOBJECTSTORE_H */
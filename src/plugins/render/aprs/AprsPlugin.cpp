@@ -62,6 +62,11 @@ AprsPlugin::AprsPlugin()
     connect( m_action,    SIGNAL( toggled( bool ) ),
 	     this,        SLOT( setVisible( bool ) ) );
 
+    // Stations which stopped reporting are removed once a minute
+    m_expiryTimer.setInterval( 60 * 1000 );
+    connect( &m_expiryTimer, SIGNAL( timeout() ),
+             this,           SLOT( expireObjects() ) );
+
 }
 
 AprsPlugin::~AprsPlugin()
@@ -71,13 +76,6 @@ AprsPlugin::~AprsPlugin()
     delete m_configDialog;
     delete ui_configWidget;
 
-    QMap<QString, AprsObject *>::Iterator obj;
-    QMap<QString, AprsObject *>::Iterator end = m_objects.end();
-
-    for( obj = m_objects.begin(); obj != end; ++obj ) {
-        delete *obj;
-    }
-
     m_objects.clear();
 
     delete m_mutex;
@@ -92,6 +90,19 @@ void AprsPlugin::updateVisibility( QString nameId, bool visible )
         stopGatherers();
 }
 
+void AprsPlugin::expireObjects()
+{
+    // Hidden stations are not drawn anyway
+    const int hidetime = m_settings.value( "hideTime" ).toInt() * 60000;
+
+    m_objects.applyPending();
+    if ( hidetime > 0 ) {
+        const int expired = m_objects.expire( hidetime );
+        if ( expired > 0 )
+            mDebug() << "aprs: expired" << expired << "stations";
+    }
+}
+
 RenderPlugin::RenderType AprsPlugin::renderType() const
 {
     return Online;
@@ -220,6 +231,7 @@ void AprsPlugin::initialize ()
     mDebug() << "APRS initialized";
 
     restartGatherers();
+    m_expiryTimer.start();
 }
 
 QDialog *AprsPlugin::configDialog()
@@ -403,10 +415,11 @@ bool AprsPlugin::render( GeoPainter *painter, ViewportParams *viewport, const QS
     }
     
 
-    QMutexLocker locker( m_mutex );
-    QMap<QString, AprsObject *>::ConstIterator obj;
-    for( obj = m_objects.constBegin(); obj != m_objects.constEnd(); ++obj ) {
-        ( *obj )->render( painter, viewport, renderPos, layer, fadetime, hidetime );
+    // Only this thread touches the stations, the gatherers just queue
+    // their packets
+    m_objects.applyPending();
+    foreach ( AprsObject *object, m_objects.objects( m_lastBox ) ) {
+        object->render( painter, viewport, renderPos, layer, fadetime, hidetime );
     }
 
     painter->restore();
@@ -13,10 +13,12 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QMutex>
+#include <QtCore/QTimer>
 #include <QtGui/QDialog>
 
 #include "RenderPlugin.h"
 #include "AprsObject.h"
+#include "AprsObjectStore.h"
 #include "AprsGatherer.h"
 #include "GeoDataLatLonAltBox.h"
 
@@ -70,12 +72,15 @@ namespace Marble
         void readSettings();
         void writeSettings();
         void updateVisibility( QString nameId, bool visible );
+        void expireObjects();
         virtual RenderType renderType() const;
 
       private:
 
+        // Guards the filter which the gatherers send to their sources
         QMutex                        *m_mutex;
-        QMap<QString, AprsObject *>    m_objects;
+        AprsObjectStore                m_objects;
+        QTimer                         m_expiryTimer;
         bool m_initialized;
         GeoDataLatLonAltBox            m_lastBox;
         AprsGatherer                  *m_tcpipGatherer,
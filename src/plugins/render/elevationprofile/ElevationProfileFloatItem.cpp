@@ -629,13 +629,9 @@ QList<QPointF> ElevationProfileFloatItem::calculateElevationData( const GeoDataL
     // TODO: Don't re-calculate the whole route if only a small part of it was changed
     QList<QPointF> result;
 
-    GeoDataLineString path;
+    const QVector<qreal> heights = marbleModel()->elevationModel()->heights( lineString );
     for ( int i = 0; i < lineString.size(); i++ ) {
-        path.append( lineString[i] );
-
-        const qreal lat = lineString[i].latitude ( GeoDataCoordinates::Degree );
-        const qreal lon = lineString[i].longitude( GeoDataCoordinates::Degree );
-        qreal ele = marbleModel()->elevationModel()->height( lon, lat );
+        qreal ele = heights.at( i );
         if ( ele == invalidElevationData ) { // no data
             ele = 0;
         }
@@ -58,8 +58,6 @@ SatellitesItem::SatellitesItem( const QString &name, elsetrec satrec, const Marb
     placemark()->style()->lineStyle().setColor( oxygenBrickRed4 );
     placemark()->style()->lineStyle().setPenStyle( Qt::NoPen );
     placemark()->style()->labelStyle().setGlow( true );
-
-    update();
 }
 
 void SatellitesItem::setDescription()
@@ -77,65 +75,24 @@ void SatellitesItem::setDescription()
      placemark()->setDescription( description );
 }
 
-void SatellitesItem::update()
+void SatellitesItem::applyOrbit( const SatellitesPropagator::OrbitUpdate &update )
 {
-    QDateTime startTime = m_clock->dateTime().addSecs( - 2 * 60 );
-
-    QDateTime endTime = startTime.addSecs( period() );
-
-    m_track->removeBefore( startTime );
-    m_track->removeAfter( endTime );
-
-    addPointAt( m_clock->dateTime() );
-
-    // time interval between each point in the track, in seconds
-    double step = period() / 100.0;
-
-    for ( double i = startTime.toTime_t(); i < endTime.toTime_t(); i += step ) {
-        // No need to add points in this interval
-        if ( i >= m_track->firstWhen().toTime_t() ) {
-            i = m_track->lastWhen().toTime_t() + step;
-        }
-
-        addPointAt( QDateTime::fromTime_t( i ) );
+    for ( int i = 0; i < update.times.size(); ++i ) {
+        m_track->addPoint( QDateTime::fromTime_t( update.times.at( i ) ), update.coordinates.at( i ) );
     }
-}
 
-void SatellitesItem::addPointAt( const QDateTime &dateTime )
-{
-    // in minutes
-    double timeSinceEpoch = (double)( dateTime.toTime_t() - timeAtEpoch().toTime_t() ) / 60.0;
-
-    double r[3], v[3];
-    sgp4( wgs84, m_satrec, timeSinceEpoch, r, v );
-
-    GeoDataCoordinates coordinates = fromTEME( r[0], r[1], r[2], gmst( timeSinceEpoch ) );
-    if ( m_satrec.error != 0 ) {
-        return;
-    }
-
-    m_track->addPoint( dateTime, coordinates);
+    m_track->removeBefore( QDateTime::fromTime_t( update.windowStart ) );
+    m_track->removeAfter( QDateTime::fromTime_t( update.windowEnd ) );
 }
 
-QDateTime SatellitesItem::timeAtEpoch()
+const elsetrec &SatellitesItem::satrec() const
 {
-    int year = m_satrec.epochyr + ( m_satrec.epochyr < 57 ? 2000 : 1900 );
-
-    int month, day, hours, minutes;
-    double seconds;
-    days2mdhms( year, m_satrec.epochdays, month, day, hours , minutes, seconds );
-
-    int ms = fmod(seconds * 1000.0, 1000.0);
-
-    return QDateTime( QDate( year, month, day ),
-                      QTime( hours, minutes, (int)seconds, ms ),
-                      Qt::UTC );
+    return m_satrec;
 }
 
 double SatellitesItem::period()
 {
-    // no := mean motion (rad / min)
-    return 60 * (2 * M_PI / m_satrec.no);
+    return SatellitesPropagator::period( m_satrec );
 }
 
 double SatellitesItem::apogee()
@@ -159,43 +116,4 @@ double SatellitesItem::inclination()
     return m_satrec.inclo / M_PI * 180;
 }
 
-GeoDataCoordinates SatellitesItem::fromTEME( double x, double y, double z, double gmst )
-{
-    double lon = atan2( y, x );
-    // Rotate the angle by gmst (the origin goes from the vernal equinox point to the Greenwich Meridian)
-    lon = GeoDataCoordinates::normalizeLon( fmod(lon - gmst, 2 * M_PI) );
-
-    double lat = atan2( z, sqrt( x*x + y*y ) );
-
-    //TODO: determine if this is worth the extra precision
-    // Algorithm from http://celestrak.com/columns/v02n03/
-    //TODO: demonstrate it.
-    double a = m_earthSemiMajorAxis;
-    double R = sqrt( x*x + y*y );
-    double latp = lat;
-    double C;
-    for ( int i = 0; i < 3; i++ ) {
-        C = 1 / sqrt( 1 - square( m_satrec.ecco * sin( latp ) ) );
-        lat = atan2( z + a * C * square( m_satrec.ecco ) * sin( latp ), R );
-    }
-
-    double alt = R / cos( lat ) - a * C;
-
-    lat = GeoDataCoordinates::normalizeLat( lat );
-
-    return GeoDataCoordinates( lon, lat, alt * 1000 );
-}
-
-double SatellitesItem::gmst( double minutesP )
-{
-    // Earth rotation rate in rad/min, from sgp4io.cpp
-    double rptim = 4.37526908801129966e-3;
-    return fmod( m_satrec.gsto + rptim * minutesP, 2 * M_PI );
-}
-
-double SatellitesItem::square( double x )
-{
-    return x * x;
-}
-
 #include "SatellitesItem.moc"
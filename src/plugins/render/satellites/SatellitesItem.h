@@ -12,6 +12,7 @@
 #define MARBLE_SATELLITESITEM_H
 
 #include "TrackerPluginItem.h"
+#include "SatellitesPropagator.h"
 
 #include "GeoDataCoordinates.h"
 #include "GeoDataTrack.h"
@@ -29,7 +30,13 @@ class SatellitesItem : public TrackerPluginItem
 public:
     SatellitesItem( const QString &name, elsetrec satrec, const MarbleClock *clock );
 
-    void update();
+    /**
+     * Adds the samples computed by a SatellitesPropagator to the orbit and
+     * removes the outdated ones.
+     */
+    void applyOrbit( const SatellitesPropagator::OrbitUpdate &update );
+
+    const elsetrec &satrec() const;
 
     void showOrbit( bool show );
 
@@ -44,25 +51,6 @@ private:
 
     void setDescription();
 
-    /**
-     * Add a point in the GeoDataTrack geometry of the placemark with time
-     * dateTime and coordinates of the satellite determined from m_satrec.
-     */
-    void addPointAt( const QDateTime &dateTime );
-
-    /**
-     * Create a GeoDataCoordinates object from the cartesian coordinates
-     * @p x, @p y and @p z in km in the Earth-centered inertial frame known
-     * as TEME (True equator, Mean equinox) with Greenwich Mean Sidereal Time
-     * @p gmst in radians at time of observation.
-     */
-    GeoDataCoordinates fromTEME( double x, double y, double z, double gmst );
-
-    /**
-     * @return The time at the satellite epoch determined from m_satrec
-     */
-    QDateTime timeAtEpoch();
-
     /**
      * @return The orbital period of the satellite in seconds
      */
@@ -85,17 +73,6 @@ private:
      * @return The inclination in degrees
      */
     double inclination();
-
-    /**
-     * Returns the Greenwich Mean Sideral Time in radians, @p minutes
-     * after the epoch.
-     */
-    double gmst( double minutes );
-
-    /**
-     * @return The square of @p x
-     */
-    double square( double x );
 };
 
 }
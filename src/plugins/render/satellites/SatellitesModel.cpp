@@ -21,10 +21,40 @@ using namespace Marble;
 
 SatellitesModel::SatellitesModel( GeoDataTreeModel *treeModel, const PluginManager *pluginManager, const MarbleClock *clock )
     : TrackerPluginModel( treeModel, pluginManager ),
-      m_clock( clock )
+      m_clock( clock ),
+      m_propagator( this, "applyOrbits" )
 {
     connect(m_clock, SIGNAL(timeChanged()),
-            this, SLOT(update()));
+            this, SLOT(propagate()));
+}
+
+SatellitesModel::~SatellitesModel()
+{
+    // Make sure no results get posted to this object anymore
+    m_propagator.waitForDone();
+}
+
+void SatellitesModel::clear()
+{
+    m_propagator.clear();
+    m_satellites.clear();
+    TrackerPluginModel::clear();
+}
+
+void SatellitesModel::propagate()
+{
+    m_propagator.propagate( m_clock->dateTime().toTime_t() );
+}
+
+void SatellitesModel::applyOrbits()
+{
+    foreach ( const SatellitesPropagator::OrbitUpdate &update, m_propagator.takeUpdates() ) {
+        if ( update.satellite < m_satellites.size() ) {
+            m_satellites.at( update.satellite )->applyOrbit( update );
+        }
+    }
+
+    emit orbitsChanged();
 }
 
 void SatellitesModel::parseFile( const QString &id, const QByteArray &file )
@@ -44,6 +74,7 @@ void SatellitesModel::parseFile( const QString &id, const QByteArray &file )
 
     double startmfe, stopmfe, deltamin;
     elsetrec satrec;
+    QVector<elsetrec> satrecs;
     int i = 0;
     while ( i < tleLines.size() - 1 ) {
         QString satelliteName = QString( tleLines.at( i++ ) ).trimmed();
@@ -55,17 +86,24 @@ void SatellitesModel::parseFile( const QString &id, const QByteArray &file )
                     startmfe, stopmfe, deltamin, satrec );
         if ( satrec.error != 0 ) {
             mDebug() << "Error: " << satrec.error;
-            return;
+            break;
         }
 
         SatellitesItem *item = new SatellitesItem( satelliteName, satrec, m_clock );
         addItem( item );
+        satrecs.append( satrec );
+        m_satellites.append( item );
     }
 
+    // Waits for a running propagation only once for the whole catalog.
+    m_propagator.addSatellites( satrecs );
+
     //Reset to environment
     setlocale( LC_NUMERIC, "" );
 
     endUpdateItems();
+
+    propagate();
 }
 
 #include "SatellitesModel.moc"
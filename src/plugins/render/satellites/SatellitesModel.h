@@ -13,20 +13,42 @@
 
 #include "TrackerPluginModel.h"
 
+#include "SatellitesPropagator.h"
+
+#include <QtCore/QVector>
 
 namespace Marble {
 
 class MarbleClock;
+class SatellitesItem;
 
 class SatellitesModel : public TrackerPluginModel
 {
     Q_OBJECT
 public:
     SatellitesModel( GeoDataTreeModel *treeModel, const PluginManager *pluginManager, const MarbleClock *clock );
+    ~SatellitesModel();
+
     void parseFile( const QString &id, const QByteArray &file );
 
+    void clear();
+
+Q_SIGNALS:
+    /**
+     * Emitted when the orbits of the satellites changed.
+     */
+    void orbitsChanged();
+
+private Q_SLOTS:
+    void propagate();
+
+    void applyOrbits();
+
 private:
     const MarbleClock *m_clock;
+    SatellitesPropagator m_propagator;
+    // The satellites in the order they were added to m_propagator
+    QVector<SatellitesItem *> m_satellites;
 };
 
 }
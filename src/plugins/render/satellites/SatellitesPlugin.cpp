@@ -109,6 +109,7 @@ void SatellitesPlugin::initialize()
     //marbleModel() is not const, since traditional RenderPlugins do not require that
     m_model = new SatellitesModel( const_cast<MarbleModel *>( marbleModel() )->treeModel(), marbleModel()->pluginManager(),
                                    marbleModel()->clock() );
+    connect( m_model, SIGNAL(orbitsChanged()), this, SIGNAL(repaintNeeded()) );
     m_isInitialized = true;
     updateSettings();
     enableModel( enabled() && visible() );
@@ -0,0 +1,354 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "SatellitesPropagator.h"
+
+#include "sgp4/sgp4ext.h"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QMetaObject>
+#include <QtCore/QObject>
+#include <QtCore/QRunnable>
+
+#include <cmath>
+
+namespace Marble {
+
+// The number of satellites propagated by one job of the thread pool.
+static const int batchSize = 32;
+
+// The number of samples per orbital period.
+static const int samplesPerPeriod = 100;
+
+// How far the orbit reaches into the past, in seconds.
+static const uint orbitHistory = 2 * 60;
+
+class SatellitesPropagationBatch : public QRunnable
+{
+public:
+    SatellitesPropagationBatch( SatellitesPropagator *propagator,
+                                SatellitesPropagator::Orbit *orbits,
+                                SatellitesPropagator::OrbitUpdate *results,
+                                int first, int count, uint time )
+        : m_propagator( propagator ),
+          m_orbits( orbits ),
+          m_results( results ),
+          m_first( first ),
+          m_count( count ),
+          m_time( time )
+    {
+    }
+
+    virtual void run()
+    {
+        for ( int i = m_first; i < m_first + m_count; ++i ) {
+            m_results[i].satellite = i;
+            m_propagator->propagateOrbit( m_orbits[i], m_time, m_results[i] );
+        }
+
+        m_propagator->batchDone();
+    }
+
+private:
+    SatellitesPropagator *const m_propagator;
+    SatellitesPropagator::Orbit *const m_orbits;
+    SatellitesPropagator::OrbitUpdate *const m_results;
+    const int m_first;
+    const int m_count;
+    const uint m_time;
+};
+
+SatellitesPropagator::OrbitUpdate::OrbitUpdate()
+    : satellite( -1 ),
+      windowStart( 0 ),
+      windowEnd( 0 )
+{
+}
+
+bool SatellitesPropagator::OrbitUpdate::isValid() const
+{
+    return satellite >= 0;
+}
+
+SatellitesPropagator::SatellitesPropagator( QObject *receiver, const char *member )
+    : m_receiver( receiver ),
+      m_member( member ),
+      m_remainingBatches( 0 ),
+      m_running( false ),
+      m_hasPendingTime( false ),
+      m_pendingTime( 0 )
+{
+}
+
+SatellitesPropagator::~SatellitesPropagator()
+{
+    waitForDone();
+}
+
+int SatellitesPropagator::addSatellite( const elsetrec &satrec )
+{
+    addSatellites( QVector<elsetrec>() << satrec );
+
+    return m_orbits.size() - 1;
+}
+
+void SatellitesPropagator::addSatellites( const QVector<elsetrec> &satrecs )
+{
+    waitForDone();
+
+    m_orbits.reserve( m_orbits.size() + satrecs.size() );
+    foreach ( const elsetrec &satrec, satrecs ) {
+        Orbit orbit;
+        orbit.satrec = satrec;
+        orbit.epoch = epoch( satrec );
+        orbit.step = period( satrec ) / samplesPerPeriod;
+        orbit.firstSample = 0;
+        orbit.lastSample = -1;
+        m_orbits.append( orbit );
+    }
+
+    QMutexLocker locker( &m_mutex );
+    m_published.resize( m_orbits.size() );
+}
+
+void SatellitesPropagator::clear()
+{
+    waitForDone();
+
+    m_orbits.clear();
+    m_results.clear();
+
+    QMutexLocker locker( &m_mutex );
+    m_published.clear();
+    m_changed.clear();
+}
+
+int SatellitesPropagator::satelliteCount() const
+{
+    return m_orbits.size();
+}
+
+void SatellitesPropagator::propagate( uint time )
+{
+    QMutexLocker locker( &m_mutex );
+
+    if ( m_running ) {
+        m_hasPendingTime = true;
+        m_pendingTime = time;
+        return;
+    }
+
+    m_running = true;
+    start( time );
+}
+
+void SatellitesPropagator::waitForDone()
+{
+    // A pending propagation is started by the last batch of the running
+    // one, so this also waits for it.
+    QMutexLocker locker( &m_mutex );
+    while ( m_running ) {
+        m_done.wait( &m_mutex );
+    }
+}
+
+QVector<SatellitesPropagator::OrbitUpdate> SatellitesPropagator::takeUpdates()
+{
+    QMutexLocker locker( &m_mutex );
+
+    QVector<OrbitUpdate> result;
+    result.reserve( m_changed.size() );
+    foreach ( int satellite, m_changed ) {
+        result.append( m_published.at( satellite ) );
+        m_published[satellite] = OrbitUpdate();
+    }
+    m_changed.clear();
+
+    return result;
+}
+
+void SatellitesPropagator::start( uint time )
+{
+    // Called with m_mutex locked and m_running set.
+    const int count = m_orbits.size();
+    if ( count == 0 ) {
+        m_running = false;
+        m_done.wakeAll();
+        return;
+    }
+
+    m_results.resize( count );
+
+    // Each batch works on its own range of orbits and results.
+    Orbit *orbits = m_orbits.data();
+    OrbitUpdate *results = m_results.data();
+
+    const int batches = ( count + batchSize - 1 ) / batchSize;
+    m_remainingBatches = batches;
+    for ( int i = 0; i < batches; ++i ) {
+        const int first = i * batchSize;
+        const int size = qMin( batchSize, count - first );
+        m_threadPool.start( new SatellitesPropagationBatch( this, orbits, results, first, size, time ) );
+    }
+}
+
+void SatellitesPropagator::propagateOrbit( Orbit &orbit, uint time, OrbitUpdate &update )
+{
+    const uint windowStart = time - orbitHistory;
+    const uint windowEnd = windowStart + uint( period( orbit.satrec ) );
+
+    update.windowStart = windowStart;
+    update.windowEnd = windowEnd;
+    update.times.resize( 0 );
+    update.coordinates.resize( 0 );
+
+    GeoDataCoordinates coordinates;
+    if ( position( orbit.satrec, orbit.epoch, time, coordinates ) ) {
+        update.times.append( time );
+        update.coordinates.append( coordinates );
+    }
+
+    // The samples on the grid inside the window. Only those which weren't
+    // inside the window at the previous propagation need to be computed.
+    const qint64 first = qint64( ceil( ( double( windowStart ) - orbit.epoch ) / orbit.step ) );
+    const qint64 last = qint64( ceil( ( double( windowEnd ) - orbit.epoch ) / orbit.step ) ) - 1;
+
+    for ( qint64 k = first; k <= last; ++k ) {
+        if ( k >= orbit.firstSample && k <= orbit.lastSample ) {
+            k = orbit.lastSample;
+            continue;
+        }
+
+        const uint sampleTime = uint( qRound64( orbit.epoch + k * orbit.step ) );
+        if ( position( orbit.satrec, orbit.epoch, sampleTime, coordinates ) ) {
+            update.times.append( sampleTime );
+            update.coordinates.append( coordinates );
+        }
+    }
+
+    orbit.firstSample = first;
+    orbit.lastSample = last;
+}
+
+void SatellitesPropagator::batchDone()
+{
+    if ( m_remainingBatches.deref() ) {
+        return;
+    }
+
+    // This was the last batch of the propagation, publish its results.
+    QMutexLocker locker( &m_mutex );
+
+    for ( int i = 0; i < m_results.size(); ++i ) {
+        const OrbitUpdate &result = m_results.at( i );
+        OrbitUpdate &published = m_published[i];
+
+        if ( !published.isValid() ) {
+            published = result;
+            m_changed.append( i );
+        } else {
+            published.windowStart = result.windowStart;
+            published.windowEnd = result.windowEnd;
+            published.times += result.times;
+            published.coordinates += result.coordinates;
+        }
+    }
+
+    // Posted before the propagation is marked as done, so no event gets
+    // posted to the receiver once waitForDone() returned.
+    if ( m_receiver ) {
+        QMetaObject::invokeMethod( m_receiver, m_member, Qt::QueuedConnection );
+    }
+
+    if ( m_hasPendingTime ) {
+        m_hasPendingTime = false;
+        start( m_pendingTime );
+    } else {
+        m_running = false;
+        m_done.wakeAll();
+    }
+}
+
+bool SatellitesPropagator::position( elsetrec &satrec, uint epoch, uint time,
+                                     GeoDataCoordinates &coordinates )
+{
+    // in minutes
+    const double timeSinceEpoch = ( double( time ) - double( epoch ) ) / 60.0;
+
+    double r[3], v[3];
+    sgp4( wgs84, satrec, timeSinceEpoch, r, v );
+
+    if ( satrec.error != 0 ) {
+        return false;
+    }
+
+    coordinates = fromTEME( satrec, r[0], r[1], r[2], gmst( satrec, timeSinceEpoch ) );
+    return true;
+}
+
+uint SatellitesPropagator::epoch( const elsetrec &satrec )
+{
+    int year = satrec.epochyr + ( satrec.epochyr < 57 ? 2000 : 1900 );
+
+    int month, day, hours, minutes;
+    double seconds;
+    days2mdhms( year, satrec.epochdays, month, day, hours , minutes, seconds );
+
+    int ms = fmod(seconds * 1000.0, 1000.0);
+
+    return QDateTime( QDate( year, month, day ),
+                      QTime( hours, minutes, (int)seconds, ms ),
+                      Qt::UTC ).toTime_t();
+}
+
+double SatellitesPropagator::period( const elsetrec &satrec )
+{
+    // no := mean motion (rad / min)
+    return 60 * (2 * M_PI / satrec.no);
+}
+
+GeoDataCoordinates SatellitesPropagator::fromTEME( const elsetrec &satrec,
+                                                   double x, double y, double z, double gmst )
+{
+    double lon = atan2( y, x );
+    // Rotate the angle by gmst (the origin goes from the vernal equinox point to the Greenwich Meridian)
+    lon = GeoDataCoordinates::normalizeLon( fmod(lon - gmst, 2 * M_PI) );
+
+    double lat = atan2( z, sqrt( x*x + y*y ) );
+
+    double tumin, mu, xke, j2, j3, j4, j3oj2;
+    double radiusearthkm;
+    getgravconst( wgs84, tumin, mu, radiusearthkm, xke, j2, j3, j4, j3oj2 );
+
+    //TODO: determine if this is worth the extra precision
+    // Algorithm from http://celestrak.com/columns/v02n03/
+    //TODO: demonstrate it.
+    double a = radiusearthkm;
+    double R = sqrt( x*x + y*y );
+    double latp = lat;
+    double C;
+    for ( int i = 0; i < 3; i++ ) {
+        C = 1 / sqrt( 1 - satrec.ecco * sin( latp ) * satrec.ecco * sin( latp ) );
+        lat = atan2( z + a * C * satrec.ecco * satrec.ecco * sin( latp ), R );
+    }
+
+    double alt = R / cos( lat ) - a * C;
+
+    lat = GeoDataCoordinates::normalizeLat( lat );
+
+    return GeoDataCoordinates( lon, lat, alt * 1000 );
+}
+
+double SatellitesPropagator::gmst( const elsetrec &satrec, double minutesP )
+{
+    // Earth rotation rate in rad/min, from sgp4io.cpp
+    double rptim = 4.37526908801129966e-3;
+    return fmod( satrec.gsto + rptim * minutesP, 2 * M_PI );
+}
+
+}
@@ -0,0 +1,177 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_SATELLITESPROPAGATOR_H
+#define MARBLE_SATELLITESPROPAGATOR_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+#include "GeoDataCoordinates.h"
+
+#include "sgp4/sgp4unit.h"
+
+class QObject;
+
+namespace Marble {
+
+class SatellitesPropagationBatch;
+
+/**
+ * @short Propagates the orbits of many satellites on a thread pool.
+ *
+ * Each orbit is sampled on a fixed grid of times anchored at the epoch of
+ * the satellite, one hundred samples per period. The propagator remembers
+ * which samples of the window around the requested time were computed
+ * already, so moving the time only computes the samples that entered the
+ * window. The satellites are split into batches which run on a private
+ * thread pool.
+ *
+ * Results are collected until they are taken by takeUpdates(). Whenever
+ * new results are available, the given member of the receiver is invoked
+ * with a queued connection.
+ */
+class SatellitesPropagator
+{
+public:
+    /**
+     * The samples of one orbit which were computed since the last call of
+     * takeUpdates(). All samples of the orbit outside of
+     * [windowStart, windowEnd] are outdated.
+     */
+    struct OrbitUpdate
+    {
+        OrbitUpdate();
+
+        bool isValid() const;
+
+        int satellite;
+        uint windowStart;
+        uint windowEnd;
+        QVector<uint> times;
+        QVector<GeoDataCoordinates> coordinates;
+    };
+
+    SatellitesPropagator( QObject *receiver = 0, const char *member = 0 );
+    ~SatellitesPropagator();
+
+    /**
+     * @brief Adds a satellite and returns its index.
+     * Waits until a running propagation is done.
+     */
+    int addSatellite( const elsetrec &satrec );
+
+    /**
+     * @brief Adds several satellites at once, e.g. a whole catalog.
+     * Waits only once until a running propagation is done.
+     */
+    void addSatellites( const QVector<elsetrec> &satrecs );
+
+    /**
+     * @brief Removes all satellites.
+     * Waits until a running propagation is done.
+     */
+    void clear();
+
+    int satelliteCount() const;
+
+    /**
+     * @brief Requests the orbits around @p time, given in seconds since 1970.
+     * Returns immediately. If a propagation is running already, the request
+     * is handled once it is done, replacing any earlier pending request.
+     */
+    void propagate( uint time );
+
+    /**
+     * @brief Blocks until all requested propagations are done, including
+     * a pending one.
+     */
+    void waitForDone();
+
+    /**
+     * @brief Returns the results collected since the last call.
+     */
+    QVector<OrbitUpdate> takeUpdates();
+
+    /**
+     * @brief Computes the position of a satellite at @p time.
+     * Returns false if the SGP4 model fails for this time.
+     */
+    static bool position( elsetrec &satrec, uint epoch, uint time,
+                          GeoDataCoordinates &coordinates );
+
+    /**
+     * @return The time at the satellite epoch determined from @p satrec,
+     * in seconds since 1970
+     */
+    static uint epoch( const elsetrec &satrec );
+
+    /**
+     * @return The orbital period of the satellite in seconds
+     */
+    static double period( const elsetrec &satrec );
+
+    /**
+     * Create a GeoDataCoordinates object from the cartesian coordinates
+     * @p x, @p y and @p z in km in the Earth-centered inertial frame known
+     * as TEME (True equator, Mean equinox) with Greenwich Mean Sidereal Time
+     * @p gmst in radians at time of observation.
+     */
+    static GeoDataCoordinates fromTEME( const elsetrec &satrec,
+                                        double x, double y, double z, double gmst );
+
+    /**
+     * Returns the Greenwich Mean Sideral Time in radians, @p minutes
+     * after the epoch.
+     */
+    static double gmst( const elsetrec &satrec, double minutes );
+
+private:
+    Q_DISABLE_COPY( SatellitesPropagator )
+
+    friend class SatellitesPropagationBatch;
+
+    struct Orbit
+    {
+        elsetrec satrec;
+        uint epoch;
+        double step;
+        // The range of grid samples computed so far, empty if last < first.
+        qint64 firstSample;
+        qint64 lastSample;
+    };
+
+    void start( uint time );
+    void propagateOrbit( Orbit &orbit, uint time, OrbitUpdate &update );
+    void batchDone();
+
+    QObject *const m_receiver;
+    const char *const m_member;
+
+    QVector<Orbit> m_orbits;
+    QThreadPool m_threadPool;
+
+    // The results of the running propagation, one per orbit.
+    QVector<OrbitUpdate> m_results;
+    QAtomicInt m_remainingBatches;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_done;
+    bool m_running;
+    bool m_hasPendingTime;
+    uint m_pendingTime;
+    QVector<OrbitUpdate> m_published;
+    QVector<int> m_changed;
+};
+
+}
+
+#endif // MARBLE_SATELLITESPROPAGATOR_H
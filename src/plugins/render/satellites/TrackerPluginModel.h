@@ -52,7 +52,7 @@ public:
     /**
      * Remove all items from the model.
      */
-    void clear();
+    virtual void clear();
 
     /**
      * Begin a series of add or remove items operations on the model.
@@ -0,0 +1,173 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "StarCatalog.h"
+
+#include <QtCore/QtAlgorithms>
+
+#include <cmath>
+
+namespace Marble
+{
+
+// The upper magnitude bounds of all size classes but the last one.
+static const qreal classMagnitudes[StarCatalog::SizeClassCount - 1] = { -1, 0, 1, 2, 3, 4, 5 };
+
+static const qreal classSizes[StarCatalog::SizeClassCount] = { 6.5, 5.5, 4.5, 4.0, 3.0, 2.0, 1.0, 0.5 };
+
+class StarMagnitudeLessThan
+{
+ public:
+    explicit StarMagnitudeLessThan( const QVector<StarPoint> &stars )
+        : m_stars( stars )
+    {
+    }
+
+    bool operator()( int a, int b ) const
+    {
+        return m_stars.at( a ).magnitude() < m_stars.at( b ).magnitude();
+    }
+
+ private:
+    const QVector<StarPoint> &m_stars;
+};
+
+StarCatalog::StarCatalog()
+{
+    clear();
+}
+
+void StarCatalog::setStars( const QVector<StarPoint> &stars )
+{
+    QVector<int> order( stars.size() );
+    for ( int i = 0; i < order.size(); ++i ) {
+        order[i] = i;
+    }
+    qStableSort( order.begin(), order.end(), StarMagnitudeLessThan( stars ) );
+
+    m_x.resize( stars.size() );
+    m_y.resize( stars.size() );
+    m_z.resize( stars.size() );
+    m_magnitudes.resize( stars.size() );
+
+    for ( int i = 0; i < order.size(); ++i ) {
+        const StarPoint &star = stars.at( order.at( i ) );
+        m_x[i] = star.quaternion().v[Q_X];
+        m_y[i] = star.quaternion().v[Q_Y];
+        m_z[i] = star.quaternion().v[Q_Z];
+        m_magnitudes[i] = star.magnitude();
+    }
+
+    m_classBegin[0] = 0;
+    for ( int i = 1; i < SizeClassCount; ++i ) {
+        m_classBegin[i] = qLowerBound( m_magnitudes.constBegin(), m_magnitudes.constEnd(),
+                                       classMagnitudes[i - 1] ) - m_magnitudes.constBegin();
+    }
+    m_classBegin[SizeClassCount] = m_magnitudes.size();
+}
+
+void StarCatalog::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_magnitudes.clear();
+
+    for ( int i = 0; i <= SizeClassCount; ++i ) {
+        m_classBegin[i] = 0;
+    }
+}
+
+int StarCatalog::size() const
+{
+    return m_magnitudes.size();
+}
+
+bool StarCatalog::isEmpty() const
+{
+    return m_magnitudes.isEmpty();
+}
+
+qreal StarCatalog::magnitude( int index ) const
+{
+    return m_magnitudes.at( index );
+}
+
+int StarCatalog::sizeClass( qreal magnitude )
+{
+    for ( int i = 0; i < SizeClassCount - 1; ++i ) {
+        if ( magnitude < classMagnitudes[i] ) {
+            return i;
+        }
+    }
+
+    return SizeClassCount - 1;
+}
+
+qreal StarCatalog::starSize( int sizeClass )
+{
+    return classSizes[sizeClass];
+}
+
+qreal StarCatalog::magnitudeLimit( qreal skyRadius )
+{
+    // Stars down to magnitude 6, about what the naked eye can see, for a
+    // sky radius of 400 pixels. Each magnitude is 2.5 times fainter, so
+    // we allow one more magnitude for a sky that is 2.5 times as large.
+    return 6.0 + log( qMax<qreal>( skyRadius, 1.0 ) / 400.0 ) / log( 2.5 );
+}
+
+void StarCatalog::project( const matrix &skyAxisMatrix, qreal skyRadius, qreal earthRadius,
+                           int width, int height, qreal magnitudeLimit, QVector<QPointF> *points ) const
+{
+    const int end = qUpperBound( m_magnitudes.constBegin(), m_magnitudes.constEnd(),
+                                 magnitudeLimit ) - m_magnitudes.constBegin();
+
+    const qreal * const xs = m_x.constData();
+    const qreal * const ys = m_y.constData();
+    const qreal * const zs = m_z.constData();
+
+    const qreal earthRadiusSquared = earthRadius * earthRadius;
+
+    for ( int sizeClass = 0; sizeClass < SizeClassCount; ++sizeClass ) {
+        const int classEnd = qMin( end, m_classBegin[sizeClass + 1] );
+        const qreal offset = classSizes[sizeClass] / 2.0;
+        QVector<QPointF> &classPoints = points[sizeClass];
+
+        for ( int i = m_classBegin[sizeClass]; i < classEnd; ++i ) {
+            const qreal z = skyAxisMatrix[0][2] * xs[i] + skyAxisMatrix[1][2] * ys[i] + skyAxisMatrix[2][2] * zs[i];
+
+            // Stars on the far side of the sky
+            if ( z > 0 ) {
+                continue;
+            }
+
+            const qreal x = skyAxisMatrix[0][0] * xs[i] + skyAxisMatrix[1][0] * ys[i] + skyAxisMatrix[2][0] * zs[i];
+            const qreal y = skyAxisMatrix[0][1] * xs[i] + skyAxisMatrix[1][1] * ys[i] + skyAxisMatrix[2][1] * zs[i];
+
+            const qreal earthCenteredX = x * skyRadius;
+            const qreal earthCenteredY = y * skyRadius;
+
+            // Stars hidden by the globe
+            if ( z < 0 && earthCenteredX * earthCenteredX + earthCenteredY * earthCenteredY < earthRadiusSquared ) {
+                continue;
+            }
+
+            const int screenX = (int)( width / 2 + earthCenteredX );
+            const int screenY = (int)( height / 2 - earthCenteredY );
+
+            if ( screenX < 0 || screenX >= width || screenY < 0 || screenY >= height ) {
+                continue;
+            }
+
+            classPoints.append( QPointF( screenX + offset, screenY + offset ) );
+        }
+    }
+}
+
+}
@@ -0,0 +1,118 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_STARCATALOG_H
+#define MARBLE_STARCATALOG_H
+
+#include <QtCore/QPointF>
+#include <QtCore/QVector>
+
+#include "Quaternion.h"
+
+namespace Marble
+{
+
+class StarPoint
+{
+ public:
+    StarPoint() {}
+    /**
+     * @brief create a starpoint from rectaszension and declination
+     * @param  rect rectaszension
+     * @param  lat declination
+     * @param  mag
+     * (default for Radian: north pole at pi/2, southpole at -pi/2)
+     */
+    StarPoint(qreal rect, qreal decl, qreal mag) {
+        m_q = Quaternion::fromSpherical( rect, decl );
+        m_mag = mag;
+    }
+
+    ~StarPoint(){}
+
+    qreal magnitude() const {
+        return m_mag;
+    }
+
+    const Quaternion &quaternion() const {
+        return m_q;
+    }
+
+ private:
+    qreal      m_mag;
+    Quaternion  m_q;
+};
+
+/**
+ * @short The stars of the sky, prepared for projecting many of them at once.
+ *
+ * The stars are sorted by magnitude and stored as separate arrays of their
+ * coordinates, so that the stars of one size class are adjacent and the
+ * faint stars can be skipped by a single comparison.
+ */
+class StarCatalog
+{
+ public:
+    enum { SizeClassCount = 8 };
+
+    StarCatalog();
+
+    /**
+     * @brief Replaces the stars of the catalog.
+     */
+    void setStars( const QVector<StarPoint> &stars );
+
+    void clear();
+
+    int size() const;
+
+    bool isEmpty() const;
+
+    qreal magnitude( int index ) const;
+
+    /**
+     * @brief The size class a star of the given magnitude belongs to.
+     * Size class 0 holds the brightest stars.
+     */
+    static int sizeClass( qreal magnitude );
+
+    /**
+     * @brief The diameter in pixels of the stars of a size class.
+     */
+    static qreal starSize( int sizeClass );
+
+    /**
+     * @brief The faintest magnitude worth drawing for a sky of the given radius in pixels.
+     * Faint stars only get drawn if the sky is large enough on the screen.
+     */
+    static qreal magnitudeLimit( qreal skyRadius );
+
+    /**
+     * @brief Projects the stars brighter than @p magnitudeLimit onto the screen.
+     *
+     * The sky is rotated by @p skyAxisMatrix and drawn as a sphere of
+     * @p skyRadius pixels around the center of the screen. Stars behind the
+     * globe of @p earthRadius pixels and stars off the screen are skipped.
+     * The centers of the visible stars get appended to @p points, which
+     * must point to SizeClassCount vectors, one per size class.
+     */
+    void project( const matrix &skyAxisMatrix, qreal skyRadius, qreal earthRadius,
+                  int width, int height, qreal magnitudeLimit, QVector<QPointF> *points ) const;
+
+ private:
+    QVector<qreal> m_x;
+    QVector<qreal> m_y;
+    QVector<qreal> m_z;
+    QVector<qreal> m_magnitudes;
+    // The stars of size class i are those from m_classBegin[i] up to m_classBegin[i + 1].
+    int m_classBegin[SizeClassCount + 1];
+};
+
+}
+
+#endif // MARBLE_STARCATALOG_H
@@ -13,6 +13,7 @@
 #include <QtCore/QRectF>
 #include <QtCore/QSize>
 #include <QtCore/QDateTime>
+#include <QtGui/QPainter>
 #include <QtGui/QRegion>
 
 #include "MarbleClock.h"
@@ -28,7 +29,12 @@ namespace Marble
 
 StarsPlugin::StarsPlugin()
     : m_renderStars( false ),
-      m_starsLoaded( false )
+      m_starsLoaded( false ),
+      m_skyLayerValid( false ),
+      m_skyLayerSkyRadius( 0.0 ),
+      m_skyLayerEarthRadius( 0.0 ),
+      m_skyLayerAntialiasing( false ),
+      m_skyLayerRotationAngle( 0.0 )
 {
     setVersion( "1.0" );
     setCopyrightYear( 2008 );
@@ -90,6 +96,7 @@ void StarsPlugin::loadStars() {
     mDebug() << Q_FUNC_INFO;
     // Load star data
     m_stars.clear();
+    m_skyLayerValid = false;
 
     QFile starFile( MarbleDirs::path( "stars/stars.dat" ) );
     starFile.open( QIODevice::ReadOnly );
@@ -112,14 +119,16 @@ void StarsPlugin::loadStars() {
     double de;
     double mag;
 
+    QVector<StarPoint> stars;
     while ( !in.atEnd() ) {
         in >> ra;
         in >> de;
         in >> mag;
         StarPoint star( (qreal)(ra), (qreal)(de), (qreal)(mag) );
-        m_stars << star;
+        stars << star;
 //        mDebug() << "RA:" << ra << "DE:" << de << "MAG:" << mag;
     }
+    m_stars.setStars( stars );
     m_starsLoaded = true;
 }
 
@@ -140,21 +149,12 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
 
         painter->autoMapQuality();
 
-        QPen starPen( Qt::NoPen );
-        QBrush starBrush( Qt::white );
-
-        painter->setPen( starPen );
-        painter->setBrush( starBrush );
-
-        QDateTime currentDateTime = marbleModel()->clockDateTime();
-
-        qreal gmst = siderealTime( currentDateTime );
-        qreal skyRotationAngle = gmst / 12.0 * M_PI;
+        const qreal skyRotation = skyRotationAngle();
 
         const qreal centerLon = viewport->centerLongitude();
         const qreal centerLat = viewport->centerLatitude();
 
-        const Quaternion skyAxis = Quaternion::fromEuler( -centerLat , centerLon + skyRotationAngle, 0.0 );
+        const Quaternion skyAxis = Quaternion::fromEuler( -centerLat , centerLon + skyRotation, 0.0 );
 
         matrix       skyAxisMatrix;
         skyAxis.inverse().toMatrix( skyAxisMatrix );
@@ -170,54 +170,30 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
                 m_starsLoaded = true;
             }
 
-            int x, y;
-
             const qreal  skyRadius      = 0.6 * sqrt( (qreal)viewport->width() * viewport->width() + viewport->height() * viewport->height() );
             const qreal  earthRadius    = viewport->radius();
-
-            QVector<StarPoint>::const_iterator i = m_stars.constBegin();
-            QVector<StarPoint>::const_iterator itEnd = m_stars.constEnd();
-            for (; i != itEnd; ++i)
-            {
-                Quaternion  qpos = (*i).quaternion();
-
-                qpos.rotateAroundAxis( skyAxisMatrix );
-
-                if ( qpos.v[Q_Z] > 0 ) {
-                   continue;
-                }
-
-                qreal  earthCenteredX = qpos.v[Q_X] * skyRadius;
-                qreal  earthCenteredY = qpos.v[Q_Y] * skyRadius;
-
-                // Don't draw high placemarks (e.g. satellites) that aren't visible.
-                if ( qpos.v[Q_Z] < 0
-                    && ( ( earthCenteredX * earthCenteredX
-                            + earthCenteredY * earthCenteredY )
-                        < earthRadius * earthRadius ) ) {
-                    continue;
-                }
-
-                // Let (x, y) be the position on the screen of the placemark..
-                x = (int)(viewport->width()  / 2 + skyRadius * qpos.v[Q_X]);
-                y = (int)(viewport->height() / 2 - skyRadius * qpos.v[Q_Y]);
-
-                // Skip placemarks that are outside the screen area
-                if ( x < 0 || x >= viewport->width()
-    		 || y < 0 || y >= viewport->height() )
-                    continue;
-
-                qreal size;
-                if ( (*i).magnitude() < -1 ) size = 6.5;
-                else if ( (*i).magnitude() < 0 ) size = 5.5;
-                else if ( (*i).magnitude() < 1 ) size = 4.5;
-                else if ( (*i).magnitude() < 2 ) size = 4.0;
-                else if ( (*i).magnitude() < 3 ) size = 3.0;
-                else if ( (*i).magnitude() < 4 ) size = 2.0;
-                else if ( (*i).magnitude() < 5 ) size = 1.0;
-                else size = 0.5;
-                painter->drawEllipse( QRectF( x, y, size, size ) );
+            const bool   antialiasing   = painter->testRenderHint( QPainter::Antialiasing );
+
+            // The angle between the current and the cached rotation of the sky
+            // bounds how far any star moved, re-render once that's a pixel.
+            const qreal cosine = qAbs( skyAxis.v[Q_W] * m_skyLayerAxis.v[Q_W]
+                                     + skyAxis.v[Q_X] * m_skyLayerAxis.v[Q_X]
+                                     + skyAxis.v[Q_Y] * m_skyLayerAxis.v[Q_Y]
+                                     + skyAxis.v[Q_Z] * m_skyLayerAxis.v[Q_Z] );
+            const qreal rotationAngle = 2.0 * acos( qMin<qreal>( cosine, 1.0 ) );
+
+            if ( !m_skyLayerValid
+                 || m_skyLayer.size() != viewport->size()
+                 || m_skyLayerSkyRadius != skyRadius
+                 || m_skyLayerEarthRadius != earthRadius
+                 || m_skyLayerAntialiasing != antialiasing
+                 || rotationAngle * skyRadius >= 1.0 ) {
+                renderSkyLayer( skyAxisMatrix, skyRadius, earthRadius, viewport->size(), antialiasing );
+                m_skyLayerAxis = skyAxis;
+                m_skyLayerRotationAngle = skyRotation;
             }
+
+            painter->drawPixmap( 0, 0, m_skyLayer );
         }
 
         if ( renderStars != m_renderStars ) {
@@ -237,6 +213,46 @@ bool StarsPlugin::render( GeoPainter *painter, ViewportParams *viewport,
     return true;
 }
 
+qreal StarsPlugin::skyRotationAngle()
+{
+    QDateTime currentDateTime = marbleModel()->clockDateTime();
+
+    qreal gmst = siderealTime( currentDateTime );
+    return gmst / 12.0 * M_PI;
+}
+
+void StarsPlugin::renderSkyLayer( const matrix &skyAxisMatrix, qreal skyRadius, qreal earthRadius,
+                                  const QSize &size, bool antialiasing )
+{
+    QVector<QPointF> points[StarCatalog::SizeClassCount];
+    m_stars.project( skyAxisMatrix, skyRadius, earthRadius, size.width(), size.height(),
+                     StarCatalog::magnitudeLimit( skyRadius ), points );
+
+    if ( m_skyLayer.size() != size ) {
+        m_skyLayer = QPixmap( size );
+    }
+    m_skyLayer.fill( Qt::transparent );
+
+    QPainter painter( &m_skyLayer );
+    painter.setRenderHint( QPainter::Antialiasing, antialiasing );
+
+    // A round pen draws each point as a disc of the pen width, which
+    // allows drawing all stars of one size with a single call.
+    for ( int i = 0; i < StarCatalog::SizeClassCount; ++i ) {
+        if ( points[i].isEmpty() ) {
+            continue;
+        }
+
+        painter.setPen( QPen( Qt::white, StarCatalog::starSize( i ), Qt::SolidLine, Qt::RoundCap ) );
+        painter.drawPoints( points[i].constData(), points[i].size() );
+    }
+
+    m_skyLayerSkyRadius = skyRadius;
+    m_skyLayerEarthRadius = earthRadius;
+    m_skyLayerAntialiasing = antialiasing;
+    m_skyLayerValid = true;
+}
+
 qreal StarsPlugin::siderealTime( const QDateTime& localDateTime )
 {
     QDateTime utcDateTime = localDateTime.toTimeSpec ( Qt::UTC );
@@ -257,6 +273,13 @@ qreal StarsPlugin::siderealTime( const QDateTime& localDateTime )
 
 void StarsPlugin::requestRepaint()
 {
+    // Only repaint once the stars moved by a pixel at least.
+    qreal angle = qAbs( skyRotationAngle() - m_skyLayerRotationAngle );
+    angle = qMin<qreal>( angle, 2 * M_PI - angle );
+    if ( m_skyLayerValid && angle * m_skyLayerSkyRadius < 1.0 ) {
+        return;
+    }
+
     emit repaintNeeded( QRegion() );
 }
 
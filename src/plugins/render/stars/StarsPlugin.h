@@ -16,48 +16,17 @@
 #define MARBLESTARSPLUGIN_H
 
 #include <QtCore/QObject>
-#include <QtCore/QVector>
+#include <QtGui/QPixmap>
 
 #include "RenderPlugin.h"
 #include "Quaternion.h"
+#include "StarCatalog.h"
 
 class QDateTime;
 
 namespace Marble
 {
 
-class StarPoint
-{
- public:
-    StarPoint() {}
-    /**
-     * @brief create a starpoint from rectaszension and declination
-     * @param  rect rectaszension
-     * @param  lat declination
-     * @param  mag
-     * (default for Radian: north pole at pi/2, southpole at -pi/2)
-     */
-    StarPoint(qreal rect, qreal decl, qreal mag) {
-        m_q = Quaternion::fromSpherical( rect, decl );
-        m_mag = mag;
-    }
-
-    ~StarPoint(){}
-
-    qreal magnitude() const {
-        return m_mag;
-    }
-
-    const Quaternion &quaternion() const {
-        return m_q;
-    }
-
- private:
-    qreal      m_mag;
-    Quaternion  m_q;
-};
-
-
 /**
  * @short The class that specifies the Marble layer interface of a plugin.
  *
@@ -101,9 +70,30 @@ class StarsPlugin : public RenderPlugin
 
  private:
     void loadStars();
+
+    /**
+     * Returns the sky rotation angle in radians for the current time.
+     */
+    qreal skyRotationAngle();
+
+    /**
+     * Renders the stars into m_skyLayer.
+     */
+    void renderSkyLayer( const matrix &skyAxisMatrix, qreal skyRadius, qreal earthRadius,
+                         const QSize &size, bool antialiasing );
+
     bool m_renderStars;
     bool m_starsLoaded;
-    QVector<StarPoint> m_stars;
+    StarCatalog m_stars;
+
+    // The cached sky and the parameters it was rendered with
+    QPixmap    m_skyLayer;
+    bool       m_skyLayerValid;
+    Quaternion m_skyLayerAxis;
+    qreal      m_skyLayerSkyRadius;
+    qreal      m_skyLayerEarthRadius;
+    bool       m_skyLayerAntialiasing;
+    qreal      m_skyLayerRotationAngle;
 };
 
 }
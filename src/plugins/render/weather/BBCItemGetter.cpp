@@ -12,6 +12,7 @@
 #include "BBCItemGetter.h"
 #include "BBCStation.h"
 #include "BBCWeatherItem.h"
+#include "GeoDataCoordinates.h"
 #include "MarbleDebug.h"
 
 // Qt
@@ -20,6 +21,21 @@
 
 using namespace Marble;
 
+// Stations are sorted into cells of this size in degrees
+const int cellSize = 5;
+const int gridColumns = 360 / cellSize;
+const int gridRows = 180 / cellSize;
+
+static int column( qreal lon )
+{
+    return qBound( 0, int( ( lon + 180.0 ) / cellSize ), gridColumns - 1 );
+}
+
+static int row( qreal lat )
+{
+    return qBound( 0, int( ( lat + 90.0 ) / cellSize ), gridRows - 1 );
+}
+
 BBCItemGetter::BBCItemGetter( QObject *parent )
         : AbstractWorkerThread( parent ),
           m_scheduleMutex(),
@@ -45,42 +61,102 @@ void BBCItemGetter::setSchedule( const GeoDataLatLonAltBox& box,
 
 void BBCItemGetter::setStationList( const QList<BBCStation>& items )
 {
+    // The list is sorted by priority, so are the cells
+    QVector<QVector<int> > grid( gridColumns * gridRows );
+    for ( int i = 0; i < items.size(); ++i ) {
+        const GeoDataCoordinates coordinate = items.at( i ).coordinate();
+        grid[cell( column( coordinate.longitude( GeoDataCoordinates::Degree ) ),
+                   row( coordinate.latitude( GeoDataCoordinates::Degree ) ) )].append( i );
+    }
+
+    m_scheduleMutex.lock();
     m_items = items;
+    m_grid = grid;
+    m_scheduleMutex.unlock();
     ensureRunning();
 }
 
 bool BBCItemGetter::workAvailable()
 {
-    return !m_scheduledBox.isNull()
+    QMutexLocker locker( &m_scheduleMutex );
+    return !m_items.isEmpty()
+           && !m_scheduledBox.isNull()
            && m_scheduledNumber;
-
 }
 
 void BBCItemGetter::work()
 {
-    if ( m_items.isEmpty() ) {
-        sleep( 1 );
-        return;
-    }
-
     m_scheduleMutex.lock();
     GeoDataLatLonAltBox box = m_scheduledBox;
     qint32 number = m_scheduledNumber;
     m_scheduledBox = GeoDataLatLonAltBox();
     m_scheduledNumber = 0;
+    const QList<BBCStation> items = m_items;
+    const QVector<QVector<int> > grid = m_grid;
     m_scheduleMutex.unlock();
 
-    qint32 fetched = 0;
-    QList<BBCStation>::ConstIterator it = m_items.constBegin();
-    QList<BBCStation>::ConstIterator end = m_items.constEnd();
+    // No cell can contribute more than the requested number of stations
+    QVector<int> found;
+    foreach ( int cell, cells( box ) ) {
+        qint32 fetched = 0;
+        QVector<int>::ConstIterator it = grid.at( cell ).constBegin();
+        QVector<int>::ConstIterator end = grid.at( cell ).constEnd();
 
-    while ( fetched < number && it != end ) {
-        if ( box.contains( it->coordinate() ) ) {
-            emit foundStation( (*it) );
-            fetched++;
+        while ( fetched < number && it != end ) {
+            if ( box.contains( items.at( *it ).coordinate() ) ) {
+                found.append( *it );
+                fetched++;
+            }
+            ++it;
         }
-        ++it;
     }
+
+    // Take the ones with the highest priority over all cells
+    qSort( found );
+    for ( int i = 0; i < found.size() && i < number; ++i ) {
+        emit foundStation( items.at( found.at( i ) ) );
+    }
+}
+
+QVector<int> BBCItemGetter::cells( const GeoDataLatLonAltBox& box )
+{
+    QVector<int> columns;
+    const int west = column( box.west( GeoDataCoordinates::Degree ) );
+    const int east = column( box.east( GeoDataCoordinates::Degree ) );
+    if ( box.containsPole() ) {
+        for ( int x = 0; x < gridColumns; ++x ) {
+            columns.append( x );
+        }
+    }
+    else if ( box.crossesDateLine() ) {
+        for ( int x = west; x < gridColumns; ++x ) {
+            columns.append( x );
+        }
+        for ( int x = 0; x <= east; ++x ) {
+            columns.append( x );
+        }
+    }
+    else {
+        for ( int x = west; x <= east; ++x ) {
+            columns.append( x );
+        }
+    }
+
+    QVector<int> result;
+    const int south = row( box.south( GeoDataCoordinates::Degree ) );
+    const int north = row( box.north( GeoDataCoordinates::Degree ) );
+    for ( int y = south; y <= north; ++y ) {
+        foreach ( int x, columns ) {
+            result.append( cell( x, y ) );
+        }
+    }
+
+    return result;
+}
+
+int BBCItemGetter::cell( int column, int row )
+{
+    return row * gridColumns + column;
 }
 
 #include "BBCItemGetter.moc"
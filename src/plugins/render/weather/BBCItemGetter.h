@@ -19,6 +19,7 @@
 #include <QtCore/QList>
 #include <QtCore/QMutex>
 #include <QtCore/QThread>
+#include <QtCore/QVector>
 
 namespace Marble
 {
@@ -47,8 +48,17 @@ class BBCItemGetter : public AbstractWorkerThread
  Q_SIGNALS:
     void foundStation( BBCStation );
 
+ private:
+    /**
+     * The grid cells which cover @p box.
+     */
+    static QVector<int> cells( const GeoDataLatLonAltBox& box );
+    static int cell( int column, int row );
+
  public:
     QList<BBCStation> m_items;
+    // Indices of m_items by grid cell, each cell is sorted by priority
+    QVector<QVector<int> > m_grid;
     QMutex m_scheduleMutex;
     GeoDataLatLonAltBox m_scheduledBox;
     qint32 m_scheduledNumber;
@@ -139,6 +139,7 @@ void BBCWeatherService::setupList()
 
     m_parser = new StationListParser( this );
     m_parser->setPath( MarbleDirs::path( "weather/bbc-stations.xml" ) );
+    m_parser->setCachePath( MarbleDirs::localPath() + "/weather/bbc-stations.cache" );
     connect( m_parser, SIGNAL( finished() ),
              this,     SLOT( fetchStationList() ) );
     if ( m_parser->wait( 100 ) ) {
@@ -18,11 +18,18 @@
 #include "MarbleDebug.h"
 
 // Qt
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QString>
 
 using namespace Marble;
 
+// Increase this when changing the cache file format
+const quint32 cacheVersion = 1;
+
 StationListParser::StationListParser( QObject *parent )
     : QThread( parent ),
       QXmlStreamReader()
@@ -60,8 +67,17 @@ void StationListParser::setPath( QString path )
     m_path = path;
 }
 
+void StationListParser::setCachePath( const QString &cachePath )
+{
+    m_cachePath = cachePath;
+}
+
 void StationListParser::run()
 {
+    if ( readCache() ) {
+        return;
+    }
+
     QFile file( m_path );
 
     if( !file.open( QIODevice::ReadOnly | QIODevice::Text ) ) {
@@ -70,6 +86,80 @@ void StationListParser::run()
 
     setDevice( &file );
     read();
+
+    if ( !hasError() ) {
+        writeCache();
+    }
+}
+
+bool StationListParser::readCache()
+{
+    if ( m_cachePath.isEmpty() ) {
+        return false;
+    }
+
+    QFile file( m_cachePath );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return false;
+    }
+
+    QDataStream stream( &file );
+    quint32 version;
+    QString path;
+    QDateTime lastModified;
+    qint32 count;
+    stream >> version >> path >> lastModified >> count;
+    if ( version != cacheVersion || stream.status() != QDataStream::Ok
+         || path != m_path || lastModified != QFileInfo( m_path ).lastModified() ) {
+        return false;
+    }
+
+    // The stations are stored sorted by priority
+    QList<BBCStation> list;
+    for ( qint32 i = 0; i < count; ++i ) {
+        QString name;
+        quint32 bbcId;
+        quint8 priority;
+        double lon;
+        double lat;
+        stream >> name >> bbcId >> priority >> lon >> lat;
+        if ( stream.status() != QDataStream::Ok ) {
+            return false;
+        }
+
+        BBCStation station;
+        station.setName( name );
+        station.setBbcId( bbcId );
+        station.setPriority( priority );
+        station.setCoordinate( GeoDataCoordinates( lon, lat ) );
+        list.append( station );
+    }
+
+    m_list = list;
+    return true;
+}
+
+void StationListParser::writeCache() const
+{
+    if ( m_cachePath.isEmpty() ) {
+        return;
+    }
+
+    QDir().mkpath( QFileInfo( m_cachePath ).path() );
+    QFile file( m_cachePath );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        mDebug() << "Unable to write the station cache" << m_cachePath;
+        return;
+    }
+
+    QDataStream stream( &file );
+    stream << cacheVersion << m_path << QFileInfo( m_path ).lastModified()
+           << qint32( m_list.size() );
+    foreach ( const BBCStation &station, m_list ) {
+        const GeoDataCoordinates coordinate = station.coordinate();
+        stream << station.name() << station.bbcId() << station.priority()
+               << double( coordinate.longitude() ) << double( coordinate.latitude() );
+    }
 }
 
 void StationListParser::readUnknownElement()
@@ -38,6 +38,12 @@ public:
 
     void setPath( QString path );
 
+    /**
+     * The parsed stations are written to @p cachePath and read from
+     * there as long as the station list did not change.
+     */
+    void setCachePath( const QString &cachePath );
+
 protected:
     void run();
 
@@ -48,7 +54,11 @@ private:
     QString readCharacters();
     void readPoint( BBCStation *station );
 
+    bool readCache();
+    void writeCache() const;
+
     QString m_path;
+    QString m_cachePath;
     QList<BBCStation> m_list;
     QObject *m_parent;
 };
@@ -16,6 +16,7 @@ namespace Marble
 CachePlugin::CachePlugin( QObject *parent ) : RunnerPlugin( parent )
 {
     setCapabilities( Parsing );
+    setFileExtensions( QStringList() << "cache" );
     setName( tr( "Cache File Parser" ) );
     setNameId( "Cache" );
     setDescription( tr( "Create GeoDataDocument from Cache Files" ) );
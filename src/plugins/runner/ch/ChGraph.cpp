@@ -0,0 +1,354 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ChGraph.h"
+
+#include "ChHeap.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+
+#include <cmath>
+
+namespace Marble
+{
+
+const char ChGraph::magic[8] = { 'M', 'A', 'R', 'B', 'L', 'E', 'C', 'H' };
+
+struct ChGraph::Label
+{
+    quint32 distance;
+    quint32 parent;
+    quint32 edge;
+};
+
+ChGraph::ChGraph() :
+    m_header( 0 ),
+    m_longitudes( 0 ),
+    m_latitudes( 0 ),
+    m_firstEdge( 0 ),
+    m_edges( 0 ),
+    m_firstCellNode( 0 ),
+    m_cellNodes( 0 )
+{
+    // nothing to do
+}
+
+ChGraph::~ChGraph()
+{
+    m_file.close();
+}
+
+bool ChGraph::load( const QString &fileName )
+{
+    m_file.close();
+    m_header = 0;
+
+    m_file.setFileName( fileName );
+    if ( !m_file.open( QIODevice::ReadOnly ) || m_file.size() < qint64( sizeof( ChGraphHeader ) ) ) {
+        m_file.close();
+        return false;
+    }
+
+    const uchar *data = m_file.map( 0, m_file.size() );
+    if ( !data ) {
+        m_file.close();
+        return false;
+    }
+
+    const ChGraphHeader *header = reinterpret_cast<const ChGraphHeader *>( data );
+    const qint64 nodes = header->nodeCount;
+    const qint64 edges = header->edgeCount;
+    const qint64 cells = qint64( header->gridColumns ) * header->gridRows;
+    const qint64 expectedSize = sizeof( ChGraphHeader ) + 4 * ( 2 * nodes + nodes + 1 + cells + 1 + nodes )
+                                + edges * sizeof( ChEdge );
+    if ( qstrncmp( header->magic, magic, sizeof( magic ) ) != 0 || header->version != version
+         || cells < 1 || m_file.size() != expectedSize ) {
+        m_file.close();
+        return false;
+    }
+
+    const quint32 *values = reinterpret_cast<const quint32 *>( data + sizeof( ChGraphHeader ) );
+    m_longitudes = reinterpret_cast<const qint32 *>( values );
+    m_latitudes = reinterpret_cast<const qint32 *>( values + nodes );
+    m_firstEdge = values + 2 * nodes;
+    m_edges = reinterpret_cast<const ChEdge *>( m_firstEdge + nodes + 1 );
+    m_firstCellNode = reinterpret_cast<const quint32 *>( m_edges + edges );
+    m_cellNodes = m_firstCellNode + cells + 1;
+
+    if ( header->east < header->west || header->north < header->south
+         || m_firstEdge[0] != 0 || m_firstEdge[nodes] != edges
+         || m_firstCellNode[0] != 0 || m_firstCellNode[cells] != nodes ) {
+        m_file.close();
+        return false;
+    }
+
+    // Queries index with the offsets and node references without further
+    // checks. Edges lead upwards and shortcuts bypass a lower node, which
+    // also keeps unpacking them from recursing endlessly.
+    for ( quint32 node = 0; node < nodes; ++node ) {
+        if ( m_firstEdge[node] > m_firstEdge[node + 1] ) {
+            m_file.close();
+            return false;
+        }
+
+        for ( quint32 i = m_firstEdge[node]; i < m_firstEdge[node + 1]; ++i ) {
+            const ChEdge &edge = m_edges[i];
+            if ( edge.target <= node || edge.target >= nodes
+                 || ( edge.middle != ChEdge::noMiddle && edge.middle >= node ) ) {
+                m_file.close();
+                return false;
+            }
+        }
+    }
+
+    for ( qint64 cell = 0; cell < cells; ++cell ) {
+        if ( m_firstCellNode[cell] > m_firstCellNode[cell + 1] ) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    for ( quint32 i = 0; i < nodes; ++i ) {
+        if ( m_cellNodes[i] >= nodes ) {
+            m_file.close();
+            return false;
+        }
+    }
+
+    m_header = header;
+    return true;
+}
+
+bool ChGraph::isLoaded() const
+{
+    return m_header != 0;
+}
+
+int ChGraph::nodeCount() const
+{
+    return m_header ? m_header->nodeCount : 0;
+}
+
+bool ChGraph::contains( qreal lon, qreal lat ) const
+{
+    if ( !m_header || !m_header->nodeCount ) {
+        return false;
+    }
+
+    const qreal microLon = lon * 1000000.0;
+    const qreal microLat = lat * 1000000.0;
+    return microLon >= m_header->west && microLon <= m_header->east
+           && microLat >= m_header->south && microLat <= m_header->north;
+}
+
+qreal ChGraph::longitude( int node ) const
+{
+    return m_longitudes[node] / 1000000.0;
+}
+
+qreal ChGraph::latitude( int node ) const
+{
+    return m_latitudes[node] / 1000000.0;
+}
+
+int ChGraph::nearestNode( qreal lon, qreal lat ) const
+{
+    if ( !m_header || !m_header->nodeCount ) {
+        return -1;
+    }
+
+    const qreal microLon = qBound<qreal>( -180000000.0, lon * 1000000.0, 180000000.0 );
+    const qreal microLat = qBound<qreal>( -90000000.0, lat * 1000000.0, 90000000.0 );
+    const qreal scale = cos( lat * M_PI / 180.0 );
+
+    const int columns = m_header->gridColumns;
+    const int rows = m_header->gridRows;
+    const qreal cellWidth = ( qreal( m_header->east ) - m_header->west + 1 ) / columns * scale;
+    const qreal cellHeight = ( qreal( m_header->north ) - m_header->south + 1 ) / rows;
+    const qreal cellSize = qMin( cellWidth, cellHeight );
+
+    const int column = m_header->column( qRound( microLon ) );
+    const int row = m_header->row( qRound( microLat ) );
+
+    // Look at rings of cells around the one of the position until no cell
+    // further out can hold a closer node
+    int result = -1;
+    qreal best = 0.0;
+    const int maximumRing = qMax( columns, rows );
+    for ( int ring = 0; ring <= maximumRing; ++ring ) {
+        if ( result >= 0 && ( ring - 1 ) * cellSize > best ) {
+            break;
+        }
+
+        for ( int y = row - ring; y <= row + ring; ++y ) {
+            if ( y < 0 || y >= rows ) {
+                continue;
+            }
+
+            const bool border = y == row - ring || y == row + ring;
+            const int step = border ? 1 : 2 * ring;
+            for ( int x = column - ring; x <= column + ring; x += qMax( 1, step ) ) {
+                if ( x < 0 || x >= columns ) {
+                    continue;
+                }
+
+                const int cell = y * columns + x;
+                for ( quint32 i = m_firstCellNode[cell]; i < m_firstCellNode[cell + 1]; ++i ) {
+                    const quint32 node = m_cellNodes[i];
+                    const qreal dx = ( qreal( m_longitudes[node] ) - microLon ) * scale;
+                    const qreal dy = qreal( m_latitudes[node] ) - microLat;
+                    const qreal distance = sqrt( dx * dx + dy * dy );
+                    if ( result < 0 || distance < best ) {
+                        result = node;
+                        best = distance;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+qint64 ChGraph::route( int source, int target, QVector<int> *path ) const
+{
+    if ( !m_header || source < 0 || target < 0 || source >= nodeCount() || target >= nodeCount() ) {
+        return -1;
+    }
+
+    // A bidirectional Dijkstra search which only follows edges upwards in the
+    // hierarchy. The shortest path goes up from both ends to a common node.
+    QHash<quint32, Label> labels[2];
+    ChHeap<quint32> heaps[2];
+    const quint32 directionFlags[2] = { ChEdge::Forward, ChEdge::Backward };
+
+    const Label start = { 0, ChEdge::noMiddle, ChEdge::noMiddle };
+    labels[0].insert( source, start );
+    labels[1].insert( target, start );
+    heaps[0].push( 0, source );
+    heaps[1].push( 0, target );
+
+    quint32 best = 0xFFFFFFFF;
+    qint64 meeting = -1;
+
+    for ( ;; ) {
+        // Neither search can improve the best path once it got that far
+        for ( int i = 0; i < 2; ++i ) {
+            if ( !heaps[i].isEmpty() && heaps[i].top().key >= best ) {
+                heaps[i].clear();
+            }
+        }
+
+        if ( heaps[0].isEmpty() && heaps[1].isEmpty() ) {
+            break;
+        }
+
+        const int direction = heaps[1].isEmpty() || ( !heaps[0].isEmpty() && heaps[0].top().key <= heaps[1].top().key ) ? 0 : 1;
+        const ChHeap<quint32>::Entry entry = heaps[direction].pop();
+        const quint32 node = entry.node;
+        if ( entry.key > labels[direction].value( node ).distance ) {
+            continue;
+        }
+
+        QHash<quint32, Label>::const_iterator other = labels[1 - direction].constFind( node );
+        if ( other != labels[1 - direction].constEnd() && entry.key + other.value().distance < best ) {
+            best = entry.key + other.value().distance;
+            meeting = node;
+        }
+
+        for ( quint32 i = m_firstEdge[node]; i < m_firstEdge[node + 1]; ++i ) {
+            const ChEdge &edge = m_edges[i];
+            if ( !( edge.flags & directionFlags[direction] ) ) {
+                continue;
+            }
+
+            const quint32 distance = entry.key + edge.weight;
+            QHash<quint32, Label>::iterator label = labels[direction].find( edge.target );
+            if ( label == labels[direction].end() ) {
+                const Label reached = { distance, node, i };
+                labels[direction].insert( edge.target, reached );
+                heaps[direction].push( distance, edge.target );
+            } else if ( distance < label.value().distance ) {
+                label.value().distance = distance;
+                label.value().parent = node;
+                label.value().edge = i;
+                heaps[direction].push( distance, edge.target );
+            }
+        }
+    }
+
+    if ( meeting < 0 ) {
+        return -1;
+    }
+
+    if ( path ) {
+        path->clear();
+
+        // From the source up to the meeting node
+        QVector<quint32> upwards;
+        for ( quint32 node = meeting; node != quint32( source ); node = labels[0].value( node ).parent ) {
+            upwards << node;
+        }
+        upwards << source;
+
+        *path << source;
+        for ( int i = upwards.size() - 1; i > 0; --i ) {
+            unpack( upwards.at( i ), upwards.at( i - 1 ), labels[0].value( upwards.at( i - 1 ) ).edge, path );
+        }
+
+        // And down to the target
+        for ( quint32 node = meeting; node != quint32( target ); ) {
+            const Label &label = labels[1].value( node );
+            unpack( node, label.parent, label.edge, path );
+            node = label.parent;
+        }
+    }
+
+    return best;
+}
+
+void ChGraph::unpack( quint32 from, quint32 to, quint32 edge, QVector<int> *path ) const
+{
+    const quint32 middle = m_edges[edge].middle;
+    if ( middle == ChEdge::noMiddle ) {
+        *path << to;
+        return;
+    }
+
+    const int first = findEdge( from, middle );
+    const int second = findEdge( middle, to );
+    if ( first < 0 || second < 0 ) {
+        // Cannot happen with files written by ChGraphBuilder
+        *path << to;
+        return;
+    }
+
+    unpack( from, middle, first, path );
+    unpack( middle, to, second, path );
+}
+
+int ChGraph::findEdge( quint32 from, quint32 to ) const
+{
+    // Edges are stored with their lower node
+    const quint32 node = qMin( from, to );
+    const quint32 target = qMax( from, to );
+    const quint32 flag = from < to ? ChEdge::Forward : ChEdge::Backward;
+
+    int result = -1;
+    for ( quint32 i = m_firstEdge[node]; i < m_firstEdge[node + 1]; ++i ) {
+        if ( m_edges[i].target == target && ( m_edges[i].flags & flag )
+             && ( result < 0 || m_edges[i].weight < m_edges[result].weight ) ) {
+            result = i;
+        }
+    }
+
+    return result;
+}
+
+}
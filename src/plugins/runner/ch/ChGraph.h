@@ -0,0 +1,148 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CHGRAPH_H
+#define MARBLE_CHGRAPH_H
+
+#include <QtCore/QFile>
+#include <QtCore/QVector>
+
+namespace Marble
+{
+
+/**
+ * The layout of a contraction hierarchy file. All values are stored in host
+ * byte order, coordinates in microdegrees and edge weights in tenths of a second
+ * of travel time. The header is followed by these arrays, each of them
+ * four byte aligned:
+ *
+ * - qint32 longitude[nodeCount], qint32 latitude[nodeCount]
+ * - quint32 firstEdge[nodeCount + 1], the edges of each node
+ * - ChEdge edges[edgeCount]
+ * - quint32 firstCellNode[gridColumns * gridRows + 1], quint32 cellNodes[nodeCount],
+ *   the nodes in each cell of a uniform grid over the bounding box
+ *
+ * Nodes are numbered by the order in which they were contracted. Each edge
+ * is stored with its lower node only and leads upwards to its target.
+ */
+struct ChGraphHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 nodeCount;
+    quint32 edgeCount;
+    quint32 gridColumns;
+    quint32 gridRows;
+    qint32 west;
+    qint32 south;
+    qint32 east;
+    qint32 north;
+    quint32 reserved;
+
+    int column( qint32 lon ) const
+    {
+        const qint64 width = qint64( east ) - west + 1;
+        return qBound<qint64>( 0, ( qint64( lon ) - west ) * gridColumns / width, gridColumns - 1 );
+    }
+
+    int row( qint32 lat ) const
+    {
+        const qint64 height = qint64( north ) - south + 1;
+        return qBound<qint64>( 0, ( qint64( lat ) - south ) * gridRows / height, gridRows - 1 );
+    }
+};
+
+struct ChEdge
+{
+    enum Flag {
+        Forward = 0x1,  ///< The edge can be taken from its node to its target
+        Backward = 0x2  ///< The edge can be taken from its target to its node
+    };
+
+    quint32 target;
+    quint32 weight;
+    quint32 middle;  ///< The node a shortcut bypasses, or noMiddle for road segments
+    quint32 flags;
+
+    static const quint32 noMiddle = 0xFFFFFFFF;
+};
+
+/**
+ * @short A road network prepared as contraction hierarchy for fast shortest path queries.
+ *
+ * The graph is memory mapped from a file written by ChGraphBuilder, so the
+ * operating system keeps just the parts in memory which queries touch. Queries do not modify the graph and can run concurrently.
+ */
+class ChGraph
+{
+public:
+    ChGraph();
+
+    ~ChGraph();
+
+    /**
+     * @brief Maps the given file into memory. Returns false if it is no valid graph file.
+     *
+     * The offsets and node references of the file are checked once, so loading
+     * reads through the whole file.
+     */
+    bool load( const QString &fileName );
+
+    bool isLoaded() const;
+
+    int nodeCount() const;
+
+    /**
+     * @brief Whether the bounding box of the graph contains the given position, in degrees.
+     */
+    bool contains( qreal lon, qreal lat ) const;
+
+    qreal longitude( int node ) const;
+
+    qreal latitude( int node ) const;
+
+    /**
+     * @brief The node closest to the given position in degrees, or -1 for an empty graph.
+     */
+    int nearestNode( qreal lon, qreal lat ) const;
+
+    /**
+     * @brief Calculates the fastest way from @p source to @p target.
+     *
+     * Returns the travel time in tenths of a second, or -1 if the target cannot
+     * be reached. If @p path is given, the nodes along the way are stored in it,
+     * including source and target.
+     */
+    qint64 route( int source, int target, QVector<int> *path = 0 ) const;
+
+    static const char magic[8];
+
+    static const quint32 version = 1;
+
+private:
+    Q_DISABLE_COPY( ChGraph )
+
+    struct Label;
+
+    void unpack( quint32 from, quint32 to, quint32 edge, QVector<int> *path ) const;
+
+    int findEdge( quint32 from, quint32 to ) const;
+
+    QFile m_file;
+    const ChGraphHeader *m_header;
+    const qint32 *m_longitudes;
+    const qint32 *m_latitudes;
+    const quint32 *m_firstEdge;
+    const ChEdge *m_edges;
+    const quint32 *m_firstCellNode;
+    const quint32 *m_cellNodes;
+};
+
+}
+
+#endif
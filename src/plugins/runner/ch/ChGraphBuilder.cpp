@@ -0,0 +1,323 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ChGraphBuilder.h"
+
+#include "ChGraph.h"
+#include "ChHeap.h"
+
+#include <QtCore/QFile>
+
+#include <cmath>
+
+namespace Marble
+{
+
+// Witness searches give up after settling that many nodes and add the
+// shortcut, which is always correct, just possibly superfluous.
+static const int maximumSettledNodes = 500;
+
+static const quint32 infinity = 0xFFFFFFFF;
+
+ChGraphBuilder::ChGraphBuilder()
+{
+    // nothing to do
+}
+
+int ChGraphBuilder::addNode( qreal lon, qreal lat )
+{
+    m_longitudes << qRound( lon * 1000000.0 );
+    m_latitudes << qRound( lat * 1000000.0 );
+    m_outgoing.resize( m_longitudes.size() );
+    m_incoming.resize( m_longitudes.size() );
+    return m_longitudes.size() - 1;
+}
+
+void ChGraphBuilder::addEdge( int from, int to, quint32 weight )
+{
+    Q_ASSERT( from >= 0 && from < nodeCount() && to >= 0 && to < nodeCount() );
+    if ( from == to ) {
+        return;
+    }
+
+    insertEdge( m_outgoing[from], to, weight, ChEdge::noMiddle );
+    insertEdge( m_incoming[to], from, weight, ChEdge::noMiddle );
+}
+
+int ChGraphBuilder::nodeCount() const
+{
+    return m_longitudes.size();
+}
+
+void ChGraphBuilder::insertEdge( QVector<Edge> &edges, quint32 target, quint32 weight, quint32 middle )
+{
+    // Only the fastest of parallel edges matters
+    for ( int i = 0; i < edges.size(); ++i ) {
+        if ( edges.at( i ).target == target ) {
+            if ( weight < edges.at( i ).weight ) {
+                edges[i].weight = weight;
+                edges[i].middle = middle;
+            }
+            return;
+        }
+    }
+
+    Edge edge;
+    edge.target = target;
+    edge.weight = weight;
+    edge.middle = middle;
+    edges << edge;
+}
+
+int ChGraphBuilder::findShortcuts( quint32 node, QVector<quint32> *sources, QVector<Edge> *shortcuts )
+{
+    const QVector<Edge> &outgoing = m_outgoing.at( node );
+    const QVector<Edge> &incoming = m_incoming.at( node );
+
+    quint32 maximumOutgoing = 0;
+    foreach ( const Edge &edge, outgoing ) {
+        maximumOutgoing = qMax( maximumOutgoing, edge.weight );
+    }
+
+    int result = 0;
+    foreach ( const Edge &in, incoming ) {
+        // Look for paths from the source which avoid the node and are not
+        // longer than the ones through it
+        const quint32 limit = in.weight + maximumOutgoing;
+        ChHeap<quint32> heap;
+        m_distance[in.target] = 0;
+        m_touched << in.target;
+        heap.push( 0, in.target );
+
+        int settled = 0;
+        while ( !heap.isEmpty() && settled < maximumSettledNodes ) {
+            const ChHeap<quint32>::Entry entry = heap.pop();
+            if ( entry.key > m_distance.at( entry.node ) ) {
+                continue;
+            }
+            if ( entry.key > limit ) {
+                break;
+            }
+
+            ++settled;
+            foreach ( const Edge &edge, m_outgoing.at( entry.node ) ) {
+                const quint32 distance = entry.key + edge.weight;
+                if ( edge.target != node && distance < m_distance.at( edge.target ) ) {
+                    if ( m_distance.at( edge.target ) == infinity ) {
+                        m_touched << edge.target;
+                    }
+                    m_distance[edge.target] = distance;
+                    heap.push( distance, edge.target );
+                }
+            }
+        }
+
+        foreach ( const Edge &out, outgoing ) {
+            const quint32 weight = in.weight + out.weight;
+            if ( out.target == in.target || m_distance.at( out.target ) <= weight ) {
+                continue;
+            }
+
+            ++result;
+            if ( shortcuts ) {
+                Edge shortcut;
+                shortcut.target = out.target;
+                shortcut.weight = weight;
+                shortcut.middle = node;
+                *shortcuts << shortcut;
+                *sources << in.target;
+            }
+        }
+
+        foreach ( quint32 touched, m_touched ) {
+            m_distance[touched] = infinity;
+        }
+        m_touched.clear();
+    }
+
+    return result;
+}
+
+int ChGraphBuilder::priority( quint32 node )
+{
+    const int removedEdges = m_outgoing.at( node ).size() + m_incoming.at( node ).size();
+    return findShortcuts( node, 0, 0 ) - removedEdges + m_contractedNeighbors.at( node );
+}
+
+void ChGraphBuilder::contract()
+{
+    const int count = nodeCount();
+    m_contracted.fill( false, count );
+    m_contractedNeighbors.fill( 0, count );
+    m_rank.fill( 0, count );
+    m_upward.resize( count );
+    m_distance.fill( infinity, count );
+
+    ChHeap<int> queue;
+    for ( int i = 0; i < count; ++i ) {
+        queue.push( priority( i ), i );
+    }
+
+    quint32 rank = 0;
+    while ( !queue.isEmpty() ) {
+        const quint32 node = queue.pop().node;
+
+        // Priorities change as the neighbors get contracted. They are updated
+        // lazily, just for the node about to be contracted.
+        const int current = priority( node );
+        if ( !queue.isEmpty() && current > queue.top().key ) {
+            queue.push( current, node );
+            continue;
+        }
+
+        QVector<quint32> sources;
+        QVector<Edge> shortcuts;
+        findShortcuts( node, &sources, &shortcuts );
+
+        // The remaining edges of the node all lead upwards
+        foreach ( const Edge &edge, m_outgoing.at( node ) ) {
+            const UpwardEdge upward = { edge.target, edge.weight, edge.middle, ChEdge::Forward };
+            m_upward[node] << upward;
+
+            QVector<Edge> &incoming = m_incoming[edge.target];
+            for ( int i = 0; i < incoming.size(); ++i ) {
+                if ( incoming.at( i ).target == node ) {
+                    incoming.remove( i );
+                    break;
+                }
+            }
+            ++m_contractedNeighbors[edge.target];
+        }
+
+        foreach ( const Edge &edge, m_incoming.at( node ) ) {
+            const UpwardEdge upward = { edge.target, edge.weight, edge.middle, ChEdge::Backward };
+            m_upward[node] << upward;
+
+            QVector<Edge> &outgoing = m_outgoing[edge.target];
+            for ( int i = 0; i < outgoing.size(); ++i ) {
+                if ( outgoing.at( i ).target == node ) {
+                    outgoing.remove( i );
+                    break;
+                }
+            }
+            ++m_contractedNeighbors[edge.target];
+        }
+
+        for ( int i = 0; i < shortcuts.size(); ++i ) {
+            const Edge &shortcut = shortcuts.at( i );
+            insertEdge( m_outgoing[sources.at( i )], shortcut.target, shortcut.weight, shortcut.middle );
+            insertEdge( m_incoming[shortcut.target], sources.at( i ), shortcut.weight, shortcut.middle );
+        }
+
+        m_outgoing[node] = QVector<Edge>();
+        m_incoming[node] = QVector<Edge>();
+        m_contracted[node] = true;
+        m_rank[node] = rank++;
+    }
+}
+
+bool ChGraphBuilder::write( const QString &fileName )
+{
+    const int count = nodeCount();
+    if ( m_rank.size() != count ) {
+        contract();
+    }
+
+    // Nodes are stored in the order of their contraction
+    QVector<quint32> nodes( count );
+    for ( int i = 0; i < count; ++i ) {
+        nodes[m_rank.at( i )] = i;
+    }
+
+    ChGraphHeader header;
+    qMemCopy( header.magic, ChGraph::magic, sizeof( header.magic ) );
+    header.version = ChGraph::version;
+    header.nodeCount = count;
+    header.gridColumns = qMax( 1, int( sqrt( count / 8.0 ) ) );
+    header.gridRows = header.gridColumns;
+    header.west = header.south = header.east = header.north = 0;
+    header.reserved = 0;
+
+    QVector<qint32> longitudes( count );
+    QVector<qint32> latitudes( count );
+    for ( int i = 0; i < count; ++i ) {
+        longitudes[i] = m_longitudes.at( nodes.at( i ) );
+        latitudes[i] = m_latitudes.at( nodes.at( i ) );
+        if ( i == 0 ) {
+            header.west = header.east = longitudes.at( i );
+            header.south = header.north = latitudes.at( i );
+        } else {
+            header.west = qMin( header.west, longitudes.at( i ) );
+            header.east = qMax( header.east, longitudes.at( i ) );
+            header.south = qMin( header.south, latitudes.at( i ) );
+            header.north = qMax( header.north, latitudes.at( i ) );
+        }
+    }
+
+    // Edges which only differ in their direction are stored once
+    QVector<quint32> firstEdge;
+    QVector<ChEdge> edges;
+    for ( int i = 0; i < count; ++i ) {
+        firstEdge << edges.size();
+        foreach ( const UpwardEdge &upward, m_upward.at( nodes.at( i ) ) ) {
+            ChEdge edge;
+            edge.target = m_rank.at( upward.target );
+            edge.weight = upward.weight;
+            edge.middle = upward.middle == ChEdge::noMiddle ? quint32( ChEdge::noMiddle ) : m_rank.at( upward.middle );
+            edge.flags = upward.flags;
+
+            bool merged = false;
+            for ( int j = firstEdge.last(); j < edges.size() && !merged; ++j ) {
+                ChEdge &other = edges[j];
+                if ( other.target == edge.target && other.weight == edge.weight && other.middle == edge.middle ) {
+                    other.flags |= edge.flags;
+                    merged = true;
+                }
+            }
+            if ( !merged ) {
+                edges << edge;
+            }
+        }
+    }
+    firstEdge << edges.size();
+    header.edgeCount = edges.size();
+
+    // Sort the nodes into the grid cells
+    const int cells = header.gridColumns * header.gridRows;
+    QVector<quint32> firstCellNode( cells + 1, 0 );
+    QVector<int> cellOfNode( count );
+    for ( int i = 0; i < count; ++i ) {
+        cellOfNode[i] = header.row( latitudes.at( i ) ) * header.gridColumns + header.column( longitudes.at( i ) );
+        ++firstCellNode[cellOfNode.at( i ) + 1];
+    }
+    for ( int i = 0; i < cells; ++i ) {
+        firstCellNode[i + 1] += firstCellNode.at( i );
+    }
+    QVector<quint32> cellNodes( count );
+    QVector<quint32> next = firstCellNode;
+    for ( int i = 0; i < count; ++i ) {
+        cellNodes[next[cellOfNode.at( i )]++] = i;
+    }
+
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        return false;
+    }
+
+    file.write( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+    file.write( reinterpret_cast<const char *>( longitudes.constData() ), count * sizeof( qint32 ) );
+    file.write( reinterpret_cast<const char *>( latitudes.constData() ), count * sizeof( qint32 ) );
+    file.write( reinterpret_cast<const char *>( firstEdge.constData() ), firstEdge.size() * sizeof( quint32 ) );
+    file.write( reinterpret_cast<const char *>( edges.constData() ), edges.size() * sizeof( ChEdge ) );
+    file.write( reinterpret_cast<const char *>( firstCellNode.constData() ), firstCellNode.size() * sizeof( quint32 ) );
+    file.write( reinterpret_cast<const char *>( cellNodes.constData() ), cellNodes.size() * sizeof( quint32 ) );
+
+    return file.error() == QFile::NoError;
+}
+
+}
@@ -0,0 +1,97 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CHGRAPHBUILDER_H
+#define MARBLE_CHGRAPHBUILDER_H
+
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+namespace Marble
+{
+
+/**
+ * @short Turns a road network into a contraction hierarchy and writes it for ChGraph.
+ *
+ * Nodes are contracted one after another in the order of their edge difference,
+ * the number of shortcuts contracting them needs minus the number of edges
+ * removed. Shortcuts are only added if a limited Dijkstra search finds no
+ * other path of the same length around the contracted node.
+ */
+class ChGraphBuilder
+{
+public:
+    ChGraphBuilder();
+
+    /**
+     * @brief Adds a node at the given position in degrees and returns its id.
+     */
+    int addNode( qreal lon, qreal lat );
+
+    /**
+     * @brief Adds a road from one node to another which takes @p weight tenths of a second.
+     */
+    void addEdge( int from, int to, quint32 weight );
+
+    int nodeCount() const;
+
+    /**
+     * @brief Contracts the network and writes it to the given file.
+     */
+    bool write( const QString &fileName );
+
+private:
+    struct Edge
+    {
+        quint32 target;
+        quint32 weight;
+        quint32 middle;
+    };
+
+    struct UpwardEdge
+    {
+        quint32 target;
+        quint32 weight;
+        quint32 middle;
+        quint32 flags;
+    };
+
+    void contract();
+
+    /**
+     * Determines the shortcuts needed when contracting @p node, or just
+     * their number if @p shortcuts is null.
+     */
+    int findShortcuts( quint32 node, QVector<quint32> *sources, QVector<Edge> *shortcuts );
+
+    int priority( quint32 node );
+
+    static void insertEdge( QVector<Edge> &edges, quint32 target, quint32 weight, quint32 middle );
+
+    QVector<qint32> m_longitudes;
+    QVector<qint32> m_latitudes;
+
+    // The edges among the nodes not contracted yet
+    QVector<QVector<Edge> > m_outgoing;
+    QVector<QVector<Edge> > m_incoming;
+
+    QVector<bool> m_contracted;
+    QVector<int> m_contractedNeighbors;
+
+    // The contraction order of each node and the edges leading upwards from it
+    QVector<quint32> m_rank;
+    QVector<QVector<UpwardEdge> > m_upward;
+
+    // Working memory of the witness search
+    QVector<quint32> m_distance;
+    QVector<quint32> m_touched;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CHHEAP_H
+#define MARBLE_CHHEAP_H
+
+#include <QtCore/QVector>
+
+namespace Marble
+{
+
+/**
+ * @short A binary min heap of nodes keyed by distance, as needed by Dijkstra's algorithm.
+ *
+ * Nodes are not updated in place. Pushing a node again with a smaller key
+ * leaves the old entry behind, which the caller recognizes as outdated when
+ * it is popped.
+ */
+template<typename Key>
+class ChHeap
+{
+public:
+    struct Entry
+    {
+        Key key;
+        quint32 node;
+    };
+
+    bool isEmpty() const
+    {
+        return m_entries.isEmpty();
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+    }
+
+    const Entry &top() const
+    {
+        return m_entries.first();
+    }
+
+    void push( Key key, quint32 node )
+    {
+        Entry entry;
+        entry.key = key;
+        entry.node = node;
+
+        int i = m_entries.size();
+        m_entries.append( entry );
+        while ( i > 0 ) {
+            const int parent = ( i - 1 ) / 2;
+            if ( !( entry.key < m_entries.at( parent ).key ) ) {
+                break;
+            }
+            m_entries[i] = m_entries.at( parent );
+            i = parent;
+        }
+        m_entries[i] = entry;
+    }
+
+    Entry pop()
+    {
+        const Entry result = m_entries.first();
+        const Entry last = m_entries.last();
+        m_entries.remove( m_entries.size() - 1 );
+
+        const int size = m_entries.size();
+        if ( size > 0 ) {
+            int i = 0;
+            for ( ;; ) {
+                int child = 2 * i + 1;
+                if ( child >= size ) {
+                    break;
+                }
+                if ( child + 1 < size && m_entries.at( child + 1 ).key < m_entries.at( child ).key ) {
+                    ++child;
+                }
+                if ( !( m_entries.at( child ).key < last.key ) ) {
+                    break;
+                }
+                m_entries[i] = m_entries.at( child );
+                i = child;
+            }
+            m_entries[i] = last;
+        }
+
+        return result;
+    }
+
+private:
+    QVector<Entry> m_entries;
+};
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ChPlugin.h"
+
+#include "ChGraph.h"
+#include "ChRunner.h"
+#include "MarbleDebug.h"
+#include "MarbleDirs.h"
+#include "routing/RouteRequest.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+namespace Marble
+{
+
+ChPlugin::ChPlugin( QObject *parent ) : RunnerPlugin( parent )
+{
+    setCapabilities( Routing );
+    setSupportedCelestialBodies( QStringList() << "earth" );
+    setCanWorkOffline( true );
+    setName( tr( "Contraction Hierarchies" ) );
+    setNameId( "ch" );
+    setDescription( tr( "Calculates routes offline on prepared road networks" ) );
+    setGuiString( tr( "Offline Routing" ) );
+}
+
+ChPlugin::~ChPlugin()
+{
+    qDeleteAll( m_graphs );
+}
+
+MarbleAbstractRunner* ChPlugin::newRunner() const
+{
+    return new ChRunner( this );
+}
+
+bool ChPlugin::supportsTemplate( RoutingProfilesModel::ProfileTemplate profileTemplate ) const
+{
+    // The networks are weighted by the travel time of cars
+    return profileTemplate == RoutingProfilesModel::CarFastestTemplate;
+}
+
+bool ChPlugin::canWork( Capability capability ) const
+{
+    if ( supports( capability ) ) {
+        return !QDir( mapDirectory() ).entryList( QStringList() << "*.ch", QDir::Files ).isEmpty();
+    } else {
+        return false;
+    }
+}
+
+QString ChPlugin::mapDirectory()
+{
+    return MarbleDirs::localPath() + "/maps/earth/ch/";
+}
+
+const ChGraph *ChPlugin::graph( const RouteRequest *request ) const
+{
+    QMutexLocker locker( &m_mutex );
+
+    const QDir directory( mapDirectory() );
+    foreach ( const QFileInfo &file, directory.entryInfoList( QStringList() << "*.ch", QDir::Files, QDir::Name ) ) {
+        const QString fileName = file.absoluteFilePath();
+        if ( !m_graphs.contains( fileName ) ) {
+            ChGraph *graph = new ChGraph;
+            if ( !graph->load( fileName ) ) {
+                mDebug() << "Ignoring invalid road network" << fileName;
+                delete graph;
+                graph = 0;
+            }
+            m_graphs.insert( fileName, graph );
+        }
+
+        const ChGraph *graph = m_graphs.value( fileName );
+        if ( !graph ) {
+            continue;
+        }
+
+        bool covered = true;
+        for ( int i = 0; i < request->size() && covered; ++i ) {
+            covered = graph->contains( request->at( i ).longitude( GeoDataCoordinates::Degree ),
+                                       request->at( i ).latitude( GeoDataCoordinates::Degree ) );
+        }
+        if ( covered ) {
+            return graph;
+        }
+    }
+
+    return 0;
+}
+
+}
+
+Q_EXPORT_PLUGIN2( ChPlugin, Marble::ChPlugin )
+
+#include "ChPlugin.moc"
@@ -0,0 +1,61 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CHPLUGIN_H
+#define MARBLE_CHPLUGIN_H
+
+#include "RunnerPlugin.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+
+namespace Marble
+{
+
+class ChGraph;
+class RouteRequest;
+
+/**
+ * @short Calculates routes in-process on road networks prepared as contraction hierarchies.
+ *
+ * The networks are read from the *.ch files in maps/earth/ch/ of the local
+ * Marble data directory, which the osm-ch tool creates from OpenStreetMap
+ * data. Each file is mapped into memory once and shared by all runners.
+ */
+class ChPlugin : public RunnerPlugin
+{
+    Q_OBJECT
+    Q_INTERFACES( Marble::RunnerPlugin )
+
+public:
+    explicit ChPlugin( QObject *parent = 0 );
+
+    ~ChPlugin();
+
+    virtual MarbleAbstractRunner* newRunner() const;
+
+    bool supportsTemplate( RoutingProfilesModel::ProfileTemplate profileTemplate ) const;
+
+    virtual bool canWork( Capability capability ) const;
+
+    /**
+     * @brief The road network which covers all waypoints of the request, if any.
+     */
+    const ChGraph *graph( const RouteRequest *request ) const;
+
+private:
+    static QString mapDirectory();
+
+    mutable QMutex m_mutex;
+
+    mutable QHash<QString, ChGraph*> m_graphs;
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ChRunner.h"
+
+#include "ChGraph.h"
+#include "ChPlugin.h"
+#include "MarbleDebug.h"
+#include "MarbleMath.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataPlacemark.h"
+#include "routing/RouteRequest.h"
+
+namespace Marble
+{
+
+ChRunner::ChRunner( const ChPlugin *plugin, QObject *parent ) :
+    MarbleAbstractRunner( parent ),
+    m_plugin( plugin )
+{
+    // nothing to do
+}
+
+GeoDataFeature::GeoDataVisualCategory ChRunner::category() const
+{
+    return GeoDataFeature::OsmSite;
+}
+
+void ChRunner::retrieveRoute( const RouteRequest *request )
+{
+    const ChGraph *graph = request->size() < 2 ? 0 : m_plugin->graph( request );
+    if ( !graph ) {
+        emit routeCalculated( 0 );
+        return;
+    }
+
+    GeoDataLineString *waypoints = new GeoDataLineString;
+    qint64 duration = 0;
+    int source = graph->nearestNode( request->at( 0 ).longitude( GeoDataCoordinates::Degree ),
+                                     request->at( 0 ).latitude( GeoDataCoordinates::Degree ) );
+
+    for ( int i = 1; i < request->size(); ++i ) {
+        const int target = graph->nearestNode( request->at( i ).longitude( GeoDataCoordinates::Degree ),
+                                               request->at( i ).latitude( GeoDataCoordinates::Degree ) );
+        QVector<int> path;
+        const qint64 legDuration = graph->route( source, target, &path );
+        if ( legDuration < 0 ) {
+            mDebug() << "No route between waypoints" << i - 1 << "and" << i;
+            delete waypoints;
+            emit routeCalculated( 0 );
+            return;
+        }
+
+        duration += legDuration;
+        // Each leg starts where the previous one ended
+        for ( int j = waypoints->isEmpty() ? 0 : 1; j < path.size(); ++j ) {
+            *waypoints << GeoDataCoordinates( graph->longitude( path.at( j ) ), graph->latitude( path.at( j ) ),
+                                              0.0, GeoDataCoordinates::Degree );
+        }
+        source = target;
+    }
+
+    GeoDataDocument *result = new GeoDataDocument;
+    GeoDataPlacemark *routePlacemark = new GeoDataPlacemark;
+    routePlacemark->setName( "Route" );
+    routePlacemark->setGeometry( waypoints );
+    result->append( routePlacemark );
+
+    QString name = "%1 %2 (CH)";
+    QString unit = "m";
+    qreal length = waypoints->length( EARTH_RADIUS );
+    if ( length >= 1000 ) {
+        length /= 1000.0;
+        unit = "km";
+    }
+    result->setName( name.arg( length, 0, 'f', 1 ).arg( unit ) );
+    mDebug() << "Route of" << duration / 10 << "seconds";
+
+    emit routeCalculated( result );
+}
+
+}
+
+#include "ChRunner.moc"
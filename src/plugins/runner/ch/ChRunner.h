@@ -0,0 +1,37 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_CHRUNNER_H
+#define MARBLE_CHRUNNER_H
+
+#include "MarbleAbstractRunner.h"
+
+namespace Marble
+{
+
+class ChPlugin;
+
+class ChRunner : public MarbleAbstractRunner
+{
+    Q_OBJECT
+public:
+    explicit ChRunner( const ChPlugin *plugin, QObject *parent = 0 );
+
+    // Overriding MarbleAbstractRunner
+    GeoDataFeature::GeoDataVisualCategory category() const;
+
+    // Overriding MarbleAbstractRunner
+    virtual void retrieveRoute( const RouteRequest *request );
+
+private:
+    const ChPlugin *const m_plugin;
+};
+
+}
+
+#endif
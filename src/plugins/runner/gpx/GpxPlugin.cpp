@@ -16,6 +16,7 @@ namespace Marble
 GpxPlugin::GpxPlugin( QObject *parent ) : RunnerPlugin( parent )
 {
     setCapabilities( Parsing );
+    setFileExtensions( QStringList() << "gpx" );
     setName( tr( "Gpx File Parser" ) );
     setNameId( "Gpx" );
     setDescription( tr( "Create GeoDataDocument from Gpx Files" ) );
@@ -23,6 +23,7 @@
 
 #include "GPXElementDictionary.h"
 #include "GeoParser.h"
+#include "GeoCoordinatesTokenizer.h"
 #include "GeoDataLineString.h"
 #include "GeoDataCoordinates.h"
 #include "GeoDataPlacemark.h"
@@ -54,12 +55,12 @@ GeoNode* GPXrteptTagHandler::parse(GeoParser& parser) const
         tmp = attributes.value(gpxTag_lat);
         if ( !tmp.isEmpty() )
         {
-            lat = tmp.toString().toFloat();
+            lat = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         tmp = attributes.value(gpxTag_lon);
         if ( !tmp.isEmpty() )
         {
-            lon = tmp.toString().toFloat();
+            lon = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         coord.set(lon, lat, 0, GeoDataCoordinates::Degree);
         linestring->append(coord);
@@ -23,6 +23,7 @@
 
 #include "GPXElementDictionary.h"
 #include "GeoParser.h"
+#include "GeoCoordinatesTokenizer.h"
 #include "GeoDataLineString.h"
 #include "GeoDataCoordinates.h"
 #include "GeoDataTrack.h"
@@ -50,12 +51,12 @@ GeoNode* GPXtrkptTagHandler::parse(GeoParser& parser) const
         tmp = attributes.value(gpxTag_lat);
         if ( !tmp.isEmpty() )
         {
-            lat = tmp.toString().toDouble();
+            lat = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         tmp = attributes.value(gpxTag_lon);
         if ( !tmp.isEmpty() )
         {
-            lon = tmp.toString().toDouble();
+            lon = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         coord.set(lon, lat, 0, GeoDataCoordinates::Degree);
         track->appendCoordinates( coord );
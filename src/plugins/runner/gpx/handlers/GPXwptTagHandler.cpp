@@ -23,6 +23,7 @@
 
 #include "GPXElementDictionary.h"
 #include "GeoParser.h"
+#include "GeoCoordinatesTokenizer.h"
 #include "GeoDataDocument.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataPoint.h"
@@ -50,16 +51,16 @@ GeoNode* GPXwptTagHandler::parse(GeoParser& parser) const
         tmp = attributes.value(gpxTag_lat);
         if ( !tmp.isEmpty() )
         {
-            lat = tmp.toString().toFloat();
+            lat = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         tmp = attributes.value(gpxTag_lon);
         if ( !tmp.isEmpty() )
         {
-            lon = tmp.toString().toFloat();
+            lon = GeoCoordinatesTokenizer::toDouble( tmp );
         }
         placemark->setCoordinate( lon, lat, 0, GeoDataPoint::Degree );
         
-        placemark->setStyle(&doc->style("waypoint"));
+        placemark->setStyle(&doc->styleForEditing("waypoint"));
         
         doc->append(placemark);
 #ifdef DEBUG_TAGS
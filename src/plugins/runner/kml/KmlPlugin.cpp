@@ -16,6 +16,7 @@ namespace Marble
 KmlPlugin::KmlPlugin( QObject *parent ) : RunnerPlugin( parent )
 {
     setCapabilities( Parsing );
+    setFileExtensions( QStringList() << "kml" );
     setName( tr( "Kml File Parser" ) );
     setNameId( "Kml" );
     setDescription( tr( "Create GeoDataDocument from Kml Files" ) );
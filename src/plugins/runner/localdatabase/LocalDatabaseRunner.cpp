@@ -12,7 +12,7 @@
 
 #include "MarbleAbstractRunner.h"
 #include "MarbleModel.h"
-#include "MarblePlacemarkModel.h"
+#include "PlacemarkIndexModel.h"
 #include "GeoDataFeature.h"
 #include "GeoDataPlacemark.h"
 #include "GeoDataCoordinates.h"
@@ -46,23 +46,14 @@ void LocalDatabaseRunner::search( const QString &searchTerm )
     QVector<GeoDataPlacemark*> vector;
 
     if (model()) {
-        QAbstractItemModel * placemarkModel = model()->placemarkModel();
+        const PlacemarkIndexModel * placemarkModel = qobject_cast<const PlacemarkIndexModel*>( model()->placemarkModel() );
 
         if (placemarkModel) {
-            QModelIndexList resultList;
-            QModelIndex firstIndex = placemarkModel->index( 0, 0 );
-            resultList = placemarkModel->match( firstIndex,
-                                    Qt::DisplayRole, searchTerm, -1,
-                                    Qt::MatchStartsWith );
-
-            foreach ( const QModelIndex& index, resultList )
+            // Walk the placemarks directly instead of matching through QVariants
+            const QVector<GeoDataPlacemark*> placemarks = placemarkModel->placemarks();
+            foreach ( const GeoDataPlacemark *placemark, placemarks )
             {
-                if( !index.isValid() ) {
-                    mDebug() << "invalid index!!!";
-                    continue;
-                }
-                GeoDataPlacemark *placemark = dynamic_cast<GeoDataPlacemark*>(qvariant_cast<GeoDataObject*>( index.data( MarblePlacemarkModel::ObjectPointerRole )));
-                if ( placemark ) {
+                if ( placemark->name().startsWith( searchTerm, Qt::CaseInsensitive ) ) {
                     vector.append( new GeoDataPlacemark( *placemark ));
                 }
             }
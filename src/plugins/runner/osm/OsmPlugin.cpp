@@ -16,6 +16,7 @@ namespace Marble
 OsmPlugin::OsmPlugin( QObject *parent ) : RunnerPlugin( parent )
 {
     setCapabilities( Parsing );
+    setFileExtensions( QStringList() << "osm" );
     setName( tr( "Osm File Parser" ) );
     setNameId( "Osm" );
     setDescription( tr( "Create GeoDataDocument from Osm Files" ) );
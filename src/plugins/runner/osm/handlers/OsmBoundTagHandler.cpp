@@ -49,7 +49,7 @@ GeoNode* OsmBoundTagHandler::parse( GeoParser& parser ) const
     GeoDataPlacemark *pl = new GeoDataPlacemark();
     pl->setGeometry( p );
     pl->setVisualCategory( GeoDataFeature::None );
-    pl->setStyle( &doc->style( "background" ) );
+    pl->setStyle( &doc->styleForEditing( "background" ) );
     pl->setVisible( true );
     doc->append( pl );
 
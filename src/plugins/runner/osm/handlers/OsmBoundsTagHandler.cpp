@@ -48,7 +48,7 @@ GeoNode* OsmBoundsTagHandler::parse( GeoParser& parser ) const
     GeoDataPlacemark *pl = new GeoDataPlacemark();
     pl->setGeometry( p );
     pl->setVisualCategory( GeoDataFeature::None );
-    pl->setStyle( &doc->style( "background" ) );
+    pl->setStyle( &doc->styleForEditing( "background" ) );
     pl->setVisible( true );
     doc->append( pl );
 
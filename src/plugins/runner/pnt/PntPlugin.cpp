@@ -16,6 +16,7 @@ namespace Marble
 PntPlugin::PntPlugin( QObject *parent ) : RunnerPlugin( parent )
 {
     setCapabilities( Parsing );
+    setFileExtensions( QStringList() << "pnt" );
     setName( tr( "Pnt File Parser" ) );
     setNameId( "Pnt" );
     setDescription( tr( "Create GeoDataDocument from Pnt Files" ) );
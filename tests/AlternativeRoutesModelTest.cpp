@@ -0,0 +1,247 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtGui/QPainter>
+
+#include "routing/AlternativeRoutesModel.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataPlacemark.h"
+
+#include <cmath>
+
+Q_DECLARE_METATYPE( QVector<QPointF> )
+
+namespace Marble
+{
+
+class AlternativeRoutesModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void duplicates_data();
+    void duplicates();
+
+    void dateLine_data();
+    void dateLine();
+
+ private:
+    static QVector<QPointF> baseRoute();
+
+    /**
+     * Moves the part of the route between @p from and @p to, given as a fraction
+     * of its points, sideways by up to @p offset degrees in a smooth bump.
+     */
+    static QVector<QPointF> detour( const QVector<QPointF> &route, qreal from, qreal to, qreal offset );
+
+    /**
+     * Moves the route east, so that it starts at the date line and crosses it.
+     */
+    static QVector<QPointF> acrossDateLine( const QVector<QPointF> &route );
+
+    static GeoDataDocument *document( const QVector<QPointF> &route );
+
+    /**
+     * The similarity of two routes as it used to be determined, by drawing
+     * them into a small image and counting the pixels.
+     */
+    static qreal rasterSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB );
+
+    static qreal unidirectionalRasterSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB );
+};
+
+QVector<QPointF> AlternativeRoutesModelTest::baseRoute()
+{
+    // About 19 x 19 km with a point every 26 meters
+    QVector<QPointF> result;
+    for ( int i = 0; i < 1000; ++i ) {
+        result << QPointF( 8.0 + 0.25 * i / 999, 48.0 + 0.17 * i / 999 );
+    }
+    return result;
+}
+
+QVector<QPointF> AlternativeRoutesModelTest::detour( const QVector<QPointF> &route, qreal from, qreal to, qreal offset )
+{
+    const QPointF direction = route.last() - route.first();
+    const qreal length = sqrt( direction.x() * direction.x() + direction.y() * direction.y() );
+    const QPointF normal( -direction.y() / length, direction.x() / length );
+
+    QVector<QPointF> result;
+    for ( int i = 0; i < route.size(); ++i ) {
+        const qreal t = qreal( i ) / ( route.size() - 1 );
+        const qreal bump = ( t < from || t > to ) ? 0.0 : sin( M_PI * ( t - from ) / ( to - from ) );
+        result << route.at( i ) + normal * bump * offset;
+    }
+    return result;
+}
+
+QVector<QPointF> AlternativeRoutesModelTest::acrossDateLine( const QVector<QPointF> &route )
+{
+    QVector<QPointF> result;
+    foreach ( const QPointF &point, route ) {
+        const qreal longitude = point.x() - route.first().x() + 180.0;
+        result << QPointF( longitude > 180.0 ? longitude - 360.0 : longitude, point.y() );
+    }
+    return result;
+}
+
+GeoDataDocument *AlternativeRoutesModelTest::document( const QVector<QPointF> &route )
+{
+    GeoDataLineString *lineString = new GeoDataLineString;
+    foreach ( const QPointF &point, route ) {
+        *lineString << GeoDataCoordinates( point.x(), point.y(), 0.0, GeoDataCoordinates::Degree );
+    }
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setName( "Route" );
+    placemark->setGeometry( lineString );
+
+    GeoDataDocument *result = new GeoDataDocument;
+    result->append( placemark );
+    return result;
+}
+
+qreal AlternativeRoutesModelTest::rasterSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB )
+{
+    return qMax<qreal>( unidirectionalRasterSimilarity( routeA, routeB ),
+                        unidirectionalRasterSimilarity( routeB, routeA ) );
+}
+
+qreal AlternativeRoutesModelTest::unidirectionalRasterSimilarity( const GeoDataLineString &routeA, const GeoDataLineString &routeB )
+{
+    QImage image( 64, 64, QImage::Format_ARGB32_Premultiplied );
+    image.fill( qRgb( 0, 0, 0 ) );
+    GeoDataLatLonBox box = GeoDataLatLonBox::fromLineString( routeA );
+    box = box.united( GeoDataLatLonBox::fromLineString( routeB ) );
+    if ( !box.width() || !box.height() ) {
+        return 0.0;
+    }
+
+    const qreal sw = image.width() / box.width();
+    const qreal sh = image.height() / box.height();
+
+    QPainter painter( &image );
+    painter.setPen( QColor( Qt::white ) );
+
+    int counts[2];
+    const GeoDataLineString *routes[2] = { &routeA, &routeB };
+    for ( int r = 0; r < 2; ++r ) {
+        QPolygonF polygon;
+        for ( int i = 0; i < routes[r]->size(); ++i ) {
+            polygon << QPointF( qAbs( routes[r]->at( i ).longitude() - box.west() ) * sw,
+                                qAbs( routes[r]->at( i ).latitude() - box.north() ) * sh );
+        }
+        painter.drawPoints( polygon );
+
+        counts[r] = 0;
+        for ( int y = 0; y < image.height(); ++y ) {
+            const QRgb *line = reinterpret_cast<const QRgb *>( image.scanLine( y ) );
+            for ( int x = 0; x < image.width(); ++x ) {
+                counts[r] += line[x] == qRgb( 0, 0, 0 ) ? 0 : 1;
+            }
+        }
+    }
+
+    return counts[1] ? 1.0 - qreal( counts[1] - counts[0] ) / counts[1] : 0;
+}
+
+void AlternativeRoutesModelTest::duplicates_data()
+{
+    QTest::addColumn<QVector<QPointF> >( "alternative" );
+    QTest::addColumn<bool>( "duplicate" );
+
+    const QVector<QPointF> route = baseRoute();
+
+    QVector<QPointF> jittered;
+    qsrand( 1 );
+    foreach ( const QPointF &point, route ) {
+        jittered << point + QPointF( ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 1e-4,
+                                     ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 1e-4 );
+    }
+
+    QVector<QPointF> reversed;
+    foreach ( const QPointF &point, route ) {
+        reversed.prepend( point );
+    }
+
+    QVector<QPointF> elsewhere;
+    foreach ( const QPointF &point, route ) {
+        elsewhere << point + QPointF( 1.0, 0.0 );
+    }
+
+    QTest::newRow( "identical" ) << route << true;
+    QTest::newRow( "jittered" ) << jittered << true;
+    QTest::newRow( "reversed" ) << reversed << true;
+    QTest::newRow( "small detour" ) << detour( route, 0.45, 0.55, 0.005 ) << true;
+    QTest::newRow( "alternative" ) << detour( route, 0.2, 0.8, 0.04 ) << false;
+    QTest::newRow( "elsewhere" ) << elsewhere << false;
+}
+
+void AlternativeRoutesModelTest::duplicates()
+{
+    QFETCH( QVector<QPointF>, alternative );
+    QFETCH( bool, duplicate );
+
+    GeoDataDocument *first = document( baseRoute() );
+    GeoDataDocument *second = document( alternative );
+
+    // The decision agrees with the one of the old raster based comparison
+    const qreal similarity = rasterSimilarity( *AlternativeRoutesModel::waypoints( first ),
+                                               *AlternativeRoutesModel::waypoints( second ) );
+    QCOMPARE( similarity > 0.8, duplicate );
+
+    AlternativeRoutesModel model;
+    model.addRoute( first, AlternativeRoutesModel::Instant );
+    model.addRoute( second );
+
+    // Duplicates either replace the first route or are dropped
+    QCOMPARE( model.rowCount(), duplicate ? 1 : 2 );
+    if ( duplicate ) {
+        delete ( model.route( 0 ) == first ? second : first );
+    }
+}
+
+void AlternativeRoutesModelTest::dateLine_data()
+{
+    QTest::addColumn<QVector<QPointF> >( "alternative" );
+    QTest::addColumn<bool>( "duplicate" );
+
+    const QVector<QPointF> route = baseRoute();
+
+    QTest::newRow( "identical" ) << acrossDateLine( route ) << true;
+    QTest::newRow( "small detour" ) << acrossDateLine( detour( route, 0.45, 0.55, 0.005 ) ) << true;
+    QTest::newRow( "alternative" ) << acrossDateLine( detour( route, 0.2, 0.8, 0.04 ) ) << false;
+}
+
+void AlternativeRoutesModelTest::dateLine()
+{
+    QFETCH( QVector<QPointF>, alternative );
+    QFETCH( bool, duplicate );
+
+    // The raster comparison doesn't work across the date line, the
+    // decisions are the same as for the routes in duplicates() though.
+    GeoDataDocument *first = document( acrossDateLine( baseRoute() ) );
+    GeoDataDocument *second = document( alternative );
+
+    AlternativeRoutesModel model;
+    model.addRoute( first, AlternativeRoutesModel::Instant );
+    model.addRoute( second );
+
+    QCOMPARE( model.rowCount(), duplicate ? 1 : 2 );
+    if ( duplicate ) {
+        delete ( model.route( 0 ) == first ? second : first );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::AlternativeRoutesModelTest )
+
+#include "AlternativeRoutesModelTest.moc"
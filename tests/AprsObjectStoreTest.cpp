@@ -0,0 +1,276 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtCore/QtConcurrentRun>
+
+#include "AprsFile.h"
+#include "AprsGatherer.h"
+#include "AprsObject.h"
+#include "AprsObjectStore.h"
+#include "GeoDataLatLonBox.h"
+
+namespace Marble
+{
+
+// Stations and packets of the replayed feed
+static const int stations = 500;
+static const int packets = 50000;
+
+class AprsObjectStoreTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void history();
+    void culling();
+    void expire();
+    void expireRepeatedPosition();
+    void concurrentProducers();
+    void replay();
+
+    void benchmarkApply();
+    void benchmarkCulling();
+
+ private:
+    static AprsPacket packet( const QString &callSign, qreal lon, qreal lat );
+
+    /**
+     * Queues one packet for every station on a grid over Europe and
+     * North America, @p round moves them a bit.
+     */
+    static void enqueueStations( AprsObjectStore *store, int round );
+
+    /**
+     * Sends @p count packets of station @p callSign, moving eastwards.
+     */
+    static void produce( AprsObjectStore *store, const QString &callSign, int count );
+
+    QString m_fileName;
+};
+
+AprsPacket AprsObjectStoreTest::packet( const QString &callSign, qreal lon, qreal lat )
+{
+    AprsPacket result;
+    result.callSign = callSign;
+    result.longitude = lon;
+    result.latitude = lat;
+    result.seenFrom = GeoAprsCoordinates::FromFile;
+    return result;
+}
+
+void AprsObjectStoreTest::enqueueStations( AprsObjectStore *store, int round )
+{
+    for ( int i = 0; i < stations; ++i ) {
+        const qreal lon = ( i % 2 ? -100.0 : 0.0 ) + ( i % 25 ) + round * 0.001;
+        const qreal lat = 30.0 + ( i / 25 ) + round * 0.001;
+        store->enqueue( packet( QString( "S%1" ).arg( i ), lon, lat ) );
+    }
+}
+
+void AprsObjectStoreTest::produce( AprsObjectStore *store, const QString &callSign, int count )
+{
+    for ( int i = 0; i < count; ++i ) {
+        store->enqueue( packet( callSign, i * 0.0001, 0.0 ) );
+    }
+}
+
+void AprsObjectStoreTest::initTestCase()
+{
+    // Position reports as sent by APRS-IS, every station moves northeast
+    m_fileName = QDir::tempPath() + "/marble-aprsobjectstoretest.txt";
+    QFile file( m_fileName );
+    QVERIFY( file.open( QFile::WriteOnly | QFile::Truncate ) );
+    QTextStream stream( &file );
+    for ( int i = 0; i < packets; ++i ) {
+        const int station = i % stations;
+        const int step = i / stations;
+        stream << QString( "T%1>APRS,TCPIP*:!%2%3.%4N/%5%6.%7W-Replayed\n" )
+                  .arg( station )
+                  .arg( 30 + station / 25, 2, 10, QChar( '0' ) )
+                  .arg( step / 100 % 60, 2, 10, QChar( '0' ) )
+                  .arg( step % 100, 2, 10, QChar( '0' ) )
+                  .arg( 80 + station % 25, 3, 10, QChar( '0' ) )
+                  .arg( step / 100 % 60, 2, 10, QChar( '0' ) )
+                  .arg( step % 100, 2, 10, QChar( '0' ) );
+    }
+}
+
+void AprsObjectStoreTest::cleanupTestCase()
+{
+    QFile::remove( m_fileName );
+}
+
+void AprsObjectStoreTest::history()
+{
+    AprsObject object( 0.0, 0.0, "TEST" );
+    for ( int i = 1; i < 100; ++i ) {
+        object.setLocation( i, i, GeoAprsCoordinates::FromTCPIP );
+    }
+
+    // Only the latest positions are kept
+    QCOMPARE( object.historySize(), int( AprsObject::maxHistorySize ) );
+    QCOMPARE( object.location().longitude( GeoDataCoordinates::Degree ), 99.0 );
+    const int oldest = 100 - AprsObject::maxHistorySize;
+    QCOMPARE( object.boundingBox().west( GeoDataCoordinates::Degree ), qreal( oldest ) );
+    QCOMPARE( object.boundingBox().east( GeoDataCoordinates::Degree ), 99.0 );
+
+    // Positions seen before are not added again
+    object.setLocation( 70.0, 70.0, GeoAprsCoordinates::FromTTY );
+    QCOMPARE( object.historySize(), int( AprsObject::maxHistorySize ) );
+    QCOMPARE( object.location().longitude( GeoDataCoordinates::Degree ), 99.0 );
+    QCOMPARE( object.boundingBox().west( GeoDataCoordinates::Degree ), qreal( oldest ) );
+
+    // Dropped ones are
+    object.setLocation( 0.0, 0.0, GeoAprsCoordinates::FromTTY );
+    QCOMPARE( object.location().longitude( GeoDataCoordinates::Degree ), 0.0 );
+    QCOMPARE( object.boundingBox().west( GeoDataCoordinates::Degree ), 0.0 );
+}
+
+void AprsObjectStoreTest::culling()
+{
+    AprsObjectStore store;
+    enqueueStations( &store, 0 );
+    QCOMPARE( store.applyPending(), stations );
+    QCOMPARE( store.count(), stations );
+
+    const GeoDataLatLonBox europe( 70.0, 20.0, 40.0, -20.0, GeoDataCoordinates::Degree );
+    const GeoDataLatLonBox pacific( 50.0, -50.0, -150.0, 150.0, GeoDataCoordinates::Degree );
+    QCOMPARE( store.objects( europe ).size(), stations / 2 );
+    QCOMPARE( store.objects( pacific ).size(), 0 );
+
+    // A station leaving the box with its track still in it is drawn
+    store.enqueue( packet( "S0", 100.0, 30.0 ) );
+    store.applyPending();
+    QVERIFY( store.objects( europe ).contains( store.object( "S0" ) ) );
+}
+
+void AprsObjectStoreTest::expire()
+{
+    AprsObjectStore store;
+    store.enqueue( packet( "OLD", 0.0, 0.0 ) );
+    store.applyPending();
+    QTest::qWait( 100 );
+    store.enqueue( packet( "NEW", 0.0, 0.0 ) );
+    store.applyPending();
+
+    QCOMPARE( store.expire( 50 ), 1 );
+    QVERIFY( !store.object( "OLD" ) );
+    QVERIFY( store.object( "NEW" ) );
+}
+
+void AprsObjectStoreTest::expireRepeatedPosition()
+{
+    AprsObjectStore store;
+    store.enqueue( packet( "PARKED", 0.0, 0.0 ) );
+    store.enqueue( packet( "PARKED", 1.0, 1.0 ) );
+    store.applyPending();
+    QTest::qWait( 100 );
+
+    // Back at the first position, which updates that older history entry
+    store.enqueue( packet( "PARKED", 0.0, 0.0 ) );
+    store.applyPending();
+    QCOMPARE( store.object( "PARKED" )->historySize(), 2 );
+    QVERIFY( store.object( "PARKED" )->location().timestamp().elapsed() >= 100 );
+
+    QCOMPARE( store.expire( 50 ), 0 );
+    QVERIFY( store.object( "PARKED" ) );
+}
+
+void AprsObjectStoreTest::concurrentProducers()
+{
+    // Packets of each producer arrive in order, none get lost
+    AprsObjectStore store;
+    const int count = 20000;
+    QList<QFuture<void> > producers;
+    for ( int i = 0; i < 4; ++i ) {
+        producers << QtConcurrent::run( &AprsObjectStoreTest::produce, &store, QString( "P%1" ).arg( i ), count );
+    }
+
+    int applied = 0;
+    bool finished = false;
+    while ( !finished ) {
+        finished = true;
+        foreach ( const QFuture<void> &producer, producers ) {
+            finished = finished && producer.isFinished();
+        }
+        applied += store.applyPending();
+    }
+    applied += store.applyPending();
+
+    QCOMPARE( applied, 4 * count );
+    QCOMPARE( store.count(), 4 );
+    for ( int i = 0; i < 4; ++i ) {
+        const AprsObject *object = store.object( QString( "P%1" ).arg( i ) );
+        QVERIFY( object );
+        QCOMPARE( object->location().longitude( GeoDataCoordinates::Degree ), ( count - 1 ) * 0.0001 );
+    }
+}
+
+void AprsObjectStoreTest::replay()
+{
+    AprsObjectStore store;
+    AprsFile *source = new AprsFile( m_fileName );
+    AprsGatherer *gatherer = new AprsGatherer( source, &store, 0, 0 );
+    gatherer->setSeenFrom( GeoAprsCoordinates::FromFile );
+
+    QTime timer;
+    timer.start();
+    gatherer->start();
+    int applied = 0;
+    while ( applied < packets && timer.elapsed() < 60000 ) {
+        applied += store.applyPending();
+        QTest::qWait( 10 );
+    }
+    const int elapsed = timer.elapsed();
+    gatherer->shutDown();
+    QVERIFY( gatherer->wait( 5000 ) );
+    delete gatherer;
+    delete source;
+
+    qDebug() << "Replayed" << applied << "packets in" << elapsed << "ms";
+    QCOMPARE( applied, packets );
+    QCOMPARE( store.count(), stations );
+    QCOMPARE( store.object( "T0" )->historySize(), int( AprsObject::maxHistorySize ) );
+}
+
+void AprsObjectStoreTest::benchmarkApply()
+{
+    AprsObjectStore store;
+    int round = 0;
+    QBENCHMARK {
+        for ( int i = 0; i < 10; ++i ) {
+            enqueueStations( &store, round++ );
+        }
+        store.applyPending();
+    }
+    QCOMPARE( store.count(), stations );
+}
+
+void AprsObjectStoreTest::benchmarkCulling()
+{
+    AprsObjectStore store;
+    for ( int round = 0; round < AprsObject::maxHistorySize; ++round ) {
+        enqueueStations( &store, round );
+    }
+    store.applyPending();
+
+    const GeoDataLatLonBox europe( 70.0, 20.0, 40.0, -20.0, GeoDataCoordinates::Degree );
+    QBENCHMARK {
+        store.objects( europe );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::AprsObjectStoreTest )
+
+#include "AprsObjectStoreTest.moc"
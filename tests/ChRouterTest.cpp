@@ -0,0 +1,285 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "ChGraph.h"
+#include "ChGraphBuilder.h"
+#include "ChHeap.h"
+
+namespace Marble
+{
+
+// A grid of streets, 0.002 degrees apart from west to east and 0.0015
+// degrees from south to north, roughly 150 meters in both directions.
+static const int columns = 60;
+static const int rows = 60;
+
+class ChRouterTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void nearestNode();
+    void routes();
+    void corruptedFile_data();
+    void corruptedFile();
+
+    void benchmarkDijkstra();
+    void benchmarkContractionHierarchy();
+
+ private:
+    struct Road
+    {
+        int target;
+        quint32 weight;
+    };
+
+    static qreal longitude( int node );
+    static qreal latitude( int node );
+
+    /**
+     * The travel time from @p source to @p target on the original streets,
+     * or -1 if there is no way.
+     */
+    qint64 dijkstra( int source, int target ) const;
+
+    /**
+     * The grid node a node of the contraction hierarchy corresponds to.
+     */
+    int gridNode( int node ) const;
+
+    QVector<QVector<Road> > m_roads;
+    QVector<QPair<int, int> > m_queries;
+    QString m_fileName;
+    ChGraph m_graph;
+};
+
+qreal ChRouterTest::longitude( int node )
+{
+    return 8.0 + ( node % columns ) * 0.002;
+}
+
+qreal ChRouterTest::latitude( int node )
+{
+    return 48.0 + ( node / columns ) * 0.0015;
+}
+
+int ChRouterTest::gridNode( int node ) const
+{
+    const int column = qRound( ( m_graph.longitude( node ) - 8.0 ) / 0.002 );
+    const int row = qRound( ( m_graph.latitude( node ) - 48.0 ) / 0.0015 );
+    return row * columns + column;
+}
+
+void ChRouterTest::initTestCase()
+{
+    // Streets with random travel times, every tenth one missing. Every
+    // seventh row is a one way street eastwards.
+    qsrand( 17 );
+    ChGraphBuilder builder;
+    m_roads.resize( columns * rows );
+    for ( int node = 0; node < columns * rows; ++node ) {
+        QCOMPARE( builder.addNode( longitude( node ), latitude( node ) ), node );
+    }
+
+    for ( int node = 0; node < columns * rows; ++node ) {
+        const int column = node % columns;
+        const int row = node / columns;
+        if ( column + 1 < columns && qrand() % 10 ) {
+            const Road east = { node + 1, quint32( 100 + qrand() % 100 ) };
+            m_roads[node] << east;
+            builder.addEdge( node, east.target, east.weight );
+            if ( row % 7 ) {
+                const Road west = { node, east.weight };
+                m_roads[node + 1] << west;
+                builder.addEdge( node + 1, node, west.weight );
+            }
+        }
+        if ( row + 1 < rows && qrand() % 10 ) {
+            const Road north = { node + columns, quint32( 100 + qrand() % 100 ) };
+            const Road south = { node, quint32( north.weight + qrand() % 20 ) };
+            m_roads[node] << north;
+            m_roads[node + columns] << south;
+            builder.addEdge( node, north.target, north.weight );
+            builder.addEdge( node + columns, node, south.weight );
+        }
+    }
+
+    m_fileName = QDir::tempPath() + "/marble-chroutertest.ch";
+    QVERIFY( builder.write( m_fileName ) );
+    QVERIFY( m_graph.load( m_fileName ) );
+    QCOMPARE( m_graph.nodeCount(), columns * rows );
+
+    for ( int i = 0; i < 200; ++i ) {
+        m_queries << qMakePair( qrand() % ( columns * rows ), qrand() % ( columns * rows ) );
+    }
+}
+
+void ChRouterTest::cleanupTestCase()
+{
+    QFile::remove( m_fileName );
+}
+
+qint64 ChRouterTest::dijkstra( int source, int target ) const
+{
+    QVector<quint32> distances( m_roads.size(), 0xFFFFFFFF );
+    ChHeap<quint32> heap;
+    distances[source] = 0;
+    heap.push( 0, source );
+
+    while ( !heap.isEmpty() ) {
+        const ChHeap<quint32>::Entry entry = heap.pop();
+        if ( entry.node == quint32( target ) ) {
+            return entry.key;
+        }
+        if ( entry.key > distances.at( entry.node ) ) {
+            continue;
+        }
+
+        foreach ( const Road &road, m_roads.at( entry.node ) ) {
+            if ( entry.key + road.weight < distances.at( road.target ) ) {
+                distances[road.target] = entry.key + road.weight;
+                heap.push( distances.at( road.target ), road.target );
+            }
+        }
+    }
+
+    return -1;
+}
+
+void ChRouterTest::nearestNode()
+{
+    QCOMPARE( gridNode( m_graph.nearestNode( longitude( 0 ), latitude( 0 ) ) ), 0 );
+    QCOMPARE( gridNode( m_graph.nearestNode( 7.5, 47.5 ) ), 0 );
+    QCOMPARE( gridNode( m_graph.nearestNode( 9.0, 49.0 ) ), columns * rows - 1 );
+
+    for ( int i = 0; i < 100; ++i ) {
+        const int node = qrand() % ( columns * rows );
+        const qreal lon = longitude( node ) + ( qrand() % 900 - 450 ) * 0.000001;
+        const qreal lat = latitude( node ) + ( qrand() % 700 - 350 ) * 0.000001;
+        QCOMPARE( gridNode( m_graph.nearestNode( lon, lat ) ), node );
+    }
+}
+
+void ChRouterTest::routes()
+{
+    for ( int i = 0; i < m_queries.size(); ++i ) {
+        const int source = m_queries.at( i ).first;
+        const int target = m_queries.at( i ).second;
+        const int from = m_graph.nearestNode( longitude( source ), latitude( source ) );
+        const int to = m_graph.nearestNode( longitude( target ), latitude( target ) );
+
+        QVector<int> path;
+        const qint64 duration = m_graph.route( from, to, &path );
+        QCOMPARE( duration, dijkstra( source, target ) );
+        if ( duration < 0 ) {
+            continue;
+        }
+
+        // The unpacked path follows the streets and takes as long as calculated
+        QCOMPARE( gridNode( path.first() ), source );
+        QCOMPARE( gridNode( path.last() ), target );
+        qint64 sum = 0;
+        for ( int j = 1; j < path.size(); ++j ) {
+            const int a = gridNode( path.at( j - 1 ) );
+            const int b = gridNode( path.at( j ) );
+            qint64 weight = -1;
+            foreach ( const Road &road, m_roads.at( a ) ) {
+                if ( road.target == b && ( weight < 0 || road.weight < weight ) ) {
+                    weight = road.weight;
+                }
+            }
+            QVERIFY( weight >= 0 );
+            sum += weight;
+        }
+        QCOMPARE( sum, duration );
+    }
+}
+
+void ChRouterTest::corruptedFile_data()
+{
+    const qint64 nodes = columns * rows;
+    const qint64 firstEdge = sizeof( ChGraphHeader ) + 2 * 4 * nodes;
+    const qint64 edges = firstEdge + 4 * ( nodes + 1 );
+
+    QFile file( m_fileName );
+    QVERIFY( file.open( QIODevice::ReadOnly ) );
+    ChGraphHeader header;
+    QCOMPARE( file.read( reinterpret_cast<char *>( &header ), sizeof( header ) ), qint64( sizeof( header ) ) );
+    const qint64 firstCellNode = edges + header.edgeCount * sizeof( ChEdge );
+    const qint64 cellNodes = firstCellNode + 4 * ( qint64( header.gridColumns ) * header.gridRows + 1 );
+
+    QTest::addColumn<qint64>( "offset" );
+    QTest::addColumn<quint32>( "value" );
+
+    QTest::newRow( "edge offsets" ) << firstEdge + 4 << quint32( header.edgeCount + 1 );
+    QTest::newRow( "edge target" ) << edges << quint32( nodes );
+    QTest::newRow( "downward edge" ) << edges << quint32( 0 );
+    QTest::newRow( "shortcut middle" ) << edges + 8 << quint32( nodes - 1 );
+    QTest::newRow( "cell offsets" ) << firstCellNode + 4 << quint32( nodes + 1 );
+    QTest::newRow( "cell node" ) << cellNodes << quint32( nodes );
+}
+
+void ChRouterTest::corruptedFile()
+{
+    QFETCH( qint64, offset );
+    QFETCH( quint32, value );
+
+    QFile original( m_fileName );
+    QVERIFY( original.open( QIODevice::ReadOnly ) );
+    QByteArray data = original.readAll();
+    memcpy( data.data() + offset, &value, sizeof( value ) );
+
+    const QString fileName = QDir::tempPath() + "/marble-chroutertest-corrupted.ch";
+    QFile corrupted( fileName );
+    QVERIFY( corrupted.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+    QCOMPARE( corrupted.write( data ), qint64( data.size() ) );
+    corrupted.close();
+
+    ChGraph graph;
+    QVERIFY( !graph.load( fileName ) );
+    QVERIFY( !graph.isLoaded() );
+    QFile::remove( fileName );
+}
+
+void ChRouterTest::benchmarkDijkstra()
+{
+    QBENCHMARK {
+        for ( int i = 0; i < m_queries.size(); ++i ) {
+            dijkstra( m_queries.at( i ).first, m_queries.at( i ).second );
+        }
+    }
+}
+
+void ChRouterTest::benchmarkContractionHierarchy()
+{
+    QVector<QPair<int, int> > queries;
+    for ( int i = 0; i < m_queries.size(); ++i ) {
+        const int source = m_queries.at( i ).first;
+        const int target = m_queries.at( i ).second;
+        queries << qMakePair( m_graph.nearestNode( longitude( source ), latitude( source ) ),
+                              m_graph.nearestNode( longitude( target ), latitude( target ) ) );
+    }
+
+    QBENCHMARK {
+        QVector<int> path;
+        for ( int i = 0; i < queries.size(); ++i ) {
+            m_graph.route( queries.at( i ).first, queries.at( i ).second, &path );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ChRouterTest )
+
+#include "ChRouterTest.moc"
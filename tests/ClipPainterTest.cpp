@@ -0,0 +1,146 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtCore/QVector>
+#include <QtGui/QImage>
+#include <QtGui/QPolygonF>
+#include <QtTest/QtTest>
+#include "ClipPainter.h"
+
+namespace Marble
+{
+
+class ClipPainterTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void compareEngines_data();
+    void compareEngines();
+
+    void benchmarkClipping_data();
+    void benchmarkClipping();
+
+ private:
+    static QPolygonF randomPolygon( int size, const QRectF &area );
+
+    QImage m_image;
+};
+
+QPolygonF ClipPainterTest::randomPolygon( int size, const QRectF &area )
+{
+    QPolygonF polygon;
+    polygon.reserve( size );
+
+    // A random walk resembles projected coast lines more than uniformly
+    // scattered nodes, but still crosses the viewport border frequently.
+    QPointF point( area.left() + qrand() % int( area.width() ),
+                   area.top() + qrand() % int( area.height() ) );
+    const qreal step = area.width() / 20.0;
+
+    for ( int i = 0; i < size; ++i ) {
+        point += QPointF( step * ( qrand() / qreal( RAND_MAX ) - 0.5 ),
+                          step * ( qrand() / qreal( RAND_MAX ) - 0.5 ) );
+        point.setX( qBound( area.left(), point.x(), area.right() ) );
+        point.setY( qBound( area.top(), point.y(), area.bottom() ) );
+        polygon << point;
+    }
+
+    return polygon;
+}
+
+void ClipPainterTest::initTestCase()
+{
+    m_image = QImage( 800, 600, QImage::Format_ARGB32_Premultiplied );
+    qsrand( 42 );
+}
+
+void ClipPainterTest::compareEngines_data()
+{
+    QTest::addColumn<QRectF>( "area" );
+    QTest::addColumn<int>( "size" );
+    QTest::addColumn<bool>( "isClosed" );
+
+    const QRectF inside( 10, 10, 780, 580 );
+    const QRectF around( -800, -600, 2400, 1800 );
+    const QRectF outside( -2000, -2000, 1000, 1000 );
+
+    QTest::newRow( "inside polygon" ) << inside << 500 << true;
+    QTest::newRow( "inside polyline" ) << inside << 500 << false;
+    QTest::newRow( "around polygon" ) << around << 500 << true;
+    QTest::newRow( "around polyline" ) << around << 500 << false;
+    QTest::newRow( "outside polygon" ) << outside << 500 << true;
+    QTest::newRow( "outside polyline" ) << outside << 500 << false;
+    QTest::newRow( "single node polygon" ) << around << 1 << true;
+    QTest::newRow( "two node polyline" ) << around << 2 << false;
+}
+
+void ClipPainterTest::compareEngines()
+{
+    QFETCH( QRectF, area );
+    QFETCH( int, size );
+    QFETCH( bool, isClosed );
+
+    ClipPainter painter( &m_image, true );
+
+    for ( int run = 0; run < 200; ++run ) {
+        const QPolygonF polygon = randomPolygon( size, area );
+
+        QVector<QPolygonF> expected;
+        painter.setBatchClipping( false );
+        painter.clipPolygon( polygon, expected, isClosed );
+
+        QVector<QPolygonF> actual;
+        painter.setBatchClipping( true );
+        painter.clipPolygon( polygon, actual, isClosed );
+
+        QCOMPARE( actual.size(), expected.size() );
+        for ( int i = 0; i < expected.size(); ++i ) {
+            QCOMPARE( actual.at( i ), expected.at( i ) );
+        }
+    }
+}
+
+void ClipPainterTest::benchmarkClipping_data()
+{
+    QTest::addColumn<bool>( "batchClipping" );
+
+    QTest::newRow( "point by point" ) << false;
+    QTest::newRow( "batched" ) << true;
+}
+
+void ClipPainterTest::benchmarkClipping()
+{
+    QFETCH( bool, batchClipping );
+
+    QVector<QPolygonF> polygons;
+    for ( int i = 0; i < 100; ++i ) {
+        polygons << randomPolygon( 1000, QRectF( -800, -600, 2400, 1800 ) );
+        polygons << randomPolygon( 1000, QRectF( 10, 10, 780, 580 ) );
+        polygons << randomPolygon( 1000, QRectF( -2000, -2000, 1000, 1000 ) );
+    }
+
+    ClipPainter painter( &m_image, true );
+    painter.setBatchClipping( batchClipping );
+
+    QVector<QPolygonF> clippedPolyObjects;
+    QBENCHMARK {
+        foreach ( const QPolygonF &polygon, polygons ) {
+            clippedPolyObjects.resize( 0 );
+            painter.clipPolygon( polygon, clippedPolyObjects, true );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ClipPainterTest )
+
+#include "ClipPainterTest.moc"
@@ -0,0 +1,226 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtCore/QtConcurrentRun>
+
+#include "ElevationModel.h"
+#include "GeoDataLineString.h"
+#include "MarbleDirs.h"
+#include "MarbleModel.h"
+
+namespace Marble
+{
+
+// The srtm2 theme: 1024 x 512 tiles on level 9, 384 pixels per degree
+// for the tile size used here.
+static const int tileSize = 135;
+static const qreal pixelsPerDegree = 384;
+
+// The synthetic elevation tiles cover the tiles from ( firstTileX, firstTileY )
+// on, tileCount tiles in both directions.
+static const int firstTileX = 560;
+static const int firstTileY = 100;
+static const int tileCount = 4;
+
+static QVector<qreal> routeHeights( const ElevationModel *elevationModel, const GeoDataLineString &route )
+{
+    return elevationModel->heights( route );
+}
+
+class ElevationModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void heights();
+    void heightsFromThreads();
+    void heightProfile();
+
+    void benchmarkHeight();
+    void benchmarkHeights();
+
+ private:
+    /**
+     * The height of the synthetic data at the given pixel of level 9,
+     * a plane which bilinear interpolation reproduces exactly.
+     */
+    static int syntheticHeight( qreal x, qreal y );
+
+    static void writeTile( const QString &fileName, int tileX, int tileY );
+
+    void removeDataPath( const QString &path );
+
+    QString m_dataPath;
+    QString m_oldDataPath;
+    MarbleModel *m_model;
+    GeoDataLineString m_route;
+};
+
+int ElevationModelTest::syntheticHeight( qreal x, qreal y )
+{
+    return qRound( ( x - firstTileX * tileSize ) + 2 * ( y - firstTileY * tileSize ) );
+}
+
+void ElevationModelTest::writeTile( const QString &fileName, int tileX, int tileY )
+{
+    QImage tile( tileSize, tileSize, QImage::Format_RGB32 );
+    for ( int y = 0; y < tileSize; ++y ) {
+        for ( int x = 0; x < tileSize; ++x ) {
+            const int height = qMax( 0, syntheticHeight( tileX * tileSize + x, tileY * tileSize + y ) );
+            tile.setPixel( x, y, qRgb( 0, height >> 8, height & 0xFF ) );
+        }
+    }
+
+    QDir().mkpath( QFileInfo( fileName ).path() );
+    QVERIFY( tile.save( fileName, "PNG" ) );
+}
+
+void ElevationModelTest::initTestCase()
+{
+    m_dataPath = QDir::tempPath() + "/marble-elevationmodeltest";
+    removeDataPath( m_dataPath );
+
+    const QString themePath = m_dataPath + "/maps/earth/srtm2";
+    QDir().mkpath( themePath );
+    QVERIFY( QFile::copy( MarbleDirs::path( "maps/earth/srtm2/srtm2.dgml" ), themePath + "/srtm2.dgml" ) );
+
+    // The base tile determines the tile size
+    writeTile( themePath + "/0/000000/000000_000000.png", 0, 0 );
+
+    for ( int tileY = firstTileY; tileY < firstTileY + tileCount; ++tileY ) {
+        for ( int tileX = firstTileX; tileX < firstTileX + tileCount; ++tileX ) {
+            writeTile( QString( "%1/9/%2/%2_%3.png" ).arg( themePath )
+                       .arg( tileY, 6, 10, QChar( '0' ) )
+                       .arg( tileX, 6, 10, QChar( '0' ) ), tileX, tileY );
+        }
+    }
+
+    m_oldDataPath = MarbleDirs::marbleDataPath();
+    MarbleDirs::setMarbleDataPath( m_dataPath );
+    m_model = new MarbleModel;
+
+    // A route diagonally across all tiles, about four samples per pixel
+    const qreal west = -180 + ( firstTileX * tileSize + 2 ) / pixelsPerDegree;
+    const qreal east = -180 + ( ( firstTileX + tileCount ) * tileSize - 2 ) / pixelsPerDegree;
+    const qreal north = 90 - ( firstTileY * tileSize + 2 ) / pixelsPerDegree;
+    const qreal south = 90 - ( ( firstTileY + tileCount ) * tileSize - 2 ) / pixelsPerDegree;
+    const int count = 4 * tileCount * tileSize;
+    for ( int i = 0; i < count; ++i ) {
+        const qreal lon = west + ( east - west ) * i / ( count - 1 );
+        const qreal lat = north + ( south - north ) * i / ( count - 1 );
+        m_route << GeoDataCoordinates( lon, lat, 0, GeoDataCoordinates::Degree );
+    }
+}
+
+void ElevationModelTest::cleanupTestCase()
+{
+    delete m_model;
+    MarbleDirs::setMarbleDataPath( m_oldDataPath );
+    removeDataPath( m_dataPath );
+}
+
+void ElevationModelTest::removeDataPath( const QString &path )
+{
+    QDirIterator it( path, QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() ) {
+        QFile::remove( it.next() );
+    }
+
+    QDirIterator dirs( path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
+    QStringList directories;
+    while ( dirs.hasNext() ) {
+        directories.prepend( dirs.next() );
+    }
+    foreach ( const QString &directory, directories ) {
+        QDir().rmdir( directory );
+    }
+    QDir().rmdir( path );
+}
+
+void ElevationModelTest::heights()
+{
+    const ElevationModel *elevationModel = m_model->elevationModel();
+    const QVector<qreal> heights = elevationModel->heights( m_route );
+    QCOMPARE( heights.size(), m_route.size() );
+
+    for ( int i = 0; i < m_route.size(); ++i ) {
+        const qreal lon = m_route.at( i ).longitude( GeoDataCoordinates::Degree );
+        const qreal lat = m_route.at( i ).latitude( GeoDataCoordinates::Degree );
+        const qreal x = ( 180 + lon ) * pixelsPerDegree;
+        const qreal y = ( 90 - lat ) * pixelsPerDegree;
+        const qreal expected = ( x - firstTileX * tileSize ) + 2 * ( y - firstTileY * tileSize );
+
+        QVERIFY( qAbs( heights.at( i ) - expected ) < 1e-6 );
+        QCOMPARE( elevationModel->height( lon, lat ), heights.at( i ) );
+    }
+}
+
+void ElevationModelTest::heightsFromThreads()
+{
+    const ElevationModel *elevationModel = m_model->elevationModel();
+    const QVector<qreal> expected = elevationModel->heights( m_route );
+
+    // All tiles are in memory now, so other threads get the same results.
+    QList<QFuture<QVector<qreal> > > futures;
+    for ( int i = 0; i < 8; ++i ) {
+        futures << QtConcurrent::run( routeHeights, elevationModel, m_route );
+    }
+
+    foreach ( QFuture<QVector<qreal> > future, futures ) {
+        QCOMPARE( future.result(), expected );
+    }
+}
+
+void ElevationModelTest::heightProfile()
+{
+    const qreal fromLon = m_route.first().longitude( GeoDataCoordinates::Degree );
+    const qreal fromLat = m_route.first().latitude( GeoDataCoordinates::Degree );
+    const qreal toLon = m_route.last().longitude( GeoDataCoordinates::Degree );
+    const qreal toLat = m_route.last().latitude( GeoDataCoordinates::Degree );
+
+    const QList<GeoDataCoordinates> profile = m_model->elevationModel()->heightProfile( fromLon, fromLat, toLon, toLat );
+    QVERIFY( profile.size() > tileCount * tileSize / 2 );
+
+    foreach ( const GeoDataCoordinates &coordinates, profile ) {
+        const qreal x = ( 180 + coordinates.longitude( GeoDataCoordinates::Degree ) ) * pixelsPerDegree;
+        const qreal y = ( 90 - coordinates.latitude( GeoDataCoordinates::Degree ) ) * pixelsPerDegree;
+        const qreal expected = ( x - firstTileX * tileSize ) + 2 * ( y - firstTileY * tileSize );
+        QVERIFY( qAbs( coordinates.altitude() - expected ) < 1e-6 );
+    }
+}
+
+void ElevationModelTest::benchmarkHeight()
+{
+    const ElevationModel *elevationModel = m_model->elevationModel();
+
+    QBENCHMARK {
+        for ( int i = 0; i < m_route.size(); ++i ) {
+            elevationModel->height( m_route.at( i ).longitude( GeoDataCoordinates::Degree ),
+                                    m_route.at( i ).latitude( GeoDataCoordinates::Degree ) );
+        }
+    }
+}
+
+void ElevationModelTest::benchmarkHeights()
+{
+    const ElevationModel *elevationModel = m_model->elevationModel();
+
+    QBENCHMARK {
+        elevationModel->heights( m_route );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::ElevationModelTest )
+
+#include "ElevationModelTest.moc"
@@ -0,0 +1,270 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtTest/QSignalSpy>
+
+#include "FileManager.h"
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataTreeModel.h"
+#include "MarbleDirs.h"
+#include "MarbleMap.h"
+#include "MarbleModel.h"
+
+namespace Marble
+{
+
+class FileManagerTest : public QObject
+{
+    Q_OBJECT
+
+ public slots:
+    void setCenteredBox( const GeoDataLatLonBox &box );
+    void tick();
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void smallFilesFirst();
+    void chunkedDocument();
+    void removeChunkedFolder();
+    void largeDocument();
+
+ private:
+    /**
+     * Writes a kml file with a folder of @p count placemarks, one hundredth
+     * of a degree apart from west to east.
+     */
+    QString writeKml( const QString &name, int count ) const;
+
+    /**
+     * Runs the event loop until @p spy recorded @p count signals, for at most 30 seconds.
+     */
+    static bool waitFor( const QSignalSpy &spy, int count );
+
+    QString m_directory;
+    GeoDataLatLonBox m_centeredBox;
+
+    // The longest time the event loop did not get to a timer, in ms
+    QTime m_lastTick;
+    int m_longestStall;
+};
+
+void FileManagerTest::setCenteredBox( const GeoDataLatLonBox &box )
+{
+    m_centeredBox = box;
+}
+
+void FileManagerTest::tick()
+{
+    m_longestStall = qMax( m_longestStall, m_lastTick.restart() );
+}
+
+QString FileManagerTest::writeKml( const QString &name, int count ) const
+{
+    QString kml = "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><Folder>";
+    for ( int i = 0; i < count; ++i ) {
+        kml += QString( "<Placemark><name>%1</name><Point><coordinates>%2,10</coordinates></Point></Placemark>" )
+               .arg( i ).arg( 1.0 + 0.01 * i );
+    }
+    kml += "</Folder></Document></kml>";
+
+    const QString fileName = m_directory + '/' + name + ".kml";
+    QFile file( fileName );
+    if ( !file.open( QIODevice::WriteOnly ) || file.write( kml.toUtf8() ) < 0 ) {
+        return QString();
+    }
+
+    return fileName;
+}
+
+bool FileManagerTest::waitFor( const QSignalSpy &spy, int count )
+{
+    QTime timer;
+    timer.start();
+    while ( spy.count() < count && timer.elapsed() < 30000 ) {
+        QTest::qWait( 10 );
+    }
+
+    return spy.count() >= count;
+}
+
+void FileManagerTest::initTestCase()
+{
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( PLUGIN_PATH );
+
+    m_directory = QDir::tempPath() + QString( "/marble-filemanagertest-%1" ).arg( QCoreApplication::applicationPid() );
+    QVERIFY( QDir().mkpath( m_directory ) );
+}
+
+void FileManagerTest::cleanupTestCase()
+{
+    QDir directory( m_directory );
+    foreach ( const QString &name, directory.entryList( QDir::Files ) ) {
+        directory.remove( name );
+    }
+    QDir().rmdir( m_directory );
+}
+
+void FileManagerTest::smallFilesFirst()
+{
+    MarbleModel model;
+    FileManager *manager = model.fileManager();
+    QSignalSpy addedSpy( manager, SIGNAL( fileAdded( int ) ) );
+
+    // The first files occupy all loaders, the others wait for them. The
+    // small one of those is loaded first although it was added last.
+    const int loaders = qMax( 2, QThread::idealThreadCount() );
+    for ( int i = 0; i < loaders; ++i ) {
+        const QString fileName = writeKml( QString( "busy%1" ).arg( i ), 1 );
+        QVERIFY( !fileName.isEmpty() );
+        manager->addFile( fileName, UserDocument );
+    }
+    for ( int i = 0; i < loaders; ++i ) {
+        const QString fileName = writeKml( QString( "large%1" ).arg( i ), 20000 );
+        QVERIFY( !fileName.isEmpty() );
+        manager->addFile( fileName, UserDocument );
+    }
+    const QString small = writeKml( "small", 1 );
+    QVERIFY( !small.isEmpty() );
+    manager->addFile( small, UserDocument );
+
+    QVERIFY( waitFor( addedSpy, 2 * loaders + 1 ) );
+    QCOMPARE( manager->size(), 2 * loaders + 1 );
+
+    QStringList order;
+    for ( int i = 0; i < addedSpy.count(); ++i ) {
+        order << QFileInfo( manager->at( addedSpy.at( i ).first().toInt() )->fileName() ).baseName();
+    }
+    const int smallIndex = order.indexOf( "small" );
+    QVERIFY( smallIndex >= 0 );
+    for ( int i = 0; i < loaders; ++i ) {
+        QVERIFY( smallIndex < order.indexOf( QString( "large%1" ).arg( i ) ) );
+    }
+}
+
+void FileManagerTest::chunkedDocument()
+{
+    const QString fileName = writeKml( "chunked", 2500 );
+    QVERIFY( !fileName.isEmpty() );
+
+    MarbleModel model;
+    FileManager *manager = model.fileManager();
+    QSignalSpy addedSpy( manager, SIGNAL( fileAdded( int ) ) );
+    connect( manager, SIGNAL( centeredDocument( GeoDataLatLonBox ) ),
+             this, SLOT( setCenteredBox( GeoDataLatLonBox ) ) );
+    m_centeredBox = GeoDataLatLonBox();
+
+    manager->addFile( fileName, UserDocument, true );
+    QVERIFY( waitFor( addedSpy, 1 ) );
+
+    // The document is announced once the tree model has all of its features
+    GeoDataDocument *document = manager->at( addedSpy.first().first().toInt() );
+    QCOMPARE( document->size(), 1 );
+    GeoDataContainer *folder = static_cast<GeoDataContainer*>( document->child( 0 ) );
+    QCOMPARE( folder->size(), 2500 );
+    QCOMPARE( model.treeModel()->rowCount( model.treeModel()->index( folder ) ), 2500 );
+
+    // The view centers on all of them
+    QVERIFY( qAbs( m_centeredBox.west( GeoDataCoordinates::Degree ) - 1.0 ) < 0.0001 );
+    QVERIFY( qAbs( m_centeredBox.east( GeoDataCoordinates::Degree ) - 25.99 ) < 0.0001 );
+
+    disconnect( manager, 0, this, 0 );
+}
+
+void FileManagerTest::removeChunkedFolder()
+{
+    const QString fileName = writeKml( "removed", 2500 );
+    QVERIFY( !fileName.isEmpty() );
+
+    MarbleModel model;
+    FileManager *manager = model.fileManager();
+    QSignalSpy addedSpy( manager, SIGNAL( fileAdded( int ) ) );
+
+    // Stop as soon as the document is part of the tree model
+    QEventLoop loop;
+    connect( model.treeModel(), SIGNAL( added( GeoDataObject* ) ), &loop, SLOT( quit() ) );
+    QTimer::singleShot( 30000, &loop, SLOT( quit() ) );
+    manager->addFile( fileName, UserDocument );
+    loop.exec();
+
+    const QVector<GeoDataFeature*> documents = model.treeModel()->rootDocument()->featureList();
+    QVERIFY( !documents.isEmpty() );
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( documents.last() );
+    QCOMPARE( document->fileName(), fileName );
+    QCOMPARE( addedSpy.count(), 0 );
+
+    // Only the first chunk of the folder is in yet
+    GeoDataContainer *folder = static_cast<GeoDataContainer*>( document->child( 0 ) );
+    QVERIFY( folder->size() < 2500 );
+
+    // Removing the folder drops its pending features, which completes the document
+    QVERIFY( model.treeModel()->removeFeature( folder ) );
+    delete folder;
+    QVERIFY( waitFor( addedSpy, 1 ) );
+    QCOMPARE( manager->at( addedSpy.first().first().toInt() ), document );
+    QCOMPARE( document->size(), 0 );
+}
+
+}
+
+void FileManagerTest::largeDocument()
+{
+    const int count = 50000;
+    const QString fileName = writeKml( "large", count );
+    QVERIFY( !fileName.isEmpty() );
+
+    // The layers of the map rebuild their contents on every insertion
+    MarbleModel model;
+    MarbleMap map( &model );
+    FileManager *manager = model.fileManager();
+    QSignalSpy addedSpy( manager, SIGNAL( fileAdded( int ) ) );
+    qRegisterMetaType<QModelIndex>( "QModelIndex" );
+    QSignalSpy insertedSpy( model.treeModel(), SIGNAL( rowsInserted( QModelIndex, int, int ) ) );
+
+    QTimer ticker;
+    ticker.setInterval( 0 );
+    connect( &ticker, SIGNAL( timeout() ), this, SLOT( tick() ) );
+    m_longestStall = 0;
+
+    QTime timer;
+    timer.start();
+    m_lastTick.start();
+    ticker.start();
+    manager->addFile( fileName, UserDocument );
+    QVERIFY( waitFor( addedSpy, 1 ) );
+    ticker.stop();
+    const int elapsed = timer.elapsed();
+
+    GeoDataDocument *document = manager->at( addedSpy.first().first().toInt() );
+    GeoDataContainer *folder = static_cast<GeoDataContainer*>( document->child( 0 ) );
+    QCOMPARE( folder->size(), count );
+
+    // The chunks grow with the folder, 1000 features per chunk took 49 insertions
+    const QModelIndex folderIndex = model.treeModel()->index( folder );
+    int chunks = 0;
+    for ( int i = 0; i < insertedSpy.count(); ++i ) {
+        if ( qvariant_cast<QModelIndex>( insertedSpy.at( i ).first() ) == folderIndex ) {
+            ++chunks;
+        }
+    }
+    qDebug() << "Added" << count << "placemarks in" << chunks << "chunks within" << elapsed
+             << "ms, the event loop stalled for at most" << m_longestStall << "ms";
+    QVERIFY( chunks > 0 );
+    QVERIFY( chunks <= 6 );
+
+    disconnect( &ticker, 0, this, 0 );
+}
+
+QTEST_MAIN( Marble::FileManagerTest )
+
+#include "FileManagerTest.moc"
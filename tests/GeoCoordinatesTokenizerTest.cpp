@@ -0,0 +1,244 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtCore/qmath.h>
+
+#include "GeoCoordinatesTokenizer.h"
+#include "GeoDataCoordinates.h"
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "global.h"
+
+namespace Marble
+{
+
+class GeoCoordinatesTokenizerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void toDouble_data();
+    void toDouble();
+    void randomNumbers();
+    void tuples_data();
+    void tuples();
+    void kmlLineString();
+
+    void benchmarkSplit();
+    void benchmarkTokenizer();
+
+ private:
+    /**
+     * Parses @p text by splitting it into strings like the KML handler did.
+     */
+    static QVector<GeoDataCoordinates> split( const QString &text );
+
+    static QVector<GeoDataCoordinates> tokenize( const QString &text );
+
+    static bool equal( qreal a, qreal b );
+
+    static bool equal( const QVector<GeoDataCoordinates> &a, const QVector<GeoDataCoordinates> &b );
+
+    QString m_boundary;
+};
+
+QVector<GeoDataCoordinates> GeoCoordinatesTokenizerTest::split( const QString &text )
+{
+    QVector<GeoDataCoordinates> result;
+    foreach ( const QString &line, text.simplified().split( ' ', QString::SkipEmptyParts ) ) {
+        const QStringList coordinates = line.split( ',' );
+        GeoDataCoordinates coord;
+        if ( coordinates.size() == 2 ) {
+            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
+                       DEG2RAD * coordinates.at( 1 ).toDouble() );
+        } else if ( coordinates.size() == 3 ) {
+            coord.set( DEG2RAD * coordinates.at( 0 ).toDouble(),
+                       DEG2RAD * coordinates.at( 1 ).toDouble(),
+                       coordinates.at( 2 ).toDouble() );
+        }
+        result.append( coord );
+    }
+
+    return result;
+}
+
+QVector<GeoDataCoordinates> GeoCoordinatesTokenizerTest::tokenize( const QString &text )
+{
+    QVector<GeoDataCoordinates> result;
+    GeoCoordinatesTokenizer tokenizer( text );
+    while ( tokenizer.next() ) {
+        result.append( tokenizer.coordinates() );
+    }
+
+    return result;
+}
+
+bool GeoCoordinatesTokenizerTest::equal( qreal a, qreal b )
+{
+    // Bitwise, QCOMPARE would be fuzzy
+    return a == b || ( a != a && b != b );
+}
+
+bool GeoCoordinatesTokenizerTest::equal( const QVector<GeoDataCoordinates> &a, const QVector<GeoDataCoordinates> &b )
+{
+    if ( a.size() != b.size() ) {
+        return false;
+    }
+
+    for ( int i = 0; i < a.size(); ++i ) {
+        if ( !equal( a.at( i ).longitude(), b.at( i ).longitude() )
+             || !equal( a.at( i ).latitude(), b.at( i ).latitude() )
+             || !equal( a.at( i ).altitude(), b.at( i ).altitude() ) ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void GeoCoordinatesTokenizerTest::initTestCase()
+{
+    // A closed boundary with 100000 points like those of the OSM exports
+    qsrand( 42 );
+    QStringList tuples;
+    for ( int i = 0; i < 100000; ++i ) {
+        const qreal lon = -180.0 + 360.0 * qrand() / RAND_MAX;
+        const qreal lat = -90.0 + 180.0 * qrand() / RAND_MAX;
+        tuples << QString( "%1,%2,0" ).arg( lon, 0, 'f', 7 ).arg( lat, 0, 'f', 7 );
+    }
+    m_boundary = tuples.join( "\n" );
+}
+
+void GeoCoordinatesTokenizerTest::toDouble_data()
+{
+    QTest::addColumn<QString>( "text" );
+
+    QTest::newRow( "integer" ) << "42";
+    QTest::newRow( "negative" ) << "-122.207881";
+    QTest::newRow( "plus" ) << "+7.5";
+    QTest::newRow( "zero" ) << "0";
+    QTest::newRow( "negative zero" ) << "-0.0";
+    QTest::newRow( "leading zeros" ) << "0000.000123";
+    QTest::newRow( "trailing zeros" ) << "8.12000000000000000000000000";
+    QTest::newRow( "no integer part" ) << ".5";
+    QTest::newRow( "no fraction" ) << "5.";
+    QTest::newRow( "exponent" ) << "1.25e3";
+    QTest::newRow( "negative exponent" ) << "-4.5E-7";
+    QTest::newRow( "large exponent" ) << "1e300";
+    QTest::newRow( "tiny" ) << "2.2250738585072014e-308";
+    QTest::newRow( "many digits" ) << "3.14159265358979323846264338327950288";
+    QTest::newRow( "53 bits" ) << "9007199254740993";
+    QTest::newRow( "whitespace" ) << " 12.5 ";
+    QTest::newRow( "empty" ) << "";
+    QTest::newRow( "dot" ) << ".";
+    QTest::newRow( "sign" ) << "-";
+    QTest::newRow( "two dots" ) << "1.2.3";
+    QTest::newRow( "incomplete exponent" ) << "1e";
+    QTest::newRow( "text" ) << "abc";
+    QTest::newRow( "nan" ) << "nan";
+}
+
+void GeoCoordinatesTokenizerTest::toDouble()
+{
+    QFETCH( QString, text );
+
+    const qreal value = GeoCoordinatesTokenizer::toDouble( text.constData(), text.constData() + text.size() );
+    QVERIFY2( equal( value, text.toDouble() ),
+              qPrintable( QString( "%1 != %2" ).arg( value, 0, 'g', 17 ).arg( text.toDouble(), 0, 'g', 17 ) ) );
+}
+
+void GeoCoordinatesTokenizerTest::randomNumbers()
+{
+    qsrand( 7 );
+    for ( int i = 0; i < 100000; ++i ) {
+        const qreal number = ( qrand() - RAND_MAX / 2 ) * qPow( 10.0, qrand() % 20 - 12 );
+        const QString text = QString::number( number, i % 2 ? 'f' : 'g', qrand() % 17 );
+        const qreal value = GeoCoordinatesTokenizer::toDouble( QStringRef( &text ) );
+        QVERIFY2( equal( value, text.toDouble() ), qPrintable( text ) );
+    }
+}
+
+void GeoCoordinatesTokenizerTest::tuples_data()
+{
+    QTest::addColumn<QString>( "text" );
+
+    QTest::newRow( "single" ) << "13.5,52.5";
+    QTest::newRow( "altitude" ) << "13.5,52.5,34";
+    QTest::newRow( "whitespace" ) << "\n\t 13.5,52.5,34\n\t\t-0.1,51.5,0 \r\n 2.35,48.85\n";
+    QTest::newRow( "single value" ) << "13.5 1,2";
+    QTest::newRow( "four values" ) << "1,2,3,4 5,6";
+    QTest::newRow( "empty values" ) << "1,,3 ,2";
+    QTest::newRow( "spaces after commas" ) << "1, 2, 3";
+}
+
+void GeoCoordinatesTokenizerTest::tuples()
+{
+    QFETCH( QString, text );
+
+    QVERIFY( equal( tokenize( text ), split( text ) ) );
+}
+
+void GeoCoordinatesTokenizerTest::kmlLineString()
+{
+    const QString content =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+        "<kml xmlns=\"http://www.opengis.net/kml/2.2\">"
+        "<Document><Placemark><LineString><coordinates>\n"
+        + m_boundary +
+        "\n</coordinates></LineString></Placemark></Document></kml>";
+    QByteArray array( content.toUtf8() );
+    QBuffer buffer( &array );
+    buffer.open( QIODevice::ReadOnly );
+
+    GeoDataParser parser( GeoData_KML );
+    QVERIFY( parser.read( &buffer ) );
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( parser.releaseDocument() );
+    QVERIFY( document );
+    QCOMPARE( document->placemarkList().size(), 1 );
+
+    const GeoDataLineString *lineString = static_cast<const GeoDataLineString*>( document->placemarkList().first()->geometry() );
+    QVector<GeoDataCoordinates> coordinates;
+    for ( int i = 0; i < lineString->size(); ++i ) {
+        coordinates.append( lineString->at( i ) );
+    }
+    QCOMPARE( coordinates.size(), 100000 );
+    QVERIFY( equal( coordinates, split( m_boundary ) ) );
+
+    delete document;
+}
+
+void GeoCoordinatesTokenizerTest::benchmarkSplit()
+{
+    QVector<GeoDataCoordinates> coordinates;
+    QBENCHMARK {
+        coordinates = split( m_boundary );
+    }
+    QCOMPARE( coordinates.size(), 100000 );
+}
+
+void GeoCoordinatesTokenizerTest::benchmarkTokenizer()
+{
+    int count = 0;
+    QBENCHMARK {
+        GeoDataLineString lineString;
+        GeoCoordinatesTokenizer tokenizer( m_boundary );
+        count = tokenizer.appendTo( &lineString );
+    }
+    QCOMPARE( count, 100000 );
+}
+
+}
+
+QTEST_MAIN( Marble::GeoCoordinatesTokenizerTest )
+
+#include "GeoCoordinatesTokenizerTest.moc"
@@ -0,0 +1,273 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLineStyle.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataStyle.h"
+#include "GeoDataStyleMap.h"
+#include "KmlRunner.h"
+
+namespace Marble
+{
+
+class GeoDataDocumentStyleTest : public QObject
+{
+    Q_OBJECT
+
+ public slots:
+    void setParsedDocument( GeoDataDocument *document );
+
+ private slots:
+    void stylesDefinedLater();
+    void kmlRunner();
+    void inlineStyle();
+    void unknownIds();
+    void restyle();
+    void copy();
+    void nestedDocuments();
+
+    void benchmarkResolve();
+
+ private:
+    static GeoDataDocument *parse( const QString &kml );
+
+    static QString placemarks( int count, const QString &styleUrl );
+    static QString styles();
+
+    GeoDataDocument *m_parsedDocument;
+};
+
+void GeoDataDocumentStyleTest::setParsedDocument( GeoDataDocument *document )
+{
+    m_parsedDocument = document;
+}
+
+GeoDataDocument *GeoDataDocumentStyleTest::parse( const QString &kml )
+{
+    QByteArray data = kml.toUtf8();
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::ReadOnly );
+
+    GeoDataParser parser( GeoData_KML );
+    if ( !parser.read( &buffer ) ) {
+        return 0;
+    }
+
+    return static_cast<GeoDataDocument*>( parser.releaseDocument() );
+}
+
+QString GeoDataDocumentStyleTest::placemarks( int count, const QString &styleUrl )
+{
+    QString result = "<Folder>";
+    for ( int i = 0; i < count; ++i ) {
+        result += QString( "<Placemark><name>%1</name><styleUrl>%2</styleUrl>"
+                           "<LineString><coordinates>0,0 1,1</coordinates></LineString></Placemark>" )
+                  .arg( i ).arg( styleUrl );
+    }
+    return result + "</Folder>";
+}
+
+QString GeoDataDocumentStyleTest::styles()
+{
+    return "<Style id=\"red\"><LineStyle><color>ff0000ff</color></LineStyle></Style>"
+           "<Style id=\"blue\"><LineStyle><color>ffff0000</color></LineStyle></Style>"
+           "<StyleMap id=\"map-red\"><Pair><key>normal</key><styleUrl>#red</styleUrl></Pair>"
+           "<Pair><key>highlight</key><styleUrl>#blue</styleUrl></Pair></StyleMap>";
+}
+
+void GeoDataDocumentStyleTest::stylesDefinedLater()
+{
+    GeoDataDocument *document = parse( "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                                       + placemarks( 3, "#map-red" ) + placemarks( 3, "#blue" )
+                                       + styles() + "</Document></kml>" );
+    QVERIFY( document );
+    QCOMPARE( document->size(), 2 );
+
+    const int red = document->styleHandle( "#map-red" );
+    QVERIFY( red >= 0 );
+    QCOMPARE( document->styleHandle( "#red" ), red );
+    QCOMPARE( document->styleHandle( "red" ), red );
+    QCOMPARE( document->styleForHandle( red )->lineStyle().color(), QColor( Qt::red ) );
+
+    const int blue = document->styleHandle( "#blue" );
+    QVERIFY( blue >= 0 && blue != red );
+
+    foreach ( const GeoDataPlacemark *placemark, static_cast<GeoDataFolder*>( document->child( 0 ) )->placemarkList() ) {
+        QCOMPARE( placemark->style(), document->styleForHandle( red ) );
+    }
+    foreach ( const GeoDataPlacemark *placemark, static_cast<GeoDataFolder*>( document->child( 1 ) )->placemarkList() ) {
+        QCOMPARE( placemark->style(), document->styleForHandle( blue ) );
+    }
+
+    delete document;
+}
+
+void GeoDataDocumentStyleTest::kmlRunner()
+{
+    // The app loads files through the runner, whose parser resolves the urls as well
+    const QString fileName = QDir::tempPath() + QString( "/marble-documentstyletest-%1.kml" ).arg( QCoreApplication::applicationPid() );
+    QFile file( fileName );
+    QVERIFY( file.open( QIODevice::WriteOnly ) );
+    file.write( QString( "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                         + placemarks( 3, "#map-red" ) + styles() + "</Document></kml>" ).toUtf8() );
+    file.close();
+
+    KmlRunner runner;
+    connect( &runner, SIGNAL( parsingFinished( GeoDataDocument*, QString ) ),
+             this, SLOT( setParsedDocument( GeoDataDocument* ) ) );
+    m_parsedDocument = 0;
+    runner.parseFile( fileName, UserDocument );
+    QFile::remove( fileName );
+
+    GeoDataDocument *document = m_parsedDocument;
+    QVERIFY( document );
+    const GeoDataStyle *red = document->styleForHandle( document->styleHandle( "#red" ) );
+    QVERIFY( red );
+    QCOMPARE( red->lineStyle().color(), QColor( Qt::red ) );
+    foreach ( const GeoDataPlacemark *placemark, static_cast<GeoDataFolder*>( document->child( 0 ) )->placemarkList() ) {
+        QCOMPARE( placemark->style(), red );
+    }
+
+    delete document;
+}
+
+void GeoDataDocumentStyleTest::inlineStyle()
+{
+    GeoDataDocument *document = parse( "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                                       "<Placemark><styleUrl>#red</styleUrl>"
+                                       "<Style><LineStyle><color>ff00ff00</color></LineStyle></Style></Placemark>"
+                                       + styles() + "</Document></kml>" );
+    QVERIFY( document );
+
+    const GeoDataPlacemark *placemark = document->placemarkList().first();
+    QCOMPARE( placemark->style()->lineStyle().color(), QColor( Qt::green ) );
+
+    delete document;
+}
+
+void GeoDataDocumentStyleTest::unknownIds()
+{
+    GeoDataDocument document;
+    GeoDataStyle style;
+    style.setStyleId( "known" );
+    document.addStyle( style );
+
+    // Looking up unknown ids does not add them
+    QCOMPARE( document.styleHandle( "#unknown" ), -1 );
+    QVERIFY( !document.styleForHandle( -1 ) );
+    QVERIFY( !document.styleForHandle( 1 ) );
+    QCOMPARE( document.style( "unknown" ).styleId(), QString() );
+    QVERIFY( document.styleMap( "unknown" ).isEmpty() );
+    QCOMPARE( document.styles().size(), 1 );
+    QCOMPARE( document.styleMaps().size(), 0 );
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    document.append( placemark );
+    placemark->setStyleUrl( "#unknown" );
+    QVERIFY( placemark->style() != &document.style( "known" ) );
+    QCOMPARE( document.styles().size(), 1 );
+
+    document.removeStyle( "known" );
+    QCOMPARE( document.styleHandle( "#known" ), -1 );
+    QVERIFY( !document.styleForHandle( 0 ) );
+
+    // Editing them does, so that the change is not shared
+    document.styleForEditing( "added" ).lineStyle().setColor( Qt::red );
+    document.styleMapForEditing( "map-added" ).insert( "normal", "#added" );
+    QCOMPARE( document.style( "added" ).lineStyle().color(), QColor( Qt::red ) );
+    QCOMPARE( document.style( "unknown" ).lineStyle().color(), GeoDataStyle().lineStyle().color() );
+    QCOMPARE( document.styleHandle( "#map-added" ), document.styleHandle( "#added" ) );
+    QVERIFY( document.styleHandle( "#added" ) >= 0 );
+    QVERIFY( document.styleMap( "unknown" ).isEmpty() );
+}
+
+void GeoDataDocumentStyleTest::nestedDocuments()
+{
+    GeoDataDocument document;
+    GeoDataDocument *nested = new GeoDataDocument;
+    document.append( nested );
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    nested->append( placemark );
+    placemark->setStyleUrl( "#line" );
+
+    GeoDataStyle style;
+    style.setStyleId( "line" );
+    nested->addStyle( style );
+
+    // The outer document has no styles, the nested one is resolved anyway
+    document.resolveStyleUrls();
+    QCOMPARE( placemark->style(), nested->styleForHandle( nested->styleHandle( "#line" ) ) );
+}
+
+void GeoDataDocumentStyleTest::restyle()
+{
+    GeoDataDocument document;
+    GeoDataStyle style;
+    style.setStyleId( "line" );
+    document.addStyle( style );
+    const int handle = document.styleHandle( "#line" );
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    document.append( placemark );
+    placemark->setStyleUrl( "#line" );
+    QCOMPARE( placemark->style(), document.styleForHandle( handle ) );
+
+    // Replacing a shared style keeps its handle and reaches all its features
+    GeoDataLineStyle lineStyle;
+    lineStyle.setColor( Qt::red );
+    style.setLineStyle( lineStyle );
+    document.addStyle( style );
+    QCOMPARE( document.styleHandle( "#line" ), handle );
+    QCOMPARE( placemark->style()->lineStyle().color(), QColor( Qt::red ) );
+
+    document.styleForHandle( handle )->lineStyle().setColor( Qt::blue );
+    QCOMPARE( placemark->style()->lineStyle().color(), QColor( Qt::blue ) );
+}
+
+void GeoDataDocumentStyleTest::copy()
+{
+    GeoDataDocument document;
+    GeoDataStyle style;
+    style.setStyleId( "line" );
+    document.addStyle( style );
+    const int handle = document.styleHandle( "#line" );
+
+    GeoDataDocument copy( document );
+    GeoDataStyle other;
+    other.setStyleId( "other" );
+    copy.addStyle( other );
+
+    QVERIFY( copy.styleForHandle( handle ) );
+    QVERIFY( copy.styleForHandle( handle ) != document.styleForHandle( handle ) );
+    QVERIFY( copy.styleForHandle( handle ) == &copy.style( "line" ) );
+    QVERIFY( document.styleForHandle( handle ) == &document.style( "line" ) );
+    QCOMPARE( document.styleHandle( "#other" ), -1 );
+}
+
+void GeoDataDocumentStyleTest::benchmarkResolve()
+{
+    const QString kml = "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document>"
+                        + placemarks( 10000, "#map-red" ) + placemarks( 10000, "#blue" )
+                        + styles() + "</Document></kml>";
+
+    QBENCHMARK {
+        delete parse( kml );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::GeoDataDocumentStyleTest )
+
+#include "GeoDataDocumentStyleTest.moc"
@@ -0,0 +1,215 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+
+namespace Marble
+{
+
+class GeoDataTreeModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void parentAndRow();
+    void removeFeature();
+    void addFeatures();
+
+    void benchmarkEnumerate_data();
+    void benchmarkEnumerate();
+    void benchmarkObjectIndex();
+
+ private:
+    /**
+     * A document with @p folders folders of @p placemarks placemarks each.
+     */
+    static GeoDataDocument *createDocument( int folders, int placemarks );
+
+    /**
+     * Visits every index below @p parent and asks for its parent like views do.
+     */
+    static int enumerate( const QAbstractItemModel &model, const QModelIndex &parent );
+};
+
+GeoDataDocument *GeoDataTreeModelTest::createDocument( int folders, int placemarks )
+{
+    GeoDataDocument *document = new GeoDataDocument;
+    for ( int i = 0; i < folders; ++i ) {
+        GeoDataFolder *folder = new GeoDataFolder;
+        folder->setName( QString( "Folder %1" ).arg( i ) );
+        for ( int j = 0; j < placemarks; ++j ) {
+            GeoDataPlacemark *placemark = new GeoDataPlacemark;
+            placemark->setName( QString( "Placemark %1/%2" ).arg( i ).arg( j ) );
+            folder->append( placemark );
+        }
+        document->append( folder );
+    }
+
+    return document;
+}
+
+int GeoDataTreeModelTest::enumerate( const QAbstractItemModel &model, const QModelIndex &parent )
+{
+    int count = 0;
+    const int rows = model.rowCount( parent );
+    for ( int row = 0; row < rows; ++row ) {
+        const QModelIndex child = model.index( row, 0, parent );
+        if ( model.parent( child ) != parent ) {
+            return -1;
+        }
+        ++count;
+        if ( model.hasChildren( child ) ) {
+            const int below = enumerate( model, child );
+            if ( below < 0 ) {
+                return -1;
+            }
+            count += below;
+        }
+    }
+
+    return count;
+}
+
+void GeoDataTreeModelTest::parentAndRow()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *document = createDocument( 20, 50 );
+    QCOMPARE( model.addDocument( document ), 0 );
+
+    const QModelIndex documentIndex = model.index( 0, 0 );
+    QCOMPARE( model.rowCount( documentIndex ), 20 );
+    QCOMPARE( enumerate( model, QModelIndex() ), 1 + 20 + 20 * 50 );
+
+    for ( int i = 0; i < document->size(); ++i ) {
+        GeoDataFolder *folder = static_cast<GeoDataFolder*>( document->child( i ) );
+        const QModelIndex folderIndex = model.index( folder );
+        QCOMPARE( folderIndex, model.index( i, 0, documentIndex ) );
+        QCOMPARE( document->childPosition( folder ), i );
+
+        for ( int j = 0; j < folder->size(); ++j ) {
+            const QModelIndex placemarkIndex = model.index( folder->child( j ) );
+            QCOMPARE( placemarkIndex.row(), j );
+            QCOMPARE( model.parent( placemarkIndex ), folderIndex );
+        }
+    }
+
+    GeoDataPlacemark stranger;
+    QCOMPARE( document->childPosition( &stranger ), -1 );
+}
+
+void GeoDataTreeModelTest::removeFeature()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *document = createDocument( 10, 2 );
+    model.addDocument( document );
+
+    // Rows behind a removed feature move up
+    GeoDataFeature *removed = document->child( 3 );
+    GeoDataFeature *moved = document->child( 7 );
+    QCOMPARE( document->childPosition( moved ), 7 );
+    QVERIFY( model.removeFeature( removed ) );
+    delete removed;
+    QCOMPARE( document->childPosition( moved ), 6 );
+    QCOMPARE( model.index( moved ).row(), 6 );
+    QCOMPARE( model.parent( model.index( 0, 0, model.index( moved ) ) ), model.index( moved ) );
+
+    // And appended ones are found at the end
+    GeoDataFolder *appended = new GeoDataFolder;
+    QCOMPARE( model.addFeature( document, appended ), 9 );
+    QCOMPARE( document->childPosition( appended ), 9 );
+    QCOMPARE( enumerate( model, QModelIndex() ), 1 + 10 + 9 * 2 );
+
+    // Reordering through iterators is noticed as well
+    qSwap( *document->begin(), *( document->end() - 1 ) );
+    QCOMPARE( document->childPosition( appended ), 0 );
+    QCOMPARE( model.index( moved ).row(), 6 );
+}
+
+void GeoDataTreeModelTest::addFeatures()
+{
+    qRegisterMetaType<QModelIndex>( "QModelIndex" );
+
+    GeoDataTreeModel model;
+    GeoDataDocument *document = createDocument( 3, 2 );
+    model.addDocument( document );
+    GeoDataFolder *folder = static_cast<GeoDataFolder*>( document->child( 1 ) );
+    QSignalSpy inserted( &model, SIGNAL( rowsInserted( const QModelIndex &, int, int ) ) );
+
+    // A single insertion for all of them
+    QVector<GeoDataFeature*> features;
+    for ( int i = 0; i < 5; ++i ) {
+        features.append( new GeoDataPlacemark );
+    }
+    QCOMPARE( model.addFeatures( folder, features ), 2 );
+    QCOMPARE( inserted.count(), 1 );
+    QCOMPARE( inserted.last().at( 0 ).value<QModelIndex>(), model.index( folder ) );
+    QCOMPARE( inserted.last().at( 1 ).toInt(), 2 );
+    QCOMPARE( inserted.last().at( 2 ).toInt(), 6 );
+    QCOMPARE( folder->size(), 7 );
+    QCOMPARE( model.index( features.last() ).row(), 6 );
+    QCOMPARE( enumerate( model, QModelIndex() ), 1 + 3 + 3 * 2 + 5 );
+
+    // Nothing happens for containers outside of the model
+    GeoDataFolder stranger;
+    GeoDataPlacemark placemark;
+    QCOMPARE( model.addFeatures( &stranger, QVector<GeoDataFeature*>() << &placemark ), -1 );
+    QCOMPARE( model.addFeatures( folder, QVector<GeoDataFeature*>() ), -1 );
+    QCOMPARE( inserted.count(), 1 );
+    QCOMPARE( stranger.size(), 0 );
+}
+
+void GeoDataTreeModelTest::benchmarkEnumerate_data()
+{
+    QTest::addColumn<int>( "folders" );
+    QTest::addColumn<int>( "placemarks" );
+
+    QTest::newRow( "100000 placemarks in one folder" ) << 1 << 100000;
+    QTest::newRow( "20000 folders" ) << 20000 << 5;
+}
+
+void GeoDataTreeModelTest::benchmarkEnumerate()
+{
+    QFETCH( int, folders );
+    QFETCH( int, placemarks );
+
+    GeoDataTreeModel model;
+    model.addDocument( createDocument( folders, placemarks ) );
+
+    int count = 0;
+    QBENCHMARK {
+        count = enumerate( model, QModelIndex() );
+    }
+    QCOMPARE( count, 1 + folders + folders * placemarks );
+}
+
+void GeoDataTreeModelTest::benchmarkObjectIndex()
+{
+    GeoDataTreeModel model;
+    GeoDataDocument *document = createDocument( 200, 100 );
+    model.addDocument( document );
+
+    QBENCHMARK {
+        for ( int i = 0; i < document->size(); ++i ) {
+            GeoDataFolder *folder = static_cast<GeoDataFolder*>( document->child( i ) );
+            for ( int j = 0; j < folder->size(); ++j ) {
+                model.index( folder->child( j ) );
+            }
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::GeoDataTreeModelTest )
+
+#include "GeoDataTreeModelTest.moc"
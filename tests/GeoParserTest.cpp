@@ -0,0 +1,230 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoAtomTable.h"
+#include "GeoDataDocument.h"
+#include "GeoDataMultiGeometry.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPoint.h"
+#include "GeoDataTrack.h"
+#include "GeoSceneDocument.h"
+#include "GeoSceneLegend.h"
+#include "GeoSceneMap.h"
+#include "GeoSceneParser.h"
+#include "GeoSceneSection.h"
+#include "GpxParser.h"
+
+namespace Marble
+{
+
+class GeoParserTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void atomTable();
+    void parseKml();
+    void parseGpx();
+    void parseDgml();
+
+    void benchmarkKml();
+    void benchmarkGpx();
+    void benchmarkDgml();
+
+ private:
+    /**
+     * Parses @p data with @p parser and returns the document, 0 on errors.
+     */
+    static GeoDocument *parse( GeoParser &parser, const QByteArray &data );
+
+    QByteArray m_kml;
+    QByteArray m_gpx;
+    QByteArray m_dgml;
+};
+
+void GeoParserTest::initTestCase()
+{
+    // Placemarks with the usual mix of short elements
+    QString kml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<kml xmlns=\"http://www.opengis.net/kml/2.2\"><Document><Folder><name>Places</name>";
+    for ( int i = 0; i < 5000; ++i ) {
+        kml += QString( "<Placemark><name>Place %1</name><description>Somewhere</description>"
+                        "<visibility>1</visibility><styleUrl>#style%2</styleUrl>"
+                        "<ExtendedData><Data name=\"index\"><value>%1</value></Data></ExtendedData>"
+                        "<Point><coordinates>%3,%4,0</coordinates></Point></Placemark>" )
+               .arg( i ).arg( i % 7 ).arg( i % 360 - 180 ).arg( i % 180 - 90 );
+    }
+    kml += "</Folder></Document></kml>";
+    m_kml = kml.toUtf8();
+
+    // A recorded track with elevation and time stamps
+    QString gpx = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                  "<gpx version=\"1.1\" creator=\"Marble\" xmlns=\"http://www.topografix.com/GPX/1/1\">"
+                  "<trk><name>Track</name><trkseg>";
+    const QDateTime start( QDate( 2012, 5, 1 ), QTime( 8, 0 ), Qt::UTC );
+    for ( int i = 0; i < 20000; ++i ) {
+        gpx += QString( "<trkpt lat=\"%1\" lon=\"%2\"><ele>%3</ele><time>%4</time></trkpt>" )
+               .arg( 48.0 + i * 1e-5, 0, 'f', 7 ).arg( 9.0 + i * 1e-5, 0, 'f', 7 )
+               .arg( 300 + i % 50 ).arg( start.addSecs( i ).toString( "yyyy-MM-ddThh:mm:ss" ) + 'Z' );
+    }
+    gpx += "</trkseg></trk></gpx>";
+    m_gpx = gpx.toUtf8();
+
+    // A map theme with plenty of layers and legend entries
+    QString dgml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+                   "<dgml xmlns=\"http://edu.kde.org/marble/dgml/2.0\"><document>"
+                   "<head><name>Benchmark</name><target>earth</target><theme>benchmark</theme>"
+                   "<visible>true</visible><zoom><minimum>900</minimum><maximum>2100</maximum>"
+                   "<discrete>false</discrete></zoom></head><map bgcolor=\"#000000\"><canvas/><target/>";
+    for ( int i = 0; i < 200; ++i ) {
+        dgml += QString( "<layer name=\"layer%1\" backend=\"vector\" role=\"polyline\">" ).arg( i );
+        for ( int j = 0; j < 10; ++j ) {
+            dgml += QString( "<vector name=\"vector%1\" feature=\"border\">"
+                             "<sourcefile format=\"PNT\">earth/mwdbii/PCOAST.PNT</sourcefile>"
+                             "<pen color=\"#cccbca\"/></vector>" ).arg( j );
+        }
+        dgml += "</layer>";
+    }
+    dgml += "</map><legend>";
+    for ( int i = 0; i < 200; ++i ) {
+        dgml += QString( "<section name=\"section%1\" checkable=\"false\"><heading>Section</heading>" ).arg( i );
+        for ( int j = 0; j < 10; ++j ) {
+            dgml += QString( "<item name=\"item%1\"><icon color=\"#ff0000\"/><text>Item</text></item>" ).arg( j );
+        }
+        dgml += "</section>";
+    }
+    dgml += "</legend></document></dgml>";
+    m_dgml = dgml.toUtf8();
+}
+
+GeoDocument *GeoParserTest::parse( GeoParser &parser, const QByteArray &data )
+{
+    QBuffer buffer;
+    buffer.setData( data );
+    buffer.open( QIODevice::ReadOnly );
+    if ( !parser.read( &buffer ) ) {
+        return 0;
+    }
+
+    return parser.releaseDocument();
+}
+
+void GeoParserTest::atomTable()
+{
+    GeoAtomTable atoms;
+    const char *placemark = "Placemark";
+    const QString text = "<Placemark><Point>";
+    const int atom = atoms.atom( QStringRef( &text, 1, 9 ) );
+    QCOMPARE( atoms.atom( placemark ), atom );
+    QCOMPARE( atoms.atom( QString( "Placemark" ) ), atom );
+    QCOMPARE( atoms.string( atom ), QString( "Placemark" ) );
+    QVERIFY( atoms.atom( QStringRef( &text, 12, 5 ) ) != atom );
+    QCOMPARE( atoms.atom( QString() ), atoms.atom( QString( "" ) ) );
+    QCOMPARE( atoms.size(), 3 );
+
+    // Growing the table keeps the atoms
+    for ( int i = 0; i < 1000; ++i ) {
+        QCOMPARE( atoms.atom( QString::number( i ) ), i + 3 );
+    }
+    for ( int i = 0; i < 1000; ++i ) {
+        QCOMPARE( atoms.atom( QString::number( i ) ), i + 3 );
+        QCOMPARE( atoms.string( i + 3 ), QString::number( i ) );
+    }
+    QCOMPARE( atoms.atom( placemark ), atom );
+    QCOMPARE( atoms.size(), 1003 );
+}
+
+void GeoParserTest::parseKml()
+{
+    GeoDataParser parser( GeoData_KML );
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( parse( parser, m_kml ) );
+    QVERIFY( document );
+
+    // Handlers of nested elements rely on their parents being recognized
+    QCOMPARE( document->size(), 1 );
+    const GeoDataContainer *folder = static_cast<const GeoDataContainer*>( document->child( 0 ) );
+    QCOMPARE( folder->name(), QString( "Places" ) );
+    QCOMPARE( folder->placemarkList().size(), 5000 );
+
+    const GeoDataPlacemark *placemark = folder->placemarkList().at( 42 );
+    QCOMPARE( placemark->name(), QString( "Place 42" ) );
+    QCOMPARE( placemark->description(), QString( "Somewhere" ) );
+    QCOMPARE( placemark->styleUrl(), QString( "#style0" ) );
+    QCOMPARE( placemark->extendedData().value( "index" ).value().toString(), QString( "42" ) );
+    QCOMPARE( placemark->coordinate().longitude( GeoDataCoordinates::Degree ), -138.0 );
+    QCOMPARE( placemark->coordinate().latitude( GeoDataCoordinates::Degree ), -48.0 );
+
+    delete document;
+}
+
+void GeoParserTest::parseGpx()
+{
+    GpxParser parser;
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( parse( parser, m_gpx ) );
+    QVERIFY( document );
+    QCOMPARE( document->placemarkList().size(), 1 );
+
+    const GeoDataPlacemark *placemark = document->placemarkList().first();
+    QCOMPARE( placemark->name(), QString( "Track" ) );
+    QCOMPARE( placemark->geometry()->geometryId(), GeoDataMultiGeometryId );
+    const GeoDataMultiGeometry *multiGeometry = static_cast<const GeoDataMultiGeometry*>( placemark->geometry() );
+    const GeoDataTrack *track = static_cast<const GeoDataTrack*>( &multiGeometry->at( 0 ) );
+    QCOMPARE( track->size(), 20000 );
+    QCOMPARE( track->whenList().at( 10 ), QDateTime( QDate( 2012, 5, 1 ), QTime( 8, 0, 10 ), Qt::UTC ) );
+    QCOMPARE( track->coordinatesList().at( 10 ).altitude(), 310.0 );
+
+    delete document;
+}
+
+void GeoParserTest::parseDgml()
+{
+    GeoSceneParser parser( GeoScene_DGML );
+    GeoSceneDocument *document = static_cast<GeoSceneDocument*>( parse( parser, m_dgml ) );
+    QVERIFY( document );
+
+    QCOMPARE( document->map()->layers().size(), 200 );
+    QCOMPARE( document->legend()->sections().size(), 200 );
+    QCOMPARE( document->legend()->sections().last()->items().size(), 10 );
+
+    delete document;
+}
+
+void GeoParserTest::benchmarkKml()
+{
+    QBENCHMARK {
+        GeoDataParser parser( GeoData_KML );
+        delete parse( parser, m_kml );
+    }
+}
+
+void GeoParserTest::benchmarkGpx()
+{
+    QBENCHMARK {
+        GpxParser parser;
+        delete parse( parser, m_gpx );
+    }
+}
+
+void GeoParserTest::benchmarkDgml()
+{
+    QBENCHMARK {
+        GeoSceneParser parser( GeoScene_DGML );
+        delete parse( parser, m_dgml );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::GeoParserTest )
+
+#include "GeoParserTest.moc"
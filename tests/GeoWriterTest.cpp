@@ -0,0 +1,178 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataLineString.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataParser.h"
+#include "GeoDataPlacemark.h"
+#include "GeoWriter.h"
+
+namespace Marble
+{
+
+class GeoWriterTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void appendNumber_data();
+    void appendNumber();
+    void appendRandomNumbers();
+    void roundTrip();
+
+    void benchmarkWrite();
+
+ private:
+    /**
+     * A document with a placemark whose line string wanders around with
+     * @p points points, optionally at some altitude.
+     */
+    static GeoDataDocument *createDocument( int points, bool altitude );
+
+    static QByteArray write( const GeoDataDocument *document );
+};
+
+GeoDataDocument *GeoWriterTest::createDocument( int points, bool altitude )
+{
+    qsrand( 42 );
+    GeoDataLineString *lineString = new GeoDataLineString;
+    for ( int i = 0; i < points; ++i ) {
+        const qreal lon = -180.0 + 360.0 * qrand() / RAND_MAX;
+        const qreal lat = -90.0 + 180.0 * qrand() / RAND_MAX;
+        const qreal alt = altitude ? 9000.0 * qrand() / RAND_MAX - 500.0 : 0.0;
+        lineString->append( GeoDataCoordinates( lon, lat, alt, GeoDataCoordinates::Degree ) );
+    }
+
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setName( "Track" );
+    placemark->setGeometry( lineString );
+
+    GeoDataLinearRing *ring = new GeoDataLinearRing;
+    for ( int i = 0; i < 100; ++i ) {
+        ring->append( GeoDataCoordinates( i * 0.1, -i * 0.1, 0.0, GeoDataCoordinates::Degree ) );
+    }
+    GeoDataPlacemark *boundary = new GeoDataPlacemark;
+    boundary->setName( "Boundary" );
+    boundary->setGeometry( ring );
+
+    GeoDataDocument *document = new GeoDataDocument;
+    document->append( placemark );
+    document->append( boundary );
+    return document;
+}
+
+QByteArray GeoWriterTest::write( const GeoDataDocument *document )
+{
+    QBuffer buffer;
+    buffer.open( QIODevice::WriteOnly );
+    GeoWriter writer;
+    if ( !writer.write( &buffer, document ) ) {
+        return QByteArray();
+    }
+
+    return buffer.data();
+}
+
+void GeoWriterTest::appendNumber_data()
+{
+    QTest::addColumn<qreal>( "value" );
+    QTest::addColumn<int>( "precision" );
+
+    QTest::newRow( "longitude" ) << qreal( 13.3770012345 ) << 10;
+    QTest::newRow( "negative" ) << qreal( -122.207881 ) << 10;
+    QTest::newRow( "zero" ) << qreal( 0.0 ) << 10;
+    QTest::newRow( "negative zero" ) << qreal( -0.0 ) << 2;
+    QTest::newRow( "rounds to zero" ) << qreal( -0.001 ) << 2;
+    QTest::newRow( "altitude" ) << qreal( 8848.456 ) << 2;
+    QTest::newRow( "no decimals" ) << qreal( 42.7 ) << 0;
+    QTest::newRow( "tie" ) << qreal( 0.125 ) << 2;
+    QTest::newRow( "carry" ) << qreal( 9.9999999999999 ) << 10;
+    QTest::newRow( "huge" ) << qreal( 1e300 ) << 10;
+    QTest::newRow( "many decimals" ) << qreal( 1.0 / 3.0 ) << 20;
+}
+
+void GeoWriterTest::appendNumber()
+{
+    QFETCH( qreal, value );
+    QFETCH( int, precision );
+
+    QString text( "x" );
+    GeoWriter::appendNumber( text, value, precision );
+    QCOMPARE( text, "x" + QString::number( value, 'f', precision ) );
+}
+
+void GeoWriterTest::appendRandomNumbers()
+{
+    qsrand( 7 );
+    QString text;
+    text.reserve( 64 );
+    for ( int i = 0; i < 100000; ++i ) {
+        const qreal value = ( 360.0 * qrand() / RAND_MAX - 180.0 ) * ( i % 3 ? 1.0 : 0.001 );
+        const int precision = i % 2 ? 10 : 2;
+        text.resize( 0 );
+        GeoWriter::appendNumber( text, value, precision );
+        QCOMPARE( text, QString::number( value, 'f', precision ) );
+    }
+}
+
+void GeoWriterTest::roundTrip()
+{
+    GeoDataDocument *document = createDocument( 20000, true );
+    const QByteArray kml = write( document );
+    QVERIFY( !kml.isEmpty() );
+
+    QBuffer buffer;
+    buffer.setData( kml );
+    buffer.open( QIODevice::ReadOnly );
+    GeoDataParser parser( GeoData_KML );
+    QVERIFY( parser.read( &buffer ) );
+    GeoDataDocument *reloaded = static_cast<GeoDataDocument*>( parser.releaseDocument() );
+    QVERIFY( reloaded );
+    QCOMPARE( reloaded->placemarkList().size(), 2 );
+
+    for ( int i = 0; i < 2; ++i ) {
+        const GeoDataLineString *expected = static_cast<const GeoDataLineString*>( document->placemarkList().at( i )->geometry() );
+        const GeoDataLineString *actual = static_cast<const GeoDataLineString*>( reloaded->placemarkList().at( i )->geometry() );
+        QCOMPARE( actual->nodeType(), expected->nodeType() );
+        QCOMPARE( actual->size(), expected->size() );
+
+        // Ten decimals for the angles and two for the altitude are written
+        for ( int j = 0; j < expected->size(); ++j ) {
+            const GeoDataCoordinates &a = actual->at( j );
+            const GeoDataCoordinates &b = expected->at( j );
+            QVERIFY( qAbs( a.longitude( GeoDataCoordinates::Degree ) - b.longitude( GeoDataCoordinates::Degree ) ) < 1e-9 );
+            QVERIFY( qAbs( a.latitude( GeoDataCoordinates::Degree ) - b.latitude( GeoDataCoordinates::Degree ) ) < 1e-9 );
+            QVERIFY( qAbs( a.altitude() - b.altitude() ) < 0.006 );
+        }
+    }
+
+    delete reloaded;
+    delete document;
+}
+
+void GeoWriterTest::benchmarkWrite()
+{
+    GeoDataDocument *document = createDocument( 100000, true );
+
+    QByteArray kml;
+    QBENCHMARK {
+        kml = write( document );
+    }
+    qDebug() << "Wrote" << kml.size() << "bytes";
+
+    delete document;
+}
+
+}
+
+QTEST_MAIN( Marble::GeoWriterTest )
+
+#include "GeoWriterTest.moc"
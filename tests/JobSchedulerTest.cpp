@@ -0,0 +1,171 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "jobscheduler.h"
+
+namespace Marble
+{
+
+class JobSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void estimate();
+    void largestFirst();
+    void oversizedJob();
+    void sameGroup();
+    void fakeJobs();
+
+ private:
+    static JobCost cost( int memory, int cores, int duration );
+};
+
+JobCost JobSchedulerTest::cost( int memory, int cores, int duration )
+{
+    JobCost result;
+    result.memory = memory;
+    result.cores = cores;
+    result.duration = duration;
+    return result;
+}
+
+void JobSchedulerTest::estimate()
+{
+    // Without history, larger inputs need more
+    const JobCost small = JobScheduler::estimate( 10 * 1024 * 1024, QList<JobRun>() );
+    const JobCost large = JobScheduler::estimate( 1000 * 1024 * 1024, QList<JobRun>() );
+    QVERIFY( large.memory > small.memory );
+    QVERIFY( large.duration > small.duration );
+    QCOMPARE( small.cores, 1 );
+
+    // The most recent run is scaled to the input size
+    JobRun recent;
+    recent.inputSize = 100;
+    recent.cost = cost( 1000, 2, 600 );
+    JobRun older;
+    older.inputSize = 100;
+    older.cost = cost( 4000, 1, 60 );
+    QList<JobRun> history;
+    history << recent << older;
+    const JobCost scaled = JobScheduler::estimate( 150, history );
+    QCOMPARE( scaled.memory, 1500 );
+    QCOMPARE( scaled.cores, 2 );
+    QCOMPARE( scaled.duration, 900 );
+
+    // The input size is not known before the download
+    const JobCost unknown = JobScheduler::estimate( 0, history );
+    QCOMPARE( unknown.memory, 1000 );
+    QCOMPARE( unknown.duration, 600 );
+}
+
+void JobSchedulerTest::largestFirst()
+{
+    JobScheduler scheduler;
+    scheduler.setMemoryBudget( 1000 );
+    scheduler.setCoreBudget( 1 );
+    scheduler.add( "city", cost( 100, 1, 60 ) );
+    scheduler.add( "country", cost( 800, 1, 3600 ) );
+    scheduler.add( "state", cost( 300, 1, 600 ) );
+    QVERIFY( scheduler.contains( "state" ) );
+    QVERIFY( !scheduler.contains( "continent" ) );
+
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "country" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() );
+    scheduler.finish( "country" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "state" );
+    scheduler.finish( "state" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "city" );
+    scheduler.finish( "city" );
+    QCOMPARE( scheduler.runningCount(), 0 );
+    QCOMPARE( scheduler.usedMemory(), 0 );
+    QCOMPARE( scheduler.usedCores(), 0 );
+}
+
+void JobSchedulerTest::oversizedJob()
+{
+    JobScheduler scheduler;
+    scheduler.setMemoryBudget( 1000 );
+    scheduler.setCoreBudget( 4 );
+    scheduler.add( "small", cost( 100, 1, 60 ) );
+    scheduler.add( "huge", cost( 5000, 1, 7200 ) );
+
+    // The huge job gets the machine for itself
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "huge" );
+    QCOMPARE( scheduler.pendingCount(), 1 );
+    scheduler.finish( "huge" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "small" );
+}
+
+void JobSchedulerTest::sameGroup()
+{
+    JobScheduler scheduler;
+    scheduler.setMemoryBudget( 1000 );
+    scheduler.setCoreBudget( 4 );
+    scheduler.add( "germany_Motorcar", cost( 300, 1, 3600 ), "germany" );
+    scheduler.add( "germany_Bicycle", cost( 300, 1, 1800 ), "germany" );
+    scheduler.add( "malta_Motorcar", cost( 100, 1, 60 ), "malta" );
+
+    // Jobs of one region share their files, they run one after the other
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "germany_Motorcar" << "malta_Motorcar" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() );
+    scheduler.finish( "malta_Motorcar" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() );
+    scheduler.finish( "germany_Motorcar" );
+    QCOMPARE( scheduler.takeRunnable(), QStringList() << "germany_Bicycle" );
+}
+
+void JobSchedulerTest::fakeJobs()
+{
+    // Fake jobs finish after their estimated duration. The scheduler must
+    // never exceed its budgets and keep the machine busy.
+    qsrand( 42 );
+    JobScheduler scheduler;
+    scheduler.setMemoryBudget( 16000 );
+    scheduler.setCoreBudget( 8 );
+
+    QHash<QString, JobCost> jobs;
+    qint64 coreWork = 0;
+    qint64 memoryWork = 0;
+    for ( int i = 0; i < 200; ++i ) {
+        const JobCost job = cost( 100 + qrand() % 6000, 1 + qrand() % 3, 60 + qrand() % 3600 );
+        const QString id = QString( "job%1" ).arg( i );
+        jobs[id] = job;
+        scheduler.add( id, job );
+        coreWork += job.duration * job.cores;
+        memoryWork += qint64( job.duration ) * job.memory;
+    }
+
+    QMultiMap<int, QString> finishing;
+    int time = 0;
+    while ( scheduler.pendingCount() > 0 || !finishing.isEmpty() ) {
+        foreach ( const QString &id, scheduler.takeRunnable() ) {
+            finishing.insert( time + jobs[id].duration, id );
+        }
+        QVERIFY( scheduler.usedMemory() <= scheduler.memoryBudget() );
+        QVERIFY( scheduler.usedCores() <= scheduler.coreBudget() );
+        QVERIFY( !finishing.isEmpty() );
+
+        time = finishing.begin().key();
+        const QString id = finishing.begin().value();
+        finishing.erase( finishing.begin() );
+        scheduler.finish( id );
+    }
+
+    // Not much longer than a perfect packing of either the cores or the memory
+    const qint64 lowerBound = qMax( coreWork / scheduler.coreBudget(), memoryWork / scheduler.memoryBudget() );
+    QVERIFY( time < 3 * lowerBound / 2 );
+}
+
+}
+
+QTEST_MAIN( Marble::JobSchedulerTest )
+
+#include "JobSchedulerTest.moc"
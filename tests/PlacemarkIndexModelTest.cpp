@@ -0,0 +1,215 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataTreeModel.h"
+#include "MarblePlacemarkModel.h"
+#include "PlacemarkIndexModel.h"
+
+namespace Marble
+{
+
+class PlacemarkIndexModelTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void documents();
+    void nestedChanges();
+    void reset();
+
+    void benchmarkAddRemove();
+    void benchmarkData();
+
+ private:
+    /**
+     * A document named @p name with @p folders folders of @p placemarks placemarks each.
+     */
+    static GeoDataDocument *createDocument( const QString &name, int folders, int placemarks );
+
+    static GeoDataPlacemark *createPlacemark( const QString &name );
+};
+
+GeoDataDocument *PlacemarkIndexModelTest::createDocument( const QString &name, int folders, int placemarks )
+{
+    GeoDataDocument *document = new GeoDataDocument;
+    document->setName( name );
+    for ( int i = 0; i < folders; ++i ) {
+        GeoDataFolder *folder = new GeoDataFolder;
+        for ( int j = 0; j < placemarks; ++j ) {
+            folder->append( createPlacemark( QString( "%1 %2/%3" ).arg( name ).arg( i ).arg( j ) ) );
+        }
+        document->append( folder );
+    }
+
+    return document;
+}
+
+GeoDataPlacemark *PlacemarkIndexModelTest::createPlacemark( const QString &name )
+{
+    GeoDataPlacemark *placemark = new GeoDataPlacemark;
+    placemark->setName( name );
+    return placemark;
+}
+
+void PlacemarkIndexModelTest::initTestCase()
+{
+    qRegisterMetaType<QModelIndex>( "QModelIndex" );
+}
+
+void PlacemarkIndexModelTest::documents()
+{
+    GeoDataTreeModel treeModel;
+    PlacemarkIndexModel model;
+    model.setTreeModel( &treeModel );
+    QSignalSpy inserted( &model, SIGNAL( rowsInserted( const QModelIndex &, int, int ) ) );
+    QSignalSpy removed( &model, SIGNAL( rowsRemoved( const QModelIndex &, int, int ) ) );
+
+    GeoDataDocument *a = createDocument( "A", 2, 3 );
+    GeoDataDocument *empty = createDocument( "Empty", 2, 0 );
+    GeoDataDocument *b = createDocument( "B", 1, 4 );
+    treeModel.addDocument( a );
+    treeModel.addDocument( empty );
+    treeModel.addDocument( b );
+    QCOMPARE( model.rowCount(), 10 );
+    QCOMPARE( inserted.count(), 2 );
+
+    // Depth-first order like the tree model lists them
+    QCOMPARE( model.index( 0 ).data().toString(), QString( "A 0/0" ) );
+    QCOMPARE( model.index( 3 ).data().toString(), QString( "A 1/0" ) );
+    QCOMPARE( model.index( 6 ).data().toString(), QString( "B 0/0" ) );
+    QCOMPARE( model.placemark( 9 )->name(), QString( "B 0/3" ) );
+    QVERIFY( !model.placemark( 10 ) );
+    QCOMPARE( model.placemarks().size(), 10 );
+    GeoDataObject *object = qvariant_cast<GeoDataObject*>( model.index( 9 ).data( MarblePlacemarkModel::ObjectPointerRole ) );
+    QCOMPARE( object, static_cast<GeoDataObject*>( model.placemark( 9 ) ) );
+
+    // Removing a document removes its rows only
+    QVERIFY( treeModel.removeFeature( a ) );
+    delete a;
+    QCOMPARE( model.rowCount(), 4 );
+    QCOMPARE( removed.count(), 1 );
+    QCOMPARE( removed.last().at( 1 ).toInt(), 0 );
+    QCOMPARE( removed.last().at( 2 ).toInt(), 5 );
+    QCOMPARE( model.placemark( 0 )->name(), QString( "B 0/0" ) );
+
+    QVERIFY( treeModel.removeFeature( empty ) );
+    delete empty;
+    QCOMPARE( removed.count(), 1 );
+    QCOMPARE( model.rowCount(), 4 );
+}
+
+void PlacemarkIndexModelTest::nestedChanges()
+{
+    GeoDataTreeModel treeModel;
+    PlacemarkIndexModel model;
+    model.setTreeModel( &treeModel );
+    GeoDataDocument *a = createDocument( "A", 2, 2 );
+    GeoDataDocument *b = createDocument( "B", 1, 2 );
+    treeModel.addDocument( a );
+    treeModel.addDocument( b );
+
+    QSignalSpy inserted( &model, SIGNAL( rowsInserted( const QModelIndex &, int, int ) ) );
+    QSignalSpy removed( &model, SIGNAL( rowsRemoved( const QModelIndex &, int, int ) ) );
+    QSignalSpy changed( &model, SIGNAL( dataChanged( const QModelIndex &, const QModelIndex & ) ) );
+
+    // A placemark added to the first folder of A goes behind its siblings
+    GeoDataFolder *folder = static_cast<GeoDataFolder*>( a->child( 0 ) );
+    GeoDataPlacemark *placemark = createPlacemark( "A 0/2" );
+    treeModel.addFeature( folder, placemark );
+    QCOMPARE( inserted.count(), 1 );
+    QCOMPARE( inserted.last().at( 1 ).toInt(), 2 );
+    QCOMPARE( inserted.last().at( 2 ).toInt(), 2 );
+    QCOMPARE( model.placemark( 2 ), placemark );
+    QCOMPARE( model.placemark( 3 )->name(), QString( "A 1/0" ) );
+    QCOMPARE( model.placemark( 5 )->name(), QString( "B 0/0" ) );
+
+    // Updates reach the row of the placemark
+    treeModel.updateFeature( placemark );
+    QCOMPARE( changed.count(), 1 );
+    QCOMPARE( changed.last().at( 0 ).value<QModelIndex>().row(), 2 );
+
+    // So does the removal of a whole folder
+    GeoDataFolder *second = static_cast<GeoDataFolder*>( a->child( 1 ) );
+    QVERIFY( treeModel.removeFeature( second ) );
+    delete second;
+    QCOMPARE( removed.count(), 1 );
+    QCOMPARE( removed.last().at( 1 ).toInt(), 3 );
+    QCOMPARE( removed.last().at( 2 ).toInt(), 4 );
+    QCOMPARE( model.rowCount(), 5 );
+    QCOMPARE( model.placemark( 3 )->name(), QString( "B 0/0" ) );
+}
+
+void PlacemarkIndexModelTest::reset()
+{
+    GeoDataTreeModel treeModel;
+    treeModel.addDocument( createDocument( "A", 3, 3 ) );
+
+    // Placemarks already in the tree model are listed as well
+    PlacemarkIndexModel model;
+    model.setTreeModel( &treeModel );
+    QCOMPARE( model.rowCount(), 9 );
+
+    GeoDataDocument root;
+    treeModel.setRootDocument( &root );
+    QCOMPARE( model.rowCount(), 0 );
+    treeModel.addDocument( createDocument( "B", 1, 2 ) );
+    QCOMPARE( model.rowCount(), 2 );
+
+    model.setTreeModel( 0 );
+    QCOMPARE( model.rowCount(), 0 );
+}
+
+void PlacemarkIndexModelTest::benchmarkAddRemove()
+{
+    GeoDataTreeModel treeModel;
+    PlacemarkIndexModel model;
+    model.setTreeModel( &treeModel );
+    treeModel.addDocument( createDocument( "Cities", 100, 500 ) );
+
+    QBENCHMARK {
+        GeoDataDocument *document = createDocument( "Track", 50, 1000 );
+        treeModel.addDocument( document );
+        treeModel.removeFeature( document );
+        delete document;
+    }
+    QCOMPARE( model.rowCount(), 50000 );
+}
+
+void PlacemarkIndexModelTest::benchmarkData()
+{
+    GeoDataTreeModel treeModel;
+    PlacemarkIndexModel model;
+    model.setTreeModel( &treeModel );
+    for ( int i = 0; i < 10; ++i ) {
+        treeModel.addDocument( createDocument( QString::number( i ), 10, 500 ) );
+    }
+
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for ( int row = 0; row < model.rowCount(); ++row ) {
+            if ( model.index( row ).data( MarblePlacemarkModel::PopularityIndexRole ).toInt() >= 0 ) {
+                ++count;
+            }
+        }
+    }
+    QCOMPARE( count, 50000 );
+}
+
+}
+
+QTEST_MAIN( Marble::PlacemarkIndexModelTest )
+
+#include "PlacemarkIndexModelTest.moc"
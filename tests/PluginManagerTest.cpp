@@ -12,6 +12,12 @@
 
 #include "MarbleDirs.h"
 #include "PluginManager.h"
+#include "RenderPlugin.h"
+#include "RunnerPlugin.h"
+
+#ifndef Q_OS_WIN
+#include <utime.h>
+#endif
 
 namespace Marble
 {
@@ -21,8 +27,114 @@ class PluginManagerTest : public QObject
     Q_OBJECT
     private slots:
         void loadPlugins();
+        void cache();
+
+    private:
+        // The plugin kinds as the cache stores them
+        enum CachedType {
+            InvalidType = 1,
+            NetworkType = 3,
+            RunnerType = 5
+        };
+
+        struct CacheEntry
+        {
+            QString path;
+            qint64 size;
+            qint64 lastModified;
+            qint32 type;
+            QString nameId;
+            qint32 capabilities;
+            QStringList fileExtensions;
+        };
+
+        static bool copyPlugin( const QString &name, const QString &directory,
+                                const QString &targetName = QString() );
+        static void removeDirectory( const QString &path );
+
+        QList<CacheEntry> readCache() const;
+        void writeCache( const QList<CacheEntry> &entries ) const;
+        static CacheEntry &entry( QList<CacheEntry> &entries, const QString &fileName );
+
+        QString m_pluginDirectory;
+        QString m_cacheFileName;
 };
 
+bool PluginManagerTest::copyPlugin( const QString &name, const QString &directory,
+                                    const QString &targetName )
+{
+    const QStringList files = QDir( PLUGIN_PATH ).entryList( QStringList() << '*' + name + ".*", QDir::Files );
+    if ( files.isEmpty() ) {
+        return false;
+    }
+
+    QString target = files.first();
+    if ( !targetName.isEmpty() ) {
+        target.replace( name, targetName );
+    }
+    return QFile::copy( QString( PLUGIN_PATH ) + '/' + files.first(), directory + '/' + target );
+}
+
+void PluginManagerTest::removeDirectory( const QString &path )
+{
+    QDir directory( path );
+    foreach ( const QString &name, directory.entryList( QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+        removeDirectory( directory.filePath( name ) );
+    }
+    foreach ( const QString &name, directory.entryList( QDir::Files ) ) {
+        directory.remove( name );
+    }
+    QDir().rmdir( path );
+}
+
+QList<PluginManagerTest::CacheEntry> PluginManagerTest::readCache() const
+{
+    QList<CacheEntry> result;
+
+    QFile file( m_cacheFileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        return result;
+    }
+
+    QDataStream stream( &file );
+    quint32 version;
+    qint32 count;
+    stream >> version >> count;
+    for ( qint32 i = 0; i < count; ++i ) {
+        CacheEntry entry;
+        stream >> entry.path >> entry.size >> entry.lastModified >> entry.type >> entry.nameId
+               >> entry.capabilities >> entry.fileExtensions;
+        result << entry;
+    }
+
+    return result;
+}
+
+void PluginManagerTest::writeCache( const QList<CacheEntry> &entries ) const
+{
+    QFile file( m_cacheFileName );
+    QVERIFY( file.open( QIODevice::WriteOnly | QIODevice::Truncate ) );
+
+    QDataStream stream( &file );
+    stream << quint32( 2 ) << qint32( entries.size() );
+    foreach ( const CacheEntry &entry, entries ) {
+        stream << entry.path << entry.size << entry.lastModified << entry.type << entry.nameId
+               << entry.capabilities << entry.fileExtensions;
+    }
+}
+
+PluginManagerTest::CacheEntry &PluginManagerTest::entry( QList<CacheEntry> &entries, const QString &fileName )
+{
+    for ( int i = 0; i < entries.size(); ++i ) {
+        if ( QFileInfo( entries.at( i ).path ).completeBaseName().endsWith( fileName ) ) {
+            return entries[i];
+        }
+    }
+
+    Q_ASSERT( false );
+    return entries[0];
+}
+
 void PluginManagerTest::loadPlugins()
 {
     MarbleDirs::setMarbleDataPath( DATA_PATH );
@@ -37,6 +149,95 @@ void PluginManagerTest::loadPlugins()
     QCOMPARE( renderPlugins + networkPlugins + positionPlugins + runnerPlugins, pluginNumber );
 }
 
+void PluginManagerTest::cache()
+{
+#ifdef Q_OS_WIN
+    QSKIP( "The local Marble directory can only be redirected on Unix", SkipAll );
+#else
+    const QString directory = QDir::tempPath() + QString( "/marble-pluginmanagertest-%1" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( directory );
+    m_pluginDirectory = directory + "/plugins";
+    QVERIFY( QDir().mkpath( m_pluginDirectory ) );
+
+    // The cache lives in the local Marble directory
+    qputenv( "XDG_DATA_HOME", QFile::encodeName( directory + "/data" ) );
+    m_cacheFileName = MarbleDirs::localPath() + "/plugins.cache";
+    QVERIFY( m_cacheFileName.startsWith( directory ) );
+
+    MarbleDirs::setMarbleDataPath( DATA_PATH );
+    MarbleDirs::setMarblePluginPath( m_pluginDirectory );
+
+    QVERIFY( copyPlugin( "CompassFloatItem", m_pluginDirectory ) );
+    QVERIFY( copyPlugin( "GpxPlugin", m_pluginDirectory ) );
+    QVERIFY( copyPlugin( "GpxPlugin", m_pluginDirectory, "GpxPluginCopy" ) );
+    QVERIFY( copyPlugin( "KmlPlugin", m_pluginDirectory ) );
+    QFile invalid( m_pluginDirectory + "/NotAPlugin" );
+    QVERIFY( invalid.open( QIODevice::WriteOnly ) );
+    invalid.write( "This is not a plugin." );
+    invalid.close();
+
+    {
+        PluginManager manager;
+        const QList<RenderPlugin *> renderPlugins = manager.createRenderPlugins();
+        QCOMPARE( renderPlugins.size(), 1 );
+        qDeleteAll( renderPlugins );
+
+        // The copy of the gpx plugin is ignored
+        QCOMPARE( manager.runnerPlugins().size(), 2 );
+    }
+
+    QList<CacheEntry> entries = readCache();
+    QCOMPARE( entries.size(), 5 );
+    QCOMPARE( entry( entries, "NotAPlugin" ).type, qint32( InvalidType ) );
+    QCOMPARE( entry( entries, "KmlPlugin" ).type, qint32( RunnerType ) );
+    QCOMPARE( entry( entries, "KmlPlugin" ).nameId, QString( "Kml" ) );
+    QCOMPARE( entry( entries, "KmlPlugin" ).fileExtensions, QStringList() << "kml" );
+    QCOMPARE( entry( entries, "GpxPluginCopy" ).nameId, QString( "Gpx" ) );
+
+    // The cached kind decides which plugins get loaded, so a kml plugin
+    // that pretends to be a network plugin isn't loaded for parsing.
+    entry( entries, "KmlPlugin" ).type = NetworkType;
+    writeCache( entries );
+    {
+        PluginManager manager;
+        QCOMPARE( manager.parsingRunnerPlugins( "GPX" ).size(), 1 );
+        QCOMPARE( manager.parsingRunnerPlugins( "gpx" ).first()->nameId(), QString( "Gpx" ) );
+        QCOMPARE( manager.runnerPlugins().size(), 1 );
+    }
+    entries = readCache();
+    QCOMPARE( entries.size(), 5 );
+    QCOMPARE( entry( entries, "KmlPlugin" ).type, qint32( NetworkType ) );
+
+    // A changed modification time invalidates the entry
+    const QString kmlPath = entry( entries, "KmlPlugin" ).path;
+    utimbuf times;
+    times.actime = QFileInfo( kmlPath ).lastModified().toTime_t() - 3600;
+    times.modtime = times.actime;
+    QCOMPARE( utime( QFile::encodeName( kmlPath ).constData(), &times ), 0 );
+    {
+        PluginManager manager;
+        QCOMPARE( manager.parsingRunnerPlugins( "kml" ).size(), 1 );
+        QCOMPARE( manager.parsingRunnerPlugins( "kml" ).first()->nameId(), QString( "Kml" ) );
+        QCOMPARE( manager.runnerPlugins().size(), 2 );
+    }
+    entries = readCache();
+    QCOMPARE( entry( entries, "KmlPlugin" ).type, qint32( RunnerType ) );
+
+    // Plugins that failed to load before are tried again
+    entry( entries, "GpxPlugin" ).type = InvalidType;
+    writeCache( entries );
+    {
+        PluginManager manager;
+        QCOMPARE( manager.runnerPlugins().size(), 2 );
+    }
+    entries = readCache();
+    QCOMPARE( entry( entries, "GpxPlugin" ).type, qint32( RunnerType ) );
+    QCOMPARE( entry( entries, "NotAPlugin" ).type, qint32( InvalidType ) );
+
+    removeDirectory( directory );
+#endif
+}
+
 }
 
 QTEST_MAIN( Marble::PluginManagerTest )
@@ -0,0 +1,147 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "routing/Route.h"
+
+#include <cmath>
+
+namespace Marble
+{
+
+class RouteTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void positionOnRoute();
+
+    void benchmarkReplayAllSegments();
+    void benchmarkReplay();
+
+ private:
+    /**
+     * Matches the position to the route by looking at all segments,
+     * as it used to be done for each position. Returns the index of the
+     * matched segment.
+     */
+    static int matchAllSegments( const Route &route, const GeoDataCoordinates &position,
+                                 int lastSegmentIndex, GeoDataCoordinates &positionOnRoute );
+
+    Route m_route;
+    QVector<GeoDataCoordinates> m_positions;
+};
+
+void RouteTest::initTestCase()
+{
+    // A winding route of about 1000 km with a point every ten meters,
+    // made up of 200 segments which share their end points.
+    const int segmentCount = 200;
+    const int pointsPerSegment = 500;
+    GeoDataCoordinates last( 8.0, 48.0, 0.0, GeoDataCoordinates::Degree );
+    for ( int i = 0; i < segmentCount; ++i ) {
+        GeoDataLineString path;
+        path << last;
+        for ( int j = 1; j < pointsPerSegment; ++j ) {
+            const int k = i * pointsPerSegment + j;
+            const qreal lon = 8.0 + k * 0.000135;
+            const qreal lat = 48.0 + 0.05 * sin( k / 700.0 ) + 0.01 * sin( k / 90.0 );
+            last = GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+            path << last;
+        }
+
+        RouteSegment segment;
+        segment.setPath( path );
+        m_route.addRouteSegment( segment );
+    }
+    QCOMPARE( m_route.size(), segmentCount );
+
+    // GPS fixes about every third point, a few meters off the route, with a
+    // detour of some kilometers every now and then.
+    qsrand( 42 );
+    const GeoDataLineString &path = m_route.path();
+    for ( int i = 0; i < path.size(); i += 3 ) {
+        qreal lon = path.at( i ).longitude( GeoDataCoordinates::Degree );
+        qreal lat = path.at( i ).latitude( GeoDataCoordinates::Degree );
+        lon += ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 0.0002;
+        lat += ( qrand() / qreal( RAND_MAX ) - 0.5 ) * 0.0002;
+        if ( ( i / 3 ) % 5000 > 4990 ) {
+            lat += 0.05;
+        }
+        m_positions << GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree );
+    }
+}
+
+int RouteTest::matchAllSegments( const Route &route, const GeoDataCoordinates &position,
+                                 int lastSegmentIndex, GeoDataCoordinates &positionOnRoute )
+{
+    GeoDataCoordinates closest, interpolated;
+    int segmentIndex = lastSegmentIndex;
+    qreal distance = route.at( segmentIndex ).distanceTo( position, closest, positionOnRoute );
+
+    for ( int i = 0; i < route.size(); ++i ) {
+        if ( i != lastSegmentIndex && route.at( i ).minimalDistanceTo( position ) <= distance ) {
+            const qreal dist = route.at( i ).distanceTo( position, closest, interpolated );
+            if ( dist < distance ) {
+                distance = dist;
+                segmentIndex = i;
+                positionOnRoute = interpolated;
+            }
+        }
+    }
+
+    return segmentIndex;
+}
+
+void RouteTest::positionOnRoute()
+{
+    Route route = m_route;
+    int expectedIndex = 0;
+
+    foreach ( const GeoDataCoordinates &position, m_positions ) {
+        GeoDataCoordinates expected;
+        expectedIndex = matchAllSegments( route, position, expectedIndex, expected );
+
+        route.setPosition( position );
+        QCOMPARE( int( &route.currentSegment() - &route.at( 0 ) ), expectedIndex );
+        QCOMPARE( route.positionOnRoute().longitude(), expected.longitude() );
+        QCOMPARE( route.positionOnRoute().latitude(), expected.latitude() );
+    }
+}
+
+void RouteTest::benchmarkReplayAllSegments()
+{
+    QBENCHMARK {
+        int segmentIndex = 0;
+        GeoDataCoordinates positionOnRoute;
+        for ( int i = 0; i < m_positions.size(); i += 10 ) {
+            segmentIndex = matchAllSegments( m_route, m_positions.at( i ), segmentIndex, positionOnRoute );
+        }
+    }
+}
+
+void RouteTest::benchmarkReplay()
+{
+    Route route = m_route;
+
+    QBENCHMARK {
+        for ( int i = 0; i < m_positions.size(); i += 10 ) {
+            route.setPosition( m_positions.at( i ) );
+            route.positionOnRoute();
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::RouteTest )
+
+#include "RouteTest.moc"
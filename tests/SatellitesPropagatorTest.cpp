@@ -0,0 +1,239 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "global.h"
+#include "MarbleMath.h"
+#include "SatellitesPropagator.h"
+#include "sgp4/sgp4ext.h"
+#include "sgp4/sgp4io.h"
+
+#include <cmath>
+#include <locale.h>
+
+namespace Marble
+{
+
+class SatellitesPropagatorTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void propagate();
+    void reference_data();
+    void reference();
+    void propagateMovedWindow();
+    void propagatePending();
+
+    void benchmarkInitial();
+    void benchmarkClockTick();
+
+ private:
+    /**
+     * Creates the orbital elements of a made-up satellite in a low earth orbit.
+     */
+    static elsetrec syntheticSatellite( int number );
+
+    QVector<elsetrec> m_satellites;
+    uint m_time;
+};
+
+elsetrec SatellitesPropagatorTest::syntheticSatellite( int number )
+{
+    const double deg2rad = M_PI / 180.0;
+
+    elsetrec satrec;
+    satrec.epochyr = 12;
+    satrec.epochdays = 100.5 + number % 10;
+
+    int month, day, hours, minutes;
+    double seconds;
+    days2mdhms( 2012, satrec.epochdays, month, day, hours, minutes, seconds );
+    jday( 2012, month, day, hours, minutes, seconds, satrec.jdsatepoch );
+
+    // Between 12 and 16 revolutions per day, given in radian per minute
+    const double meanMotion = ( 12.0 + ( number % 40 ) * 0.1 ) * 2 * M_PI / 1440.0;
+
+    sgp4init( wgs84, 'i', number, satrec.jdsatepoch - 2433281.5, 1e-4,
+              0.001 + ( number % 7 ) * 0.002,
+              ( number * 37 % 360 ) * deg2rad,
+              ( 20 + number % 80 ) * deg2rad,
+              ( number * 53 % 360 ) * deg2rad,
+              meanMotion,
+              ( number * 71 % 360 ) * deg2rad,
+              satrec );
+
+    return satrec;
+}
+
+void SatellitesPropagatorTest::initTestCase()
+{
+    for ( int i = 0; i < 2000; ++i ) {
+        m_satellites << syntheticSatellite( i );
+        QCOMPARE( m_satellites.last().error, 0 );
+    }
+
+    m_time = QDateTime( QDate( 2012, 4, 20 ), QTime( 12, 0 ), Qt::UTC ).toTime_t();
+}
+
+void SatellitesPropagatorTest::propagate()
+{
+    SatellitesPropagator propagator;
+    propagator.addSatellites( m_satellites );
+
+    propagator.propagate( m_time );
+    propagator.waitForDone();
+
+    const QVector<SatellitesPropagator::OrbitUpdate> updates = propagator.takeUpdates();
+    QCOMPARE( updates.size(), m_satellites.size() );
+
+    foreach ( const SatellitesPropagator::OrbitUpdate &update, updates ) {
+        QVERIFY( update.times.size() >= 100 );
+        QCOMPARE( update.times.size(), update.coordinates.size() );
+        QCOMPARE( update.times.first(), m_time );
+        for ( int i = 2; i < update.times.size(); ++i ) {
+            QVERIFY( update.times.at( i ) > update.times.at( i - 1 ) );
+        }
+        QVERIFY( update.times.last() <= update.windowEnd );
+    }
+
+    QVERIFY( propagator.takeUpdates().isEmpty() );
+}
+
+void SatellitesPropagatorTest::reference_data()
+{
+    QTest::addColumn<int>( "minutes" );
+    QTest::addColumn<double>( "x" );
+    QTest::addColumn<double>( "y" );
+    QTest::addColumn<double>( "z" );
+
+    // Positions in km of satellite 00005 as listed in the verification
+    // output of the reference SGP4 implementation (tcppver.out of
+    // "Revisiting Spacetrack Report #3", Vallado et al.).
+    QTest::newRow( "epoch" ) << 0 << 7022.46529266 << -1400.08296755 << 0.03995155;
+    QTest::newRow( "6 hours" ) << 360 << -7154.03120202 << -3783.17682504 << -3536.19412294;
+    QTest::newRow( "12 hours" ) << 720 << -7134.59340119 << 6531.68641334 << 3260.27186483;
+    QTest::newRow( "18 hours" ) << 1080 << 5568.53901181 << 4492.06992591 << 3863.87641983;
+    QTest::newRow( "24 hours" ) << 1440 << -938.55923943 << -6268.18748831 << -4294.02924751;
+}
+
+void SatellitesPropagatorTest::reference()
+{
+    QFETCH( int, minutes );
+    QFETCH( double, x );
+    QFETCH( double, y );
+    QFETCH( double, z );
+
+    char line1[130];
+    char line2[130];
+    qstrcpy( line1, "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753" );
+    qstrcpy( line2, "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667" );
+
+    // twoline2rv uses sscanf
+    setlocale( LC_NUMERIC, "C" );
+    double startmfe, stopmfe, deltamin;
+    elsetrec satrec;
+    twoline2rv( line1, line2, 'c', 'd', 'i', wgs84, startmfe, stopmfe, deltamin, satrec );
+    setlocale( LC_NUMERIC, "" );
+    QCOMPARE( satrec.error, 0 );
+
+    SatellitesPropagator propagator;
+    propagator.addSatellite( satrec );
+    const uint time = SatellitesPropagator::epoch( satrec ) + minutes * 60;
+    propagator.propagate( time );
+    propagator.waitForDone();
+
+    const QVector<SatellitesPropagator::OrbitUpdate> updates = propagator.takeUpdates();
+    QCOMPARE( updates.size(), 1 );
+    QCOMPARE( updates.first().times.first(), time );
+    const GeoDataCoordinates actual = updates.first().coordinates.first();
+
+    // The reference uses the WGS-72 constants, Marble WGS-84, which moves
+    // the satellite by a few ten meters.
+    const GeoDataCoordinates expected =
+        SatellitesPropagator::fromTEME( satrec, x, y, z, SatellitesPropagator::gmst( satrec, minutes ) );
+    const qreal distance = EARTH_RADIUS * distanceSphere( actual, expected );
+    QVERIFY2( distance < 500.0, qPrintable( QString::number( distance ) ) );
+    QVERIFY( qAbs( actual.altitude() - expected.altitude() ) < 500.0 );
+}
+
+void SatellitesPropagatorTest::propagateMovedWindow()
+{
+    SatellitesPropagator propagator;
+    propagator.addSatellites( m_satellites );
+
+    propagator.propagate( m_time );
+    propagator.waitForDone();
+    propagator.takeUpdates();
+
+    propagator.propagate( m_time + 60 );
+    propagator.waitForDone();
+
+    // A minute is at most two samples for the orbits above.
+    const QVector<SatellitesPropagator::OrbitUpdate> updates = propagator.takeUpdates();
+    QCOMPARE( updates.size(), m_satellites.size() );
+    foreach ( const SatellitesPropagator::OrbitUpdate &update, updates ) {
+        QCOMPARE( update.times.first(), m_time + 60 );
+        QVERIFY( update.times.size() <= 3 );
+        QCOMPARE( update.windowStart, m_time + 60 - 2 * 60 );
+    }
+}
+
+void SatellitesPropagatorTest::propagatePending()
+{
+    SatellitesPropagator propagator;
+    propagator.addSatellites( m_satellites );
+
+    // The second request waits for the first one and must not get lost.
+    propagator.propagate( m_time );
+    propagator.propagate( m_time + 600 );
+    propagator.waitForDone();
+
+    const QVector<SatellitesPropagator::OrbitUpdate> updates = propagator.takeUpdates();
+    QCOMPARE( updates.size(), m_satellites.size() );
+    foreach ( const SatellitesPropagator::OrbitUpdate &update, updates ) {
+        QCOMPARE( update.windowStart, m_time + 600 - 2 * 60 );
+        QVERIFY( update.times.contains( m_time + 600 ) );
+    }
+}
+
+void SatellitesPropagatorTest::benchmarkInitial()
+{
+    QBENCHMARK {
+        SatellitesPropagator propagator;
+        propagator.addSatellites( m_satellites );
+        propagator.propagate( m_time );
+        propagator.waitForDone();
+    }
+}
+
+void SatellitesPropagatorTest::benchmarkClockTick()
+{
+    SatellitesPropagator propagator;
+    propagator.addSatellites( m_satellites );
+    propagator.propagate( m_time );
+    propagator.waitForDone();
+    propagator.takeUpdates();
+
+    uint time = m_time;
+    QBENCHMARK {
+        time += 60;
+        propagator.propagate( time );
+        propagator.waitForDone();
+        propagator.takeUpdates();
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::SatellitesPropagatorTest )
+
+#include "SatellitesPropagatorTest.moc"
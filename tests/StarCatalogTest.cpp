@@ -0,0 +1,183 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "StarCatalog.h"
+
+#include <cmath>
+
+namespace Marble
+{
+
+static bool pointLessThan( const QPointF &a, const QPointF &b )
+{
+    return a.x() < b.x() || ( a.x() == b.x() && a.y() < b.y() );
+}
+
+class StarCatalogTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+
+    void sizeClass_data();
+    void sizeClass();
+
+    void project();
+
+    void benchmarkStarLoop();
+    void benchmarkCatalog();
+
+ private:
+    /**
+     * The projection as it used to be done for every star and frame.
+     */
+    static void projectStars( const QVector<StarPoint> &stars, const matrix &skyAxisMatrix,
+                              qreal skyRadius, qreal earthRadius, int width, int height,
+                              QVector<QPointF> *points );
+
+    QVector<StarPoint> m_stars;
+    matrix m_skyAxisMatrix;
+};
+
+void StarCatalogTest::initTestCase()
+{
+    // A catalog of 200000 stars with about three times as many stars per
+    // magnitude, similar to real catalogs.
+    qsrand( 42 );
+    for ( int i = 0; i < 200000; ++i ) {
+        const qreal rect = ( qrand() / qreal( RAND_MAX ) ) * 2 * M_PI;
+        const qreal decl = asin( 2 * ( qrand() / qreal( RAND_MAX ) ) - 1 );
+        const qreal magnitude = 9.0 + log( qMax<qreal>( qrand() / qreal( RAND_MAX ), 1e-6 ) ) / log( 3.0 );
+        m_stars << StarPoint( rect, decl, magnitude );
+    }
+
+    const Quaternion skyAxis = Quaternion::fromEuler( -0.5, 1.2, 0.0 );
+    skyAxis.inverse().toMatrix( m_skyAxisMatrix );
+}
+
+void StarCatalogTest::sizeClass_data()
+{
+    QTest::addColumn<qreal>( "magnitude" );
+    QTest::addColumn<qreal>( "size" );
+
+    QTest::newRow( "Sirius" ) << qreal( -1.46 ) << qreal( 6.5 );
+    QTest::newRow( "-1" ) << qreal( -1.0 ) << qreal( 5.5 );
+    QTest::newRow( "Vega" ) << qreal( 0.03 ) << qreal( 4.5 );
+    QTest::newRow( "Polaris" ) << qreal( 1.98 ) << qreal( 4.0 );
+    QTest::newRow( "4.5" ) << qreal( 4.5 ) << qreal( 1.0 );
+    QTest::newRow( "5.99" ) << qreal( 5.99 ) << qreal( 0.5 );
+    QTest::newRow( "12" ) << qreal( 12.0 ) << qreal( 0.5 );
+}
+
+void StarCatalogTest::sizeClass()
+{
+    QFETCH( qreal, magnitude );
+    QFETCH( qreal, size );
+
+    QCOMPARE( StarCatalog::starSize( StarCatalog::sizeClass( magnitude ) ), size );
+}
+
+void StarCatalogTest::projectStars( const QVector<StarPoint> &stars, const matrix &skyAxisMatrix,
+                                    qreal skyRadius, qreal earthRadius, int width, int height,
+                                    QVector<QPointF> *points )
+{
+    QVector<StarPoint>::const_iterator i = stars.constBegin();
+    QVector<StarPoint>::const_iterator itEnd = stars.constEnd();
+    for (; i != itEnd; ++i)
+    {
+        Quaternion  qpos = (*i).quaternion();
+
+        qpos.rotateAroundAxis( skyAxisMatrix );
+
+        if ( qpos.v[Q_Z] > 0 ) {
+           continue;
+        }
+
+        qreal  earthCenteredX = qpos.v[Q_X] * skyRadius;
+        qreal  earthCenteredY = qpos.v[Q_Y] * skyRadius;
+
+        if ( qpos.v[Q_Z] < 0
+            && ( ( earthCenteredX * earthCenteredX
+                    + earthCenteredY * earthCenteredY )
+                < earthRadius * earthRadius ) ) {
+            continue;
+        }
+
+        int x = (int)(width  / 2 + skyRadius * qpos.v[Q_X]);
+        int y = (int)(height / 2 - skyRadius * qpos.v[Q_Y]);
+
+        if ( x < 0 || x >= width || y < 0 || y >= height )
+            continue;
+
+        const int sizeClass = StarCatalog::sizeClass( (*i).magnitude() );
+        const qreal size = StarCatalog::starSize( sizeClass );
+        points[sizeClass] << QPointF( x + size / 2.0, y + size / 2.0 );
+    }
+}
+
+void StarCatalogTest::project()
+{
+    StarCatalog catalog;
+    catalog.setStars( m_stars );
+    QCOMPARE( catalog.size(), m_stars.size() );
+
+    for ( int i = 1; i < catalog.size(); ++i ) {
+        QVERIFY( catalog.magnitude( i - 1 ) <= catalog.magnitude( i ) );
+    }
+
+    QVector<QPointF> expected[StarCatalog::SizeClassCount];
+    projectStars( m_stars, m_skyAxisMatrix, 600.0, 200.0, 800, 600, expected );
+
+    QVector<QPointF> points[StarCatalog::SizeClassCount];
+    catalog.project( m_skyAxisMatrix, 600.0, 200.0, 800, 600, 100.0, points );
+
+    // The order within a size class changes, the projected points don't.
+    for ( int i = 0; i < StarCatalog::SizeClassCount; ++i ) {
+        qSort( expected[i].begin(), expected[i].end(), pointLessThan );
+        qSort( points[i].begin(), points[i].end(), pointLessThan );
+        QCOMPARE( points[i], expected[i] );
+    }
+
+    // The magnitude limit drops the faint stars only.
+    QVector<QPointF> limited[StarCatalog::SizeClassCount];
+    catalog.project( m_skyAxisMatrix, 600.0, 200.0, 800, 600, 4.0, limited );
+    for ( int i = 0; i < 6; ++i ) {
+        QCOMPARE( limited[i].size(), points[i].size() );
+    }
+    QVERIFY( limited[6].isEmpty() );
+    QVERIFY( limited[7].isEmpty() );
+}
+
+void StarCatalogTest::benchmarkStarLoop()
+{
+    QBENCHMARK {
+        QVector<QPointF> points[StarCatalog::SizeClassCount];
+        projectStars( m_stars, m_skyAxisMatrix, 600.0, 200.0, 800, 600, points );
+    }
+}
+
+void StarCatalogTest::benchmarkCatalog()
+{
+    StarCatalog catalog;
+    catalog.setStars( m_stars );
+
+    QBENCHMARK {
+        QVector<QPointF> points[StarCatalog::SizeClassCount];
+        catalog.project( m_skyAxisMatrix, 600.0, 200.0, 800, 600,
+                         StarCatalog::magnitudeLimit( 600.0 ), points );
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::StarCatalogTest )
+
+#include "StarCatalogTest.moc"
@@ -0,0 +1,146 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "TileCreator.h"
+#include "global.h"
+
+namespace Marble
+{
+
+// Tiles are created up to this level
+static const int maxTileLevel = 2;
+
+/**
+ * A source image of distinct but predictable colors.
+ */
+class PatternSource : public TileCreatorSource
+{
+public:
+    virtual QSize fullImageSize() const
+    {
+        return QSize( ( defaultLevelZeroColumns << maxTileLevel ) * c_defaultTileSize,
+                      ( defaultLevelZeroRows << maxTileLevel ) * c_defaultTileSize );
+    }
+
+    virtual QImage tile( int n, int m, int tileLevel )
+    {
+        Q_ASSERT( tileLevel == maxTileLevel );
+        Q_UNUSED( tileLevel );
+
+        QImage result( c_defaultTileSize, c_defaultTileSize, QImage::Format_RGB32 );
+        for ( uint y = 0; y < c_defaultTileSize; ++y ) {
+            for ( uint x = 0; x < c_defaultTileSize; ++x ) {
+                result.setPixel( x, y, color( m * c_defaultTileSize + x, n * c_defaultTileSize + y ) );
+            }
+        }
+        return result;
+    }
+
+    static QRgb color( int x, int y )
+    {
+        return qRgb( x % 251, y % 241, ( x / 7 + y / 5 ) % 256 );
+    }
+};
+
+class TileCreatorTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void createTiles();
+
+ private:
+    /**
+     * The color a tile should have at the given pixel. Each pixel of a lower
+     * level is taken from a pixel of one of the four tiles it is built from.
+     */
+    static QRgb expectedColor( int level, int n, int m, int x, int y );
+
+    static void removeDirectory( const QString &path );
+};
+
+QRgb TileCreatorTest::expectedColor( int level, int n, int m, int x, int y )
+{
+    if ( level == maxTileLevel ) {
+        return PatternSource::color( m * c_defaultTileSize + x, n * c_defaultTileSize + y );
+    }
+
+    const int half = c_defaultTileSize / 2;
+    const int right = x < half ? 0 : 1;
+    const int bottom = y < half ? 0 : 1;
+    return expectedColor( level + 1, 2 * n + bottom, 2 * m + right,
+                          2 * ( x - right * half ), 2 * ( y - bottom * half ) );
+}
+
+void TileCreatorTest::removeDirectory( const QString &path )
+{
+    QDirIterator it( path, QDir::Files, QDirIterator::Subdirectories );
+    while ( it.hasNext() ) {
+        QFile::remove( it.next() );
+    }
+
+    QDirIterator dirs( path, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories );
+    QStringList directories;
+    while ( dirs.hasNext() ) {
+        directories.prepend( dirs.next() );
+    }
+    foreach ( const QString &directory, directories ) {
+        QDir().rmdir( directory );
+    }
+    QDir().rmdir( path );
+}
+
+void TileCreatorTest::createTiles()
+{
+    const QString targetDir = QDir::tempPath() + "/marble-tilecreatortest/";
+    removeDirectory( targetDir );
+
+    TileCreator creator( new PatternSource, "false", targetDir );
+    creator.setTileFormat( "png" );
+    creator.setVerifyExactResult( true );
+
+    QSignalSpy progress( &creator, SIGNAL( progress( int ) ) );
+    creator.start();
+    QVERIFY( creator.wait( 300000 ) );
+    QVERIFY( !progress.isEmpty() );
+    QCOMPARE( progress.last().first().toInt(), 100 );
+
+    // Each tile has the same content no matter which worker created it
+    for ( int level = 0; level <= maxTileLevel; ++level ) {
+        const int rows = defaultLevelZeroRows << level;
+        const int columns = defaultLevelZeroColumns << level;
+        for ( int n = 0; n < rows; ++n ) {
+            for ( int m = 0; m < columns; ++m ) {
+                const QString fileName = QString( "%1%2/%3/%3_%4.png" ).arg( targetDir ).arg( level )
+                                         .arg( n, tileDigits, 10, QChar( '0' ) )
+                                         .arg( m, tileDigits, 10, QChar( '0' ) );
+                const QImage tile( fileName );
+                QCOMPARE( tile.size(), QSize( c_defaultTileSize, c_defaultTileSize ) );
+
+                for ( int y = 0; y < tile.height(); ++y ) {
+                    for ( int x = 0; x < tile.width(); ++x ) {
+                        if ( qRgb( qRed( tile.pixel( x, y ) ), qGreen( tile.pixel( x, y ) ), qBlue( tile.pixel( x, y ) ) )
+                             != expectedColor( level, n, m, x, y ) ) {
+                            QFAIL( qPrintable( QString( "Pixel %1, %2 of %3 differs" ).arg( x ).arg( y ).arg( fileName ) ) );
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    removeDirectory( targetDir );
+}
+
+}
+
+QTEST_MAIN( Marble::TileCreatorTest )
+
+#include "TileCreatorTest.moc"
@@ -0,0 +1,213 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "TrackJournal.h"
+
+namespace Marble
+{
+
+class TrackJournalTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void init();
+    void cleanup();
+
+    void append();
+    void restoreCrashed();
+    void keepRunning();
+    void clear();
+    void tail();
+    void writeGpx();
+
+ private:
+    static void appendPoints( TrackJournal &journal, int count, qreal longitude );
+
+    QString filePath( const QString &fileName ) const;
+
+    QString m_directory;
+};
+
+void TrackJournalTest::appendPoints( TrackJournal &journal, int count, qreal longitude )
+{
+    journal.beginSegment();
+    for ( int i = 0; i < count; ++i ) {
+        const GeoDataCoordinates position( longitude, i, 100.0 * i, GeoDataCoordinates::Degree );
+        journal.append( position, QDateTime::fromMSecsSinceEpoch( 1000 * i + 42 ).toUTC() );
+    }
+}
+
+QString TrackJournalTest::filePath( const QString &fileName ) const
+{
+    return m_directory + '/' + fileName;
+}
+
+void TrackJournalTest::init()
+{
+    m_directory = QDir::tempPath() + QString( "/marble-trackjournal-%1" ).arg( QCoreApplication::applicationPid() );
+}
+
+void TrackJournalTest::cleanup()
+{
+    QDir directory( m_directory );
+    foreach ( const QString &name, directory.entryList( QDir::Files ) ) {
+        directory.remove( name );
+    }
+    QDir().rmdir( m_directory );
+}
+
+void TrackJournalTest::append()
+{
+    TrackJournal journal( m_directory );
+    QVERIFY( journal.open() );
+    QVERIFY( !journal.hasPoints() );
+    QVERIFY( journal.fileName().contains( QString::number( QCoreApplication::applicationPid() ) ) );
+
+    appendPoints( journal, 3, 10.0 );
+    appendPoints( journal, 2, 20.0 );
+    QVERIFY( journal.hasPoints() );
+
+    const QVector<TrackJournal::Segment> segments = journal.segments();
+    QCOMPARE( segments.size(), 2 );
+    QCOMPARE( segments.at( 0 ).size(), 3 );
+    QCOMPARE( segments.at( 1 ).size(), 2 );
+
+    const TrackJournal::Point &point = segments.at( 0 ).at( 2 );
+    QCOMPARE( point.coordinates.longitude( GeoDataCoordinates::Degree ), 10.0 );
+    QCOMPARE( point.coordinates.latitude( GeoDataCoordinates::Degree ), 2.0 );
+    QCOMPARE( point.coordinates.altitude(), 200.0 );
+    QCOMPARE( point.timestamp, QDateTime::fromMSecsSinceEpoch( 2042 ).toUTC() );
+
+    journal.remove();
+    QVERIFY( !QFile::exists( journal.fileName() ) );
+    QVERIFY( !QFile::exists( journal.fileName() + ".lock" ) );
+}
+
+void TrackJournalTest::restoreCrashed()
+{
+    {
+        // Leaving the journal without removing it is what a crash does
+        TrackJournal crashed( m_directory, "journal-1.txt" );
+        QVERIFY( crashed.open() );
+        appendPoints( crashed, 3, 10.0 );
+        crashed.flush();
+    }
+
+    // The crash interrupted the last line
+    QFile file( filePath( "journal-1.txt" ) );
+    QVERIFY( file.open( QIODevice::Append ) );
+    file.write( "P 5042 10.0" );
+    file.close();
+
+    TrackJournal journal( m_directory, "journal-2.txt" );
+    QVERIFY( journal.open() );
+    QVERIFY( journal.hasPoints() );
+    QVERIFY( !QFile::exists( filePath( "journal-1.txt" ) ) );
+    QVERIFY( !QFile::exists( filePath( "journal-1.txt.lock" ) ) );
+
+    appendPoints( journal, 2, 20.0 );
+    const QVector<TrackJournal::Segment> segments = journal.segments();
+    QCOMPARE( segments.size(), 2 );
+    QCOMPARE( segments.at( 0 ).size(), 3 );
+    QCOMPARE( segments.at( 0 ).at( 0 ).coordinates.longitude( GeoDataCoordinates::Degree ), 10.0 );
+    QCOMPARE( segments.at( 1 ).size(), 2 );
+    QCOMPARE( segments.at( 1 ).at( 0 ).coordinates.longitude( GeoDataCoordinates::Degree ), 20.0 );
+
+    journal.remove();
+}
+
+void TrackJournalTest::keepRunning()
+{
+    TrackJournal running( m_directory, "journal-1.txt" );
+    QVERIFY( running.open() );
+    appendPoints( running, 3, 10.0 );
+    running.flush();
+
+    TrackJournal journal( m_directory, "journal-2.txt" );
+    QVERIFY( journal.open() );
+    QVERIFY( !journal.hasPoints() );
+    QVERIFY( journal.segments().isEmpty() );
+
+    QCOMPARE( running.segments().size(), 1 );
+    QCOMPARE( running.segments().first().size(), 3 );
+
+    // Removing one journal leaves the other one alone
+    journal.remove();
+    QVERIFY( QFile::exists( running.fileName() ) );
+    QVERIFY( QFile::exists( running.fileName() + ".lock" ) );
+    running.remove();
+}
+
+void TrackJournalTest::clear()
+{
+    TrackJournal journal( m_directory );
+    QVERIFY( journal.open() );
+    appendPoints( journal, 3, 10.0 );
+
+    journal.clear();
+    QVERIFY( !journal.hasPoints() );
+    QVERIFY( journal.segments().isEmpty() );
+
+    appendPoints( journal, 2, 20.0 );
+    QCOMPARE( journal.segments().size(), 1 );
+    QCOMPARE( journal.segments().first().size(), 2 );
+
+    journal.remove();
+}
+
+void TrackJournalTest::tail()
+{
+    TrackJournal journal( m_directory );
+    QVERIFY( journal.open() );
+    appendPoints( journal, 3, 10.0 );
+    appendPoints( journal, 2, 20.0 );
+    appendPoints( journal, 4, 30.0 );
+    const QVector<TrackJournal::Segment> segments = journal.segments();
+    journal.remove();
+
+    QCOMPARE( TrackJournal::tail( segments, 100 ).size(), 3 );
+    QVERIFY( TrackJournal::tail( segments, 0 ).isEmpty() );
+
+    const QVector<TrackJournal::Segment> last = TrackJournal::tail( segments, 5 );
+    QCOMPARE( last.size(), 2 );
+    QCOMPARE( last.at( 0 ).size(), 1 );
+    QCOMPARE( last.at( 0 ).first().coordinates.longitude( GeoDataCoordinates::Degree ), 20.0 );
+    QCOMPARE( last.at( 0 ).first().coordinates.latitude( GeoDataCoordinates::Degree ), 1.0 );
+    QCOMPARE( last.at( 1 ).size(), 4 );
+    QCOMPARE( last.at( 1 ).last().coordinates.latitude( GeoDataCoordinates::Degree ), 3.0 );
+}
+
+void TrackJournalTest::writeGpx()
+{
+    TrackJournal journal( m_directory );
+    QVERIFY( journal.open() );
+    appendPoints( journal, 3, 10.0 );
+    appendPoints( journal, 2, 20.0 );
+
+    QByteArray data;
+    QBuffer buffer( &data );
+    buffer.open( QIODevice::WriteOnly );
+    QVERIFY( journal.writeGpx( &buffer, "Track" ) );
+    QCOMPARE( data.count( "<trkseg>" ), 2 );
+    QCOMPARE( data.count( "<trkpt " ), 5 );
+
+    QBuffer readOnly( &data );
+    readOnly.open( QIODevice::ReadOnly );
+    QVERIFY( !journal.writeGpx( &readOnly, "Track" ) );
+
+    journal.remove();
+}
+
+}
+
+QTEST_MAIN( Marble::TrackJournalTest )
+
+#include "TrackJournalTest.moc"
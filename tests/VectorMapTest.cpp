@@ -0,0 +1,201 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+
+#include "global.h"
+#include "GeoPolygon.h"
+#include "MarbleDirs.h"
+#include "VectorMap.h"
+#include "ViewportParams.h"
+
+Q_DECLARE_METATYPE( Marble::Projection )
+
+namespace Marble
+{
+
+class VectorMapTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void compareWithUncached_data();
+    void compareWithUncached();
+
+    void deletedPntMap();
+
+    void benchmarkPanning_data();
+    void benchmarkPanning();
+
+ private:
+    static void addProjections();
+
+    /**
+     * Loads @p fileName into @p pntmap and waits for the loader thread.
+     */
+    static bool load( PntMap *pntmap, const QString &fileName );
+
+    static void createFromPntMap( VectorMap &vectorMap, const PntMap *pntmap,
+                                  const ViewportParams &viewport );
+
+    PntMap *m_coastLines;
+};
+
+bool VectorMapTest::load( PntMap *pntmap, const QString &fileName )
+{
+    QEventLoop loop;
+    connect( pntmap, SIGNAL( initialized() ), &loop, SLOT( quit() ) );
+    QTimer::singleShot( 30000, &loop, SLOT( quit() ) );
+    pntmap->load( MarbleDirs::path( fileName ) );
+    loop.exec();
+
+    return pntmap->isInitialized();
+}
+
+void VectorMapTest::createFromPntMap( VectorMap &vectorMap, const PntMap *pntmap,
+                                      const ViewportParams &viewport )
+{
+    // The same limits as VectorComposer uses for the coast lines
+    vectorMap.setzBoundingBoxLimit( 0.4 );
+    vectorMap.setzPointLimit( 0 );
+    vectorMap.createFromPntMap( pntmap, &viewport );
+}
+
+void VectorMapTest::initTestCase()
+{
+    m_coastLines = new PntMap;
+    QVERIFY( load( m_coastLines, "mwdbii/PCOAST.PNT" ) );
+    QVERIFY( m_coastLines->size() > 0 );
+}
+
+void VectorMapTest::cleanupTestCase()
+{
+    delete m_coastLines;
+}
+
+void VectorMapTest::addProjections()
+{
+    QTest::addColumn<Marble::Projection>( "projection" );
+
+    QTest::newRow( "Spherical" ) << Spherical;
+    QTest::newRow( "Equirectangular" ) << Equirectangular;
+    QTest::newRow( "Mercator" ) << Mercator;
+}
+
+void VectorMapTest::compareWithUncached_data()
+{
+    addProjections();
+}
+
+void VectorMapTest::compareWithUncached()
+{
+    QFETCH( Marble::Projection, projection );
+
+    VectorMap cached;
+    VectorMap uncached;
+    uncached.setCacheEnabled( false );
+
+    ViewportParams viewport;
+    viewport.setProjection( projection );
+    viewport.setSize( QSize( 800, 600 ) );
+
+    // Pan across the dateline at two zoom levels, so that the cached
+    // polygons get translated as well as projected anew.
+    for ( int radius = 250; radius <= 2000; radius *= 8 ) {
+        viewport.setRadius( radius );
+        for ( int i = 0; i < 40; ++i ) {
+            viewport.centerOn( ( 160.0 + 1.5 * i ) * DEG2RAD, ( 50.0 - 2.0 * i ) * DEG2RAD );
+            createFromPntMap( cached, m_coastLines, viewport );
+            createFromPntMap( uncached, m_coastLines, viewport );
+
+            const ScreenPolygon::Vector &expected = uncached.polygons();
+            const ScreenPolygon::Vector &actual = cached.polygons();
+            QCOMPARE( actual.size(), expected.size() );
+            for ( int j = 0; j < expected.size(); ++j ) {
+                QCOMPARE( actual.at( j ).closed(), expected.at( j ).closed() );
+                QCOMPARE( actual.at( j ).size(), expected.at( j ).size() );
+                for ( int k = 0; k < expected.at( j ).size(); ++k ) {
+                    const QPointF delta = actual.at( j ).at( k ) - expected.at( j ).at( k );
+                    QVERIFY( qAbs( delta.x() ) < 0.01 && qAbs( delta.y() ) < 0.01 );
+                }
+            }
+        }
+    }
+}
+
+void VectorMapTest::deletedPntMap()
+{
+    ViewportParams viewport;
+    viewport.setProjection( Equirectangular );
+    viewport.setSize( QSize( 800, 600 ) );
+    viewport.setRadius( 250 );
+
+    VectorMap vectorMap;
+    createFromPntMap( vectorMap, m_coastLines, viewport );
+    QVERIFY( vectorMap.polygons().size() > 0 );
+
+    // A new PntMap may get the address of a deleted one, whose cache must
+    // not be reused then.
+    PntMap *lakes = new PntMap;
+    QVERIFY( load( lakes, "mwdbii/PLAKE.PNT" ) );
+    createFromPntMap( vectorMap, lakes, viewport );
+    delete lakes;
+
+    PntMap *glaciers = new PntMap;
+    QVERIFY( load( glaciers, "mwdbii/PGLACIER.PNT" ) );
+    createFromPntMap( vectorMap, glaciers, viewport );
+
+    VectorMap uncached;
+    uncached.setCacheEnabled( false );
+    createFromPntMap( uncached, glaciers, viewport );
+    QCOMPARE( vectorMap.polygons().size(), uncached.polygons().size() );
+    delete glaciers;
+}
+
+void VectorMapTest::benchmarkPanning_data()
+{
+    QTest::addColumn<Marble::Projection>( "projection" );
+    QTest::addColumn<bool>( "cacheEnabled" );
+
+    QTest::newRow( "Spherical" ) << Spherical << true;
+    QTest::newRow( "Spherical, uncached" ) << Spherical << false;
+    QTest::newRow( "Equirectangular" ) << Equirectangular << true;
+    QTest::newRow( "Equirectangular, uncached" ) << Equirectangular << false;
+    QTest::newRow( "Mercator" ) << Mercator << true;
+    QTest::newRow( "Mercator, uncached" ) << Mercator << false;
+}
+
+void VectorMapTest::benchmarkPanning()
+{
+    QFETCH( Marble::Projection, projection );
+    QFETCH( bool, cacheEnabled );
+
+    ViewportParams viewport;
+    viewport.setProjection( projection );
+    viewport.setSize( QSize( 800, 600 ) );
+    viewport.setRadius( 2000 );
+
+    VectorMap vectorMap;
+    vectorMap.setCacheEnabled( cacheEnabled );
+
+    QBENCHMARK {
+        for ( int i = 0; i < 20; ++i ) {
+            viewport.centerOn( ( 10.0 + 0.2 * i ) * DEG2RAD, ( 50.0 - 0.1 * i ) * DEG2RAD );
+            createFromPntMap( vectorMap, m_coastLines, viewport );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::VectorMapTest )
+
+#include "VectorMapTest.moc"
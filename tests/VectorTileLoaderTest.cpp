@@ -0,0 +1,414 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include <QtTest/QtTest>
+#include <QtTest/QSignalSpy>
+#include <QtCore/qmath.h>
+
+#include <cstring>
+
+#include "GeoDataDocument.h"
+#include "GeoDataFolder.h"
+#include "GeoDataLatLonBox.h"
+#include "GeoDataLinearRing.h"
+#include "GeoDataLineString.h"
+#include "GeoDataLineStyle.h"
+#include "GeoDataPlacemark.h"
+#include "GeoDataPolygon.h"
+#include "GeoDataStyle.h"
+#include "GeoDataTreeModel.h"
+#include "GeoDataTypes.h"
+#include "VectorTileCreator.h"
+#include "VectorTileLoader.h"
+
+namespace Marble
+{
+
+class VectorTileLoaderTest : public QObject
+{
+    Q_OBJECT
+
+ private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sourceUntouched();
+    void open();
+    void levels();
+    void coverage();
+    void pan_data();
+    void pan();
+    void panByOneTile();
+    void close();
+
+    void benchmarkPan();
+
+ private:
+    enum { MaximumLevel = 8 };
+
+    // Radius of a globe that shows the highest level
+    enum { Radius = 20000 };
+
+    typedef QPair<quint64, quint64> Key;
+
+    static Key key( const GeoDataCoordinates &coordinates );
+
+    /**
+     * The coordinates of all placemarks of @p container and its folders.
+     */
+    static QVector<GeoDataCoordinates> coordinates( const GeoDataContainer *container );
+
+    static void removeDirectory( const QString &path );
+
+    GeoDataDocument *m_document;
+    QString m_directory;
+};
+
+VectorTileLoaderTest::Key VectorTileLoaderTest::key( const GeoDataCoordinates &coordinates )
+{
+    const double lon = coordinates.longitude();
+    const double lat = coordinates.latitude();
+    Key result;
+    memcpy( &result.first, &lon, sizeof( lon ) );
+    memcpy( &result.second, &lat, sizeof( lat ) );
+    return result;
+}
+
+QVector<GeoDataCoordinates> VectorTileLoaderTest::coordinates( const GeoDataContainer *container )
+{
+    QVector<GeoDataCoordinates> result;
+    foreach ( const GeoDataFeature *feature, container->featureList() ) {
+        if ( feature->nodeType() == GeoDataTypes::GeoDataFolderType ) {
+            result += coordinates( static_cast<const GeoDataContainer*>( feature ) );
+            continue;
+        }
+
+        const GeoDataGeometry *geometry = static_cast<const GeoDataPlacemark*>( feature )->geometry();
+        QVector<const GeoDataLineString*> lines;
+        if ( geometry->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+            const GeoDataPolygon *polygon = static_cast<const GeoDataPolygon*>( geometry );
+            lines.append( &polygon->outerBoundary() );
+            for ( int i = 0; i < polygon->innerBoundaries().size(); ++i ) {
+                lines.append( &polygon->innerBoundaries().at( i ) );
+            }
+        }
+        else {
+            lines.append( static_cast<const GeoDataLineString*>( geometry ) );
+        }
+
+        foreach ( const GeoDataLineString *line, lines ) {
+            for ( int i = 0; i < line->size(); ++i ) {
+                result.append( line->at( i ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+void VectorTileLoaderTest::removeDirectory( const QString &path )
+{
+    QDir directory( path );
+    foreach ( const QFileInfo &info, directory.entryInfoList( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot ) ) {
+        if ( info.isDir() ) {
+            removeDirectory( info.filePath() );
+        }
+        else {
+            QFile::remove( info.filePath() );
+        }
+    }
+    directory.rmdir( path );
+}
+
+void VectorTileLoaderTest::initTestCase()
+{
+    qsrand( 42 );
+    m_document = new GeoDataDocument;
+
+    // Roads wandering around a region of ten by ten degrees
+    for ( int i = 0; i < 400; ++i ) {
+        qreal lon = 5.0 + 10.0 * qrand() / RAND_MAX;
+        qreal lat = 45.0 + 10.0 * qrand() / RAND_MAX;
+        GeoDataLineString *road = new GeoDataLineString;
+        for ( int j = 0; j < 1000; ++j ) {
+            lon = qBound( qreal( 5.0 ), lon + 0.02 * qrand() / RAND_MAX - 0.01, qreal( 15.0 ) );
+            lat = qBound( qreal( 45.0 ), lat + 0.02 * qrand() / RAND_MAX - 0.01, qreal( 55.0 ) );
+            road->append( GeoDataCoordinates( lon, lat, 0.0, GeoDataCoordinates::Degree ) );
+        }
+
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemark->setName( QString( "Road %1" ).arg( i ) );
+        placemark->setVisualCategory( GeoDataFeature::HighwayPrimary );
+        placemark->setGeometry( road );
+        m_document->append( placemark );
+    }
+
+    // Boundaries of some large and many small regions
+    for ( int i = 0; i < 120; ++i ) {
+        const qreal radius = i < 20 ? 1.5 : 0.05;
+        const int points = i < 20 ? 360 : 24;
+        const qreal lon = 6.5 + 7.0 * qrand() / RAND_MAX;
+        const qreal lat = 46.5 + 7.0 * qrand() / RAND_MAX;
+        GeoDataLinearRing boundary;
+        for ( int j = 0; j < points; ++j ) {
+            const qreal angle = 2 * M_PI * j / points;
+            boundary.append( GeoDataCoordinates( lon + radius * qCos( angle ), lat + radius * qSin( angle ),
+                                                 0.0, GeoDataCoordinates::Degree ) );
+        }
+
+        GeoDataPolygon *polygon = new GeoDataPolygon;
+        polygon->setOuterBoundary( boundary );
+        GeoDataPlacemark *placemark = new GeoDataPlacemark;
+        placemark->setName( QString( "Region %1" ).arg( i ) );
+        placemark->setGeometry( polygon );
+        m_document->append( placemark );
+    }
+
+    m_directory = QDir::tempPath() + QString( "/marble-vectortiles-%1" ).arg( QCoreApplication::applicationPid() );
+    removeDirectory( m_directory );
+
+    QTime timer;
+    timer.start();
+    VectorTileCreator creator( m_document );
+    creator.setMaximumLevel( MaximumLevel );
+    QVERIFY2( creator.create( m_directory ), qPrintable( creator.errorString() ) );
+    qDebug() << "Created vector tiles of" << coordinates( m_document ).size() << "points in" << timer.elapsed() << "ms";
+
+    QVERIFY( QFile::exists( VectorTileCreator::indexFileName( m_directory ) ) );
+    QVERIFY( QFile::exists( VectorTileCreator::tileFileName( m_directory, 0, 0, 0 ) ) );
+}
+
+void VectorTileLoaderTest::cleanupTestCase()
+{
+    removeDirectory( m_directory );
+    delete m_document;
+}
+
+void VectorTileLoaderTest::sourceUntouched()
+{
+    // Creating the tiles leaves the geometries with their placemarks
+    foreach ( GeoDataPlacemark *placemark, m_document->placemarkList() ) {
+        QCOMPARE( placemark->geometry()->parent(), static_cast<GeoDataObject*>( placemark ) );
+    }
+
+    // The pieces keep the fields of their placemarks
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+    loader.setViewport( GeoDataLatLonBox( 90, -90, 180, -180, GeoDataCoordinates::Degree ), 50 );
+    QCOMPARE( loader.document()->size(), 1 );
+    const GeoDataContainer *tile = static_cast<const GeoDataContainer*>( loader.document()->child( 0 ) );
+    QVERIFY( !tile->placemarkList().isEmpty() );
+    foreach ( const GeoDataPlacemark *placemark, tile->placemarkList() ) {
+        QVERIFY( placemark->name().startsWith( "Road " ) || placemark->name().startsWith( "Region " ) );
+    }
+}
+
+void VectorTileLoaderTest::open()
+{
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( !loader.open( m_directory + "/missing" ) );
+    QVERIFY( !loader.isOpen() );
+    QCOMPARE( model.rootDocument()->size(), 0 );
+
+    QVERIFY( loader.open( m_directory ) );
+    QVERIFY( loader.isOpen() );
+    QCOMPARE( loader.maximumLevel(), int( MaximumLevel ) );
+    QCOMPARE( model.rootDocument()->size(), 1 );
+    QCOMPARE( loader.document()->size(), 0 );
+}
+
+void VectorTileLoaderTest::levels()
+{
+    QCOMPARE( VectorTileLoader::levelForRadius( 50 ), 0 );
+    QVERIFY( VectorTileLoader::levelForRadius( Radius ) > MaximumLevel );
+
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+
+    // The whole world at the lowest level, the small regions are left out
+    loader.setViewport( GeoDataLatLonBox( 90, -90, 180, -180, GeoDataCoordinates::Degree ), 50 );
+    QCOMPARE( loader.level(), 0 );
+    QCOMPARE( loader.document()->size(), 1 );
+    const GeoDataContainer *tile = static_cast<const GeoDataContainer*>( loader.document()->child( 0 ) );
+    int polygons = 0;
+    foreach ( const GeoDataPlacemark *placemark, tile->placemarkList() ) {
+        if ( placemark->geometry()->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+            ++polygons;
+        }
+        else {
+            QCOMPARE( placemark->visualCategory(), GeoDataFeature::HighwayPrimary );
+            QCOMPARE( placemark->style()->lineStyle().color(),
+                      m_document->placemarkList().first()->style()->lineStyle().color() );
+        }
+    }
+    QCOMPARE( polygons, 20 );
+    QVERIFY( coordinates( loader.document() ).size() < coordinates( m_document ).size() / 20 );
+
+    // Polygons larger than a tile are shown as outlines at the highest level
+    loader.setViewport( GeoDataLatLonBox( 51, 49, 11, 9, GeoDataCoordinates::Degree ), Radius );
+    QCOMPARE( loader.level(), int( MaximumLevel ) );
+    QVERIFY( loader.document()->size() > 1 );
+    foreach ( const GeoDataFeature *feature, loader.document()->featureList() ) {
+        foreach ( const GeoDataPlacemark *placemark, static_cast<const GeoDataContainer*>( feature )->placemarkList() ) {
+            if ( placemark->geometry()->nodeType() == GeoDataTypes::GeoDataPolygonType ) {
+                const GeoDataLatLonBox box = placemark->geometry()->latLonAltBox();
+                QVERIFY( box.width( GeoDataCoordinates::Degree ) <= 360.0 / ( 1 << MaximumLevel ) );
+            }
+        }
+    }
+}
+
+void VectorTileLoaderTest::coverage()
+{
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+
+    const GeoDataLatLonBox box( 51, 49, 11, 9, GeoDataCoordinates::Degree );
+    loader.setViewport( box, Radius );
+
+    QSet<Key> loaded;
+    foreach ( const GeoDataCoordinates &point, coordinates( loader.document() ) ) {
+        loaded.insert( key( point ) );
+    }
+
+    // The highest level is not simplified, all points in view are there
+    int inside = 0;
+    foreach ( const GeoDataCoordinates &point, coordinates( m_document ) ) {
+        if ( box.contains( point ) ) {
+            ++inside;
+            QVERIFY( loaded.contains( key( point ) ) );
+        }
+    }
+    QVERIFY( inside > 10000 );
+}
+
+void VectorTileLoaderTest::pan_data()
+{
+    QTest::addColumn<qint64>( "memoryLimit" );
+
+    QTest::newRow( "cache" ) << qint64( 32 * 1024 * 1024 );
+    QTest::newRow( "viewport" ) << qint64( 8 * 1024 * 1024 );
+    QTest::newRow( "less than the viewport" ) << qint64( 2 * 1024 * 1024 );
+}
+
+void VectorTileLoaderTest::pan()
+{
+    QFETCH( qint64, memoryLimit );
+
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    loader.setMemoryLimit( memoryLimit );
+    QVERIFY( loader.open( m_directory ) );
+
+    // From the west to the east of the data and back
+    int maximumTiles = 0;
+    for ( int step = 0; step <= 96; ++step ) {
+        const qreal west = step <= 48 ? 3.0 + step * 0.25 : 27.0 - step * 0.25;
+        const GeoDataLatLonBox box( 51, 49, west + 2.0, west, GeoDataCoordinates::Degree );
+        loader.setViewport( box, Radius );
+
+        QVERIFY( loader.memoryUsage() <= memoryLimit );
+        QVERIFY( loader.document()->size() <= loader.tileCount() );
+        if ( west > 6.0 && west < 12.0 ) {
+            QVERIFY( loader.document()->size() > 0 );
+        }
+        maximumTiles = qMax( maximumTiles, loader.tileCount() );
+    }
+    qDebug() << "Loaded at most" << maximumTiles << "tiles," << loader.memoryUsage() << "bytes at the end";
+
+    loader.setMemoryLimit( 0 );
+    QCOMPARE( loader.tileCount(), loader.document()->size() );
+}
+
+void VectorTileLoaderTest::panByOneTile()
+{
+    qRegisterMetaType<QModelIndex>( "QModelIndex" );
+
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+    loader.setViewport( GeoDataLatLonBox( 51, 49, 11, 9, GeoDataCoordinates::Degree ), Radius );
+    const QVector<GeoDataFeature*> before = loader.document()->featureList();
+    QVERIFY( before.size() > 0 );
+
+    QSignalSpy insertedSpy( &model, SIGNAL( rowsInserted( QModelIndex, int, int ) ) );
+    QSignalSpy removedSpy( &model, SIGNAL( rowsRemoved( QModelIndex, int, int ) ) );
+
+    // The document stays, only the tiles that enter or leave the view change
+    const qreal tileWidth = 360.0 / ( 1 << MaximumLevel );
+    loader.setViewport( GeoDataLatLonBox( 51, 49, 11 + tileWidth, 9 + tileWidth, GeoDataCoordinates::Degree ), Radius );
+    QCOMPARE( model.rootDocument()->size(), 1 );
+    const QModelIndex documentIndex = model.index( loader.document() );
+
+    int kept = 0;
+    foreach ( GeoDataFeature *folder, before ) {
+        if ( loader.document()->childPosition( folder ) >= 0 ) {
+            ++kept;
+        }
+    }
+    QVERIFY( kept > 0 && kept < before.size() );
+
+    int removed = 0;
+    for ( int i = 0; i < removedSpy.count(); ++i ) {
+        QCOMPARE( qvariant_cast<QModelIndex>( removedSpy.at( i ).at( 0 ) ), documentIndex );
+        removed += removedSpy.at( i ).at( 2 ).toInt() - removedSpy.at( i ).at( 1 ).toInt() + 1;
+    }
+    QCOMPARE( removed, before.size() - kept );
+
+    QVERIFY( insertedSpy.count() <= 1 );
+    int inserted = 0;
+    if ( insertedSpy.count() == 1 ) {
+        QCOMPARE( qvariant_cast<QModelIndex>( insertedSpy.first().at( 0 ) ), documentIndex );
+        inserted = insertedSpy.first().at( 2 ).toInt() - insertedSpy.first().at( 1 ).toInt() + 1;
+    }
+    QCOMPARE( inserted, loader.document()->size() - kept );
+}
+
+void VectorTileLoaderTest::close()
+{
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+    loader.setViewport( GeoDataLatLonBox( 51, 49, 11, 9, GeoDataCoordinates::Degree ), Radius );
+    QVERIFY( loader.tileCount() > 0 );
+    QVERIFY( loader.memoryUsage() > 0 );
+
+    loader.close();
+    QVERIFY( !loader.isOpen() );
+    QCOMPARE( loader.tileCount(), 0 );
+    QCOMPARE( loader.memoryUsage(), qint64( 0 ) );
+    QCOMPARE( model.rootDocument()->size(), 0 );
+
+    // Without tiles, viewport changes are ignored
+    loader.setViewport( GeoDataLatLonBox( 51, 49, 11, 9, GeoDataCoordinates::Degree ), Radius );
+    QCOMPARE( model.rootDocument()->size(), 0 );
+}
+
+void VectorTileLoaderTest::benchmarkPan()
+{
+    GeoDataTreeModel model;
+    VectorTileLoader loader( &model );
+    QVERIFY( loader.open( m_directory ) );
+
+    QBENCHMARK {
+        for ( int step = 0; step <= 48; ++step ) {
+            const qreal west = 3.0 + step * 0.25;
+            loader.setViewport( GeoDataLatLonBox( 51, 49, west + 2.0, west, GeoDataCoordinates::Degree ), Radius );
+        }
+    }
+}
+
+}
+
+QTEST_MAIN( Marble::VectorTileLoaderTest )
+
+#include "VectorTileLoaderTest.moc"
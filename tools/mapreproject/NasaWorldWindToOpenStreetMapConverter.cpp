@@ -1,5 +1,6 @@
 #include "NasaWorldWindToOpenStreetMapConverter.h"
 
+#include "NwwTileCache.h"
 #include "OsmTileClusterRenderer.h"
 #include "Thread.h"
 
@@ -15,11 +16,13 @@ NasaWorldWindToOpenStreetMapConverter::NasaWorldWindToOpenStreetMapConverter( QO
       m_threadCount(),
       m_nwwTileLevel(),
       m_nwwInterpolationMethod(),
+      m_nwwTileCacheSize( 512 ),
       m_osmTileLevel(),
       m_osmTileClusterEdgeLengthTiles(),
       m_osmMapEdgeLengthClusters(),
       m_nextClusterX(),
-      m_nextClusterY()
+      m_nextClusterY(),
+      m_renderedClusters()
 {
 }
 
@@ -38,6 +41,11 @@ void NasaWorldWindToOpenStreetMapConverter::setNwwTileLevel( int const level )
     m_nwwTileLevel = level;
 }
 
+void NasaWorldWindToOpenStreetMapConverter::setNwwTileCacheSize( int const megabytes )
+{
+    m_nwwTileCacheSize = megabytes;
+}
+
 void NasaWorldWindToOpenStreetMapConverter::setOsmBaseDirectory( QDir const & osmBaseDirectory )
 {
     if ( !osmBaseDirectory.exists() ) {
@@ -73,6 +81,12 @@ QVector<QPair<Thread*, OsmTileClusterRenderer*> > NasaWorldWindToOpenStreetMapCo
     if ( osmMapEdgeLengthTiles % m_osmTileClusterEdgeLengthTiles != 0 )
         qFatal("Bad tile cluster size");
 
+    // all renderers share the decoded Nww tiles, neighboring clusters need
+    // many of the same tiles
+    m_nwwTileCache = QSharedPointer<NwwTileCache>( new NwwTileCache( m_nwwBaseDirectory, m_nwwTileCacheSize ));
+    m_renderedClusters = 0;
+    m_renderTime.start();
+
     QVector<QPair<Thread*, OsmTileClusterRenderer*> > renderThreads;
 
     for ( int i = 0; i < m_threadCount; ++i ) {
@@ -80,6 +94,7 @@ QVector<QPair<Thread*, OsmTileClusterRenderer*> > NasaWorldWindToOpenStreetMapCo
         renderer->setObjectName( QString("Renderer %1").arg( i ));
         renderer->setClusterEdgeLengthTiles( m_osmTileClusterEdgeLengthTiles );
         renderer->setNwwBaseDirectory( m_nwwBaseDirectory );
+        renderer->setNwwTileCache( m_nwwTileCache );
         renderer->setNwwInterpolationMethod( m_nwwInterpolationMethod );
         renderer->setNwwTileLevel( m_nwwTileLevel );
         renderer->setOsmBaseDirectory( m_osmBaseDirectory );
@@ -128,6 +143,9 @@ void NasaWorldWindToOpenStreetMapConverter::testReprojection()
 
 void NasaWorldWindToOpenStreetMapConverter::assignNextCluster( OsmTileClusterRenderer * renderer )
 {
+    ++m_renderedClusters;
+    reportProgress();
+
     if ( m_nextClusterX == m_osmMapEdgeLengthClusters || m_nextClusterY == m_osmMapEdgeLengthClusters )
         return;
 
@@ -136,6 +154,23 @@ void NasaWorldWindToOpenStreetMapConverter::assignNextCluster( OsmTileClusterRen
     incNextCluster();
 }
 
+void NasaWorldWindToOpenStreetMapConverter::reportProgress()
+{
+    int const totalClusters = m_osmMapEdgeLengthClusters * m_osmMapEdgeLengthClusters;
+    int const renderedTiles = m_renderedClusters * m_osmTileClusterEdgeLengthTiles * m_osmTileClusterEdgeLengthTiles;
+    double const seconds = qMax( 1, m_renderTime.elapsed() ) / 1000.0;
+    int const decodedTiles = m_nwwTileCache->decodedTiles();
+    int const requests = decodedTiles + m_nwwTileCache->hits();
+
+    qDebug() << QString( "Level %1: %2 of %3 clusters (%4%), %5 tiles/s, %6 Nww tiles decoded, %7% cache hits" )
+                .arg( m_osmTileLevel )
+                .arg( m_renderedClusters ).arg( totalClusters )
+                .arg( 100 * m_renderedClusters / qMax( 1, totalClusters ))
+                .arg( renderedTiles / seconds, 0, 'f', 1 )
+                .arg( decodedTiles )
+                .arg( requests > 0 ? 100.0 * m_nwwTileCache->hits() / requests : 0.0, 0, 'f', 1 );
+}
+
 void NasaWorldWindToOpenStreetMapConverter::checkAndCreateLevelDirectory() const
 {
     QDir const levelDirectory( m_osmBaseDirectory.path() + QString("/%1").arg( m_osmTileLevel ));
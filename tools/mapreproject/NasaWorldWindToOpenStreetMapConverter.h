@@ -6,8 +6,11 @@
 #include <QtCore/QDir>
 #include <QtCore/QObject>
 #include <QtCore/QPair>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QTime>
 #include <QtCore/QVector>
 
+class NwwTileCache;
 class OsmTileClusterRenderer;
 class Thread;
 
@@ -28,6 +31,7 @@ public:
     void setNwwBaseDirectory( QDir const & osmBaseDirectory );
     void setNwwInterpolationMethod( InterpolationMethod const interpolationMethod );
     void setNwwTileLevel( int const level );
+    void setNwwTileCacheSize( int const megabytes );
     void setOsmBaseDirectory( QDir const & nwwBaseDirectory );
     void setOsmTileClusterEdgeLengthTiles( int const clusterEdgeLengthTiles );
     void setOsmTileLevel( int const level );
@@ -46,12 +50,15 @@ public slots:
 private:
     void checkAndCreateLevelDirectory() const;
     void incNextCluster();
+    void reportProgress();
 
     int m_threadCount;
 
     QDir m_nwwBaseDirectory;
     int m_nwwTileLevel;
     InterpolationMethod m_nwwInterpolationMethod;
+    int m_nwwTileCacheSize;
+    QSharedPointer<NwwTileCache> m_nwwTileCache;
 
     QDir m_osmBaseDirectory;
     int m_osmTileLevel;
@@ -60,6 +67,9 @@ private:
     int m_osmMapEdgeLengthClusters;
     int m_nextClusterX;
     int m_nextClusterY;
+
+    int m_renderedClusters;
+    QTime m_renderTime;
 };
 
 #endif
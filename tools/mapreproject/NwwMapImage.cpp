@@ -3,11 +3,64 @@
 #include <QtCore/QDebug>
 #include <cmath>
 
+namespace
+{
+
+// The const overload of scanLine does not detach the image from the copy in
+// the tile cache
+inline QRgb const * line( QImage const & tile, int const row )
+{
+    return reinterpret_cast<QRgb const *>( tile.scanLine( row ));
+}
+
+// Reads the pixels of one row of the map, keeping the tile it read from last
+class RowReader
+{
+public:
+    RowReader( NwwTileCache & cache, int const tileEdgeLengthPixel, int const y, QRgb const emptyPixel )
+        : m_cache( cache ),
+          m_tileEdgeLengthPixel( tileEdgeLengthPixel ),
+          m_tileY( y / tileEdgeLengthPixel ),
+          m_tileRow( tileEdgeLengthPixel - y % tileEdgeLengthPixel - 1 ),
+          m_emptyPixel( emptyPixel ),
+          m_tileX( -1 ),
+          m_line( 0 )
+    {
+    }
+
+    inline QRgb pixel( int const x )
+    {
+        int const tileX = x / m_tileEdgeLengthPixel;
+        if ( tileX != m_tileX ) {
+            m_tileX = tileX;
+            m_tile = m_cache.tile( tileX, m_tileY );
+            m_line = m_tile.isNull() ? 0 : line( m_tile, m_tileRow );
+        }
+        return m_line ? m_line[ x % m_tileEdgeLengthPixel ] : m_emptyPixel;
+    }
+
+private:
+    NwwTileCache & m_cache;
+    int const m_tileEdgeLengthPixel;
+    int const m_tileY;
+    int const m_tileRow;
+    QRgb const m_emptyPixel;
+    int m_tileX;
+    QImage m_tile;
+    QRgb const * m_line;
+};
+
+inline int channel( QRgb const pixel, int const shift )
+{
+    return ( pixel >> shift ) & 0xff;
+}
+
+}
+
 NwwMapImage::NwwMapImage()
     : m_tileEdgeLengthPixel( 512 ),
       m_emptyPixel( qRgba( 0, 0, 0, 255 )),
-      m_interpolationMethod( BilinearInterpolation ),
-      m_tileCache( 100 * 1024 * 1024 ) // 100 MB cache
+      m_interpolationMethod( BilinearInterpolation )
 {
 }
 
@@ -21,7 +74,7 @@ NwwMapImage::NwwMapImage( QDir const & baseDirectory, int const tileLevel )
       m_mapWidthPixel( m_mapWidthTiles * m_tileEdgeLengthPixel ),
       m_mapHeightPixel( m_mapHeightTiles * m_tileEdgeLengthPixel ),
       m_interpolationMethod( BilinearInterpolation ),
-      m_tileCache( 100 * 1024 * 1024 ) // 100 MB cache
+      m_tileCache( new NwwTileCache( baseDirectory ))
 {
     if ( !m_baseDirectory.exists() )
         qFatal("Base directory does not exist.");
@@ -50,25 +103,38 @@ QRgb NwwMapImage::pixel( double const lonRad, double const latRad )
 
 QRgb NwwMapImage::pixel( int const x, int const y )
 {
-    int const tileX = x / m_tileEdgeLengthPixel;
-    int const tileY = y / m_tileEdgeLengthPixel;
-
-    // fast check if tile is missing
-    int const tileKey = tileId( tileX, tileY );
-    if ( m_tileMissing.contains( tileKey ))
+    QImage const tile = m_tileCache->tile( x / m_tileEdgeLengthPixel, y / m_tileEdgeLengthPixel );
+    if ( tile.isNull() )
         return m_emptyPixel;
 
-    QPair<QImage, bool> potentialTile = tile( tileX, tileY );
-    if ( !potentialTile.second )
-        return m_emptyPixel;
-    else
-        return potentialTile.first.pixel( x % m_tileEdgeLengthPixel,
-                                          m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 );
+    return line( tile, m_tileEdgeLengthPixel - y % m_tileEdgeLengthPixel - 1 )[ x % m_tileEdgeLengthPixel ];
+}
+
+void NwwMapImage::pixels( double const * const lonRad, int const count, double const latRad, QRgb * const result )
+{
+    double const y = latRadToPixelY( latRad );
+
+    switch ( m_interpolationMethod ) {
+    case NearestNeighborInterpolation:
+        nearestNeighbor( lonRad, count, y, result );
+        break;
+    case BilinearInterpolation:
+        bilinearInterpolation( lonRad, count, y, result );
+        break;
+    default:
+        nearestNeighbor( lonRad, count, y, result );
+    }
 }
 
 void NwwMapImage::setBaseDirectory( QDir const & baseDirectory )
 {
     m_baseDirectory = baseDirectory;
+    m_tileCache = QSharedPointer<NwwTileCache>( new NwwTileCache( baseDirectory ));
+}
+
+void NwwMapImage::setTileCache( QSharedPointer<NwwTileCache> const & tileCache )
+{
+    m_tileCache = tileCache;
 }
 
 void NwwMapImage::setInterpolationMethod( InterpolationMethod const method )
@@ -85,36 +151,6 @@ void NwwMapImage::setTileLevel( int const tileLevel )
     m_mapHeightPixel = m_mapHeightTiles * m_tileEdgeLengthPixel;
 }
 
-inline int NwwMapImage::tileId( int const tileX, int const tileY )
-{
-    return (tileX << 16) + tileY;
-}
-
-QPair<QImage, bool> NwwMapImage::tile( int const tileX, int const tileY )
-{
-    int const tileKey = tileId( tileX, tileY );
-
-    // first check cache
-    QImage * const cachedTile = m_tileCache.object( tileKey );
-    if ( cachedTile )
-        return QPair<QImage, bool>( *cachedTile, true );
-
-    QString const filename = QString("%1/%2/%2_%3.jpg")
-            .arg( m_baseDirectory.path() )
-            .arg( tileY, 4, 10, QLatin1Char('0'))
-            .arg( tileX, 4, 10, QLatin1Char('0'));
-    QImage tile;
-    bool const loaded = tile.load( filename );
-    if ( !loaded ) {
-        m_tileMissing.insert( tileKey );
-        //qDebug() << "Tile" << filename << "not found";
-    } else {
-        m_tileCache.insert( tileKey, new QImage( tile ), tile.byteCount() );
-        //qDebug() << "Tile" << filename << "loaded and inserted in cache";
-    }
-    return QPair<QImage, bool>( tile, loaded );
-}
-
 inline double NwwMapImage::lonRadToPixelX( double const lonRad ) const
 {
     return static_cast<double>( m_mapWidthPixel ) / ( 2.0 * M_PI ) * lonRad
@@ -185,3 +221,60 @@ QRgb NwwMapImage::bilinearInterpolation( double const x, double const y )
 
     return qRgba( round( red ), round( green ), round( blue ), round( alpha ));
 }
+
+void NwwMapImage::nearestNeighbor( double const * const lonRad, int const count, double const y, QRgb * const result )
+{
+    RowReader row( *m_tileCache, m_tileEdgeLengthPixel, round( y ), m_emptyPixel );
+    for ( int i = 0; i < count; ++i )
+        result[ i ] = row.pixel( round( lonRadToPixelX( lonRad[ i ] )));
+}
+
+void NwwMapImage::bilinearInterpolation( double const * const lonRad, int const count, double const y,
+                                         QRgb * const result )
+{
+    int const y1 = y;
+    double const fractionY = y - y1;
+
+    // separate readers for both columns, the right pixel may lie in the next tile
+    RowReader lowerLeft( *m_tileCache, m_tileEdgeLengthPixel, y1, m_emptyPixel );
+    RowReader lowerRight( *m_tileCache, m_tileEdgeLengthPixel, y1, m_emptyPixel );
+    RowReader upperLeft( *m_tileCache, m_tileEdgeLengthPixel, y1 + 1, m_emptyPixel );
+    RowReader upperRight( *m_tileCache, m_tileEdgeLengthPixel, y1 + 1, m_emptyPixel );
+
+    // The source pixels of a chunk are gathered first, then interpolated in a
+    // loop without branches or function calls which the compiler can vectorize.
+    // The arithmetic is the same as in the single pixel version above.
+    int const chunkSize = 64;
+    double fractionX[ chunkSize ];
+    QRgb lowerLeftPixel[ chunkSize ];
+    QRgb lowerRightPixel[ chunkSize ];
+    QRgb upperLeftPixel[ chunkSize ];
+    QRgb upperRightPixel[ chunkSize ];
+
+    for ( int start = 0; start < count; start += chunkSize ) {
+        int const size = qMin( chunkSize, count - start );
+
+        for ( int i = 0; i < size; ++i ) {
+            double const x = lonRadToPixelX( lonRad[ start + i ] );
+            int const x1 = x;
+            fractionX[ i ] = x - x1;
+            lowerLeftPixel[ i ] = lowerLeft.pixel( x1 );
+            lowerRightPixel[ i ] = lowerRight.pixel( x1 + 1 );
+            upperLeftPixel[ i ] = upperLeft.pixel( x1 );
+            upperRightPixel[ i ] = upperRight.pixel( x1 + 1 );
+        }
+
+        for ( int i = 0; i < size; ++i ) {
+            QRgb pixel = 0;
+            for ( int shift = 0; shift < 32; shift += 8 ) {
+                double const lowerMid = ( 1.0 - fractionX[ i ] ) * channel( lowerLeftPixel[ i ], shift )
+                                        + fractionX[ i ] * channel( lowerRightPixel[ i ], shift );
+                double const upperMid = ( 1.0 - fractionX[ i ] ) * channel( upperLeftPixel[ i ], shift )
+                                        + fractionX[ i ] * channel( upperRightPixel[ i ], shift );
+                double const value = ( 1.0 - fractionY ) * lowerMid + fractionY * upperMid;
+                pixel |= QRgb( value + 0.5 ) << shift;
+            }
+            result[ start + i ] = pixel;
+        }
+    }
+}
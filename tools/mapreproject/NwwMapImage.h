@@ -2,11 +2,10 @@
 #define NWWIMAGE_H
 
 #include "mapreproject.h"
+#include "NwwTileCache.h"
 
-#include <QtCore/QCache>
 #include <QtCore/QDir>
-#include <QtCore/QPair>
-#include <QtCore/QSet>
+#include <QtCore/QSharedPointer>
 #include <QtGui/QColor>
 #include <QtGui/QImage>
 
@@ -18,19 +17,28 @@ public:
 
     QRgb pixel( double const lonRad, double const latRad );
     QRgb pixel( int const x, int const y );
+
+    // samples a span of pixels at the same latitude, which is much faster
+    // than sampling them one by one
+    void pixels( double const * const lonRad, int const count, double const latRad, QRgb * const result );
+
     void setBaseDirectory( QDir const & baseDirectory );
     void setInterpolationMethod( InterpolationMethod const method );
     void setTileLevel( int const level );
 
+    // replaces the cache created by setBaseDirectory, e.g. by one shared
+    // with other threads
+    void setTileCache( QSharedPointer<NwwTileCache> const & tileCache );
+
 private:
-    static int tileId( int const tileX, int const tileY );
-    QPair<QImage, bool> tile( int const tileX, int const tileY );
     double lonRadToPixelX( double const lonRad ) const;
     double latRadToPixelY( double const latRad ) const;
 
     // Interpolation methods
     QRgb nearestNeighbor( double const x, double const y );
     QRgb bilinearInterpolation( double const x, double const y );
+    void nearestNeighbor( double const * const lonRad, int const count, double const y, QRgb * const result );
+    void bilinearInterpolation( double const * const lonRad, int const count, double const y, QRgb * const result );
 
     int const m_tileEdgeLengthPixel;
     QRgb const m_emptyPixel;
@@ -45,8 +53,7 @@ private:
 
     InterpolationMethod m_interpolationMethod;
 
-    QSet<int> m_tileMissing;
-    QCache<int, QImage> m_tileCache;
+    QSharedPointer<NwwTileCache> m_tileCache;
 };
 
 #endif
@@ -0,0 +1,95 @@
+#include "NwwTileCache.h"
+
+#include <QtCore/QMutexLocker>
+
+NwwTileCache::NwwTileCache( QDir const & baseDirectory, int const maxSizeMegabytes )
+    : m_baseDirectory( baseDirectory ),
+      m_tiles( maxSizeMegabytes * 1024 ), // cost in kB
+      m_hits( 0 ),
+      m_decodedTiles( 0 )
+{
+}
+
+void NwwTileCache::setMaxSize( int const megabytes )
+{
+    QMutexLocker locker( &m_mutex );
+    m_tiles.setMaxCost( megabytes * 1024 );
+}
+
+QImage NwwTileCache::tile( int const tileX, int const tileY )
+{
+    int const tileKey = tileId( tileX, tileY );
+
+    QMutexLocker locker( &m_mutex );
+    forever {
+        if ( m_tileMissing.contains( tileKey ))
+            return QImage();
+
+        QImage * const cachedTile = m_tiles.object( tileKey );
+        if ( cachedTile ) {
+            ++m_hits;
+            return *cachedTile;
+        }
+
+        if ( !m_tileLoading.contains( tileKey ))
+            break;
+
+        // another thread decodes the tile right now
+        m_tileLoaded.wait( &m_mutex );
+    }
+
+    m_tileLoading.insert( tileKey );
+    locker.unlock();
+
+    QImage const tile = loadTile( tileX, tileY );
+
+    locker.relock();
+    m_tileLoading.remove( tileKey );
+    if ( tile.isNull() ) {
+        m_tileMissing.insert( tileKey );
+    } else {
+        ++m_decodedTiles;
+        m_tiles.insert( tileKey, new QImage( tile ), tile.byteCount() / 1024 );
+    }
+    m_tileLoaded.wakeAll();
+    return tile;
+}
+
+int NwwTileCache::hits() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_hits;
+}
+
+int NwwTileCache::decodedTiles() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_decodedTiles;
+}
+
+int NwwTileCache::missingTiles() const
+{
+    QMutexLocker locker( &m_mutex );
+    return m_tileMissing.size();
+}
+
+inline int NwwTileCache::tileId( int const tileX, int const tileY )
+{
+    return (tileX << 16) + tileY;
+}
+
+QImage NwwTileCache::loadTile( int const tileX, int const tileY ) const
+{
+    QString const filename = QString("%1/%2/%2_%3.jpg")
+            .arg( m_baseDirectory.path() )
+            .arg( tileY, 4, 10, QLatin1Char('0'))
+            .arg( tileX, 4, 10, QLatin1Char('0'));
+    QImage tile;
+    if ( !tile.load( filename ))
+        return QImage();
+
+    // the renderers read the scan lines directly
+    if ( tile.format() != QImage::Format_RGB32 && tile.format() != QImage::Format_ARGB32 )
+        tile = tile.convertToFormat( QImage::Format_ARGB32 );
+    return tile;
+}
@@ -0,0 +1,47 @@
+#ifndef NWWTILECACHE_H
+#define NWWTILECACHE_H
+
+#include <QtCore/QCache>
+#include <QtCore/QDir>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QWaitCondition>
+#include <QtGui/QImage>
+
+// Decoded NASA WorldWind tiles shared by all render threads. The least
+// recently used tiles are dropped once the cache exceeds its size. A tile
+// requested by several threads at once is decoded only once, the other
+// threads wait for it.
+
+class NwwTileCache
+{
+public:
+    explicit NwwTileCache( QDir const & baseDirectory, int const maxSizeMegabytes = 512 );
+
+    void setMaxSize( int const megabytes );
+
+    // returns a null image if the tile does not exist, otherwise an image
+    // in either Format_RGB32 or Format_ARGB32
+    QImage tile( int const tileX, int const tileY );
+
+    int hits() const;
+    int decodedTiles() const;
+    int missingTiles() const;
+
+private:
+    static int tileId( int const tileX, int const tileY );
+    QImage loadTile( int const tileX, int const tileY ) const;
+
+    QDir const m_baseDirectory;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_tileLoaded;
+    QCache<int, QImage> m_tiles;
+    QSet<int> m_tileMissing;
+    QSet<int> m_tileLoading;
+
+    int m_hits;
+    int m_decodedTiles;
+};
+
+#endif
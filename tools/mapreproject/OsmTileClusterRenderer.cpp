@@ -1,6 +1,7 @@
 #include "OsmTileClusterRenderer.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QVector>
 
 #include <cmath>
 
@@ -31,6 +32,11 @@ void OsmTileClusterRenderer::setNwwTileLevel( int const level )
     m_nwwMapImage.setTileLevel( level );
 }
 
+void OsmTileClusterRenderer::setNwwTileCache( QSharedPointer<NwwTileCache> const & tileCache )
+{
+    m_nwwMapImage.setTileCache( tileCache );
+}
+
 void OsmTileClusterRenderer::setOsmBaseDirectory( QDir const & osmBaseDirectory )
 {
     m_osmBaseDirectory = osmBaseDirectory;
@@ -97,19 +103,21 @@ QImage OsmTileClusterRenderer::renderOsmTile( int const tileX, int const tileY )
     QImage tile( tileSize, QImage::Format_ARGB32 );
     bool tileEmpty = true;
 
+    // all rows of the tile share their longitudes
+    QVector<double> lonRad( m_osmTileEdgeLengthPixel );
+    for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x )
+        lonRad[ x ] = osmPixelXtoLonRad( basePixelX + x );
+
     for ( int y = 0; y < m_osmTileEdgeLengthPixel; ++y ) {
         int const pixelY = basePixelY + y;
         double const latRad = osmPixelYtoLatRad( pixelY );
 
-        for ( int x = 0; x < m_osmTileEdgeLengthPixel; ++x ) {
-            int const pixelX = basePixelX + x;
-            double const lonRad = osmPixelXtoLonRad( pixelX );
-            QRgb const color = m_nwwMapImage.pixel( lonRad, latRad );
+        QRgb * const line = reinterpret_cast<QRgb *>( tile.scanLine( y ));
+        m_nwwMapImage.pixels( lonRad.constData(), m_osmTileEdgeLengthPixel, latRad, line );
 
-            if ( color != m_emptyPixel )
+        for ( int x = 0; x < m_osmTileEdgeLengthPixel && tileEmpty; ++x ) {
+            if ( line[ x ] != m_emptyPixel )
                 tileEmpty = false;
-
-            tile.setPixel( x, y, color );
         }
     }
     return tileEmpty ? QImage() : tile;
@@ -18,6 +18,7 @@ public:
     void setNwwBaseDirectory( QDir const & nwwBaseDirectory );
     void setNwwInterpolationMethod( InterpolationMethod const interpolationMethod );
     void setNwwTileLevel( int const level );
+    void setNwwTileCache( QSharedPointer<NwwTileCache> const & tileCache );
     void setOsmBaseDirectory( QDir const & osmBaseDirectory );
     void setOsmTileLevel( int const level );
 
@@ -29,6 +29,7 @@ int main( int argc, char *argv[] )
 
     int threadCount = 0; // threads count 0 makes no sense
     int clusterSize = 0; // cluster size 0 makes no sense
+    int cacheSize = 0;
     InterpolationMethod interpolationMethod = UnknownInterpolation;
 
     int opt;
@@ -44,6 +45,8 @@ int main( int argc, char *argv[] )
              "number of threads, use to override default of one thread per cpu core")
             ("cluster-size", po::value<int>( &opt )->default_value( 64 ),
              "edge length of tile clusters in tiles")
+            ("cache-size", po::value<int>( &opt )->default_value( 512 ),
+             "size of the input tile cache shared by all threads in MB")
             ("interpolation-method", po::value<std::string>(),
              "method used for interpolating between pixels");
 
@@ -82,6 +85,8 @@ int main( int argc, char *argv[] )
         clusterSize = variables["cluster-size"].as<int>();
     if ( variables.count("jobs"))
         threadCount = variables["jobs"].as<int>();
+    if ( variables.count("cache-size"))
+        cacheSize = variables["cache-size"].as<int>();
     if ( variables.count("interpolation-method")) {
         if ( variables["interpolation-method"].as<std::string>() == "NearestNeighbor" )
             interpolationMethod = NearestNeighborInterpolation;
@@ -96,6 +101,7 @@ int main( int argc, char *argv[] )
              << "\noutput directory:" << outputDirectory
              << "\noutput tile level:" << outputTileLevel
              << "\ncluster size:" << clusterSize
+             << "\ncache size:" << cacheSize
              << "\nthreads:" << threadCount
              << "\ninterpolation method:" << interpolationMethod;
 
@@ -103,6 +109,7 @@ int main( int argc, char *argv[] )
     converter.setNwwBaseDirectory( QDir( inputDirectory ));
     converter.setNwwTileLevel( inputTileLevel );
     converter.setNwwInterpolationMethod( interpolationMethod );
+    converter.setNwwTileCacheSize( cacheSize );
     converter.setOsmBaseDirectory( QDir( outputDirectory ));
     converter.setOsmTileLevel( outputTileLevel );
     converter.setOsmTileClusterEdgeLengthTiles( clusterSize );
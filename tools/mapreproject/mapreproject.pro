@@ -18,12 +18,14 @@ TEMPLATE = app
 SOURCES += main.cpp \
     NasaWorldWindToOpenStreetMapConverter.cpp \
     NwwMapImage.cpp \
+    NwwTileCache.cpp \
     OsmTileClusterRenderer.cpp \
     Thread.cpp
 
 HEADERS += \
     NasaWorldWindToOpenStreetMapConverter.h \
     NwwMapImage.h \
+    NwwTileCache.h \
     OsmTileClusterRenderer.h \
     Thread.h \
     mapreproject.h
@@ -0,0 +1,268 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "NodeStore.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QTemporaryFile>
+#include <QtCore/QtAlgorithms>
+
+namespace Marble
+{
+
+NodeStore::NodeStore() :
+    m_memoryLimit( 0 ),
+    m_runs( 0 ),
+    m_writeFailed( false ),
+    m_merged( 0 ),
+    m_mapped( 0 ),
+    m_mappedCount( 0 ),
+    m_squeezed( false )
+{
+    // nothing to do
+}
+
+NodeStore::~NodeStore()
+{
+    clear();
+}
+
+void NodeStore::setMemoryLimit( qint64 bytes, const QString &directory )
+{
+    m_memoryLimit = bytes;
+    m_directory = directory;
+}
+
+void NodeStore::insert( int id, const Coordinate &coordinate )
+{
+    Q_ASSERT( !m_squeezed );
+
+    Entry entry;
+    entry.id = id;
+    entry.lon = coordinate.lon;
+    entry.lat = coordinate.lat;
+    m_entries.append( entry );
+
+    if ( m_memoryLimit > 0 && qint64( m_entries.size() ) * sizeof( Entry ) >= m_memoryLimit ) {
+        spill();
+    }
+}
+
+bool NodeStore::lessThan( const Entry &a, const Entry &b )
+{
+    return a.id < b.id;
+}
+
+void NodeStore::sortUnique( QVector<Entry> &entries )
+{
+    qStableSort( entries.begin(), entries.end(), lessThan );
+
+    int count = 0;
+    for ( int i = 0; i < entries.size(); ++i ) {
+        if ( i + 1 < entries.size() && entries.at( i + 1 ).id == entries.at( i ).id ) {
+            continue;
+        }
+        entries[count++] = entries.at( i );
+    }
+    entries.resize( count );
+}
+
+bool NodeStore::write( QFile *file, const QVector<Entry> &entries )
+{
+    const qint64 bytes = entries.size() * sizeof( Entry );
+    if ( file->write( reinterpret_cast<const char*>( entries.constData() ), bytes ) != bytes ) {
+        qCritical() << "Unable to write the temporary node file" << file->fileName();
+        return false;
+    }
+
+    return true;
+}
+
+void NodeStore::spill()
+{
+    if ( !m_runs ) {
+        QTemporaryFile *file = new QTemporaryFile( m_directory + "/osm-addresses-nodes" );
+        if ( !file->open() ) {
+            qCritical() << "Unable to create a temporary file in" << m_directory << ", keeping nodes in memory";
+            delete file;
+            m_memoryLimit = 0;
+            return;
+        }
+        m_runs = file;
+    }
+
+    sortUnique( m_entries );
+    m_runBounds << qMakePair( m_runs->pos() / qint64( sizeof( Entry ) ), m_entries.size() );
+    if ( !write( m_runs, m_entries ) ) {
+        m_writeFailed = true;
+    }
+    m_entries = QVector<Entry>();
+}
+
+bool NodeStore::squeeze()
+{
+    if ( m_squeezed ) {
+        return !m_writeFailed;
+    }
+
+    m_squeezed = true;
+    if ( m_runs ) {
+        if ( !m_entries.isEmpty() ) {
+            spill();
+        }
+        if ( !m_writeFailed && !mergeRuns() ) {
+            m_writeFailed = true;
+        }
+    } else {
+        sortUnique( m_entries );
+        m_entries.squeeze();
+    }
+
+    return !m_writeFailed;
+}
+
+bool NodeStore::mergeRuns()
+{
+    const Entry *runs = m_runs->flush() ? reinterpret_cast<const Entry*>( m_runs->map( 0, m_runs->size() ) ) : 0;
+
+    QTemporaryFile *merged = new QTemporaryFile( m_directory + "/osm-addresses-nodes" );
+    if ( !runs || !merged->open() ) {
+        qCritical() << "Unable to merge the temporary node files in" << m_directory;
+        delete merged;
+        return false;
+    }
+
+    QVector<int> positions( m_runBounds.size(), 0 );
+    QVector<Entry> buffer;
+    buffer.reserve( 1 << 16 );
+    m_mappedCount = 0;
+
+    for ( ;; ) {
+        // Of equal ids, the one of the latest run wins
+        int next = -1;
+        for ( int i = 0; i < m_runBounds.size(); ++i ) {
+            if ( positions.at( i ) < m_runBounds.at( i ).second ) {
+                const Entry &entry = runs[m_runBounds.at( i ).first + positions.at( i )];
+                if ( next < 0 || entry.id <= runs[m_runBounds.at( next ).first + positions.at( next )].id ) {
+                    next = i;
+                }
+            }
+        }
+
+        if ( next < 0 ) {
+            break;
+        }
+
+        const Entry entry = runs[m_runBounds.at( next ).first + positions.at( next )];
+        for ( int i = 0; i < m_runBounds.size(); ++i ) {
+            if ( positions.at( i ) < m_runBounds.at( i ).second
+                 && runs[m_runBounds.at( i ).first + positions.at( i )].id == entry.id ) {
+                ++positions[i];
+            }
+        }
+
+        buffer.append( entry );
+        ++m_mappedCount;
+        if ( buffer.size() == buffer.capacity() ) {
+            if ( !write( merged, buffer ) ) {
+                delete merged;
+                m_mappedCount = 0;
+                return false;
+            }
+            buffer.resize( 0 );
+        }
+    }
+
+    if ( !write( merged, buffer ) ) {
+        delete merged;
+        m_mappedCount = 0;
+        return false;
+    }
+
+    delete m_runs;
+    m_runs = 0;
+    m_runBounds.clear();
+
+    m_merged = merged;
+    m_mapped = m_mappedCount && m_merged->flush() ? reinterpret_cast<const Entry*>( m_merged->map( 0, m_merged->size() ) ) : 0;
+    if ( m_mappedCount && !m_mapped ) {
+        qCritical() << "Unable to map the temporary node file" << m_merged->fileName();
+        m_mappedCount = 0;
+        return false;
+    }
+
+    return true;
+}
+
+const NodeStore::Entry *NodeStore::find( int id ) const
+{
+    Q_ASSERT( m_squeezed );
+
+    const Entry *begin = m_mapped ? m_mapped : m_entries.constData();
+    const int count = m_mapped ? m_mappedCount : m_entries.size();
+
+    int low = 0;
+    int high = count;
+    while ( low < high ) {
+        const int middle = low + ( high - low ) / 2;
+        if ( begin[middle].id < id ) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low < count && begin[low].id == id ? begin + low : 0;
+}
+
+bool NodeStore::contains( int id ) const
+{
+    return find( id ) != 0;
+}
+
+Coordinate NodeStore::value( int id ) const
+{
+    const Entry *entry = find( id );
+    return entry ? Coordinate( entry->lon, entry->lat ) : Coordinate();
+}
+
+Coordinate NodeStore::at( int index ) const
+{
+    Q_ASSERT( m_squeezed && index >= 0 && index < size() );
+    const Entry &entry = m_mapped ? m_mapped[index] : m_entries.at( index );
+    return Coordinate( entry.lon, entry.lat );
+}
+
+int NodeStore::size() const
+{
+    if ( !m_squeezed ) {
+        qint64 result = m_entries.size();
+        for ( int i = 0; i < m_runBounds.size(); ++i ) {
+            result += m_runBounds.at( i ).second;
+        }
+        return int( result );
+    }
+
+    return m_mapped ? m_mappedCount : m_entries.size();
+}
+
+void NodeStore::clear()
+{
+    m_entries = QVector<Entry>();
+    delete m_runs;
+    m_runs = 0;
+    m_runBounds.clear();
+    m_writeFailed = false;
+    delete m_merged;
+    m_merged = 0;
+    m_mapped = 0;
+    m_mappedCount = 0;
+    m_squeezed = false;
+}
+
+}
@@ -0,0 +1,120 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef MARBLE_NODESTORE_H
+#define MARBLE_NODESTORE_H
+
+#include <QtCore/QPair>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+class QFile;
+
+namespace Marble
+{
+
+struct Coordinate {
+    float lon;
+    float lat;
+
+    Coordinate(float lon=0.0, float lat=0.0);
+};
+
+/**
+ * @short The coordinates of nodes in an array sorted by node id.
+ *
+ * Each node takes twelve bytes, a fraction of what a hash needs. Nodes are
+ * inserted in any order first and sorted by squeeze() before they can be
+ * looked up. With a memory limit set, nodes are written to disk in sorted
+ * runs whenever the limit is reached, and squeeze() merges the runs into a
+ * file which is memory mapped for lookups.
+ */
+class NodeStore
+{
+public:
+    NodeStore();
+
+    ~NodeStore();
+
+    /**
+     * @brief Moves nodes to temporary files in @p directory beyond @p bytes of memory, 0 for no limit.
+     */
+    void setMemoryLimit( qint64 bytes, const QString &directory );
+
+    /**
+     * @brief Adds a node. A node inserted again replaces the earlier one.
+     */
+    void insert( int id, const Coordinate &coordinate );
+
+    /**
+     * @brief Prepares the nodes for lookups, to be called after the last insert.
+     *
+     * Returns false if nodes written to disk could not be written or merged again,
+     * in which case lookups don't find them.
+     */
+    bool squeeze();
+
+    bool contains( int id ) const;
+
+    Coordinate value( int id ) const;
+
+    /**
+     * @brief The node with the given index in the order of node ids.
+     */
+    Coordinate at( int index ) const;
+
+    int size() const;
+
+    void clear();
+
+private:
+    Q_DISABLE_COPY( NodeStore )
+
+    struct Entry {
+        qint32 id;
+        float lon;
+        float lat;
+    };
+
+    static bool lessThan( const Entry &a, const Entry &b );
+
+    /**
+     * Sorts the entries by id, keeping the last one inserted of equal ids.
+     */
+    static void sortUnique( QVector<Entry> &entries );
+
+    const Entry *find( int id ) const;
+
+    static bool write( QFile *file, const QVector<Entry> &entries );
+
+    void spill();
+
+    bool mergeRuns();
+
+    QVector<Entry> m_entries;
+
+    qint64 m_memoryLimit;
+
+    QString m_directory;
+
+    // Sorted runs of entries written to disk, as offset and count
+    QFile *m_runs;
+    QVector<QPair<qint64, int> > m_runBounds;
+    bool m_writeFailed;
+
+    // The merged runs, mapped into memory after squeeze()
+    QFile *m_merged;
+    const Entry *m_mapped;
+    int m_mappedCount;
+
+    bool m_squeezed;
+};
+
+}
+
+#endif // MARBLE_NODESTORE_H
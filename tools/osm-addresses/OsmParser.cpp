@@ -26,6 +26,7 @@
 #include "geodata/data/GeoDataExtendedData.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QDir>
 #include <QtCore/QTime>
 
 namespace Marble
@@ -117,6 +118,11 @@ void OsmParser::addWriter( Writer* writer )
     m_writers.push_back( writer );
 }
 
+void OsmParser::setNodeMemoryLimit( int megabytes )
+{
+    m_coordinates.setMemoryLimit( qint64( megabytes ) * 1024 * 1024, QDir::tempPath() );
+}
+
 Node::operator OsmPlacemark() const
 {
     OsmPlacemark placemark;
@@ -145,14 +151,14 @@ Way::operator OsmPlacemark() const
     return placemark;
 }
 
-void Way::setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &placemark ) const
+void Way::setPosition( const NodeStore &database, OsmPlacemark &placemark ) const
 {
     if ( !nodes.isEmpty() ) {
         if ( nodes.first() == nodes.last() && database.contains( nodes.first() ) ) {
             GeoDataLinearRing ring;
             foreach( int id, nodes ) {
                 if ( database.contains( id ) ) {
-                    const Coordinate &node = database[id];
+                    const Coordinate node = database.value( id );
                     GeoDataCoordinates coordinates( node.lon, node.lat, 0.0, GeoDataCoordinates::Degree );
                     ring << coordinates;
                 } else {
@@ -168,7 +174,7 @@ void Way::setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &pla
         } else {
             int id = nodes.at( nodes.size() / 2 );
             if ( database.contains( id ) ) {
-                const Coordinate &node = database[id];
+                const Coordinate node = database.value( id );
                 placemark.setLongitude( node.lon );
                 placemark.setLatitude( node.lat );
             }
@@ -213,7 +219,7 @@ void Way::setRegion( const QHash<int, Node> &database,  const OsmRegionTree & tr
     placemark.setRegionId( tree.smallestRegionId( position ) );
 }
 
-void OsmParser::read( const QFileInfo &content, const QString &areaName )
+bool OsmParser::read( const QFileInfo &content, const QString &areaName )
 {
     QTime timer;
     timer.start();
@@ -233,6 +239,11 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     }
     while ( needAnotherPass );
 
+    if ( !m_coordinates.squeeze() ) {
+        qCritical() << "Unable to store the coordinates of all nodes. Exiting.";
+        return false;
+    }
+
     qWarning() << "Step 2: " << m_coordinates.size() << "coordinates."
                << "Now extracting regions from" << m_relations.size() << "relations";
 
@@ -294,7 +305,8 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
     mainArea.setName( areaName );
     mainArea.setAdminLevel( 1 );
     QPair<float, float> minLon( -180.0, 180.0 ), minLat( -90.0, 90.0 );
-    foreach( const Coordinate & node, m_coordinates ) {
+    for ( int i = 0; i < m_coordinates.size(); ++i ) {
+        const Coordinate node = m_coordinates.at( i );
         minLon.first  = qMin( node.lon, minLon.first );
         minLon.second = qMax( node.lon, minLon.second );
         minLat.first  = qMin( node.lat, minLat.first );
@@ -417,6 +429,7 @@ void OsmParser::read( const QFileInfo &content, const QString &areaName )
 
     qWarning() << "Step 8: There is no step 8. Done after " << timer.elapsed() / 1000 << "s.";
     //writeOutlineKml( areaName );
+    return true;
 }
 
 QList< QList<Way> > OsmParser::merge( const QList<Way> &ways ) const
@@ -503,7 +516,7 @@ void OsmParser::importWay( QVector<GeoDataLineString> &ways, int id )
         if ( !m_coordinates.contains( node ) ) {
             qDebug() << "Skipping unknown node " << node << ". Check data.";
         } else {
-            const Coordinate &nd = m_coordinates[node];
+            const Coordinate nd = m_coordinates.value( node );
             GeoDataCoordinates coordinates( nd.lon, nd.lat, 0.0, GeoDataCoordinates::Degree );
             way << coordinates;
         }
@@ -629,7 +642,11 @@ void OsmParser::setCategory( Element &element, const QString &key, const QString
 GeoDataLinearRing* OsmParser::convexHull() const
 {
     Q_ASSERT(m_coordinates.size()>2);
-    QList<Coordinate> coordinates = m_coordinates.values();
+    QList<Coordinate> coordinates;
+    coordinates.reserve( m_coordinates.size() );
+    for ( int i = 0; i < m_coordinates.size(); ++i ) {
+        coordinates << m_coordinates.at( i );
+    }
 
     QVector<GrahamScanHelper> points;
     points.reserve( coordinates.size()+1 );
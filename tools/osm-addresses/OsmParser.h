@@ -12,6 +12,7 @@
 #define MARBLE_OSMPARSER_H
 
 #include "Writer.h"
+#include "NodeStore.h"
 #include "OsmRegion.h"
 #include "OsmPlacemark.h"
 #include "OsmRegionTree.h"
@@ -61,13 +62,6 @@ struct Element {
         category( OsmPlacemark::UnknownCategory ) {}
 };
 
-struct Coordinate {
-    float lon;
-    float lat;
-
-    Coordinate(float lon=0.0, float lat=0.0);
-};
-
 struct Node : public Element {
     float lon;
     float lat;
@@ -81,7 +75,7 @@ struct Way : public Element {
     bool isBuilding;
 
     operator OsmPlacemark() const;
-    void setPosition( const QHash<int, Coordinate> &database, OsmPlacemark &placemark ) const;
+    void setPosition( const NodeStore &database, OsmPlacemark &placemark ) const;
     void setRegion( const QHash<int, Node> &database, const OsmRegionTree & tree, QList<OsmOsmRegion> & osmOsmRegions, OsmPlacemark &placemark ) const;
 };
 
@@ -153,10 +147,18 @@ public:
 
     void addWriter( Writer* writer );
 
-    void read( const QFileInfo &file, const QString &areaName );
+    /**
+     * @brief Parses @p file and hands its addresses to the writers. Returns false on errors.
+     */
+    bool read( const QFileInfo &file, const QString &areaName );
 
     void writeKml( const QString &area, const QString &version, const QString &date, const QString &transport, const QString &payload, const QString &outputKml ) const;
 
+    /**
+     * @brief Keeps at most @p megabytes of node coordinates in memory, the rest in temporary files
+     */
+    void setNodeMemoryLimit( int megabytes );
+
 protected:
     virtual bool parse( const QFileInfo &file, int pass, bool &needAnotherPass ) = 0;
 
@@ -164,7 +166,7 @@ protected:
 
     void setCategory( Element &element, const QString &key, const QString &value );
 
-    QHash<int, Coordinate> m_coordinates;
+    NodeStore m_coordinates;
 
     QHash<int, Node> m_nodes;
 
@@ -0,0 +1,261 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+// Writes a synthetic .osm.pbf file and measures how fast osm-addresses
+// parses it with one and with all decoding threads, as well as the node
+// store against the hash it replaced.
+
+#include "NodeStore.h"
+#include "PbfParser.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTime>
+
+#include <zlib.h>
+
+#include <netinet/in.h>
+
+using namespace Marble;
+
+// Entities per block, similar to what osmosis writes
+static const int blockSize = 8000;
+
+// Every way connects that many nodes
+static const int wayLength = 10;
+
+enum StringIndex {
+    EmptyString,
+    NameString,
+    StreetString,
+    HouseNumberString,
+    HighwayString,
+    ResidentialString,
+    BoundaryString,
+    AdministrativeString,
+    AdminLevelString,
+    EightString,
+    OuterString,
+    CityString,
+    FirstStreetName
+};
+
+static const int streetNames = 100;
+
+class BenchmarkParser : public PbfParser
+{
+public:
+    int coordinates() const { return m_coordinates.size(); }
+    int nodes() const { return m_nodes.size(); }
+    int ways() const { return m_ways.size(); }
+    int relations() const { return m_relations.size(); }
+};
+
+static void fillStringTable( OSMPBF::StringTable *table )
+{
+    const char *strings[] = { "", "name", "addr:street", "addr:housenumber", "highway", "residential",
+                              "boundary", "administrative", "admin_level", "8", "outer", "Benchmark City" };
+    for ( unsigned int i = 0; i < sizeof( strings ) / sizeof( strings[0] ); ++i ) {
+        table->add_s( strings[i] );
+    }
+    for ( int i = 0; i < streetNames; ++i ) {
+        table->add_s( QString( "Benchmark Street %1" ).arg( i ).toUtf8().constData() );
+    }
+}
+
+static void writeBlob( QFile &file, const char *type, const std::string &payload )
+{
+    uLongf size = compressBound( payload.size() );
+    QByteArray compressed( size, 0 );
+    compress2( ( Bytef* ) compressed.data(), &size, ( const Bytef* ) payload.data(), payload.size(), Z_DEFAULT_COMPRESSION );
+
+    OSMPBF::Blob blob;
+    blob.set_raw_size( payload.size() );
+    blob.set_zlib_data( compressed.constData(), size );
+    std::string blobData;
+    blob.SerializeToString( &blobData );
+
+    OSMPBF::BlobHeader header;
+    header.set_type( type );
+    header.set_datasize( blobData.size() );
+    std::string headerData;
+    header.SerializeToString( &headerData );
+
+    const quint32 length = htonl( headerData.size() );
+    file.write( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+    file.write( headerData.data(), headerData.size() );
+    file.write( blobData.data(), blobData.size() );
+}
+
+/**
+ * Nodes on a grid, every tenth with an address, ways along the grid rows
+ * and one administrative boundary made of the first ways.
+ */
+static bool writeFile( const QString &fileName, int nodeCount )
+{
+    QFile file( fileName );
+    if ( !file.open( QFile::WriteOnly | QFile::Truncate ) ) {
+        return false;
+    }
+
+    OSMPBF::HeaderBlock headerBlock;
+    headerBlock.add_required_features( "OsmSchema-V0.6" );
+    headerBlock.add_required_features( "DenseNodes" );
+    writeBlob( file, "OSMHeader", headerBlock.SerializeAsString() );
+
+    for ( int first = 0; first < nodeCount; first += blockSize ) {
+        OSMPBF::PrimitiveBlock block;
+        fillStringTable( block.mutable_stringtable() );
+        OSMPBF::DenseNodes *dense = block.add_primitivegroup()->mutable_dense();
+        long long lastLat = 0;
+        long long lastLon = 0;
+        for ( int id = first; id < qMin( nodeCount, first + blockSize ); ++id ) {
+            // Node ids start at one, granularity is 100 nanodegrees
+            const long long lat = 480000000 + ( id / 1000 ) * 100;
+            const long long lon = 80000000 + ( id % 1000 ) * 100;
+            dense->add_id( id == first ? first + 1 : 1 );
+            dense->add_lat( lat - lastLat );
+            dense->add_lon( lon - lastLon );
+            lastLat = lat;
+            lastLon = lon;
+            if ( id % 10 == 0 ) {
+                dense->add_keys_vals( StreetString );
+                dense->add_keys_vals( FirstStreetName + id % streetNames );
+                dense->add_keys_vals( HouseNumberString );
+                dense->add_keys_vals( EightString );
+            }
+            dense->add_keys_vals( 0 );
+        }
+        writeBlob( file, "OSMData", block.SerializeAsString() );
+    }
+
+    const int wayCount = nodeCount / wayLength;
+    for ( int first = 0; first < wayCount; first += blockSize ) {
+        OSMPBF::PrimitiveBlock block;
+        fillStringTable( block.mutable_stringtable() );
+        OSMPBF::PrimitiveGroup *group = block.add_primitivegroup();
+        for ( int id = first; id < qMin( wayCount, first + blockSize ); ++id ) {
+            OSMPBF::Way *way = group->add_ways();
+            way->set_id( id + 1 );
+            way->add_keys( HighwayString );
+            way->add_vals( ResidentialString );
+            way->add_keys( NameString );
+            way->add_vals( FirstStreetName + id % streetNames );
+            way->add_refs( id * wayLength + 1 );
+            for ( int i = 1; i < wayLength; ++i ) {
+                way->add_refs( 1 );
+            }
+        }
+        writeBlob( file, "OSMData", block.SerializeAsString() );
+    }
+
+    OSMPBF::PrimitiveBlock block;
+    fillStringTable( block.mutable_stringtable() );
+    OSMPBF::Relation *relation = block.add_primitivegroup()->add_relations();
+    relation->set_id( 1 );
+    relation->add_keys( BoundaryString );
+    relation->add_vals( AdministrativeString );
+    relation->add_keys( AdminLevelString );
+    relation->add_vals( EightString );
+    relation->add_keys( NameString );
+    relation->add_vals( CityString );
+    for ( int i = 0; i < qMin( wayCount, 100 ); ++i ) {
+        relation->add_memids( 1 );
+        relation->add_types( OSMPBF::Relation::WAY );
+        relation->add_roles_sid( OuterString );
+    }
+    writeBlob( file, "OSMData", block.SerializeAsString() );
+
+    return file.error() == QFile::NoError;
+}
+
+static void benchmarkParser( const QString &fileName, int threads )
+{
+    QThreadPool::globalInstance()->setMaxThreadCount( threads );
+
+    BenchmarkParser parser;
+    QTime timer;
+    timer.start();
+    bool needAnotherPass = false;
+    int pass = 0;
+    do {
+        parser.parse( QFileInfo( fileName ), pass++, needAnotherPass );
+    } while ( needAnotherPass );
+
+    qDebug() << threads << "decoding threads:" << timer.elapsed() << "ms for" << pass << "passes,"
+             << parser.nodes() << "nodes," << parser.coordinates() << "coordinates,"
+             << parser.ways() << "ways," << parser.relations() << "relations";
+}
+
+static void benchmarkNodeStore( int nodeCount )
+{
+    QVector<int> ids( nodeCount );
+    for ( int i = 0; i < nodeCount; ++i ) {
+        ids[i] = i * 3 + 1;
+    }
+    for ( int i = nodeCount - 1; i > 0; --i ) {
+        qSwap( ids[i], ids[qrand() % ( i + 1 )] );
+    }
+
+    QTime timer;
+    timer.start();
+    QHash<int, Coordinate> hash;
+    foreach ( int id, ids ) {
+        hash[id] = Coordinate( id, id );
+    }
+    const int hashInsert = timer.restart();
+    qint64 sum = 0;
+    foreach ( int id, ids ) {
+        sum += qint64( hash.value( id ).lon );
+    }
+    const int hashLookup = timer.restart();
+    hash.clear();
+
+    timer.restart();
+    NodeStore store;
+    foreach ( int id, ids ) {
+        store.insert( id, Coordinate( id, id ) );
+    }
+    store.squeeze();
+    const int storeInsert = timer.restart();
+    foreach ( int id, ids ) {
+        sum -= qint64( store.value( id ).lon );
+    }
+    const int storeLookup = timer.restart();
+
+    qDebug() << nodeCount << "coordinates in a hash:" << hashInsert << "ms to insert," << hashLookup << "ms to look up";
+    qDebug() << nodeCount << "coordinates in a node store:" << storeInsert << "ms to insert and sort," << storeLookup << "ms to look up";
+    if ( sum != 0 ) {
+        qDebug() << "The node store returned wrong coordinates";
+    }
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    const int nodeCount = argc > 1 ? QString( argv[1] ).toInt() : 2000000;
+    const QString fileName = QDir::tempPath() + "/osm-addresses-benchmark.osm.pbf";
+    if ( !writeFile( fileName, nodeCount ) ) {
+        qDebug() << "Unable to write" << fileName;
+        return 1;
+    }
+    qDebug() << "Wrote" << nodeCount << "nodes to" << fileName << "," << QFileInfo( fileName ).size() / 1024 << "kB";
+
+    benchmarkParser( fileName, 1 );
+    benchmarkParser( fileName, QThread::idealThreadCount() );
+    benchmarkNodeStore( nodeCount );
+
+    QFile::remove( fileName );
+    return 0;
+}
@@ -63,6 +63,8 @@ void usage()
     qDebug() << "\t--name aName";
     qDebug() << "\t--date aDate";
     qDebug() << "\t--payload aFilename";
+    qDebug() << "\tOther options:";
+    qDebug() << "\t--node-memory megabytes (keep node coordinates beyond that in temporary files)";
 }
 
 int main( int argc, char *argv[] )
@@ -82,6 +84,7 @@ int main( int argc, char *argv[] )
     QString date;
     QString transport;
     QString payload;
+    int nodeMemory = 0;
     for ( int i=1; i<argc-3; ++i ) {
         QString arg( argv[i] );
         if ( arg == "-v" ) {
@@ -98,6 +101,8 @@ int main( int argc, char *argv[] )
             transport = argv[++i];
         } else if ( arg == "--payload" ) {
             payload = argv[++i];
+        } else if ( arg == "--node-memory" ) {
+            nodeMemory = QString( argv[++i] ).toInt();
         } else {
             usage();
             return 1;
@@ -124,6 +129,9 @@ int main( int argc, char *argv[] )
     Q_ASSERT( parser );
     SqlWriter sql( outputSqlite );
     parser->addWriter( &sql );
-    parser->read( file, name );
+    parser->setNodeMemoryLimit( nodeMemory );
+    if ( !parser->read( file, name ) ) {
+        return 4;
+    }
     parser->writeKml( name, version, date, transport, payload, outputKml );
 }
@@ -30,6 +30,7 @@ LIBS += -L/home/dennis/marble/export-git/lib/marble/plugins -lLocalOsmSearchPlug
 LIBS += -lprotobuf
 
 SOURCES += main.cpp \
+    NodeStore.cpp \
     OsmParser.cpp \
     Writer.cpp \
     SqlWriter.cpp \
@@ -41,6 +42,7 @@ SOURCES += main.cpp \
     xml/XmlParser.cpp
 
 HEADERS += \
+    NodeStore.h \
     OsmParser.h \
     Writer.h \
     SqlWriter.h \
@@ -15,6 +15,9 @@
 #include "PbfParser.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QQueue>
+#include <QtCore/QThread>
+#include <QtCore/QtConcurrentRun>
 
 #include <zlib.h>
 
@@ -66,10 +69,30 @@ bool PbfParser::parse( const QFileInfo &fileInfo, int pass, bool &needAnotherPas
 
     m_loadBlock = true;
 
+    // Blocks are read in file order and decoded in worker threads, a few
+    // blocks ahead of the one being parsed. Parsing itself stays sequential.
+    QQueue<QFuture<PrimitiveBlock*> > decoding;
+    const int maximumDecoding = 2 * QThread::idealThreadCount();
+    bool endOfFile = false;
+
     while ( true ) {
 
         if ( m_loadBlock ) {
-            if ( !readNext() ) {
+            while ( !endOfFile && decoding.size() < maximumDecoding ) {
+                QByteArray data;
+                if ( readNext( data ) ) {
+                    decoding.enqueue( QtConcurrent::run( &PbfParser::decodeBlock, data ) );
+                } else {
+                    endOfFile = true;
+                }
+            }
+
+            PrimitiveBlock* block = decoding.isEmpty() ? 0 : decoding.dequeue().result();
+            if ( !block ) {
+                while ( !decoding.isEmpty() ) {
+                    delete decoding.dequeue().result();
+                }
+
                 if ( pass == 1 ) {
                     m_referencedWays.clear();
                 } else if ( pass == 2 ) {
@@ -78,6 +101,9 @@ bool PbfParser::parse( const QFileInfo &fileInfo, int pass, bool &needAnotherPas
 
                 return true;
             }
+
+            m_primitiveBlock.Swap( block );
+            delete block;
             loadBlock();
             loadGroup();
         }
@@ -127,6 +153,12 @@ bool PbfParser::parseBlobHeader()
 }
 
 bool PbfParser::parseBlob()
+{
+    QByteArray data;
+    return readBlob( data ) && unpackBlob( data, m_buffer );
+}
+
+bool PbfParser::readBlob( QByteArray &data )
 {
     int size = m_blobHeader.datasize();
     if ( size < 0 ) {
@@ -134,52 +166,54 @@ bool PbfParser::parseBlob()
         return false;
     }
 
-    m_buffer.resize( size );
-    int readBytes = m_stream.readRawData( m_buffer.data(), size );
+    data.resize( size );
+    int readBytes = m_stream.readRawData( data.data(), size );
     if ( readBytes != size ) {
         qCritical() << "failed to read blob";
         return false;
     }
 
-    if ( !m_blob.ParseFromArray( m_buffer.constData(), size ) ) {
+    return true;
+}
+
+bool PbfParser::unpackBlob( const QByteArray &data, QByteArray &buffer )
+{
+    Blob blob;
+    if ( !blob.ParseFromArray( data.constData(), data.size() ) ) {
         qCritical() << "failed to parse blob";
         return false;
     }
 
-    if ( m_blob.has_raw() ) {
-        const std::string& data = m_blob.raw();
-        m_buffer.resize( data.size() );
-        for ( unsigned int i = 0; i < data.size(); ++i ) {
-            m_buffer[i] = data[i];
-        }
-    } else if ( m_blob.has_zlib_data() ) {
-        m_buffer.resize( m_blob.raw_size() );
+    if ( blob.has_raw() ) {
+        const std::string& raw = blob.raw();
+        buffer = QByteArray( raw.data(), raw.size() );
+    } else if ( blob.has_zlib_data() ) {
+        buffer.resize( blob.raw_size() );
         z_stream zStream;
-        zStream.next_in = ( unsigned char* ) m_blob.zlib_data().data();
-        zStream.avail_in = m_blob.zlib_data().size();
-        zStream.next_out = ( unsigned char* ) m_buffer.data();
-        zStream.avail_out = m_blob.raw_size();
+        zStream.next_in = ( unsigned char* ) blob.zlib_data().data();
+        zStream.avail_in = blob.zlib_data().size();
+        zStream.next_out = ( unsigned char* ) buffer.data();
+        zStream.avail_out = blob.raw_size();
         zStream.zalloc = Z_NULL;
         zStream.zfree = Z_NULL;
         zStream.opaque = Z_NULL;
         int result = inflateInit( &zStream );
         if ( result != Z_OK ) {
-            qCritical() << "failed to open zlib m_stream";
+            qCritical() << "failed to open zlib stream";
             return false;
         }
         result = inflate( &zStream, Z_FINISH );
         if ( result != Z_STREAM_END ) {
-            qCritical() << "failed to inflate zlib m_stream";
+            qCritical() << "failed to inflate zlib stream";
+            inflateEnd( &zStream );
             return false;
         }
         result = inflateEnd( &zStream );
         if ( result != Z_OK ) {
-            qCritical() << "failed to close zlib m_stream";
+            qCritical() << "failed to close zlib stream";
             return false;
         }
-
-        return true;
-    } else if ( m_blob.has_lzma_data() ) {
+    } else if ( blob.has_lzma_data() ) {
         qCritical() << "No support for lzma decryption implemented, sorry.";
         return false;
     } else {
@@ -190,6 +224,23 @@ bool PbfParser::parseBlob()
     return true;
 }
 
+PrimitiveBlock* PbfParser::decodeBlock( const QByteArray &data )
+{
+    QByteArray buffer;
+    if ( !unpackBlob( data, buffer ) ) {
+        return 0;
+    }
+
+    PrimitiveBlock* block = new PrimitiveBlock;
+    if ( !block->ParseFromArray( buffer.constData(), buffer.size() ) ) {
+        qCritical() << "failed to parse PrimitiveBlock";
+        delete block;
+        return 0;
+    }
+
+    return block;
+}
+
 bool PbfParser::parseData()
 {
     if ( !m_headerBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
@@ -208,7 +259,7 @@ bool PbfParser::parseData()
     return true;
 }
 
-bool PbfParser::readNext()
+bool PbfParser::readNext( QByteArray &data )
 {
     if ( !parseBlobHeader() )
         return false;
@@ -218,14 +269,7 @@ bool PbfParser::readNext()
         return false;
     }
 
-    if ( !parseBlob() )
-        return false;
-
-    if ( !m_primitiveBlock.ParseFromArray( m_buffer.data(), m_buffer.size() ) ) {
-        qCritical() << "failed to parse PrimitiveBlock";
-        return false;
-    }
-    return true;
+    return readBlob( data );
 }
 
 void PbfParser::loadGroup()
@@ -292,7 +336,7 @@ void PbfParser::parseNode()
         }
 
         if ( m_referencedNodes.contains( inputNode.id() ) ) {
-            m_coordinates[inputNode.id()] = node;
+            m_coordinates.insert( inputNode.id(), node );
         }
     }
 
@@ -495,7 +539,7 @@ void PbfParser::parseDense()
         }
 
         if ( m_referencedNodes.contains( m_lastDenseID ) ) {
-            m_coordinates[m_lastDenseID] = node;
+            m_coordinates.insert( m_lastDenseID, node );
         }
     }
 
@@ -46,7 +46,25 @@ private:
 
     bool parseData();
 
-    bool readNext();
+    /**
+     * Reads the next data blob of the file without unpacking it
+     */
+    bool readNext( QByteArray &data );
+
+    /**
+     * Reads the blob described by the last blob header
+     */
+    bool readBlob( QByteArray &data );
+
+    /**
+     * Uncompresses the contents of a blob into @p buffer
+     */
+    static bool unpackBlob( const QByteArray &data, QByteArray &buffer );
+
+    /**
+     * Unpacks and parses a data blob, returning 0 on failure. Called in worker threads.
+     */
+    static OSMPBF::PrimitiveBlock *decodeBlock( const QByteArray &data );
 
     void loadBlock();
 
@@ -66,8 +84,6 @@ private:
 
     OSMPBF::BlobHeader m_blobHeader;
 
-    OSMPBF::Blob m_blob;
-
     OSMPBF::HeaderBlock m_headerBlock;
 
     OSMPBF::PrimitiveBlock m_primitiveBlock;
@@ -132,7 +132,10 @@ bool XmlParser::startElement ( const QString & /*namespaceURI*/, const QString &
 bool XmlParser::endElement ( const QString & /*namespaceURI*/, const QString & /*localName*/, const QString & qName )
 {
     if ( qName == "node" ) {
-        m_nodes[m_id] = m_node;
+        m_coordinates.insert( m_id, m_node );
+        if ( m_node.save || m_node.category != OsmPlacemark::UnknownCategory ) {
+            m_nodes[m_id] = m_node;
+        }
     } else if ( qName == "way" ) {
         m_ways[m_id] = m_way;
     } else if ( qName == "relation" ) {
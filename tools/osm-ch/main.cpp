@@ -0,0 +1,196 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "ChGraphBuilder.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QPointF>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+#include <QtCore/QXmlStreamReader>
+
+#include <cmath>
+
+using namespace Marble;
+
+struct Way
+{
+    QVector<qint64> nodes;
+    qreal speed;   // km/h
+    int direction; // 1 oneway, -1 oneway against the node order, 0 both ways
+};
+
+void usage()
+{
+    qDebug() << "Usage: osm-ch input.osm output.ch";
+    qDebug() << "\tCreates a road network for the offline routing plugin. Copy the result";
+    qDebug() << "\tto maps/earth/ch/ in the local Marble data directory.";
+}
+
+// Typical car speeds in km/h, other highways are ignored
+QHash<QString, qreal> speeds()
+{
+    QHash<QString, qreal> result;
+    result["motorway"] = 110;
+    result["motorway_link"] = 60;
+    result["trunk"] = 90;
+    result["trunk_link"] = 50;
+    result["primary"] = 70;
+    result["primary_link"] = 45;
+    result["secondary"] = 60;
+    result["secondary_link"] = 40;
+    result["tertiary"] = 50;
+    result["tertiary_link"] = 35;
+    result["unclassified"] = 40;
+    result["residential"] = 30;
+    result["living_street"] = 10;
+    result["service"] = 15;
+    result["road"] = 30;
+    return result;
+}
+
+qreal distance( const QPointF &a, const QPointF &b )
+{
+    // Haversine distance in meters of positions in degrees
+    const qreal lat1 = a.y() * M_PI / 180.0;
+    const qreal lat2 = b.y() * M_PI / 180.0;
+    const qreal dLat = sin( ( lat2 - lat1 ) / 2 );
+    const qreal dLon = sin( ( b.x() - a.x() ) * M_PI / 360.0 );
+    return 2 * 6378000.0 * asin( sqrt( dLat * dLat + cos( lat1 ) * cos( lat2 ) * dLon * dLon ) );
+}
+
+bool readOsm( const QString &fileName, QHash<qint64, QPointF> &nodes, QList<Way> &ways )
+{
+    QFile file( fileName );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "Cannot open" << fileName;
+        return false;
+    }
+
+    const QHash<QString, qreal> highwaySpeeds = speeds();
+    QXmlStreamReader xml( &file );
+    Way way;
+    bool inWay = false;
+    QString highway;
+    QString oneway;
+
+    while ( !xml.atEnd() ) {
+        xml.readNext();
+        if ( xml.isStartElement() ) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            if ( xml.name() == "node" ) {
+                nodes.insert( attributes.value( "id" ).toString().toLongLong(),
+                              QPointF( attributes.value( "lon" ).toString().toDouble(),
+                                       attributes.value( "lat" ).toString().toDouble() ) );
+            } else if ( xml.name() == "way" ) {
+                inWay = true;
+                way.nodes.clear();
+                highway.clear();
+                oneway.clear();
+            } else if ( inWay && xml.name() == "nd" ) {
+                way.nodes << attributes.value( "ref" ).toString().toLongLong();
+            } else if ( inWay && xml.name() == "tag" ) {
+                const QStringRef key = attributes.value( "k" );
+                if ( key == "highway" ) {
+                    highway = attributes.value( "v" ).toString();
+                } else if ( key == "oneway" ) {
+                    oneway = attributes.value( "v" ).toString();
+                } else if ( key == "junction" && attributes.value( "v" ) == "roundabout" && oneway.isEmpty() ) {
+                    oneway = "yes";
+                }
+            }
+        } else if ( xml.isEndElement() && xml.name() == "way" ) {
+            inWay = false;
+            if ( highwaySpeeds.contains( highway ) && way.nodes.size() > 1 ) {
+                way.speed = highwaySpeeds.value( highway );
+                way.direction = 0;
+                if ( oneway == "yes" || oneway == "true" || oneway == "1" || ( oneway.isEmpty() && highway == "motorway" ) ) {
+                    way.direction = 1;
+                } else if ( oneway == "-1" ) {
+                    way.direction = -1;
+                }
+                ways << way;
+            }
+        }
+    }
+
+    if ( xml.hasError() ) {
+        qDebug() << "Error reading" << fileName << ":" << xml.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    const QStringList arguments = app.arguments();
+    if ( arguments.size() != 3 ) {
+        usage();
+        return 1;
+    }
+
+    QTime timer;
+    timer.start();
+
+    QHash<qint64, QPointF> osmNodes;
+    QList<Way> ways;
+    if ( !readOsm( arguments.at( 1 ), osmNodes, ways ) ) {
+        return 2;
+    }
+    qDebug() << "Read" << osmNodes.size() << "nodes and" << ways.size() << "roads in" << timer.elapsed() << "ms";
+
+    ChGraphBuilder builder;
+    QHash<qint64, int> graphNodes;
+    foreach ( const Way &way, ways ) {
+        int previous = -1;
+        QPointF previousPosition;
+        foreach ( qint64 id, way.nodes ) {
+            if ( !osmNodes.contains( id ) ) {
+                previous = -1;
+                continue;
+            }
+
+            const QPointF position = osmNodes.value( id );
+            int node = graphNodes.value( id, -1 );
+            if ( node < 0 ) {
+                node = builder.addNode( position.x(), position.y() );
+                graphNodes.insert( id, node );
+            }
+
+            if ( previous >= 0 ) {
+                // Travel time in tenths of a second
+                const quint32 weight = qMax<quint32>( 1, qRound( distance( previousPosition, position ) / ( way.speed / 3.6 ) * 10 ) );
+                if ( way.direction >= 0 ) {
+                    builder.addEdge( previous, node, weight );
+                }
+                if ( way.direction <= 0 ) {
+                    builder.addEdge( node, previous, weight );
+                }
+            }
+
+            previous = node;
+            previousPosition = position;
+        }
+    }
+    osmNodes.clear();
+
+    timer.restart();
+    if ( !builder.write( arguments.at( 2 ) ) ) {
+        qDebug() << "Cannot write" << arguments.at( 2 );
+        return 3;
+    }
+    qDebug() << "Contracted" << builder.nodeCount() << "nodes in" << timer.elapsed() << "ms";
+
+    return 0;
+}
@@ -0,0 +1,20 @@
+QT       += core
+
+QT       -= gui
+
+TARGET = osm-ch
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+# The graph format is shared with the contraction hierarchies runner plugin
+INCLUDEPATH += ../../src/plugins/runner/ch
+
+SOURCES += main.cpp \
+    ../../src/plugins/runner/ch/ChGraphBuilder.cpp
+
+HEADERS += \
+    ../../src/plugins/runner/ch/ChGraph.h \
+    ../../src/plugins/runner/ch/ChGraphBuilder.h \
+    ../../src/plugins/runner/ch/ChHeap.h
@@ -14,7 +14,11 @@
 
 #include <QtCore/QDebug>
 #include <QtCore/QDateTime>
+#include <QtCore/QFile>
 #include <QtCore/QProcess>
+#include <QtCore/QTime>
+
+#include <unistd.h>
 
 Job::Job(const Region &region, const JobParameters &parameters, QObject *parent) :
     QObject(parent), m_status(Waiting), m_region(region), m_parameters(parameters)
@@ -37,6 +41,41 @@ Region Job::region() const
     return m_region;
 }
 
+QString Job::id() const
+{
+    return m_region.id() + "_" + m_transport;
+}
+
+qint64 Job::inputSize()
+{
+    return osmFile().exists() ? osmFile().size() : remoteInputSize();
+}
+
+qint64 Job::remoteInputSize() const
+{
+    QProcess wget;
+    QStringList arguments;
+    arguments << "--spider" << "--server-response" << "--timeout=30" << "--tries=1" << m_region.pbfFile();
+    wget.start("wget", arguments);
+    wget.waitForFinished(1000 * 60);
+
+    // The headers are printed to stderr, after redirects the last length counts
+    qint64 result = 0;
+    foreach(const QByteArray &line, wget.readAllStandardError().split('\n')) {
+        QByteArray const header = line.trimmed();
+        if (header.toLower().startsWith("content-length:")) {
+            result = header.mid(15).trimmed().toLongLong();
+        }
+    }
+
+    return result;
+}
+
+JobRun Job::lastRun() const
+{
+    return m_lastRun;
+}
+
 void Job::setTransport(const QString &transport)
 {
     m_transport = transport;
@@ -64,10 +103,16 @@ bool Job::operator ==(const Job &other) const
 
 void Job::run()
 {
+    QTime timer;
+    timer.start();
+    m_lastRun = JobRun();
+
     if (download() && monav() && search() && package() && upload()) {
         // Nothing to do.
     }
 
+    m_lastRun.inputSize = osmFile().size();
+    m_lastRun.cost.duration = timer.elapsed() / 1000;
     cleanup();
     emit finished(this);
 }
@@ -86,12 +131,50 @@ void Job::changeStatus(Job::Status status, const QString &message)
     case Error: statusType = "error"; break;
     }
 
-    Logger::instance().setStatus(m_region.id() + "_" + m_transport,
+    Logger::instance().setStatus(id(),
                                  m_region.name() + " (" + m_transport + ")", statusType, message);
     m_statusMessage = message;
     m_status = status;
 }
 
+void Job::execute(QProcess &process, const QString &program, const QStringList &arguments, int timeout)
+{
+    QTime timer;
+    timer.start();
+    process.start(program, arguments);
+    Q_PID const pid = process.pid();
+
+    // Peak memory and processor time as reported by the kernel, sampled every second
+    qint64 peakMemory = 0;
+    qint64 processorTicks = 0;
+    while (!process.waitForFinished(1000) && process.state() != QProcess::NotRunning && timer.elapsed() < timeout) {
+        QFile status(QString("/proc/%1/status").arg(pid));
+        if (status.open(QFile::ReadOnly)) {
+            foreach(const QByteArray &line, status.readAll().split('\n')) {
+                if (line.startsWith("VmHWM:")) {
+                    peakMemory = qMax(peakMemory, line.mid(6).trimmed().split(' ').first().toLongLong());
+                }
+            }
+        }
+
+        QFile stat(QString("/proc/%1/stat").arg(pid));
+        if (stat.open(QFile::ReadOnly)) {
+            QByteArray const content = stat.readAll();
+            QList<QByteArray> const fields = content.mid(content.lastIndexOf(')') + 2).split(' ');
+            if (fields.size() > 12) {
+                processorTicks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+            }
+        }
+    }
+
+    m_lastRun.cost.memory = qMax<int>(m_lastRun.cost.memory, peakMemory / 1024);
+    qint64 const elapsedTicks = qint64(timer.elapsed()) * sysconf(_SC_CLK_TCK) / 1000;
+    if (elapsedTicks > 0) {
+        int const cores = (processorTicks + elapsedTicks - 1) / elapsedTicks;
+        m_lastRun.cost.cores = qMax(m_lastRun.cost.cores, cores);
+    }
+}
+
 bool Job::download()
 {
     changeStatus(Downloading, "Downloading data.");
@@ -162,8 +245,7 @@ bool Job::monav()
     arguments << "--profile=" + m_profile;
     arguments << "-dd" /*<< "-dc"*/;
     QProcess monav;
-    monav.start("monav-preprocessor", arguments);
-    monav.waitForFinished(1000 * 60 * 60 * 6); // wait up to 6 hours for monav to convert the data
+    execute(monav, "monav-preprocessor", arguments, 1000 * 60 * 60 * 6); // wait up to 6 hours for monav to convert the data
     if (monav.exitStatus() == QProcess::NormalExit && monav.exitCode() == 0) {
         qDebug() << "Processed osm file for monav";
     } else {
@@ -211,8 +293,7 @@ bool Job::search()
     QFileInfo kmlFile(monavDir().absoluteFilePath() + "/marble.kml");
     arguments << kmlFile.absoluteFilePath();
     QProcess osmAddresses;
-    osmAddresses.start("osm-addresses", arguments);
-    osmAddresses.waitForFinished(1000 * 60 * 60 * 18); // wait up to 18 hours for osm-addresses to convert the data
+    execute(osmAddresses, "osm-addresses", arguments, 1000 * 60 * 60 * 18); // wait up to 18 hours for osm-addresses to convert the data
     if (osmAddresses.exitStatus() == QProcess::NormalExit && osmAddresses.exitCode() == 0) {
         searchFile().refresh();
         if (!searchFile().exists()) {
@@ -12,11 +12,13 @@
 #define JOB_H
 
 #include "jobparameters.h"
+#include "jobscheduler.h"
 #include "region.h"
 
 #include <QtCore/QObject>
 #include <QtCore/QRunnable>
 #include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
 
 class Job : public QObject, public QRunnable
 {
@@ -41,6 +43,18 @@ public:
 
     Region region() const;
 
+    /** The region id and transport, unique among all jobs */
+    QString id() const;
+
+    /**
+     * Size of the input file. If it was not downloaded yet, or was deleted
+     * after the last run, the download server is asked for it. 0 if unknown.
+     */
+    qint64 inputSize();
+
+    /** Time, memory and cores the job needed when it ran last */
+    JobRun lastRun() const;
+
     void setTransport(const QString &transport);
 
     QString transport() const;
@@ -59,6 +73,12 @@ Q_SIGNALS:
 private:
     void changeStatus(Status status, const QString &message);
 
+    /** Runs the program and keeps track of the memory and cores it uses */
+    void execute(QProcess &process, const QString &program, const QStringList &arguments, int timeout);
+
+    /** Size of the .osm.pbf file on the download server, 0 if unknown */
+    qint64 remoteInputSize() const;
+
     bool download();
 
     bool monav();
@@ -92,6 +112,8 @@ private:
     QString m_profile;
 
     QString m_monavSettings;
+
+    JobRun m_lastRun;
 };
 
 #endif // JOB_H
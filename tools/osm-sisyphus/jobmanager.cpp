@@ -110,6 +110,16 @@ void JobManager::setJobParameters(const JobParameters &parameters)
     m_jobParameters = parameters;
 }
 
+void JobManager::setMemoryBudget(int megabytes)
+{
+    m_queue.setMemoryBudget(megabytes);
+}
+
+void JobManager::setCoreBudget(int cores)
+{
+    m_queue.setCoreBudget(cores);
+}
+
 void JobManager::update()
 {
     bool resume = m_resumeId.isEmpty();
@@ -38,6 +38,10 @@ public:
 
     void setJobParameters(const JobParameters &parameters);
 
+    void setMemoryBudget(int megabytes);
+
+    void setCoreBudget(int cores);
+
 private Q_SLOTS:
     void update();
 
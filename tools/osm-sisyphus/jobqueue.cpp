@@ -12,52 +12,78 @@
 #include "logger.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QThread>
 #include <QtCore/QThreadPool>
 
+#include <unistd.h>
+
 JobQueue::JobQueue(QObject *parent) :
-    QObject(parent), m_maxConcurrentJobs(1)
+    QObject(parent)
 {
-    // nothing to do
+    setCoreBudget(QThread::idealThreadCount());
+
+    // Leave a quarter of the physical memory to the system
+    qint64 const pages = sysconf(_SC_PHYS_PAGES);
+    qint64 const pageSize = sysconf(_SC_PAGE_SIZE);
+    if (pages > 0 && pageSize > 0) {
+        setMemoryBudget(pages * pageSize / (1024 * 1024) * 3 / 4);
+    }
 }
 
 void JobQueue::addJob(Job *newJob)
 {
-    QList<Job*> const allJobs = m_jobs + m_runningJobs;
-    foreach(Job* job, allJobs) {
-        if (*job == *newJob) {
-            qDebug() << "Ignoring job, still running";
-            return;
-        }
+    if (m_scheduler.contains(newJob->id())) {
+        qDebug() << "Ignoring job, still running";
+        delete newJob;
+        return;
     }
 
+    // Jobs are deleted once their statistics are recorded
+    newJob->setAutoDelete(false);
     connect(newJob, SIGNAL(finished(Job*)), this, SLOT(removeJob(Job*)));
 
-    if (m_runningJobs.size()<m_maxConcurrentJobs) {
-        startJob(newJob);
-    } else {
-        Logger::instance().setStatus(newJob->region().id() + "_" + newJob->transport(), newJob->region().name() + " (" + newJob->transport() + ")", "waiting", "Queued.");
-        m_jobs << newJob;
-    }
+    JobCost const cost = JobScheduler::estimate(newJob->inputSize(), Logger::instance().runs(newJob->id()));
+    QString const estimate = QString("Queued, estimated to need %1 MB memory, %2 cores and %3 minutes.")
+                             .arg(cost.memory).arg(cost.cores).arg(cost.duration / 60);
+    Logger::instance().setStatus(newJob->id(), newJob->region().name() + " (" + newJob->transport() + ")", "waiting", estimate);
+    m_jobs[newJob->id()] = newJob;
+    // Jobs of a region share the downloaded input and the search database
+    m_scheduler.add(newJob->id(), cost, newJob->region().id());
+    startJobs();
 }
 
-void JobQueue::setMaxConcurrentJobs(int size)
+void JobQueue::setMemoryBudget(int megabytes)
 {
-    m_maxConcurrentJobs = size;
+    m_scheduler.setMemoryBudget(megabytes);
 }
 
-void JobQueue::removeJob(Job *job)
+void JobQueue::setCoreBudget(int cores)
 {
-    m_runningJobs.removeAll(job);
+    m_scheduler.setCoreBudget(cores);
+
+    // Jobs mostly wait for external processes, each needs a thread nevertheless
+    if (QThreadPool::globalInstance()->maxThreadCount() < cores) {
+        QThreadPool::globalInstance()->setMaxThreadCount(cores);
+    }
+}
 
-    while (m_runningJobs.size()<m_maxConcurrentJobs && !m_jobs.isEmpty()) {
-        Job* newJob = m_jobs.first();
-        m_jobs.removeFirst();
-        startJob(newJob);
+void JobQueue::removeJob(Job *job)
+{
+    m_scheduler.finish(job->id());
+    m_jobs.remove(job->id());
+    if (job->status() != Job::Error) {
+        Logger::instance().addRun(job->id(), job->lastRun());
     }
+    job->deleteLater();
+
+    startJobs();
 }
 
-void JobQueue::startJob(Job *job)
+void JobQueue::startJobs()
 {
-    m_runningJobs << job;
-    QThreadPool::globalInstance()->start(job);
+    foreach(const QString &id, m_scheduler.takeRunnable()) {
+        qDebug() << "Starting" << id << "," << m_scheduler.runningCount() << "jobs running using"
+                 << m_scheduler.usedMemory() << "MB and" << m_scheduler.usedCores() << "cores";
+        QThreadPool::globalInstance()->start(m_jobs.value(id));
+    }
 }
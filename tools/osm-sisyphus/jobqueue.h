@@ -12,9 +12,10 @@
 #define JOBQUEUE_H
 
 #include "job.h"
+#include "jobscheduler.h"
 
 #include <QtCore/QObject>
-#include <QtCore/QList>
+#include <QtCore/QHash>
 
 class JobQueue : public QObject
 {
@@ -24,19 +25,21 @@ public:
 
     void addJob(Job* job);
 
-    void setMaxConcurrentJobs(int size);
+    /** Memory in MB the running jobs may use together */
+    void setMemoryBudget(int megabytes);
+
+    /** Processor cores the running jobs may use together */
+    void setCoreBudget(int cores);
 
 private Q_SLOTS:
     void removeJob(Job* job);
 
 private:
-    void startJob(Job *job);
-
-    QList<Job*> m_jobs;
+    void startJobs();
 
-    QList<Job*> m_runningJobs;
+    QHash<QString, Job*> m_jobs;
 
-    int m_maxConcurrentJobs;
+    JobScheduler m_scheduler;
 };
 
 #endif // JOBQUEUE_H
@@ -0,0 +1,161 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "jobscheduler.h"
+
+#include <QtCore/QtAlgorithms>
+
+// Rough guesses for jobs without history. Converting a region with monav and
+// osm-addresses takes memory and time roughly proportional to its input size.
+static const int baseMemory = 256;
+static const int memoryPerInputMegabyte = 12;
+static const int baseDuration = 300;
+static const int durationPerInputMegabyte = 20;
+
+JobScheduler::JobScheduler() :
+    m_memoryBudget(2048), m_coreBudget(1), m_usedMemory(0), m_usedCores(0)
+{
+    // nothing to do
+}
+
+void JobScheduler::setMemoryBudget(int megabytes)
+{
+    m_memoryBudget = megabytes;
+}
+
+int JobScheduler::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+void JobScheduler::setCoreBudget(int cores)
+{
+    m_coreBudget = cores;
+}
+
+int JobScheduler::coreBudget() const
+{
+    return m_coreBudget;
+}
+
+JobCost JobScheduler::estimate(qint64 inputSize, const QList<JobRun> &history)
+{
+    JobCost result;
+
+    // Scale the most recent run to the current input size
+    foreach(const JobRun &run, history) {
+        if (inputSize > 0 && run.inputSize > 0) {
+            qreal const factor = qreal(inputSize) / run.inputSize;
+            result.memory = qMax(1, qRound(run.cost.memory * factor));
+            result.duration = qRound(run.cost.duration * factor);
+            result.cores = qMax(1, run.cost.cores);
+            return result;
+        }
+    }
+
+    if (!history.isEmpty()) {
+        return history.first().cost;
+    }
+
+    int const megabytes = inputSize / (1024 * 1024);
+    result.memory = baseMemory + memoryPerInputMegabyte * megabytes;
+    result.duration = baseDuration + durationPerInputMegabyte * megabytes;
+    return result;
+}
+
+bool JobScheduler::isLarger(const Entry &one, const Entry &other)
+{
+    if (one.cost.duration != other.cost.duration) {
+        return one.cost.duration > other.cost.duration;
+    }
+
+    return one.cost.memory > other.cost.memory;
+}
+
+void JobScheduler::add(const QString &id, const JobCost &cost, const QString &group)
+{
+    Entry entry;
+    entry.id = id;
+    entry.cost = cost;
+    entry.group = group;
+    QList<Entry>::iterator position = qUpperBound(m_pending.begin(), m_pending.end(), entry, isLarger);
+    m_pending.insert(position, entry);
+}
+
+bool JobScheduler::contains(const QString &id) const
+{
+    if (m_running.contains(id)) {
+        return true;
+    }
+
+    foreach(const Entry &entry, m_pending) {
+        if (entry.id == id) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool JobScheduler::fits(const JobCost &cost) const
+{
+    return m_usedMemory + cost.memory <= m_memoryBudget && m_usedCores + cost.cores <= m_coreBudget;
+}
+
+QStringList JobScheduler::takeRunnable()
+{
+    QStringList result;
+    QList<Entry>::iterator iter = m_pending.begin();
+    while (iter != m_pending.end()) {
+        bool const groupBusy = !iter->group.isEmpty() && m_busyGroups.contains(iter->group);
+        if (!groupBusy && (m_running.isEmpty() || fits(iter->cost))) {
+            m_running.insert(iter->id, *iter);
+            if (!iter->group.isEmpty()) {
+                m_busyGroups.insert(iter->group);
+            }
+            m_usedMemory += iter->cost.memory;
+            m_usedCores += iter->cost.cores;
+            result << iter->id;
+            iter = m_pending.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    return result;
+}
+
+void JobScheduler::finish(const QString &id)
+{
+    if (m_running.contains(id)) {
+        Entry const entry = m_running.take(id);
+        m_busyGroups.remove(entry.group);
+        m_usedMemory -= entry.cost.memory;
+        m_usedCores -= entry.cost.cores;
+    }
+}
+
+int JobScheduler::pendingCount() const
+{
+    return m_pending.size();
+}
+
+int JobScheduler::runningCount() const
+{
+    return m_running.size();
+}
+
+int JobScheduler::usedMemory() const
+{
+    return m_usedMemory;
+}
+
+int JobScheduler::usedCores() const
+{
+    return m_usedCores;
+}
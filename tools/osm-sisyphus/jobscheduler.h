@@ -0,0 +1,112 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#ifndef JOBSCHEDULER_H
+#define JOBSCHEDULER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+/** Resources a job needs, estimated before it runs or measured afterwards */
+struct JobCost {
+    JobCost() : memory(0), cores(1), duration(0) {}
+
+    int memory; // peak memory in MB
+
+    int cores;
+
+    int duration; // wall clock time in seconds
+};
+
+/** A past run of a job */
+struct JobRun {
+    JobRun() : inputSize(0) {}
+
+    qint64 inputSize; // size of the .osm.pbf file in bytes
+
+    JobCost cost;
+};
+
+/**
+ * Decides which of the queued jobs to start such that the running ones stay
+ * within the memory and core budgets. The longest jobs are started first,
+ * smaller ones fill the remaining resources. A job exceeding the budgets on
+ * its own is started once nothing else runs. Jobs of the same group, like
+ * those sharing their input and output files, never run at the same time.
+ */
+class JobScheduler
+{
+public:
+    JobScheduler();
+
+    void setMemoryBudget(int megabytes);
+
+    int memoryBudget() const;
+
+    void setCoreBudget(int cores);
+
+    int coreBudget() const;
+
+    /**
+     * Estimates the resources of a job from the size of its input and its
+     * past runs, most recent first. Without history a rough guess based on
+     * the input size is used.
+     */
+    static JobCost estimate(qint64 inputSize, const QList<JobRun> &history);
+
+    /** Queues the job with the given id, in the given group if not empty */
+    void add(const QString &id, const JobCost &cost, const QString &group = QString());
+
+    bool contains(const QString &id) const;
+
+    /** Removes the jobs which fit into the available resources from the queue and returns their ids */
+    QStringList takeRunnable();
+
+    /** Releases the resources of a running job */
+    void finish(const QString &id);
+
+    int pendingCount() const;
+
+    int runningCount() const;
+
+    int usedMemory() const;
+
+    int usedCores() const;
+
+private:
+    struct Entry {
+        QString id;
+        JobCost cost;
+        QString group;
+    };
+
+    static bool isLarger(const Entry &one, const Entry &other);
+
+    bool fits(const JobCost &cost) const;
+
+    int m_memoryBudget;
+
+    int m_coreBudget;
+
+    // Sorted by decreasing duration
+    QList<Entry> m_pending;
+
+    QHash<QString, Entry> m_running;
+
+    // Groups of the running jobs
+    QSet<QString> m_busyGroups;
+
+    int m_usedMemory;
+
+    int m_usedCores;
+};
+
+#endif // JOBSCHEDULER_H
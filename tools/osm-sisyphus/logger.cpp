@@ -38,6 +38,12 @@ void LoggerPrivate::initializeDatabase()
         qDebug() << "Error when executing query" << createJobsTable.lastQuery();
         qDebug() << "Sql reports" << createJobsTable.lastError();
     }
+
+    QSqlQuery createHistoryTable( "CREATE TABLE IF NOT EXISTS history (id VARCHAR(255), input_size INTEGER, duration INTEGER, memory INTEGER, cores INTEGER, timestamp DATETIME DEFAULT CURRENT_TIMESTAMP);" );
+    if ( createHistoryTable.lastError().isValid() ) {
+        qDebug() << "Error when executing query" << createHistoryTable.lastQuery();
+        qDebug() << "Sql reports" << createHistoryTable.lastError();
+    }
 }
 
 Logger::Logger(QObject *parent) :
@@ -85,3 +91,43 @@ void Logger::setStatus(const QString &id, const QString &name, const QString &st
         }
     }
 }
+
+void Logger::addRun(const QString &id, const JobRun &run)
+{
+    QSqlQuery addRun;
+    addRun.prepare("INSERT INTO history (id, input_size, duration, memory, cores) VALUES (:job, :inputSize, :duration, :memory, :cores);");
+    addRun.bindValue(":job", id);
+    addRun.bindValue(":inputSize", run.inputSize);
+    addRun.bindValue(":duration", run.cost.duration);
+    addRun.bindValue(":memory", run.cost.memory);
+    addRun.bindValue(":cores", run.cost.cores);
+    if ( !addRun.exec() ) {
+        qDebug() << "Error when executing query" << addRun.lastQuery();
+        qDebug() << "Sql reports" << addRun.lastError();
+    }
+}
+
+QList<JobRun> Logger::runs(const QString &id, int count) const
+{
+    QList<JobRun> result;
+    QSqlQuery history;
+    history.prepare("SELECT input_size, duration, memory, cores FROM history WHERE id=:job ORDER BY timestamp DESC, rowid DESC LIMIT :count;");
+    history.bindValue(":job", id);
+    history.bindValue(":count", count);
+    if ( !history.exec() ) {
+        qDebug() << "Error when executing query" << history.lastQuery();
+        qDebug() << "Sql reports" << history.lastError();
+        return result;
+    }
+
+    while ( history.next() ) {
+        JobRun run;
+        run.inputSize = history.value(0).toLongLong();
+        run.cost.duration = history.value(1).toInt();
+        run.cost.memory = history.value(2).toInt();
+        run.cost.cores = history.value(3).toInt();
+        result << run;
+    }
+
+    return result;
+}
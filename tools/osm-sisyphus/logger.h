@@ -11,6 +11,8 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+#include "jobscheduler.h"
+
 #include <QtCore/QObject>
 
 class LoggerPrivate;
@@ -24,6 +26,12 @@ public:
     void setFilename(const QString &filename);
 
     void setStatus(const QString &id, const QString &name, const QString &status, const QString &message);
+
+    /** Records the resources a successful run of the job needed */
+    void addRun(const QString &id, const JobRun &run);
+
+    /** The last runs of the job, most recent first */
+    QList<JobRun> runs(const QString &id, int count = 5) const;
     
 private:
     explicit Logger(QObject *parent = 0);
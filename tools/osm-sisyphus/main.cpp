@@ -22,6 +22,8 @@ void usage(const QString &app)
     qDebug() << "\t-h, --help................. Show this help";
     qDebug() << "\t-cd, --cache-data.......... Do not delete downloaded .osm.pbf and converted .tar.gz files after a successful conversion and upload";
     qDebug() << "\t-nu, --no-uploads.......... Do not upload converted files to files.kde.org";
+    qDebug() << "\t-m, --memory megabytes..... Memory all running conversions may use together (default: 3/4 of the physical memory)";
+    qDebug() << "\t-c, --cores cores.......... Processor cores all running conversions may use together (default: all)";
 }
 
 int main(int argc, char *argv[])
@@ -31,6 +33,8 @@ int main(int argc, char *argv[])
     QStringList arguments;
     bool cacheData(false);
     bool uploadFiles(true);
+    int memoryBudget(0);
+    int coreBudget(0);
     for (int i=1; i<argc; ++i) {
         QString const arg = argv[i];
         if (arg == "-h" || arg == "--help") {
@@ -40,6 +44,10 @@ int main(int argc, char *argv[])
             cacheData = true;
         } else if (arg == "-nu" || arg == "--no-uploads") {
             uploadFiles = false;
+        } else if ((arg == "-m" || arg == "--memory") && i+1<argc) {
+            memoryBudget = QString(argv[++i]).toInt();
+        } else if ((arg == "-c" || arg == "--cores") && i+1<argc) {
+            coreBudget = QString(argv[++i]).toInt();
         } else {
             arguments << arg;
         }
@@ -63,6 +71,12 @@ int main(int argc, char *argv[])
     JobManager manager;
     manager.setRegionsFile(arguments.at(0));
     manager.setJobParameters(parameters);
+    if (memoryBudget > 0) {
+        manager.setMemoryBudget(memoryBudget);
+    }
+    if (coreBudget > 0) {
+        manager.setCoreBudget(coreBudget);
+    }
     if (arguments.size() == 3) {
         manager.setResumeId(arguments.at(2));
     }
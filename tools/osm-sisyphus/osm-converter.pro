@@ -17,6 +17,7 @@ TEMPLATE = app
 
 SOURCES += main.cpp \
     jobqueue.cpp \
+    jobscheduler.cpp \
     job.cpp \
     jobmanager.cpp \
     jobparameters.cpp \
@@ -26,6 +27,7 @@ SOURCES += main.cpp \
 
 HEADERS += \
     jobqueue.h \
+    jobscheduler.h \
     job.h \
     jobmanager.h \
     jobparameters.h \
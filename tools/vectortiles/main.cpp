@@ -0,0 +1,78 @@
+//
+// This file is part of the Marble Virtual Globe.
+//
+// This program is free software licensed under the GNU LGPL. You can
+// find a copy of this license in LICENSE.txt in the top directory of
+// the source code.
+//
+
+#include "GeoDataDocument.h"
+#include "GeoDataParser.h"
+#include "VectorTileCreator.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+
+using namespace Marble;
+
+void usage()
+{
+    qDebug() << "Usage: vectortiles [-l level] input.kml outputdir";
+    qDebug() << "\tSplits a large KML document into vector tiles for the VectorTileLoader.";
+    qDebug() << "\t-l level\tthe highest tile level to create, 10 by default";
+}
+
+int main( int argc, char *argv[] )
+{
+    QCoreApplication app( argc, argv );
+
+    QStringList arguments = app.arguments();
+    arguments.removeFirst();
+    int level = 10;
+    if ( arguments.size() == 4 && arguments.first() == "-l" ) {
+        bool ok = false;
+        level = arguments.at( 1 ).toInt( &ok );
+        if ( !ok || level < 0 ) {
+            usage();
+            return 1;
+        }
+        arguments = arguments.mid( 2 );
+    }
+
+    if ( arguments.size() != 2 ) {
+        usage();
+        return 1;
+    }
+
+    QFile file( arguments.first() );
+    if ( !file.open( QIODevice::ReadOnly ) ) {
+        qDebug() << "Cannot open" << file.fileName();
+        return 2;
+    }
+
+    QTime timer;
+    timer.start();
+    GeoDataParser parser( GeoData_KML );
+    if ( !parser.read( &file ) ) {
+        qDebug() << "Cannot parse" << file.fileName() << ":" << parser.errorString();
+        return 3;
+    }
+    GeoDataDocument *document = static_cast<GeoDataDocument*>( parser.releaseDocument() );
+    qDebug() << "Parsed" << file.fileName() << "in" << timer.elapsed() << "ms";
+
+    timer.restart();
+    VectorTileCreator creator( document );
+    creator.setMaximumLevel( level );
+    const bool created = creator.create( arguments.last() );
+    delete document;
+    if ( !created ) {
+        qDebug() << creator.errorString();
+        return 4;
+    }
+
+    qDebug() << "Created the tiles of levels 0 to" << creator.maximumLevel() << "in" << timer.elapsed() << "ms";
+    return 0;
+}
@@ -0,0 +1,20 @@
+QT       += core gui xml
+
+TARGET = vectortiles
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+# Adjust these according to your system
+
+# Marble include dirs
+INCLUDEPATH += ../../src/lib
+INCLUDEPATH += ../../src/lib/geodata
+INCLUDEPATH += ../../src/lib/geodata/data
+INCLUDEPATH += ../../src/lib/geodata/parser
+
+# Marble lib path and library
+LIBS += -L../../build/src/lib -lmarblewidget
+
+SOURCES += main.cpp